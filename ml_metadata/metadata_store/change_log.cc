@@ -0,0 +1,112 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/change_log.h"
+
+#include <algorithm>
+
+#include "absl/time/clock.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace ml_metadata {
+
+ChangeLog::ChangeLog(const int64 log_id, const int64 last_sequence,
+                     const int64 max_num_changes, const int64 max_num_watchers)
+    : log_id_(log_id),
+      max_num_changes_(max_num_changes),
+      max_num_watchers_(max_num_watchers),
+      last_sequence_(last_sequence) {
+  CHECK_GT(max_num_changes, 0);
+  CHECK_GT(max_num_watchers, 0);
+}
+
+void ChangeLog::Append(const int64 last_sequence,
+                       std::vector<Change> changes) {
+  if (changes.empty()) return;
+  absl::MutexLock l(&lock_);
+  int64 sequence = last_sequence - changes.size();
+  if (sequence != last_sequence_) changes_.clear();
+  for (Change& change : changes) {
+    change.set_sequence(++sequence);
+    changes_.push_back(std::move(change));
+  }
+  last_sequence_ = last_sequence;
+  while (static_cast<int64>(changes_.size()) > max_num_changes_) {
+    changes_.pop_front();
+  }
+  appended_.SignalAll();
+}
+
+tensorflow::Status ChangeLog::Read(const int64 after_sequence,
+                                   const int64 max_num_changes,
+                                   std::vector<Change>* changes) const {
+  absl::MutexLock l(&lock_);
+  const int64 first_sequence = last_sequence_ - changes_.size() + 1;
+  if (after_sequence < first_sequence - 1 || after_sequence > last_sequence_) {
+    return tensorflow::errors::OutOfRange(
+        "The changes after sequence ", after_sequence,
+        " are not in the change log, which keeps the sequences from ",
+        first_sequence, " to ", last_sequence_);
+  }
+  const int64 end_sequence =
+      max_num_changes > 0
+          ? std::min<int64>(last_sequence_, after_sequence + max_num_changes)
+          : last_sequence_;
+  for (int64 sequence = after_sequence + 1; sequence <= end_sequence;
+       ++sequence) {
+    changes->push_back(changes_[sequence - first_sequence]);
+  }
+  return tensorflow::Status::OK();
+}
+
+bool ChangeLog::WaitForChanges(const int64 after_sequence,
+                               const absl::Duration timeout) const {
+  const absl::Time deadline = absl::Now() + timeout;
+  absl::MutexLock l(&lock_);
+  while (last_sequence_ <= after_sequence) {
+    // WaitWithDeadline returns true once the deadline expires.
+    if (appended_.WaitWithDeadline(&lock_, deadline)) break;
+  }
+  return last_sequence_ > after_sequence;
+}
+
+tensorflow::Status ChangeLog::AddWatcher() {
+  absl::MutexLock l(&lock_);
+  if (num_watchers_ >= max_num_watchers_) {
+    return tensorflow::errors::ResourceExhausted(
+        "The change log has the maximum number of watchers: ",
+        max_num_watchers_);
+  }
+  ++num_watchers_;
+  return tensorflow::Status::OK();
+}
+
+void ChangeLog::RemoveWatcher() {
+  absl::MutexLock l(&lock_);
+  CHECK_GT(num_watchers_, 0);
+  --num_watchers_;
+}
+
+int64 ChangeLog::last_sequence() const {
+  absl::MutexLock l(&lock_);
+  return last_sequence_;
+}
+
+int64 ChangeLog::num_changes() const {
+  absl::MutexLock l(&lock_);
+  return changes_.size();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,104 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_CHANGE_LOG_H_
+#define ML_METADATA_METADATA_STORE_CHANGE_LOG_H_
+
+#include <deque>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// A size-bounded log of the committed changes of a MetadataStore, read by the
+// watchers of the changes. The oldest changes are dropped once there are more
+// than `max_num_changes` of them.
+//
+// The changes are kept in memory, while their sequences are assigned by the
+// metadata source along with the writes, and the log is identified by the
+// log id stored there. So a watcher can resume its cursor with another process
+// serving the same store, as long as it has read every change before.
+//
+// It is thread-safe, so that the watchers can wait for the changes while the
+// store is written.
+class ChangeLog {
+ public:
+  // Creates a log without changes, whose next change has the sequence
+  // `last_sequence` + 1. At most `max_num_watchers` watchers are added.
+  // `max_num_changes` and `max_num_watchers` should be positive.
+  ChangeLog(int64 log_id, int64 last_sequence, int64 max_num_changes,
+            int64 max_num_watchers);
+
+  // default & copy constructors are disallowed.
+  ChangeLog() = delete;
+  ChangeLog(const ChangeLog&) = delete;
+  ChangeLog& operator=(const ChangeLog&) = delete;
+
+  // Appends the `changes` in order, and sets their sequences so that the last
+  // one is `last_sequence`. If the sequences do not follow the last appended
+  // one, e.g., they are advanced by another process, the kept changes are
+  // dropped, as the skipped changes cannot be read.
+  void Append(int64 last_sequence, std::vector<Change> changes);
+
+  // Reads at most `max_num_changes` changes after the sequence
+  // `after_sequence` to `changes`. If `max_num_changes` is not positive, all
+  // the kept changes after `after_sequence` are read.
+  // Returns OUT_OF_RANGE error, if a change after `after_sequence` is dropped,
+  // or `after_sequence` is beyond the last sequence.
+  tensorflow::Status Read(int64 after_sequence, int64 max_num_changes,
+                          std::vector<Change>* changes) const;
+
+  // Waits until there is a change after `after_sequence` or the `timeout`
+  // expires. Returns true if there is a change after `after_sequence`.
+  bool WaitForChanges(int64 after_sequence, absl::Duration timeout) const;
+
+  // Adds a watcher of the changes, which holds a server thread while it
+  // waits for them.
+  // Returns RESOURCE_EXHAUSTED error, if there are `max_num_watchers` already.
+  tensorflow::Status AddWatcher();
+
+  // Removes a watcher added by AddWatcher.
+  void RemoveWatcher();
+
+  int64 log_id() const { return log_id_; }
+  int64 max_num_changes() const { return max_num_changes_; }
+
+  // Returns the sequence of the last appended change, or 0 if there is none.
+  int64 last_sequence() const;
+
+  // Returns the number of changes kept.
+  int64 num_changes() const;
+
+ private:
+  const int64 log_id_;
+  const int64 max_num_changes_;
+  const int64 max_num_watchers_;
+  mutable absl::Mutex lock_;
+  // Signaled when changes are appended.
+  mutable absl::CondVar appended_;
+  // The kept changes in the order of their sequences.
+  std::deque<Change> changes_ ABSL_GUARDED_BY(lock_);
+  int64 last_sequence_ ABSL_GUARDED_BY(lock_);
+  int64 num_watchers_ ABSL_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_CHANGE_LOG_H_
@@ -0,0 +1,145 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/change_log.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+std::vector<Change> ArtifactChanges(const std::vector<int64>& artifact_ids) {
+  std::vector<Change> changes;
+  for (const int64 artifact_id : artifact_ids) {
+    Change change;
+    change.set_type(Change::CREATE);
+    change.mutable_artifact()->set_id(artifact_id);
+    changes.push_back(change);
+  }
+  return changes;
+}
+
+TEST(ChangeLogTest, ReadAfterSequence) {
+  ChangeLog change_log(/*log_id=*/1, /*last_sequence=*/0,
+                       /*max_num_changes=*/10, /*max_num_watchers=*/1);
+  EXPECT_EQ(change_log.last_sequence(), 0);
+  change_log.Append(/*last_sequence=*/2, ArtifactChanges({1, 2}));
+  change_log.Append(/*last_sequence=*/3, ArtifactChanges({3}));
+  EXPECT_EQ(change_log.last_sequence(), 3);
+  EXPECT_EQ(change_log.num_changes(), 3);
+
+  std::vector<Change> changes;
+  TF_ASSERT_OK(change_log.Read(/*after_sequence=*/1, /*max_num_changes=*/1,
+                               &changes));
+  ASSERT_EQ(changes.size(), 1);
+  EXPECT_THAT(changes[0], EqualsProto(ParseTextProtoOrDie<Change>(R"(
+                sequence: 2 type: CREATE artifact { id: 2 }
+              )")));
+
+  changes.clear();
+  TF_ASSERT_OK(change_log.Read(/*after_sequence=*/0, /*max_num_changes=*/0,
+                               &changes));
+  ASSERT_EQ(changes.size(), 3);
+  EXPECT_EQ(changes[2].sequence(), 3);
+
+  changes.clear();
+  TF_ASSERT_OK(change_log.Read(/*after_sequence=*/3, /*max_num_changes=*/10,
+                               &changes));
+  EXPECT_TRUE(changes.empty());
+  EXPECT_EQ(change_log
+                .Read(/*after_sequence=*/4, /*max_num_changes=*/10, &changes)
+                .code(),
+            tensorflow::error::OUT_OF_RANGE);
+}
+
+TEST(ChangeLogTest, OldestChangesAreDropped) {
+  ChangeLog change_log(/*log_id=*/1, /*last_sequence=*/0,
+                       /*max_num_changes=*/2, /*max_num_watchers=*/1);
+  change_log.Append(/*last_sequence=*/3, ArtifactChanges({1, 2, 3}));
+  EXPECT_EQ(change_log.num_changes(), 2);
+
+  std::vector<Change> changes;
+  EXPECT_EQ(change_log
+                .Read(/*after_sequence=*/0, /*max_num_changes=*/10, &changes)
+                .code(),
+            tensorflow::error::OUT_OF_RANGE);
+  TF_ASSERT_OK(change_log.Read(/*after_sequence=*/1, /*max_num_changes=*/10,
+                               &changes));
+  ASSERT_EQ(changes.size(), 2);
+  EXPECT_EQ(changes[0].artifact().id(), 2);
+  EXPECT_EQ(changes[1].artifact().id(), 3);
+}
+
+TEST(ChangeLogTest, ChangesBeforeSkippedSequencesAreDropped) {
+  // The log continues the sequences stored by a previous process.
+  ChangeLog change_log(/*log_id=*/1, /*last_sequence=*/5,
+                       /*max_num_changes=*/10, /*max_num_watchers=*/1);
+  std::vector<Change> changes;
+  TF_ASSERT_OK(change_log.Read(/*after_sequence=*/5, /*max_num_changes=*/10,
+                               &changes));
+  EXPECT_TRUE(changes.empty());
+  EXPECT_EQ(change_log
+                .Read(/*after_sequence=*/4, /*max_num_changes=*/10, &changes)
+                .code(),
+            tensorflow::error::OUT_OF_RANGE);
+  change_log.Append(/*last_sequence=*/6, ArtifactChanges({1}));
+  // The sequences 7 and 8 are assigned to the changes of another process.
+  change_log.Append(/*last_sequence=*/10, ArtifactChanges({2, 3}));
+  EXPECT_EQ(change_log.num_changes(), 2);
+  EXPECT_EQ(change_log
+                .Read(/*after_sequence=*/6, /*max_num_changes=*/10, &changes)
+                .code(),
+            tensorflow::error::OUT_OF_RANGE);
+  TF_ASSERT_OK(change_log.Read(/*after_sequence=*/8, /*max_num_changes=*/10,
+                               &changes));
+  ASSERT_EQ(changes.size(), 2);
+  EXPECT_EQ(changes[0].sequence(), 9);
+  EXPECT_EQ(changes[1].artifact().id(), 3);
+}
+
+TEST(ChangeLogTest, WatchersAreBounded) {
+  ChangeLog change_log(/*log_id=*/1, /*last_sequence=*/0,
+                       /*max_num_changes=*/10, /*max_num_watchers=*/2);
+  TF_ASSERT_OK(change_log.AddWatcher());
+  TF_ASSERT_OK(change_log.AddWatcher());
+  EXPECT_EQ(change_log.AddWatcher().code(),
+            tensorflow::error::RESOURCE_EXHAUSTED);
+  change_log.RemoveWatcher();
+  TF_EXPECT_OK(change_log.AddWatcher());
+}
+
+TEST(ChangeLogTest, WaitForChanges) {
+  ChangeLog change_log(/*log_id=*/1, /*last_sequence=*/0,
+                       /*max_num_changes=*/10, /*max_num_watchers=*/1);
+  EXPECT_FALSE(change_log.WaitForChanges(/*after_sequence=*/0,
+                                         absl::Milliseconds(10)));
+  change_log.Append(/*last_sequence=*/1, ArtifactChanges({1}));
+  EXPECT_TRUE(change_log.WaitForChanges(/*after_sequence=*/0,
+                                        absl::Milliseconds(10)));
+  EXPECT_FALSE(change_log.WaitForChanges(/*after_sequence=*/1,
+                                         absl::Milliseconds(10)));
+}
+
+}  // namespace
+}  // namespace ml_metadata
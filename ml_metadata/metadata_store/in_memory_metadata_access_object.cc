@@ -0,0 +1,1891 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/in_memory_metadata_access_object.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+namespace {
+
+// The members of the InMemoryDatabase holding each kind of types, nodes and
+// their relations.
+template <typename T>
+struct Collection;
+
+template <>
+struct Collection<ArtifactType> {
+  static std::map<int64, ArtifactType> InMemoryDatabase::*Items() {
+    return &InMemoryDatabase::artifact_types;
+  }
+};
+
+template <>
+struct Collection<ExecutionType> {
+  static std::map<int64, ExecutionType> InMemoryDatabase::*Items() {
+    return &InMemoryDatabase::execution_types;
+  }
+};
+
+template <>
+struct Collection<ContextType> {
+  static std::map<int64, ContextType> InMemoryDatabase::*Items() {
+    return &InMemoryDatabase::context_types;
+  }
+};
+
+template <>
+struct Collection<Artifact> {
+  using Type = ArtifactType;
+  static const char* Name() { return "Artifact"; }
+  static std::map<int64, Artifact> InMemoryDatabase::*Items() {
+    return &InMemoryDatabase::artifacts;
+  }
+  static int64 InMemoryDatabase::*LastId() {
+    return &InMemoryDatabase::last_artifact_id;
+  }
+  static std::map<int64, NodeTimes> InMemoryDatabase::*Times() {
+    return &InMemoryDatabase::artifact_times;
+  }
+  static std::map<std::pair<int64, std::string>, int64>
+      InMemoryDatabase::*IdsByName() {
+    return &InMemoryDatabase::artifact_ids_by_name;
+  }
+  static std::map<int64, std::vector<int64>> InMemoryDatabase::*EventIds() {
+    return &InMemoryDatabase::event_ids_by_artifact;
+  }
+  // The attributions of the artifacts to contexts.
+  static const char* EdgeName() { return "Attribution"; }
+  static std::set<std::pair<int64, int64>> InMemoryDatabase::*Edges() {
+    return &InMemoryDatabase::attributions;
+  }
+  static int64 InMemoryDatabase::*LastEdgeId() {
+    return &InMemoryDatabase::last_attribution_id;
+  }
+  static std::map<int64, std::vector<int64>> InMemoryDatabase::*ContextIds() {
+    return &InMemoryDatabase::context_ids_by_artifact;
+  }
+  static std::map<int64, std::vector<int64>> InMemoryDatabase::*NodeIds() {
+    return &InMemoryDatabase::artifact_ids_by_context;
+  }
+};
+
+template <>
+struct Collection<Execution> {
+  using Type = ExecutionType;
+  static const char* Name() { return "Execution"; }
+  static std::map<int64, Execution> InMemoryDatabase::*Items() {
+    return &InMemoryDatabase::executions;
+  }
+  static int64 InMemoryDatabase::*LastId() {
+    return &InMemoryDatabase::last_execution_id;
+  }
+  static std::map<int64, NodeTimes> InMemoryDatabase::*Times() {
+    return &InMemoryDatabase::execution_times;
+  }
+  static std::map<std::pair<int64, std::string>, int64>
+      InMemoryDatabase::*IdsByName() {
+    return &InMemoryDatabase::execution_ids_by_name;
+  }
+  static std::map<int64, std::vector<int64>> InMemoryDatabase::*EventIds() {
+    return &InMemoryDatabase::event_ids_by_execution;
+  }
+  // The associations of the executions to contexts.
+  static const char* EdgeName() { return "Association"; }
+  static std::set<std::pair<int64, int64>> InMemoryDatabase::*Edges() {
+    return &InMemoryDatabase::associations;
+  }
+  static int64 InMemoryDatabase::*LastEdgeId() {
+    return &InMemoryDatabase::last_association_id;
+  }
+  static std::map<int64, std::vector<int64>> InMemoryDatabase::*ContextIds() {
+    return &InMemoryDatabase::context_ids_by_execution;
+  }
+  static std::map<int64, std::vector<int64>> InMemoryDatabase::*NodeIds() {
+    return &InMemoryDatabase::execution_ids_by_context;
+  }
+};
+
+template <>
+struct Collection<Context> {
+  using Type = ContextType;
+  static const char* Name() { return "Context"; }
+  static std::map<int64, Context> InMemoryDatabase::*Items() {
+    return &InMemoryDatabase::contexts;
+  }
+  static int64 InMemoryDatabase::*LastId() {
+    return &InMemoryDatabase::last_context_id;
+  }
+  static std::map<int64, NodeTimes> InMemoryDatabase::*Times() {
+    return &InMemoryDatabase::context_times;
+  }
+  static std::map<std::pair<int64, std::string>, int64>
+      InMemoryDatabase::*IdsByName() {
+    return &InMemoryDatabase::context_ids_by_name;
+  }
+};
+
+// The writes below record their undo actions in the `source`. The actions
+// refer to the members of the `database` instead of their addresses, so that
+// they stay valid when the database is reset by InitMetadataSource.
+
+// Sets a member of the database to `value`.
+template <typename Field>
+void SetField(InMemoryMetadataSource* source, InMemoryDatabase* database,
+              Field InMemoryDatabase::*field, const Field& value) {
+  const Field previous = database->*field;
+  source->AddUndo([database, field, previous]() {
+    database->*field = previous;
+  });
+  database->*field = value;
+}
+
+// Inserts or replaces the entry with `key` of a map member of the database.
+template <typename Map>
+void SetEntry(InMemoryMetadataSource* source, InMemoryDatabase* database,
+              Map InMemoryDatabase::*map, const typename Map::key_type& key,
+              const typename Map::mapped_type& value) {
+  auto it = (database->*map).find(key);
+  if (it == (database->*map).end()) {
+    source->AddUndo([database, map, key]() { (database->*map).erase(key); });
+    (database->*map).emplace(key, value);
+    return;
+  }
+  const typename Map::mapped_type previous = it->second;
+  source->AddUndo([database, map, key, previous]() {
+    (database->*map)[key] = previous;
+  });
+  it->second = value;
+}
+
+// Removes the entry with `key` of a map member of the database if present.
+template <typename Map>
+void EraseEntry(InMemoryMetadataSource* source, InMemoryDatabase* database,
+                Map InMemoryDatabase::*map, const typename Map::key_type& key) {
+  auto it = (database->*map).find(key);
+  if (it == (database->*map).end()) return;
+  const typename Map::mapped_type previous = it->second;
+  source->AddUndo([database, map, key, previous]() {
+    (database->*map).emplace(key, previous);
+  });
+  (database->*map).erase(it);
+}
+
+// Appends `value` to the list with `key` of an adjacency list member.
+void AppendToEntry(InMemoryMetadataSource* source, InMemoryDatabase* database,
+                   std::map<int64, std::vector<int64>> InMemoryDatabase::*map,
+                   const int64 key, const int64 value) {
+  source->AddUndo([database, map, key]() { (database->*map)[key].pop_back(); });
+  (database->*map)[key].push_back(value);
+}
+
+// Removes `value` from the list with `key` of an adjacency list member, and
+// removes the list once it is empty.
+void RemoveFromEntry(InMemoryMetadataSource* source,
+                     InMemoryDatabase* database,
+                     std::map<int64, std::vector<int64>> InMemoryDatabase::*map,
+                     const int64 key, const int64 value) {
+  auto it = (database->*map).find(key);
+  if (it == (database->*map).end()) return;
+  std::vector<int64> values = it->second;
+  values.erase(std::remove(values.begin(), values.end(), value), values.end());
+  if (values.empty()) {
+    EraseEntry(source, database, map, key);
+  } else {
+    SetEntry(source, database, map, key, values);
+  }
+}
+
+// Inserts `value` to a set member of the database.
+void InsertToSet(InMemoryMetadataSource* source, InMemoryDatabase* database,
+                 std::set<std::pair<int64, int64>> InMemoryDatabase::*set,
+                 const std::pair<int64, int64>& value) {
+  source->AddUndo([database, set, value]() { (database->*set).erase(value); });
+  (database->*set).insert(value);
+}
+
+// Removes `value` from a set member of the database if present.
+void EraseFromSet(InMemoryMetadataSource* source, InMemoryDatabase* database,
+                  std::set<std::pair<int64, int64>> InMemoryDatabase::*set,
+                  const std::pair<int64, int64>& value) {
+  if ((database->*set).erase(value) == 0) return;
+  source->AddUndo([database, set, value]() { (database->*set).insert(value); });
+}
+
+// Removes an event along with its entries in the adjacency lists.
+void EraseEvent(InMemoryMetadataSource* source, InMemoryDatabase* database,
+                const int64 event_id) {
+  const Event& event = database->events.at(event_id);
+  RemoveFromEntry(source, database, &InMemoryDatabase::event_ids_by_artifact,
+                  event.artifact_id(), event_id);
+  RemoveFromEntry(source, database, &InMemoryDatabase::event_ids_by_execution,
+                  event.execution_id(), event_id);
+  EraseEntry(source, database, &InMemoryDatabase::events, event_id);
+}
+
+// Removes the attribution or association of a node to a context along with
+// its entries in the adjacency lists.
+template <typename Node>
+void EraseContextEdge(InMemoryMetadataSource* source,
+                      InMemoryDatabase* database, const int64 context_id,
+                      const int64 node_id) {
+  EraseFromSet(source, database, Collection<Node>::Edges(),
+               {context_id, node_id});
+  RemoveFromEntry(source, database, Collection<Node>::ContextIds(), node_id,
+                  context_id);
+  RemoveFromEntry(source, database, Collection<Node>::NodeIds(), context_id,
+                  node_id);
+}
+
+// Returns the list with `key` of an adjacency list member, or an empty list.
+std::vector<int64> GetEntry(
+    const InMemoryDatabase& database,
+    std::map<int64, std::vector<int64>> InMemoryDatabase::*map,
+    const int64 key) {
+  const auto it = (database.*map).find(key);
+  if (it == (database.*map).end()) return {};
+  return it->second;
+}
+
+// Assigns the next id of the id counter member of the database.
+int64 NextId(InMemoryMetadataSource* source, InMemoryDatabase* database,
+             int64 InMemoryDatabase::*last_id) {
+  SetField(source, database, last_id, database->*last_id + 1);
+  return database->*last_id;
+}
+
+// Returns the indexed properties of a type sorted by name without
+// duplicates, as the SQL backends read them.
+std::vector<std::string> SortedIndexedProperties(
+    const google::protobuf::RepeatedPtrField<std::string>& indexed_properties) {
+  std::vector<std::string> sorted(indexed_properties.begin(),
+                                  indexed_properties.end());
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  return sorted;
+}
+
+// Returns INVALID_ARGUMENT error, if any indexed property of `type` is not
+// one of the `properties`.
+template <typename Type>
+tensorflow::Status CheckIndexedProperties(
+    const Type& type,
+    const google::protobuf::Map<std::string, PropertyType>& properties) {
+  for (const std::string& property_name : type.indexed_properties()) {
+    if (properties.find(property_name) == properties.end()) {
+      return tensorflow::errors::InvalidArgument(
+          "Indexed property ", property_name, " is not defined in the type.");
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+// Validates properties in a `Node` with the properties defined in a `Type`.
+// Returns INVALID_ARGUMENT error, if there is unknown or mismatched property
+// w.r.t. its definition.
+template <typename Node, typename Type>
+tensorflow::Status ValidatePropertiesWithType(const Node& node,
+                                              const Type& type) {
+  const google::protobuf::Map<std::string, PropertyType>& type_properties =
+      type.properties();
+  for (const auto& p : node.properties()) {
+    const std::string& property_name = p.first;
+    const Value& property_value = p.second;
+    const auto it = type_properties.find(property_name);
+    if (it == type_properties.end())
+      return tensorflow::errors::InvalidArgument(
+          absl::StrCat("Found unknown property: ", property_name));
+    bool is_type_match = false;
+    switch (it->second) {
+      case PropertyType::INT:
+        is_type_match = property_value.has_int_value();
+        break;
+      case PropertyType::DOUBLE:
+        is_type_match = property_value.has_double_value();
+        break;
+      case PropertyType::STRING:
+        is_type_match = property_value.has_string_value();
+        break;
+      default:
+        return tensorflow::errors::Internal(absl::StrCat(
+            "Unknown registered property type: ", type.DebugString()));
+    }
+    if (!is_type_match)
+      return tensorflow::errors::InvalidArgument(
+          absl::StrCat("Found unmatched property type: ", property_name));
+  }
+  return tensorflow::Status::OK();
+}
+
+// Returns the fields of a node that the SQL backends store.
+Artifact StoredNode(const Artifact& artifact, const int64 id) {
+  Artifact stored;
+  stored.set_id(id);
+  stored.set_type_id(artifact.type_id());
+  stored.set_uri(artifact.uri());
+  // An empty name is stored as NULL.
+  if (!artifact.name().empty()) stored.set_name(artifact.name());
+  if (artifact.has_state()) stored.set_state(artifact.state());
+  *stored.mutable_properties() = artifact.properties();
+  *stored.mutable_custom_properties() = artifact.custom_properties();
+  return stored;
+}
+
+Execution StoredNode(const Execution& execution, const int64 id) {
+  Execution stored;
+  stored.set_id(id);
+  stored.set_type_id(execution.type_id());
+  if (!execution.name().empty()) stored.set_name(execution.name());
+  if (execution.has_last_known_state()) {
+    stored.set_last_known_state(execution.last_known_state());
+  }
+  *stored.mutable_properties() = execution.properties();
+  *stored.mutable_custom_properties() = execution.custom_properties();
+  return stored;
+}
+
+Context StoredNode(const Context& context, const int64 id) {
+  Context stored;
+  stored.set_id(id);
+  stored.set_type_id(context.type_id());
+  stored.set_name(context.name());
+  *stored.mutable_properties() = context.properties();
+  *stored.mutable_custom_properties() = context.custom_properties();
+  return stored;
+}
+
+// The NAME and URI attributes of the nodes for the filters, or null if the
+// column of the attribute is absent or NULL in the SQL backends.
+const std::string* NameAttribute(const Artifact& artifact) {
+  return artifact.has_name() ? &artifact.name() : nullptr;
+}
+const std::string* NameAttribute(const Execution& execution) {
+  return execution.has_name() ? &execution.name() : nullptr;
+}
+const std::string* NameAttribute(const Context& context) {
+  return &context.name();
+}
+const std::string* UriAttribute(const Artifact& artifact) {
+  return &artifact.uri();
+}
+const std::string* UriAttribute(const Execution& execution) {
+  return nullptr;
+}
+const std::string* UriAttribute(const Context& context) { return nullptr; }
+
+// Sets `state` to the STATE attribute of the nodes, i.e., the state of an
+// artifact or the last known state of an execution. Returns false if the
+// column is absent or NULL in the SQL backends.
+bool StateAttribute(const Artifact& artifact, int* state) {
+  if (!artifact.has_state()) return false;
+  *state = artifact.state();
+  return true;
+}
+bool StateAttribute(const Execution& execution, int* state) {
+  if (!execution.has_last_known_state()) return false;
+  *state = execution.last_known_state();
+  return true;
+}
+bool StateAttribute(const Context& context, int* state) { return false; }
+
+// Returns the times of a node, which are 0 if not recorded.
+template <typename Node>
+NodeTimes TimesAttribute(const InMemoryDatabase& database, const Node& node) {
+  const auto& times = database.*Collection<Node>::Times();
+  const auto it = times.find(node.id());
+  return it == times.end() ? NodeTimes() : it->second;
+}
+
+// The ids of the contexts of the nodes for the CONTEXT_ID attribute, or null
+// if the node has no contexts or is a context.
+const std::vector<int64>* ContextIdsAttribute(const InMemoryDatabase& database,
+                                              const Artifact& artifact) {
+  const auto it = database.context_ids_by_artifact.find(artifact.id());
+  return it == database.context_ids_by_artifact.end() ? nullptr : &it->second;
+}
+const std::vector<int64>* ContextIdsAttribute(const InMemoryDatabase& database,
+                                              const Execution& execution) {
+  const auto it = database.context_ids_by_execution.find(execution.id());
+  return it == database.context_ids_by_execution.end() ? nullptr
+                                                       : &it->second;
+}
+const std::vector<int64>* ContextIdsAttribute(const InMemoryDatabase& database,
+                                              const Context& context) {
+  return nullptr;
+}
+
+// Compares `lhs` with `rhs` with a filter operator.
+template <typename T>
+bool Compare(const NodeFilter::Operator op, const T& lhs, const T& rhs) {
+  switch (op) {
+    case NodeFilter::EQ:
+      return lhs == rhs;
+    case NodeFilter::NE:
+      return lhs != rhs;
+    case NodeFilter::LT:
+      return lhs < rhs;
+    case NodeFilter::LE:
+      return lhs <= rhs;
+    case NodeFilter::GT:
+      return lhs > rhs;
+    case NodeFilter::GE:
+      return lhs >= rhs;
+    default:
+      return false;
+  }
+}
+
+// Compares a stored property value with the value of a filter predicate. A
+// value of another data type never matches.
+bool CompareValue(const NodeFilter::Operator op, const Value& stored,
+                  const Value& value) {
+  if (stored.value_case() != value.value_case()) return false;
+  switch (value.value_case()) {
+    case Value::kIntValue:
+      return Compare(op, stored.int_value(), value.int_value());
+    case Value::kDoubleValue:
+      return Compare(op, stored.double_value(), value.double_value());
+    case Value::kStringValue:
+      return Compare(op, stored.string_value(), value.string_value());
+    default:
+      return false;
+  }
+}
+
+// Returns INVALID_ARGUMENT error, if the predicate is malformed or does not
+// apply to the `Node`, with the errors of the SQL backends.
+template <typename Node>
+tensorflow::Status CheckPredicate(const NodeFilter::Predicate& predicate) {
+  if (predicate.op() < NodeFilter::EQ || predicate.op() > NodeFilter::GE) {
+    return tensorflow::errors::InvalidArgument(
+        "Unknown operator in the filter predicate: ", predicate.op());
+  }
+  const Value& value = predicate.value();
+  if (value.value_case() == Value::VALUE_NOT_SET) {
+    return tensorflow::errors::InvalidArgument(
+        "No value is given in the filter predicate: ",
+        predicate.DebugString());
+  }
+  switch (predicate.subject_case()) {
+    case NodeFilter::Predicate::kProperty:
+    case NodeFilter::Predicate::kCustomProperty:
+      return tensorflow::Status::OK();
+    case NodeFilter::Predicate::kAttribute:
+      break;
+    default:
+      return tensorflow::errors::InvalidArgument(
+          "No attribute or property is given in the filter predicate: ",
+          predicate.DebugString());
+  }
+  bool applies = true;
+  Value::ValueCase value_case = Value::kIntValue;
+  switch (predicate.attribute()) {
+    case NodeFilter::ID:
+    case NodeFilter::TYPE_ID:
+    case NodeFilter::CREATE_TIME_SINCE_EPOCH:
+    case NodeFilter::LAST_UPDATE_TIME_SINCE_EPOCH:
+      break;
+    case NodeFilter::TYPE:
+    case NodeFilter::NAME:
+      value_case = Value::kStringValue;
+      break;
+    case NodeFilter::URI:
+      applies = std::is_same<Node, Artifact>::value;
+      value_case = Value::kStringValue;
+      break;
+    case NodeFilter::STATE:
+    case NodeFilter::CONTEXT_ID:
+      applies = !std::is_same<Node, Context>::value;
+      break;
+    default:
+      return tensorflow::errors::InvalidArgument(
+          "Unknown attribute in the filter predicate: ",
+          predicate.DebugString());
+  }
+  if (!applies) {
+    return tensorflow::errors::InvalidArgument(
+        "The attribute ", NodeFilter::Attribute_Name(predicate.attribute()),
+        " does not apply to ", Collection<Node>::Name());
+  }
+  if (predicate.attribute() == NodeFilter::CONTEXT_ID &&
+      predicate.op() != NodeFilter::EQ) {
+    return tensorflow::errors::InvalidArgument(
+        "Only EQ compares the CONTEXT_ID in the filter predicate: ",
+        predicate.DebugString());
+  }
+  if (value.value_case() != value_case) {
+    return tensorflow::errors::InvalidArgument(
+        "The value type does not match the attribute in the filter "
+        "predicate: ",
+        predicate.DebugString());
+  }
+  return tensorflow::Status::OK();
+}
+
+// Returns true if the `node` satisfies the checked `predicate`.
+template <typename Node>
+bool MatchesPredicate(const InMemoryDatabase& database, const Node& node,
+                      const NodeFilter::Predicate& predicate) {
+  const NodeFilter::Operator op = predicate.op();
+  const Value& value = predicate.value();
+  if (predicate.subject_case() != NodeFilter::Predicate::kAttribute) {
+    const bool is_custom_property = predicate.has_custom_property();
+    const google::protobuf::Map<std::string, Value>& properties =
+        is_custom_property ? node.custom_properties() : node.properties();
+    const auto it = properties.find(is_custom_property
+                                        ? predicate.custom_property()
+                                        : predicate.property());
+    return it != properties.end() && CompareValue(op, it->second, value);
+  }
+  switch (predicate.attribute()) {
+    case NodeFilter::ID:
+      return Compare<int64>(op, node.id(), value.int_value());
+    case NodeFilter::TYPE_ID:
+      return Compare<int64>(op, node.type_id(), value.int_value());
+    case NodeFilter::TYPE: {
+      const auto& types = database.*Collection<
+          typename Collection<Node>::Type>::Items();
+      const auto it = types.find(node.type_id());
+      return it != types.end() &&
+             Compare(op, it->second.name(), value.string_value());
+    }
+    case NodeFilter::NAME: {
+      const std::string* name = NameAttribute(node);
+      return name != nullptr && Compare(op, *name, value.string_value());
+    }
+    case NodeFilter::URI: {
+      const std::string* uri = UriAttribute(node);
+      return uri != nullptr && Compare(op, *uri, value.string_value());
+    }
+    case NodeFilter::CREATE_TIME_SINCE_EPOCH:
+      return Compare<int64>(
+          op, TimesAttribute(database, node).create_time_since_epoch,
+          value.int_value());
+    case NodeFilter::LAST_UPDATE_TIME_SINCE_EPOCH:
+      return Compare<int64>(
+          op, TimesAttribute(database, node).last_update_time_since_epoch,
+          value.int_value());
+    case NodeFilter::STATE: {
+      int state;
+      return StateAttribute(node, &state) &&
+             Compare<int64>(op, state, value.int_value());
+    }
+    case NodeFilter::CONTEXT_ID: {
+      const std::vector<int64>* context_ids =
+          ContextIdsAttribute(database, node);
+      return context_ids != nullptr &&
+             std::find(context_ids->begin(), context_ids->end(),
+                       value.int_value()) != context_ids->end();
+    }
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+tensorflow::Status InMemoryMetadataAccessObject::GetDatabase(
+    InMemoryDatabase** database, const bool allow_no_schema) {
+  if (!metadata_source_->is_connected() ||
+      !metadata_source_->transaction_open()) {
+    return tensorflow::errors::FailedPrecondition("Transaction not open.");
+  }
+  *database = metadata_source_->database();
+  if (!allow_no_schema && !(*database)->has_schema) {
+    return tensorflow::errors::FailedPrecondition(
+        "The metadata source is not initialized.");
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::InitMetadataSource() {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database, /*allow_no_schema=*/true));
+  // The dropped database is kept until the transaction ends, to be restored
+  // on rollback.
+  std::shared_ptr<InMemoryDatabase> dropped =
+      std::make_shared<InMemoryDatabase>(std::move(*database));
+  metadata_source_->AddUndo(
+      [database, dropped]() { *database = std::move(*dropped); });
+  *database = InMemoryDatabase();
+  database->has_schema = true;
+  database->schema_version = library_version_;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::InitMetadataSourceIfNotExists(
+    const bool enable_upgrade_migration) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database, /*allow_no_schema=*/true));
+  if (database->is_schema_partial) {
+    return tensorflow::errors::Aborted(
+        "There are a subset of the collections in the in-memory metadata "
+        "source. The metadata source may be corrupted.");
+  }
+  if (!database->has_schema) return InitMetadataSource();
+  if (database->schema_version > library_version_) {
+    return tensorflow::errors::FailedPrecondition(
+        "Schema migration from ", database->schema_version, " to ",
+        library_version_, " is not supported: the database is newer than the "
+        "library.");
+  }
+  if (database->schema_version < library_version_) {
+    if (!enable_upgrade_migration) {
+      return tensorflow::errors::FailedPrecondition(
+          "The database schema version ", database->schema_version,
+          " is older than the library version ", library_version_,
+          ", and upgrade migration is not enabled.");
+    }
+    // The collections are the same in all versions.
+    SetField(metadata_source_, database, &InMemoryDatabase::schema_version,
+             library_version_);
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::DowngradeMetadataSource(
+    const int64 to_schema_version) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database, /*allow_no_schema=*/true));
+  if (to_schema_version < 0 || to_schema_version > library_version_) {
+    return tensorflow::errors::InvalidArgument(
+        "MLMD cannot be downgraded to schema_version: ", to_schema_version,
+        ". The target version should be greater or equal to 0, and the "
+        "current library version: ",
+        library_version_, " needs to be greater than the target version.");
+  }
+  if (!database->has_schema) {
+    return tensorflow::errors::InvalidArgument(
+        "Empty database is given. Downgrade operation is not needed.");
+  }
+  if (database->schema_version > library_version_) {
+    return tensorflow::errors::FailedPrecondition(
+        "MLMD database version ", database->schema_version,
+        " is greater than library version ", library_version_,
+        ". Please upgrade the library to use the given database in order to "
+        "downgrade.");
+  }
+  SetField(metadata_source_, database, &InMemoryDatabase::schema_version,
+           to_schema_version);
+  return tensorflow::Status::OK();
+}
+
+template <typename Type>
+tensorflow::Status InMemoryMetadataAccessObject::CreateTypeImpl(
+    const Type& type, int64* type_id) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (type.name().empty())
+    return tensorflow::errors::InvalidArgument("No type name is specified.");
+  if (type.properties().empty())
+    LOG(WARNING) << "No property is defined for the Type";
+  for (const auto& property : type.properties()) {
+    if (property.second == PropertyType::UNKNOWN) {
+      LOG(ERROR) << "Property " << property.first
+                 << "'s value type is UNKNOWN.";
+      return tensorflow::errors::InvalidArgument(
+          absl::StrCat("Property ", property.first, " is UNKNOWN."));
+    }
+  }
+  TF_RETURN_IF_ERROR(CheckIndexedProperties(type, type.properties()));
+
+  *type_id =
+      NextId(metadata_source_, database, &InMemoryDatabase::last_type_id);
+  Type stored_type = type;
+  stored_type.set_id(*type_id);
+  const std::vector<std::string> indexed_properties =
+      SortedIndexedProperties(type.indexed_properties());
+  stored_type.clear_indexed_properties();
+  for (const std::string& property_name : indexed_properties) {
+    stored_type.add_indexed_properties(property_name);
+  }
+  SetEntry(metadata_source_, database, Collection<Type>::Items(), *type_id,
+           stored_type);
+  return tensorflow::Status::OK();
+}
+
+template <typename Type>
+tensorflow::Status InMemoryMetadataAccessObject::UpdateTypeImpl(
+    const Type& type) {
+  if (!type.has_name()) {
+    return tensorflow::errors::InvalidArgument("No type name is specified.");
+  }
+  Type stored_type;
+  TF_RETURN_IF_ERROR(FindTypeByNameImpl(type.name(), &stored_type));
+  if (type.has_id() && type.id() != stored_type.id()) {
+    return tensorflow::errors::InvalidArgument(
+        "Given type id is different from the existing type: ",
+        stored_type.DebugString());
+  }
+  google::protobuf::Map<std::string, PropertyType>& properties =
+      *stored_type.mutable_properties();
+  for (const auto& p : type.properties()) {
+    const std::string& property_name = p.first;
+    const PropertyType property_type = p.second;
+    if (property_type == PropertyType::UNKNOWN) {
+      return tensorflow::errors::InvalidArgument(
+          "Property:", property_name, " type should not be UNKNOWN.");
+    }
+    const auto it = properties.find(property_name);
+    if (it != properties.end() && it->second != property_type) {
+      return tensorflow::errors::AlreadyExists(
+          "Property:", property_name,
+          " type is different from the existing type: ",
+          stored_type.DebugString());
+    }
+  }
+  properties.insert(type.properties().begin(), type.properties().end());
+  TF_RETURN_IF_ERROR(CheckIndexedProperties(type, properties));
+
+  // indexing is additive, the already indexed properties stay indexed.
+  for (const std::string& property_name : type.indexed_properties()) {
+    stored_type.add_indexed_properties(property_name);
+  }
+  const std::vector<std::string> indexed_properties =
+      SortedIndexedProperties(stored_type.indexed_properties());
+  stored_type.clear_indexed_properties();
+  for (const std::string& property_name : indexed_properties) {
+    stored_type.add_indexed_properties(property_name);
+  }
+  SetEntry(metadata_source_, metadata_source_->database(),
+           Collection<Type>::Items(), stored_type.id(), stored_type);
+  return tensorflow::Status::OK();
+}
+
+template <typename Type>
+tensorflow::Status InMemoryMetadataAccessObject::FindTypeByIdImpl(
+    const int64 type_id, Type* type) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  const auto& types = database->*Collection<Type>::Items();
+  const auto it = types.find(type_id);
+  if (it == types.end()) {
+    return tensorflow::errors::NotFound(
+        absl::StrCat("No type found for query: ", type_id));
+  }
+  *type = it->second;
+  return tensorflow::Status::OK();
+}
+
+template <typename Type>
+tensorflow::Status InMemoryMetadataAccessObject::FindTypeByNameImpl(
+    const absl::string_view name, Type* type) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  // Type names are few, and are not indexed. As the SQL backends, the type
+  // with the smallest id is returned if the name is not unique.
+  for (const auto& entry : database->*Collection<Type>::Items()) {
+    if (entry.second.name() == name) {
+      *type = entry.second;
+      return tensorflow::Status::OK();
+    }
+  }
+  return tensorflow::errors::NotFound(
+      absl::StrCat("No type found for query: ", name));
+}
+
+template <typename Type>
+tensorflow::Status InMemoryMetadataAccessObject::FindTypesImpl(
+    std::vector<Type>* types) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  const auto& stored_types = database->*Collection<Type>::Items();
+  types->clear();
+  types->reserve(stored_types.size());
+  for (const auto& entry : stored_types) {
+    types->push_back(entry.second);
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::CreateNodeImpl(
+    const Node& node, int64* node_id) {
+  using NodeType = typename Collection<Node>::Type;
+  // clear node id
+  *node_id = 0;
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (!node.has_type_id())
+    return tensorflow::errors::InvalidArgument("Type id is missing.");
+  NodeType node_type;
+  TF_RETURN_IF_ERROR(FindTypeByIdImpl(node.type_id(), &node_type));
+  TF_RETURN_IF_ERROR(ValidatePropertiesWithType(node, node_type));
+
+  // As the SQL backends, the names are unique within a type.
+  const Node stored_node = StoredNode(node, /*id=*/0);
+  const std::string* name = NameAttribute(stored_node);
+  if (std::is_same<Node, Context>::value && name->empty()) {
+    return tensorflow::errors::InvalidArgument(
+        "Context name should not be empty");
+  }
+  if (name != nullptr &&
+      (database->*Collection<Node>::IdsByName())
+              .count(std::make_pair(node.type_id(), *name)) > 0) {
+    return tensorflow::errors::AlreadyExists(
+        "Given node already exists: ", node.DebugString());
+  }
+
+  *node_id = NextId(metadata_source_, database, Collection<Node>::LastId());
+  SetEntry(metadata_source_, database, Collection<Node>::Items(), *node_id,
+           StoredNode(node, *node_id));
+  NodeTimes times;
+  times.create_time_since_epoch = absl::ToUnixMillis(absl::Now());
+  times.last_update_time_since_epoch = times.create_time_since_epoch;
+  SetEntry(metadata_source_, database, Collection<Node>::Times(), *node_id,
+           times);
+  if (name != nullptr) {
+    SetEntry(metadata_source_, database, Collection<Node>::IdsByName(),
+             std::make_pair(node.type_id(), *name), *node_id);
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::CreateNodesImpl(
+    const std::vector<Node>& nodes, std::vector<int64>* node_ids) {
+  node_ids->clear();
+  node_ids->reserve(nodes.size());
+  for (const Node& node : nodes) {
+    int64 node_id;
+    TF_RETURN_IF_ERROR(CreateNodeImpl(node, &node_id));
+    node_ids->push_back(node_id);
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::UpdateNodeImpl(
+    const Node& node) {
+  using NodeType = typename Collection<Node>::Type;
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (!node.has_id())
+    return tensorflow::errors::InvalidArgument("No id is given.");
+  const auto& nodes = database->*Collection<Node>::Items();
+  const auto it = nodes.find(node.id());
+  if (it == nodes.end()) {
+    return tensorflow::errors::InvalidArgument(
+        absl::StrCat("Cannot find the given id ", node.id()));
+  }
+  const Node& stored_node = it->second;
+  if (node.has_type_id() && node.type_id() != stored_node.type_id()) {
+    return tensorflow::errors::InvalidArgument(absl::StrCat(
+        "Given type_id ", node.type_id(),
+        " is different from the one known before: ", stored_node.type_id()));
+  }
+  NodeType stored_type;
+  TF_RETURN_IF_ERROR(FindTypeByIdImpl(stored_node.type_id(), &stored_type));
+  TF_RETURN_IF_ERROR(ValidatePropertiesWithType(node, stored_type));
+
+  // As the SQL backends, the stored fields are replaced by the ones of the
+  // given node.
+  const Node updated_node = StoredNode(node, node.id());
+  const std::string* previous_name = NameAttribute(stored_node);
+  const std::string* name = NameAttribute(updated_node);
+  if (std::is_same<Node, Context>::value && name->empty()) {
+    return tensorflow::errors::InvalidArgument(
+        "Context name should not be empty");
+  }
+  if ((previous_name == nullptr) != (name == nullptr) ||
+      (name != nullptr && *name != *previous_name)) {
+    const auto ids_by_name = Collection<Node>::IdsByName();
+    if (name != nullptr &&
+        (database->*ids_by_name)
+                .count(std::make_pair(stored_node.type_id(), *name)) > 0) {
+      return tensorflow::errors::AlreadyExists(
+          "Given node already exists: ", node.DebugString());
+    }
+    if (previous_name != nullptr) {
+      EraseEntry(metadata_source_, database, ids_by_name,
+                 std::make_pair(stored_node.type_id(), *previous_name));
+    }
+    if (name != nullptr) {
+      SetEntry(metadata_source_, database, ids_by_name,
+               std::make_pair(stored_node.type_id(), *name), node.id());
+    }
+  }
+  SetEntry(metadata_source_, database, Collection<Node>::Items(), node.id(),
+           updated_node);
+  NodeTimes times = TimesAttribute(*database, updated_node);
+  times.last_update_time_since_epoch = absl::ToUnixMillis(absl::Now());
+  SetEntry(metadata_source_, database, Collection<Node>::Times(), node.id(),
+           times);
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::FindNodeByIdImpl(
+    const int64 node_id, Node* node, const NodeReadMask* read_mask) {
+  ParsedNodeReadMask parsed_read_mask;
+  if (read_mask != nullptr) {
+    TF_RETURN_IF_ERROR(
+        ParsedNodeReadMask::Parse<Node>(*read_mask, &parsed_read_mask));
+  }
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  const auto& nodes = database->*Collection<Node>::Items();
+  const auto it = nodes.find(node_id);
+  if (it == nodes.end()) {
+    return tensorflow::errors::NotFound(
+        absl::StrCat("Cannot find record by given id ", node_id));
+  }
+  *node = it->second;
+  parsed_read_mask.Apply(node);
+  return tensorflow::Status::OK();
+}
+
+template <typename Node, typename Predicate>
+tensorflow::Status InMemoryMetadataAccessObject::FindNodesImpl(
+    const Predicate& predicate, std::vector<Node>* nodes,
+    const NodeReadMask* read_mask) {
+  ParsedNodeReadMask parsed_read_mask;
+  if (read_mask != nullptr) {
+    TF_RETURN_IF_ERROR(
+        ParsedNodeReadMask::Parse<Node>(*read_mask, &parsed_read_mask));
+  }
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  const size_t num_nodes = nodes->size();
+  for (const auto& entry : database->*Collection<Node>::Items()) {
+    if (!predicate(entry.second)) continue;
+    nodes->push_back(entry.second);
+    parsed_read_mask.Apply(&nodes->back());
+  }
+  if (nodes->size() == num_nodes)
+    return tensorflow::errors::NotFound(absl::StrCat("Cannot find any record"));
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::FindNodesByFilterImpl(
+    const NodeFilter& filter, std::vector<Node>* nodes,
+    const NodeReadMask* read_mask) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  for (const NodeFilter::Predicate& predicate : filter.predicates()) {
+    TF_RETURN_IF_ERROR(CheckPredicate<Node>(predicate));
+  }
+  int64 num_matches = 0;
+  return FindNodesImpl(
+      [database, &filter, &num_matches](const Node& node) {
+        if (filter.limit() > 0 && num_matches >= filter.limit()) return false;
+        for (const NodeFilter::Predicate& predicate : filter.predicates()) {
+          if (!MatchesPredicate(*database, node, predicate)) return false;
+        }
+        ++num_matches;
+        return true;
+      },
+      nodes, read_mask);
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::FindNodesByTypeIdAndNamesImpl(
+    const int64 type_id, const std::vector<std::string>& names,
+    std::vector<Node>* nodes, const NodeReadMask* read_mask) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  const auto& ids_by_name = database->*Collection<Node>::IdsByName();
+  std::set<int64> node_ids;
+  for (const std::string& name : names) {
+    const auto it = ids_by_name.find(std::make_pair(type_id, name));
+    if (it != ids_by_name.end()) node_ids.insert(it->second);
+  }
+  if (node_ids.empty())
+    return tensorflow::errors::NotFound("Cannot find any record");
+  nodes->reserve(nodes->size() + node_ids.size());
+  for (const int64 node_id : node_ids) {
+    nodes->push_back(Node());
+    TF_RETURN_IF_ERROR(FindNodeByIdImpl(node_id, &nodes->back(), read_mask));
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::CountNodesImpl(
+    const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+    std::vector<NodeCount>* counts) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (filter.limit() > 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The filter of a count cannot have a limit: ", filter.DebugString());
+  }
+  for (const NodeFilter::Predicate& predicate : filter.predicates()) {
+    TF_RETURN_IF_ERROR(CheckPredicate<Node>(predicate));
+  }
+  bool group_by_type_id = false;
+  bool group_by_state = false;
+  bool group_by_context_id = false;
+  for (const NodeCount::GroupBy attribute : group_by) {
+    bool* grouped = nullptr;
+    bool applies = true;
+    switch (attribute) {
+      case NodeCount::TYPE_ID:
+        grouped = &group_by_type_id;
+        break;
+      case NodeCount::STATE:
+        grouped = &group_by_state;
+        applies = !std::is_same<Node, Context>::value;
+        break;
+      case NodeCount::CONTEXT_ID:
+        grouped = &group_by_context_id;
+        applies = !std::is_same<Node, Context>::value;
+        break;
+      default:
+        return tensorflow::errors::InvalidArgument(
+            "Unknown attribute to group the count by: ", attribute);
+    }
+    if (*grouped) {
+      return tensorflow::errors::InvalidArgument(
+          "The count is grouped by ", NodeCount::GroupBy_Name(attribute),
+          " more than once.");
+    }
+    if (!applies) {
+      return tensorflow::errors::InvalidArgument(
+          "The count of ", Collection<Node>::Name(), " cannot be grouped by ",
+          NodeCount::GroupBy_Name(attribute));
+    }
+    *grouped = true;
+  }
+
+  // (type id, state, context id) -> the number of nodes, where the
+  // attributes that are not grouped by are 0, and a NULL state is -1.
+  std::map<std::tuple<int64, int, int64>, int64> num_nodes_by_group;
+  if (group_by.empty()) num_nodes_by_group[std::make_tuple(0, 0, 0)] = 0;
+  for (const auto& entry : database->*Collection<Node>::Items()) {
+    const Node& node = entry.second;
+    bool matches = true;
+    for (const NodeFilter::Predicate& predicate : filter.predicates()) {
+      if (!MatchesPredicate(*database, node, predicate)) {
+        matches = false;
+        break;
+      }
+    }
+    if (!matches) continue;
+    const int64 type_id = group_by_type_id ? node.type_id() : 0;
+    int state = 0;
+    if (group_by_state && !StateAttribute(node, &state)) state = -1;
+    if (!group_by_context_id) {
+      ++num_nodes_by_group[std::make_tuple(type_id, state, 0)];
+      continue;
+    }
+    const std::vector<int64>* context_ids =
+        ContextIdsAttribute(*database, node);
+    if (context_ids == nullptr) continue;
+    for (const int64 context_id : *context_ids) {
+      ++num_nodes_by_group[std::make_tuple(type_id, state, context_id)];
+    }
+  }
+  for (const auto& group : num_nodes_by_group) {
+    NodeCount count;
+    if (group_by_type_id) count.set_type_id(std::get<0>(group.first));
+    if (group_by_state && std::get<1>(group.first) >= 0) {
+      count.set_state(std::get<1>(group.first));
+    }
+    if (group_by_context_id) count.set_context_id(std::get<2>(group.first));
+    count.set_count(group.second);
+    counts->push_back(count);
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::FindEventsByNodeImpl(
+    const int64 node_id, std::vector<Event>* events) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  const auto& event_ids = database->*Collection<Node>::EventIds();
+  const auto it = event_ids.find(node_id);
+  if (it == event_ids.end() || it->second.empty()) {
+    return tensorflow::errors::NotFound(
+        absl::StrCat("Cannot find events by given ",
+                     Collection<Node>::Name(), " id ", node_id));
+  }
+  if (events == nullptr)
+    return tensorflow::errors::InvalidArgument("Given events is NULL.");
+  events->reserve(events->size() + it->second.size());
+  for (const int64 event_id : it->second) {
+    events->push_back(database->events.at(event_id));
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::CreateContextEdgeImpl(
+    const int64 context_id, const int64 node_id, int64* edge_id) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  const std::pair<int64, int64> edge(context_id, node_id);
+  if ((database->*Collection<Node>::Edges()).count(edge) > 0) {
+    return tensorflow::errors::AlreadyExists(
+        "Given ", Collection<Node>::Name(), " already belongs to context ",
+        context_id, ": ", node_id);
+  }
+  *edge_id =
+      NextId(metadata_source_, database, Collection<Node>::LastEdgeId());
+  InsertToSet(metadata_source_, database, Collection<Node>::Edges(), edge);
+  AppendToEntry(metadata_source_, database, Collection<Node>::ContextIds(),
+                node_id, context_id);
+  AppendToEntry(metadata_source_, database, Collection<Node>::NodeIds(),
+                context_id, node_id);
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status
+InMemoryMetadataAccessObject::CreateContextEdgesIfNotExistImpl(
+    const std::vector<std::pair<int64, int64>>& edges,
+    std::vector<std::pair<int64, int64>>* created_edges) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  const auto& nodes = database->*Collection<Node>::Items();
+  for (const std::pair<int64, int64>& edge : edges) {
+    if (database->contexts.count(edge.first) == 0) {
+      return tensorflow::errors::InvalidArgument("Context id not found: ",
+                                                 edge.first);
+    }
+    if (nodes.count(edge.second) == 0) {
+      return tensorflow::errors::InvalidArgument(
+          Collection<Node>::Name(), " id not found: ", edge.second);
+    }
+  }
+  for (const std::pair<int64, int64>& edge : edges) {
+    if ((database->*Collection<Node>::Edges()).count(edge) > 0) continue;
+    int64 edge_id;
+    TF_RETURN_IF_ERROR(
+        CreateContextEdgeImpl<Node>(edge.first, edge.second, &edge_id));
+    created_edges->push_back(edge);
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::FindContextsByNodeImpl(
+    const int64 node_id, std::vector<Context>* contexts) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (contexts == nullptr)
+    return tensorflow::errors::InvalidArgument("Given contexts is NULL.");
+  contexts->clear();
+  const auto& context_ids = database->*Collection<Node>::ContextIds();
+  const auto it = context_ids.find(node_id);
+  if (it == context_ids.end()) return tensorflow::Status::OK();
+  contexts->reserve(it->second.size());
+  for (const int64 context_id : it->second) {
+    contexts->push_back(database->contexts.at(context_id));
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::FindNodesByContextImpl(
+    const int64 context_id, std::vector<Node>* nodes) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (nodes == nullptr)
+    return tensorflow::errors::InvalidArgument("Given array is NULL.");
+  nodes->clear();
+  const auto& node_ids = database->*Collection<Node>::NodeIds();
+  const auto it = node_ids.find(context_id);
+  if (it == node_ids.end()) return tensorflow::Status::OK();
+  const auto& stored_nodes = database->*Collection<Node>::Items();
+  nodes->reserve(it->second.size());
+  for (const int64 node_id : it->second) {
+    nodes->push_back(stored_nodes.at(node_id));
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status InMemoryMetadataAccessObject::DeleteNodesImpl(
+    const std::vector<int64>& node_ids, const bool dry_run,
+    std::map<std::string, int64>* num_deleted_rows) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (num_deleted_rows == nullptr)
+    return tensorflow::errors::InvalidArgument("Given counts is NULL.");
+  if (node_ids.empty()) return tensorflow::Status::OK();
+  // The rows are counted as the SQL backends store them.
+  const std::string node_table = Collection<Node>::Name();
+  int64& num_nodes = (*num_deleted_rows)[node_table];
+  int64& num_properties =
+      (*num_deleted_rows)[absl::StrCat(node_table, "Property")];
+  int64& num_events = (*num_deleted_rows)["Event"];
+  int64& num_event_paths = (*num_deleted_rows)["EventPath"];
+  int64& num_edges = (*num_deleted_rows)[Collection<Node>::EdgeName()];
+  const auto& nodes = database->*Collection<Node>::Items();
+  for (const int64 node_id :
+       std::set<int64>(node_ids.begin(), node_ids.end())) {
+    const auto it = nodes.find(node_id);
+    if (it == nodes.end()) continue;
+    num_nodes++;
+    num_properties +=
+        it->second.properties_size() + it->second.custom_properties_size();
+    const std::vector<int64> event_ids =
+        GetEntry(*database, Collection<Node>::EventIds(), node_id);
+    num_events += event_ids.size();
+    for (const int64 event_id : event_ids) {
+      num_event_paths += database->events.at(event_id).path().steps_size();
+    }
+    const std::vector<int64> context_ids =
+        GetEntry(*database, Collection<Node>::ContextIds(), node_id);
+    num_edges += context_ids.size();
+    if (dry_run) continue;
+
+    EraseEntry(metadata_source_, database, Collection<Node>::EventIds(),
+               node_id);
+    for (const int64 event_id : event_ids) {
+      EraseEvent(metadata_source_, database, event_id);
+    }
+    EraseEntry(metadata_source_, database, Collection<Node>::ContextIds(),
+               node_id);
+    for (const int64 context_id : context_ids) {
+      EraseContextEdge<Node>(metadata_source_, database, context_id, node_id);
+    }
+    const std::string* name = NameAttribute(it->second);
+    if (name != nullptr) {
+      EraseEntry(metadata_source_, database, Collection<Node>::IdsByName(),
+                 std::make_pair(it->second.type_id(), *name));
+    }
+    EraseEntry(metadata_source_, database, Collection<Node>::Times(), node_id);
+    EraseEntry(metadata_source_, database, Collection<Node>::Items(), node_id);
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateType(
+    const ArtifactType& type, int64* type_id) {
+  return CreateTypeImpl(type, type_id);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateType(
+    const ExecutionType& type, int64* type_id) {
+  return CreateTypeImpl(type, type_id);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateType(
+    const ContextType& type, int64* type_id) {
+  return CreateTypeImpl(type, type_id);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::UpdateType(
+    const ArtifactType& type) {
+  return UpdateTypeImpl(type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::UpdateType(
+    const ExecutionType& type) {
+  return UpdateTypeImpl(type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::UpdateType(
+    const ContextType& type) {
+  return UpdateTypeImpl(type);
+}
+
+// The in-memory source keeps no property table indexes, so only the existence
+// of the type is checked.
+tensorflow::Status InMemoryMetadataAccessObject::CreatePropertyIndexes(
+    const ArtifactType& type) {
+  ArtifactType stored_type;
+  return FindTypeByName(type.name(), &stored_type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreatePropertyIndexes(
+    const ExecutionType& type) {
+  ExecutionType stored_type;
+  return FindTypeByName(type.name(), &stored_type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreatePropertyIndexes(
+    const ContextType& type) {
+  ContextType stored_type;
+  return FindTypeByName(type.name(), &stored_type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindTypeById(
+    const int64 type_id, ArtifactType* artifact_type) {
+  return FindTypeByIdImpl(type_id, artifact_type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindTypeById(
+    const int64 type_id, ExecutionType* execution_type) {
+  return FindTypeByIdImpl(type_id, execution_type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindTypeById(
+    const int64 type_id, ContextType* context_type) {
+  return FindTypeByIdImpl(type_id, context_type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindTypeByName(
+    absl::string_view name, ArtifactType* artifact_type) {
+  return FindTypeByNameImpl(name, artifact_type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindTypeByName(
+    absl::string_view name, ExecutionType* execution_type) {
+  return FindTypeByNameImpl(name, execution_type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindTypeByName(
+    absl::string_view name, ContextType* context_type) {
+  return FindTypeByNameImpl(name, context_type);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindTypes(
+    std::vector<ArtifactType>* artifact_types) {
+  return FindTypesImpl(artifact_types);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindTypes(
+    std::vector<ExecutionType>* execution_types) {
+  return FindTypesImpl(execution_types);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindTypes(
+    std::vector<ContextType>* context_types) {
+  return FindTypesImpl(context_types);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateArtifact(
+    const Artifact& artifact, int64* artifact_id) {
+  return CreateNodeImpl(artifact, artifact_id);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateArtifacts(
+    const std::vector<Artifact>& artifacts, std::vector<int64>* artifact_ids) {
+  return CreateNodesImpl(artifacts, artifact_ids);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindArtifactById(
+    const int64 artifact_id, Artifact* artifact,
+    const NodeReadMask* read_mask) {
+  return FindNodeByIdImpl(artifact_id, artifact, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindArtifacts(
+    std::vector<Artifact>* artifacts, const NodeReadMask* read_mask) {
+  return FindNodesImpl([](const Artifact&) { return true; }, artifacts,
+                       read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindArtifactsByTypeId(
+    const int64 artifact_type_id, std::vector<Artifact>* artifacts,
+    const NodeReadMask* read_mask) {
+  return FindNodesImpl(
+      [artifact_type_id](const Artifact& artifact) {
+        return artifact.type_id() == artifact_type_id;
+      },
+      artifacts, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindArtifactsByURI(
+    const absl::string_view uri, std::vector<Artifact>* artifacts,
+    const NodeReadMask* read_mask) {
+  return FindNodesImpl(
+      [uri](const Artifact& artifact) { return artifact.uri() == uri; },
+      artifacts, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindArtifactsByTypeIdAndNames(
+    const int64 type_id, const std::vector<std::string>& names,
+    std::vector<Artifact>* artifacts, const NodeReadMask* read_mask) {
+  return FindNodesByTypeIdAndNamesImpl(type_id, names, artifacts, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindArtifactsByFilter(
+    const NodeFilter& filter, std::vector<Artifact>* artifacts,
+    const NodeReadMask* read_mask) {
+  return FindNodesByFilterImpl(filter, artifacts, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CountArtifacts(
+    const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+    std::vector<NodeCount>* counts) {
+  return CountNodesImpl<Artifact>(filter, group_by, counts);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::UpdateArtifact(
+    const Artifact& artifact) {
+  return UpdateNodeImpl(artifact);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::DeleteArtifacts(
+    const std::vector<int64>& artifact_ids, const bool dry_run,
+    std::map<std::string, int64>* num_deleted_rows) {
+  return DeleteNodesImpl<Artifact>(artifact_ids, dry_run, num_deleted_rows);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateExecution(
+    const Execution& execution, int64* execution_id) {
+  return CreateNodeImpl(execution, execution_id);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateExecutions(
+    const std::vector<Execution>& executions,
+    std::vector<int64>* execution_ids) {
+  return CreateNodesImpl(executions, execution_ids);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindExecutionById(
+    const int64 execution_id, Execution* execution,
+    const NodeReadMask* read_mask) {
+  return FindNodeByIdImpl(execution_id, execution, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindExecutions(
+    std::vector<Execution>* executions, const NodeReadMask* read_mask) {
+  return FindNodesImpl([](const Execution&) { return true; }, executions,
+                       read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindExecutionsByTypeId(
+    const int64 execution_type_id, std::vector<Execution>* executions,
+    const NodeReadMask* read_mask) {
+  return FindNodesImpl(
+      [execution_type_id](const Execution& execution) {
+        return execution.type_id() == execution_type_id;
+      },
+      executions, read_mask);
+}
+
+tensorflow::Status
+InMemoryMetadataAccessObject::FindExecutionsByTypeIdAndNames(
+    const int64 type_id, const std::vector<std::string>& names,
+    std::vector<Execution>* executions, const NodeReadMask* read_mask) {
+  return FindNodesByTypeIdAndNamesImpl(type_id, names, executions, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindExecutionsByFilter(
+    const NodeFilter& filter, std::vector<Execution>* executions,
+    const NodeReadMask* read_mask) {
+  return FindNodesByFilterImpl(filter, executions, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CountExecutions(
+    const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+    std::vector<NodeCount>* counts) {
+  return CountNodesImpl<Execution>(filter, group_by, counts);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::UpdateExecution(
+    const Execution& execution) {
+  return UpdateNodeImpl(execution);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::DeleteExecutions(
+    const std::vector<int64>& execution_ids, const bool dry_run,
+    std::map<std::string, int64>* num_deleted_rows) {
+  return DeleteNodesImpl<Execution>(execution_ids, dry_run, num_deleted_rows);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateContext(
+    const Context& context, int64* context_id) {
+  return CreateNodeImpl(context, context_id);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindContextById(
+    const int64 context_id, Context* context, const NodeReadMask* read_mask) {
+  return FindNodeByIdImpl(context_id, context, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindContexts(
+    std::vector<Context>* contexts, const NodeReadMask* read_mask) {
+  return FindNodesImpl([](const Context&) { return true; }, contexts,
+                       read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindContextsByTypeId(
+    const int64 context_type_id, std::vector<Context>* contexts,
+    const NodeReadMask* read_mask) {
+  return FindNodesImpl(
+      [context_type_id](const Context& context) {
+        return context.type_id() == context_type_id;
+      },
+      contexts, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindContextsByFilter(
+    const NodeFilter& filter, std::vector<Context>* contexts,
+    const NodeReadMask* read_mask) {
+  return FindNodesByFilterImpl(filter, contexts, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CountContexts(
+    const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+    std::vector<NodeCount>* counts) {
+  return CountNodesImpl<Context>(filter, group_by, counts);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindContextByTypeIdAndName(
+    const int64 type_id, const absl::string_view name, Context* context) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  const auto it = database->context_ids_by_name.find(
+      std::make_pair(type_id, std::string(name)));
+  if (it == database->context_ids_by_name.end())
+    return tensorflow::errors::NotFound(absl::StrCat("Cannot find any record"));
+  return FindNodeByIdImpl(it->second, context, /*read_mask=*/nullptr);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindContextsByTypeIdAndNames(
+    const int64 type_id, const std::vector<std::string>& names,
+    std::vector<Context>* contexts, const NodeReadMask* read_mask) {
+  return FindNodesByTypeIdAndNamesImpl(type_id, names, contexts, read_mask);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::UpdateContext(
+    const Context& context) {
+  return UpdateNodeImpl(context);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::DeleteContexts(
+    const std::vector<int64>& context_ids, const bool dry_run,
+    std::map<std::string, int64>* num_deleted_rows) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (num_deleted_rows == nullptr)
+    return tensorflow::errors::InvalidArgument("Given counts is NULL.");
+  if (context_ids.empty()) return tensorflow::Status::OK();
+  int64& num_contexts = (*num_deleted_rows)["Context"];
+  int64& num_properties = (*num_deleted_rows)["ContextProperty"];
+  int64& num_attributions = (*num_deleted_rows)["Attribution"];
+  int64& num_associations = (*num_deleted_rows)["Association"];
+  for (const int64 context_id :
+       std::set<int64>(context_ids.begin(), context_ids.end())) {
+    const auto it = database->contexts.find(context_id);
+    if (it == database->contexts.end()) continue;
+    num_contexts++;
+    num_properties +=
+        it->second.properties_size() + it->second.custom_properties_size();
+    const std::vector<int64> artifact_ids = GetEntry(
+        *database, &InMemoryDatabase::artifact_ids_by_context, context_id);
+    num_attributions += artifact_ids.size();
+    const std::vector<int64> execution_ids = GetEntry(
+        *database, &InMemoryDatabase::execution_ids_by_context, context_id);
+    num_associations += execution_ids.size();
+    if (dry_run) continue;
+
+    EraseEntry(metadata_source_, database,
+               &InMemoryDatabase::artifact_ids_by_context, context_id);
+    for (const int64 artifact_id : artifact_ids) {
+      EraseContextEdge<Artifact>(metadata_source_, database, context_id,
+                                 artifact_id);
+    }
+    EraseEntry(metadata_source_, database,
+               &InMemoryDatabase::execution_ids_by_context, context_id);
+    for (const int64 execution_id : execution_ids) {
+      EraseContextEdge<Execution>(metadata_source_, database, context_id,
+                                  execution_id);
+    }
+    EraseEntry(metadata_source_, database,
+               &InMemoryDatabase::context_ids_by_name,
+               {it->second.type_id(), it->second.name()});
+    EraseEntry(metadata_source_, database, &InMemoryDatabase::context_times,
+               context_id);
+    EraseEntry(metadata_source_, database, &InMemoryDatabase::contexts,
+               context_id);
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateEvent(
+    const Event& event, int64* event_id) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  // validate the given event
+  if (!event.has_artifact_id())
+    return tensorflow::errors::InvalidArgument("No artifact id is specified.");
+  if (!event.has_execution_id())
+    return tensorflow::errors::InvalidArgument("No execution id is specified.");
+  if (!event.has_type() || event.type() == Event::UNKNOWN)
+    return tensorflow::errors::InvalidArgument("No event type is specified.");
+  if (database->artifacts.count(event.artifact_id()) == 0)
+    return tensorflow::errors::InvalidArgument(
+        absl::StrCat("No artifact with the given id ", event.artifact_id()));
+  if (database->executions.count(event.execution_id()) == 0)
+    return tensorflow::errors::InvalidArgument(
+        absl::StrCat("No execution with the given id ", event.execution_id()));
+
+  Event stored_event;
+  stored_event.set_artifact_id(event.artifact_id());
+  stored_event.set_execution_id(event.execution_id());
+  stored_event.set_type(event.type());
+  stored_event.set_milliseconds_since_epoch(
+      event.has_milliseconds_since_epoch() ? event.milliseconds_since_epoch()
+                                           : absl::ToUnixMillis(absl::Now()));
+  if (event.path().steps_size() > 0) {
+    *stored_event.mutable_path() = event.path();
+  }
+  *event_id =
+      NextId(metadata_source_, database, &InMemoryDatabase::last_event_id);
+  SetEntry(metadata_source_, database, &InMemoryDatabase::events, *event_id,
+           stored_event);
+  AppendToEntry(metadata_source_, database,
+                &InMemoryDatabase::event_ids_by_artifact, event.artifact_id(),
+                *event_id);
+  AppendToEntry(metadata_source_, database,
+                &InMemoryDatabase::event_ids_by_execution,
+                event.execution_id(), *event_id);
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateEvents(
+    const std::vector<Event>& events) {
+  for (const Event& event : events) {
+    int64 event_id;
+    TF_RETURN_IF_ERROR(CreateEvent(event, &event_id));
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindEventsByArtifact(
+    const int64 artifact_id, std::vector<Event>* events) {
+  return FindEventsByNodeImpl<Artifact>(artifact_id, events);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindEventsByExecution(
+    const int64 execution_id, std::vector<Event>* events) {
+  return FindEventsByNodeImpl<Execution>(execution_id, events);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindEventsByExecutions(
+    const std::vector<int64>& execution_ids, std::vector<Event>* events) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (events == nullptr)
+    return tensorflow::errors::InvalidArgument("Given events is NULL.");
+  for (const int64 execution_id : execution_ids) {
+    const auto it = database->event_ids_by_execution.find(execution_id);
+    if (it == database->event_ids_by_execution.end()) continue;
+    for (const int64 event_id : it->second) {
+      events->push_back(database->events.at(event_id));
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindEventEdges(
+    std::vector<Event>* events) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (events == nullptr)
+    return tensorflow::errors::InvalidArgument("Given events is NULL.");
+  events->reserve(events->size() + database->events.size());
+  for (const auto& id_and_event : database->events) {
+    const Event& event = id_and_event.second;
+    events->push_back(Event());
+    events->back().set_artifact_id(event.artifact_id());
+    events->back().set_execution_id(event.execution_id());
+    events->back().set_type(event.type());
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateAssociation(
+    const Association& association, int64* association_id) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (!association.has_context_id())
+    return tensorflow::errors::InvalidArgument("No context id is specified.");
+  if (database->contexts.count(association.context_id()) == 0)
+    return tensorflow::errors::InvalidArgument("Context id not found.");
+  if (!association.has_execution_id())
+    return tensorflow::errors::InvalidArgument("No execution id is specified");
+  if (database->executions.count(association.execution_id()) == 0)
+    return tensorflow::errors::InvalidArgument("Execution id not found.");
+  return CreateContextEdgeImpl<Execution>(
+      association.context_id(), association.execution_id(), association_id);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateAssociationsIfNotExist(
+    const std::vector<Association>& associations,
+    std::vector<Association>* created_associations) {
+  std::vector<std::pair<int64, int64>> edges;
+  edges.reserve(associations.size());
+  for (const Association& association : associations) {
+    if (!association.has_context_id())
+      return tensorflow::errors::InvalidArgument("No context id is specified.");
+    if (!association.has_execution_id())
+      return tensorflow::errors::InvalidArgument(
+          "No execution id is specified");
+    edges.emplace_back(association.context_id(), association.execution_id());
+  }
+  std::vector<std::pair<int64, int64>> created_edges;
+  TF_RETURN_IF_ERROR(
+      CreateContextEdgesIfNotExistImpl<Execution>(edges, &created_edges));
+  for (const std::pair<int64, int64>& edge : created_edges) {
+    Association association;
+    association.set_context_id(edge.first);
+    association.set_execution_id(edge.second);
+    created_associations->push_back(association);
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindContextsByExecution(
+    const int64 execution_id, std::vector<Context>* contexts) {
+  return FindContextsByNodeImpl<Execution>(execution_id, contexts);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindExecutionsByContext(
+    const int64 context_id, std::vector<Execution>* executions) {
+  return FindNodesByContextImpl(context_id, executions);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindAssociationsByExecutions(
+    const std::vector<int64>& execution_ids,
+    std::vector<Association>* associations) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (associations == nullptr)
+    return tensorflow::errors::InvalidArgument("Given associations is NULL.");
+  for (const int64 execution_id : execution_ids) {
+    const auto it = database->context_ids_by_execution.find(execution_id);
+    if (it == database->context_ids_by_execution.end()) continue;
+    for (const int64 context_id : it->second) {
+      associations->push_back(Association());
+      associations->back().set_execution_id(execution_id);
+      associations->back().set_context_id(context_id);
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateAttribution(
+    const Attribution& attribution, int64* attribution_id) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (!attribution.has_context_id())
+    return tensorflow::errors::InvalidArgument("No context id is specified.");
+  if (database->contexts.count(attribution.context_id()) == 0)
+    return tensorflow::errors::InvalidArgument("Context id not found.");
+  if (!attribution.has_artifact_id())
+    return tensorflow::errors::InvalidArgument("No artifact id is specified");
+  if (database->artifacts.count(attribution.artifact_id()) == 0)
+    return tensorflow::errors::InvalidArgument("Artifact id not found.");
+  return CreateContextEdgeImpl<Artifact>(
+      attribution.context_id(), attribution.artifact_id(), attribution_id);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::CreateAttributionsIfNotExist(
+    const std::vector<Attribution>& attributions,
+    std::vector<Attribution>* created_attributions) {
+  std::vector<std::pair<int64, int64>> edges;
+  edges.reserve(attributions.size());
+  for (const Attribution& attribution : attributions) {
+    if (!attribution.has_context_id())
+      return tensorflow::errors::InvalidArgument("No context id is specified.");
+    if (!attribution.has_artifact_id())
+      return tensorflow::errors::InvalidArgument("No artifact id is specified");
+    edges.emplace_back(attribution.context_id(), attribution.artifact_id());
+  }
+  std::vector<std::pair<int64, int64>> created_edges;
+  TF_RETURN_IF_ERROR(
+      CreateContextEdgesIfNotExistImpl<Artifact>(edges, &created_edges));
+  for (const std::pair<int64, int64>& edge : created_edges) {
+    Attribution attribution;
+    attribution.set_context_id(edge.first);
+    attribution.set_artifact_id(edge.second);
+    created_attributions->push_back(attribution);
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindContextsByArtifact(
+    const int64 artifact_id, std::vector<Context>* contexts) {
+  return FindContextsByNodeImpl<Artifact>(artifact_id, contexts);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindArtifactsByContext(
+    const int64 context_id, std::vector<Artifact>* artifacts) {
+  return FindNodesByContextImpl(context_id, artifacts);
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::FindAttributionsByArtifacts(
+    const std::vector<int64>& artifact_ids,
+    std::vector<Attribution>* attributions) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (attributions == nullptr)
+    return tensorflow::errors::InvalidArgument("Given attributions is NULL.");
+  for (const int64 artifact_id : artifact_ids) {
+    const auto it = database->context_ids_by_artifact.find(artifact_id);
+    if (it == database->context_ids_by_artifact.end()) continue;
+    for (const int64 context_id : it->second) {
+      attributions->push_back(Attribution());
+      attributions->back().set_artifact_id(artifact_id);
+      attributions->back().set_context_id(context_id);
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::InitChangeLog(
+    const int64 new_log_id, int64* log_id, int64* last_sequence) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (!database->has_change_log) {
+    SetField(metadata_source_, database, &InMemoryDatabase::has_change_log,
+             true);
+    SetField(metadata_source_, database, &InMemoryDatabase::change_log_id,
+             new_log_id);
+  }
+  *log_id = database->change_log_id;
+  *last_sequence = database->last_change_sequence;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::AdvanceChangeLog(
+    const int64 num_changes, int64* last_sequence) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database));
+  if (!database->has_change_log) {
+    return tensorflow::errors::DataLoss("The change log does not exist.");
+  }
+  SetField(metadata_source_, database, &InMemoryDatabase::last_change_sequence,
+           database->last_change_sequence + num_changes);
+  *last_sequence = database->last_change_sequence;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataAccessObject::GetSchemaVersion(
+    int64* db_version) {
+  InMemoryDatabase* database;
+  TF_RETURN_IF_ERROR(GetDatabase(&database, /*allow_no_schema=*/true));
+  if (!database->has_schema) {
+    return tensorflow::errors::NotFound(
+        "The in-memory metadata source is empty.");
+  }
+  *db_version = database->schema_version;
+  return tensorflow::Status::OK();
+}
+
+}  // namespace ml_metadata
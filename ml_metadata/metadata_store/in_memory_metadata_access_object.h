@@ -0,0 +1,379 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_ACCESS_OBJECT_H_
+#define ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_ACCESS_OBJECT_H_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
+#include "ml_metadata/metadata_store/metadata_access_object.h"
+#include "ml_metadata/metadata_store/node_read_mask.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// An implementation of MetadataAccessObject keeping the metadata in the
+// InMemoryDatabase of an InMemoryMetadataSource, without composing or parsing
+// SQL queries. The nodes and types are looked up by id in ordered maps, and
+// the lineage edges are read from adjacency lists.
+//
+// It has the same semantics as the RDBMSMetadataAccessObject, and stores the
+// same fields of the nodes and types, e.g., the names are unique within a
+// type, and the times of the nodes are recorded without being returned. Each
+// method fails without changes if it returns an error, and its writes are
+// undone if the transaction is rolled back. Every method returns
+// FAILED_PRECONDITION error if no transaction is open, and the methods other
+// than the ones initializing the schema return FAILED_PRECONDITION error if
+// the schema is not initialized.
+//
+// It is thread-unsafe.
+class InMemoryMetadataAccessObject : public MetadataAccessObject {
+ public:
+  // The `metadata_source` is not owned, and should be connected while the
+  // object is used. The `library_version` is the schema version that the
+  // initialized schema gets.
+  InMemoryMetadataAccessObject(InMemoryMetadataSource* metadata_source,
+                               int64 library_version)
+      : metadata_source_(metadata_source), library_version_(library_version) {}
+  ~InMemoryMetadataAccessObject() override = default;
+
+  // default & copy constructors are disallowed.
+  InMemoryMetadataAccessObject() = delete;
+  InMemoryMetadataAccessObject(const InMemoryMetadataAccessObject&) = delete;
+  InMemoryMetadataAccessObject& operator=(
+      const InMemoryMetadataAccessObject&) = delete;
+
+  tensorflow::Status InitMetadataSource() final;
+
+  tensorflow::Status InitMetadataSourceIfNotExists(
+      bool enable_upgrade_migration = false) final;
+
+  tensorflow::Status DowngradeMetadataSource(int64 to_schema_version) final;
+
+  tensorflow::Status CreateType(const ArtifactType& type,
+                                int64* type_id) final;
+  tensorflow::Status CreateType(const ExecutionType& type,
+                                int64* type_id) final;
+  tensorflow::Status CreateType(const ContextType& type, int64* type_id) final;
+
+  tensorflow::Status UpdateType(const ArtifactType& type) final;
+  tensorflow::Status UpdateType(const ExecutionType& type) final;
+  tensorflow::Status UpdateType(const ContextType& type) final;
+
+  tensorflow::Status CreatePropertyIndexes(const ArtifactType& type) final;
+  tensorflow::Status CreatePropertyIndexes(const ExecutionType& type) final;
+  tensorflow::Status CreatePropertyIndexes(const ContextType& type) final;
+
+  tensorflow::Status FindTypeById(int64 type_id,
+                                  ArtifactType* artifact_type) final;
+  tensorflow::Status FindTypeById(int64 type_id,
+                                  ExecutionType* execution_type) final;
+  tensorflow::Status FindTypeById(int64 type_id,
+                                  ContextType* context_type) final;
+
+  tensorflow::Status FindTypeByName(absl::string_view name,
+                                    ArtifactType* artifact_type) final;
+  tensorflow::Status FindTypeByName(absl::string_view name,
+                                    ExecutionType* execution_type) final;
+  tensorflow::Status FindTypeByName(absl::string_view name,
+                                    ContextType* context_type) final;
+
+  tensorflow::Status FindTypes(std::vector<ArtifactType>* artifact_types) final;
+  tensorflow::Status FindTypes(
+      std::vector<ExecutionType>* execution_types) final;
+  tensorflow::Status FindTypes(std::vector<ContextType>* context_types) final;
+
+  tensorflow::Status CreateArtifact(const Artifact& artifact,
+                                    int64* artifact_id) final;
+
+  tensorflow::Status CreateArtifacts(const std::vector<Artifact>& artifacts,
+                                     std::vector<int64>* artifact_ids) final;
+
+  tensorflow::Status FindArtifactById(
+      int64 artifact_id, Artifact* artifact,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindArtifacts(
+      std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindArtifactsByTypeId(
+      int64 artifact_type_id, std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindArtifactsByURI(
+      absl::string_view uri, std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindArtifactsByTypeIdAndNames(
+      int64 type_id, const std::vector<std::string>& names,
+      std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindArtifactsByFilter(
+      const NodeFilter& filter, std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status CountArtifacts(
+      const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+      std::vector<NodeCount>* counts) final;
+
+  tensorflow::Status UpdateArtifact(const Artifact& artifact) final;
+
+  tensorflow::Status DeleteArtifacts(
+      const std::vector<int64>& artifact_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows) final;
+
+  tensorflow::Status CreateExecution(const Execution& execution,
+                                     int64* execution_id) final;
+
+  tensorflow::Status CreateExecutions(const std::vector<Execution>& executions,
+                                      std::vector<int64>* execution_ids) final;
+
+  tensorflow::Status FindExecutionById(
+      int64 execution_id, Execution* execution,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindExecutions(
+      std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindExecutionsByTypeId(
+      int64 execution_type_id, std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindExecutionsByTypeIdAndNames(
+      int64 type_id, const std::vector<std::string>& names,
+      std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindExecutionsByFilter(
+      const NodeFilter& filter, std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status CountExecutions(
+      const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+      std::vector<NodeCount>* counts) final;
+
+  tensorflow::Status UpdateExecution(const Execution& execution) final;
+
+  tensorflow::Status DeleteExecutions(
+      const std::vector<int64>& execution_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows) final;
+
+  tensorflow::Status CreateContext(const Context& context,
+                                   int64* context_id) final;
+
+  tensorflow::Status FindContextById(
+      int64 context_id, Context* context,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindContexts(
+      std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindContextsByTypeId(
+      int64 context_type_id, std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindContextsByFilter(
+      const NodeFilter& filter, std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status CountContexts(
+      const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+      std::vector<NodeCount>* counts) final;
+
+  tensorflow::Status FindContextByTypeIdAndName(int64 type_id,
+                                                absl::string_view name,
+                                                Context* context) final;
+
+  tensorflow::Status FindContextsByTypeIdAndNames(
+      int64 type_id, const std::vector<std::string>& names,
+      std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status UpdateContext(const Context& context) final;
+
+  tensorflow::Status DeleteContexts(
+      const std::vector<int64>& context_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows) final;
+
+  tensorflow::Status CreateEvent(const Event& event, int64* event_id) final;
+
+  tensorflow::Status CreateEvents(const std::vector<Event>& events) final;
+
+  tensorflow::Status FindEventsByArtifact(int64 artifact_id,
+                                          std::vector<Event>* events) final;
+
+  tensorflow::Status FindEventsByExecution(int64 execution_id,
+                                           std::vector<Event>* events) final;
+
+  tensorflow::Status FindEventsByExecutions(
+      const std::vector<int64>& execution_ids,
+      std::vector<Event>* events) final;
+
+  tensorflow::Status FindEventEdges(std::vector<Event>* events) final;
+
+  tensorflow::Status CreateAssociation(const Association& association,
+                                       int64* association_id) final;
+
+  tensorflow::Status CreateAssociationsIfNotExist(
+      const std::vector<Association>& associations,
+      std::vector<Association>* created_associations) final;
+
+  tensorflow::Status FindContextsByExecution(
+      int64 execution_id, std::vector<Context>* contexts) final;
+
+  tensorflow::Status FindExecutionsByContext(
+      int64 context_id, std::vector<Execution>* executions) final;
+
+  tensorflow::Status FindAssociationsByExecutions(
+      const std::vector<int64>& execution_ids,
+      std::vector<Association>* associations) final;
+
+  tensorflow::Status CreateAttribution(const Attribution& attribution,
+                                       int64* attribution_id) final;
+
+  tensorflow::Status CreateAttributionsIfNotExist(
+      const std::vector<Attribution>& attributions,
+      std::vector<Attribution>* created_attributions) final;
+
+  tensorflow::Status FindContextsByArtifact(
+      int64 artifact_id, std::vector<Context>* contexts) final;
+
+  tensorflow::Status FindArtifactsByContext(
+      int64 context_id, std::vector<Artifact>* artifacts) final;
+
+  tensorflow::Status FindAttributionsByArtifacts(
+      const std::vector<int64>& artifact_ids,
+      std::vector<Attribution>* attributions) final;
+
+  tensorflow::Status InitChangeLog(int64 new_log_id, int64* log_id,
+                                   int64* last_sequence) final;
+
+  tensorflow::Status AdvanceChangeLog(int64 num_changes,
+                                      int64* last_sequence) final;
+
+  tensorflow::Status GetSchemaVersion(int64* db_version) final;
+
+  int64 GetLibraryVersion() final { return library_version_; }
+
+ private:
+  // Returns the database if a transaction is open, and the schema is
+  // initialized unless `allow_no_schema` is set.
+  // Returns FAILED_PRECONDITION error otherwise.
+  tensorflow::Status GetDatabase(InMemoryDatabase** database,
+                                 bool allow_no_schema = false);
+
+  template <typename Type>
+  tensorflow::Status CreateTypeImpl(const Type& type, int64* type_id);
+
+  template <typename Type>
+  tensorflow::Status UpdateTypeImpl(const Type& type);
+
+  template <typename Type>
+  tensorflow::Status FindTypeByIdImpl(int64 type_id, Type* type);
+
+  template <typename Type>
+  tensorflow::Status FindTypeByNameImpl(absl::string_view name, Type* type);
+
+  template <typename Type>
+  tensorflow::Status FindTypesImpl(std::vector<Type>* types);
+
+  template <typename Node>
+  tensorflow::Status CreateNodeImpl(const Node& node, int64* node_id);
+
+  // Creates the nodes in order. As there are no statements to batch, each
+  // node is created as by CreateNodeImpl.
+  template <typename Node>
+  tensorflow::Status CreateNodesImpl(const std::vector<Node>& nodes,
+                                     std::vector<int64>* node_ids);
+
+  template <typename Node>
+  tensorflow::Status UpdateNodeImpl(const Node& node);
+
+  template <typename Node>
+  tensorflow::Status FindNodeByIdImpl(int64 node_id, Node* node,
+                                      const NodeReadMask* read_mask);
+
+  // Finds the nodes for which `predicate` returns true, in the order of ids.
+  // If a `read_mask` is given, only the selected fields are set.
+  // Returns INVALID_ARGUMENT error, if the read_mask has an unknown path.
+  // Returns NOT_FOUND error, if no node is found.
+  template <typename Node, typename Predicate>
+  tensorflow::Status FindNodesImpl(const Predicate& predicate,
+                                   std::vector<Node>* nodes,
+                                   const NodeReadMask* read_mask = nullptr);
+
+  // Finds the nodes of a type with the given names, in the order of ids.
+  // Returns NOT_FOUND error, if no node is found.
+  template <typename Node>
+  tensorflow::Status FindNodesByTypeIdAndNamesImpl(
+      int64 type_id, const std::vector<std::string>& names,
+      std::vector<Node>* nodes, const NodeReadMask* read_mask);
+
+  template <typename Node>
+  tensorflow::Status FindNodesByFilterImpl(const NodeFilter& filter,
+                                           std::vector<Node>* nodes,
+                                           const NodeReadMask* read_mask);
+
+  template <typename Node>
+  tensorflow::Status CountNodesImpl(
+      const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+      std::vector<NodeCount>* counts);
+
+  template <typename Node>
+  tensorflow::Status FindEventsByNodeImpl(int64 node_id,
+                                          std::vector<Event>* events);
+
+  template <typename Node>
+  tensorflow::Status CreateContextEdgeImpl(int64 context_id, int64 node_id,
+                                           int64* edge_id);
+
+  // Creates the (context id, node id) `edges` that do not exist yet, and
+  // appends the created ones to `created_edges`.
+  template <typename Node>
+  tensorflow::Status CreateContextEdgesIfNotExistImpl(
+      const std::vector<std::pair<int64, int64>>& edges,
+      std::vector<std::pair<int64, int64>>* created_edges);
+
+  template <typename Node>
+  tensorflow::Status FindContextsByNodeImpl(int64 node_id,
+                                            std::vector<Context>* contexts);
+
+  template <typename Node>
+  tensorflow::Status FindNodesByContextImpl(int64 context_id,
+                                            std::vector<Node>* nodes);
+
+  // Deletes artifacts or executions with their dependent rows.
+  template <typename Node>
+  tensorflow::Status DeleteNodesImpl(
+      const std::vector<int64>& node_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows);
+
+  // Not owned.
+  InMemoryMetadataSource* const metadata_source_;
+  const int64 library_version_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_ACCESS_OBJECT_H_
@@ -0,0 +1,119 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Test suite for an InMemoryMetadataSource based MetadataAccessObject.
+
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
+#include "ml_metadata/metadata_store/metadata_access_object_factory.h"
+#include "ml_metadata/metadata_store/metadata_access_object_test.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace testing {
+
+namespace {
+
+// InMemoryMetadataAccessObjectContainer implements
+// MetadataAccessObjectContainer to generate and retrieve a
+// MetadataAccessObject based on an InMemoryMetadataSource. The in-memory
+// source has a single schema version, so there are no migrations to verify.
+class InMemoryMetadataAccessObjectContainer
+    : public MetadataAccessObjectContainer {
+ public:
+  InMemoryMetadataAccessObjectContainer() {
+    metadata_source_ = absl::make_unique<InMemoryMetadataSource>();
+    TF_CHECK_OK(CreateMetadataAccessObject(
+        util::GetFakeMetadataSourceQueryConfig(), metadata_source_.get(),
+        &metadata_access_object_));
+  }
+
+  ~InMemoryMetadataAccessObjectContainer() override = default;
+
+  MetadataSource* GetMetadataSource() override {
+    return metadata_source_.get();
+  }
+  MetadataAccessObject* GetMetadataAccessObject() override {
+    return metadata_access_object_.get();
+  }
+
+  bool HasUpgradeVerification(int64 version) override { return false; }
+
+  bool HasDowngradeVerification(int64 version) override { return false; }
+
+  tensorflow::Status SetupPreviousVersionForDowngrade(int64 version) override {
+    return tensorflow::errors::Unimplemented("No previous versions.");
+  }
+
+  tensorflow::Status DowngradeVerification(int64 version) override {
+    return tensorflow::errors::Unimplemented("No previous versions.");
+  }
+
+  tensorflow::Status SetupPreviousVersionForUpgrade(int64 version) override {
+    return tensorflow::errors::Unimplemented("No previous versions.");
+  }
+
+  tensorflow::Status UpgradeVerification(int64 version) override {
+    return tensorflow::errors::Unimplemented("No previous versions.");
+  }
+
+  tensorflow::Status DropTypeTable() override { return DropCollection(); }
+
+  tensorflow::Status DropArtifactTable() override { return DropCollection(); }
+
+  tensorflow::Status DeleteSchemaVersion() override {
+    return tensorflow::errors::Unimplemented(
+        "The schema version is always kept.");
+  }
+
+  tensorflow::Status SetDatabaseVersionIncompatible() override {
+    metadata_source_->database()->schema_version =
+        metadata_access_object_->GetLibraryVersion() + 1;
+    return tensorflow::Status::OK();
+  }
+
+  int64 MinimumVersion() override {
+    return metadata_access_object_->GetLibraryVersion();
+  }
+
+  bool PerformExtendedTests() override { return false; }
+
+ private:
+  // Marks the schema as partially created.
+  tensorflow::Status DropCollection() {
+    metadata_source_->database()->is_schema_partial = true;
+    return tensorflow::Status::OK();
+  }
+
+  std::unique_ptr<InMemoryMetadataSource> metadata_source_;
+  std::unique_ptr<MetadataAccessObject> metadata_access_object_;
+};
+
+}  // namespace
+
+INSTANTIATE_TEST_CASE_P(
+    InMemoryMetadataAccessObjectTest, MetadataAccessObjectTest,
+    ::testing::Values([]() {
+      return absl::make_unique<InMemoryMetadataAccessObjectContainer>();
+    }));
+
+}  // namespace testing
+}  // namespace ml_metadata
@@ -0,0 +1,97 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace ml_metadata {
+
+std::string InMemoryMetadataSource::EscapeString(
+    absl::string_view value) const {
+  return std::string(value);
+}
+
+void InMemoryMetadataSource::AddUndo(std::function<void()> undo) {
+  undo_log_.push_back(std::move(undo));
+}
+
+tensorflow::Status InMemoryMetadataSource::ConnectImpl() {
+  database_ = absl::make_unique<InMemoryDatabase>();
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataSource::CloseImpl() {
+  database_.reset();
+  undo_log_.clear();
+  savepoints_.clear();
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataSource::ExecuteQueryImpl(
+    const std::string& query, RecordSet* results) {
+  return tensorflow::errors::Unimplemented(
+      "The in-memory metadata source does not run queries: ", query);
+}
+
+tensorflow::Status InMemoryMetadataSource::BeginImpl() {
+  undo_log_.clear();
+  savepoints_.clear();
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataSource::CommitImpl() {
+  undo_log_.clear();
+  savepoints_.clear();
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataSource::RollbackImpl() {
+  UndoTo(0);
+  savepoints_.clear();
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataSource::SavepointImpl(const int depth) {
+  savepoints_.push_back(undo_log_.size());
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataSource::ReleaseSavepointImpl(
+    const int depth) {
+  if (savepoints_.size() != depth) {
+    return tensorflow::errors::Internal("Unknown savepoint: ", depth);
+  }
+  savepoints_.pop_back();
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status InMemoryMetadataSource::RollbackToSavepointImpl(
+    const int depth) {
+  if (savepoints_.size() != depth) {
+    return tensorflow::errors::Internal("Unknown savepoint: ", depth);
+  }
+  UndoTo(savepoints_.back());
+  return tensorflow::Status::OK();
+}
+
+void InMemoryMetadataSource::UndoTo(const size_t size) {
+  while (undo_log_.size() > size) {
+    undo_log_.back()();
+    undo_log_.pop_back();
+  }
+}
+
+}  // namespace ml_metadata
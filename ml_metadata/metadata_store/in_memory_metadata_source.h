@@ -0,0 +1,162 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_SOURCE_H_
+#define ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_SOURCE_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// The times of a node in milliseconds since epoch, which are recorded by the
+// SQL backends without being returned in the node.
+struct NodeTimes {
+  int64 create_time_since_epoch = 0;
+  int64 last_update_time_since_epoch = 0;
+};
+
+// The metadata kept by an InMemoryMetadataSource. The nodes and types are
+// kept in maps ordered by id, so that they are listed in the order of the ids
+// as the SQL backends do. The lineage edges are kept in adjacency lists in
+// the order of their creation.
+struct InMemoryDatabase {
+  // True once the schema is created.
+  bool has_schema = false;
+  // True if a part of the schema is missing, e.g., dropped by a test.
+  bool is_schema_partial = false;
+  int64 schema_version = 0;
+
+  // The last assigned ids. The three kinds of types share the ids.
+  int64 last_type_id = 0;
+  int64 last_artifact_id = 0;
+  int64 last_execution_id = 0;
+  int64 last_context_id = 0;
+  int64 last_event_id = 0;
+  int64 last_attribution_id = 0;
+  int64 last_association_id = 0;
+  // The change log of the store, if it is created.
+  bool has_change_log = false;
+  int64 change_log_id = 0;
+  int64 last_change_sequence = 0;
+
+  std::map<int64, ArtifactType> artifact_types;
+  std::map<int64, ExecutionType> execution_types;
+  std::map<int64, ContextType> context_types;
+
+  std::map<int64, Artifact> artifacts;
+  std::map<int64, Execution> executions;
+  std::map<int64, Context> contexts;
+  // (type id, node name) -> node id, for the named nodes. The contexts are
+  // always named.
+  std::map<std::pair<int64, std::string>, int64> artifact_ids_by_name;
+  std::map<std::pair<int64, std::string>, int64> execution_ids_by_name;
+  std::map<std::pair<int64, std::string>, int64> context_ids_by_name;
+  // node id -> the times of the node.
+  std::map<int64, NodeTimes> artifact_times;
+  std::map<int64, NodeTimes> execution_times;
+  std::map<int64, NodeTimes> context_times;
+
+  std::map<int64, Event> events;
+  // node id -> the ids of its events.
+  std::map<int64, std::vector<int64>> event_ids_by_artifact;
+  std::map<int64, std::vector<int64>> event_ids_by_execution;
+
+  // The (context id, node id) pairs of the attributions and associations.
+  std::set<std::pair<int64, int64>> attributions;
+  std::set<std::pair<int64, int64>> associations;
+  // node id -> the ids of the contexts it is attributed or associated to.
+  std::map<int64, std::vector<int64>> context_ids_by_artifact;
+  std::map<int64, std::vector<int64>> context_ids_by_execution;
+  // context id -> the ids of the artifacts or executions in the context.
+  std::map<int64, std::vector<int64>> artifact_ids_by_context;
+  std::map<int64, std::vector<int64>> execution_ids_by_context;
+};
+
+// A MetadataSource keeping the metadata in an InMemoryDatabase instead of a
+// SQL database, for the InMemoryMetadataAccessObject. It does not run queries.
+// The database is created when connected, and destroyed when closed.
+//
+// The writes in a transaction are undone on rollback by replaying the undo
+// actions recorded with AddUndo() in reverse order. This class is
+// thread-unsafe.
+class InMemoryMetadataSource : public MetadataSource {
+ public:
+  InMemoryMetadataSource() = default;
+  ~InMemoryMetadataSource() override = default;
+
+  // Disallow copy and assign.
+  InMemoryMetadataSource(const InMemoryMetadataSource&) = delete;
+  InMemoryMetadataSource& operator=(const InMemoryMetadataSource&) = delete;
+
+  // Returns the value as is, as there are no queries to bind it to.
+  std::string EscapeString(absl::string_view value) const final;
+
+  // Returns the database, or null if the source is not connected.
+  InMemoryDatabase* database() { return database_.get(); }
+
+  // Records an action undoing a write to the database in the open
+  // transaction. It is run if the transaction, or the savepoint enclosing the
+  // write, is rolled back.
+  void AddUndo(std::function<void()> undo);
+
+ private:
+  // Creates an empty database.
+  tensorflow::Status ConnectImpl() final;
+
+  // Destroys the database.
+  tensorflow::Status CloseImpl() final;
+
+  // Returns UNIMPLEMENTED error, as the source does not run queries.
+  tensorflow::Status ExecuteQueryImpl(const std::string& query,
+                                      RecordSet* results) final;
+
+  tensorflow::Status BeginImpl() final;
+
+  tensorflow::Status CommitImpl() final;
+
+  tensorflow::Status RollbackImpl() final;
+
+  tensorflow::Status SavepointImpl(int depth) final;
+
+  tensorflow::Status ReleaseSavepointImpl(int depth) final;
+
+  tensorflow::Status RollbackToSavepointImpl(int depth) final;
+
+  // Runs the undo actions recorded after the first `size` ones in reverse
+  // order, and removes them.
+  void UndoTo(size_t size);
+
+  std::unique_ptr<InMemoryDatabase> database_;
+
+  // The undo actions of the writes in the open transaction.
+  std::vector<std::function<void()>> undo_log_;
+
+  // The sizes of the undo log when the open savepoints were created.
+  std::vector<size_t> savepoints_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_SOURCE_H_
@@ -0,0 +1,192 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_access_object.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+using testing::EqualsProto;
+using testing::ParseTextProtoOrDie;
+
+class InMemoryMetadataSourceTest : public ::testing::Test {
+ protected:
+  InMemoryMetadataSourceTest()
+      : metadata_access_object_(&metadata_source_, /*library_version=*/1) {
+    TF_CHECK_OK(metadata_source_.Connect());
+    TF_CHECK_OK(metadata_source_.Begin());
+    TF_CHECK_OK(metadata_access_object_.InitMetadataSource());
+    TF_CHECK_OK(metadata_source_.Commit());
+  }
+
+  InMemoryMetadataSource metadata_source_;
+  InMemoryMetadataAccessObject metadata_access_object_;
+};
+
+TEST_F(InMemoryMetadataSourceTest, TestQueryIsUnimplemented) {
+  TF_ASSERT_OK(metadata_source_.Begin());
+  tensorflow::Status s = metadata_source_.ExecuteQuery("SELECT 1;", nullptr);
+  EXPECT_EQ(s.code(), tensorflow::error::UNIMPLEMENTED);
+  TF_ASSERT_OK(metadata_source_.Commit());
+}
+
+TEST_F(InMemoryMetadataSourceTest, TestRollbackUndoesWrites) {
+  const ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'p' value: STRING }
+  )");
+  int64 type_id;
+  TF_ASSERT_OK(metadata_source_.Begin());
+  TF_ASSERT_OK(metadata_access_object_.CreateType(type, &type_id));
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  artifact.set_uri("uri");
+  int64 artifact_id;
+  TF_ASSERT_OK(metadata_access_object_.CreateArtifact(artifact, &artifact_id));
+  TF_ASSERT_OK(metadata_source_.Commit());
+
+  TF_ASSERT_OK(metadata_source_.Begin());
+  artifact.set_id(artifact_id);
+  (*artifact.mutable_properties())["p"].set_string_value("v");
+  TF_ASSERT_OK(metadata_access_object_.UpdateArtifact(artifact));
+  int64 another_artifact_id;
+  TF_ASSERT_OK(
+      metadata_access_object_.CreateArtifact(artifact, &another_artifact_id));
+  TF_ASSERT_OK(metadata_access_object_.InitMetadataSource());
+  TF_ASSERT_OK(metadata_source_.Rollback());
+
+  // The update, the creation and the reset are undone, and the ids are
+  // assigned again.
+  TF_ASSERT_OK(metadata_source_.Begin());
+  std::vector<Artifact> artifacts;
+  TF_ASSERT_OK(metadata_access_object_.FindArtifacts(&artifacts));
+  ASSERT_EQ(artifacts.size(), 1);
+  EXPECT_THAT(artifacts[0], EqualsProto(ParseTextProtoOrDie<Artifact>(
+                                absl::StrCat("id: ", artifact_id, " type_id: ",
+                                             type_id, " uri: 'uri'"))));
+  TF_ASSERT_OK(
+      metadata_access_object_.CreateArtifact(artifact, &another_artifact_id));
+  EXPECT_EQ(another_artifact_id, artifact_id + 1);
+  TF_ASSERT_OK(metadata_source_.Commit());
+}
+
+TEST_F(InMemoryMetadataSourceTest, TestRollbackUndoesDeletes) {
+  int64 artifact_type_id, execution_type_id, context_type_id;
+  TF_ASSERT_OK(metadata_source_.Begin());
+  TF_ASSERT_OK(metadata_access_object_.CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+      &artifact_type_id));
+  TF_ASSERT_OK(metadata_access_object_.CreateType(
+      ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+      &execution_type_id));
+  TF_ASSERT_OK(metadata_access_object_.CreateType(
+      ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+      &context_type_id));
+  Artifact artifact;
+  artifact.set_type_id(artifact_type_id);
+  int64 artifact_id;
+  TF_ASSERT_OK(metadata_access_object_.CreateArtifact(artifact, &artifact_id));
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id;
+  TF_ASSERT_OK(
+      metadata_access_object_.CreateExecution(execution, &execution_id));
+  Context context;
+  context.set_type_id(context_type_id);
+  context.set_name("context");
+  int64 context_id;
+  TF_ASSERT_OK(metadata_access_object_.CreateContext(context, &context_id));
+  Event event;
+  event.set_artifact_id(artifact_id);
+  event.set_execution_id(execution_id);
+  event.set_type(Event::OUTPUT);
+  int64 event_id;
+  TF_ASSERT_OK(metadata_access_object_.CreateEvent(event, &event_id));
+  Attribution attribution;
+  attribution.set_artifact_id(artifact_id);
+  attribution.set_context_id(context_id);
+  int64 attribution_id;
+  TF_ASSERT_OK(
+      metadata_access_object_.CreateAttribution(attribution, &attribution_id));
+  TF_ASSERT_OK(metadata_source_.Commit());
+
+  TF_ASSERT_OK(metadata_source_.Begin());
+  std::map<std::string, int64> num_deleted_rows;
+  TF_ASSERT_OK(metadata_access_object_.DeleteArtifacts(
+      {artifact_id}, /*dry_run=*/false, &num_deleted_rows));
+  TF_ASSERT_OK(metadata_access_object_.DeleteContexts(
+      {context_id}, /*dry_run=*/false, &num_deleted_rows));
+  TF_ASSERT_OK(metadata_source_.Rollback());
+
+  // The nodes are restored along with their event and attribution.
+  TF_ASSERT_OK(metadata_source_.Begin());
+  std::vector<Event> events;
+  TF_ASSERT_OK(metadata_access_object_.FindEventsByExecution(execution_id,
+                                                             &events));
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].artifact_id(), artifact_id);
+  std::vector<Artifact> artifacts;
+  TF_ASSERT_OK(
+      metadata_access_object_.FindArtifactsByContext(context_id, &artifacts));
+  ASSERT_EQ(artifacts.size(), 1);
+  EXPECT_EQ(artifacts[0].id(), artifact_id);
+  Context found_context;
+  TF_ASSERT_OK(metadata_access_object_.FindContextByTypeIdAndName(
+      context_type_id, "context", &found_context));
+  TF_ASSERT_OK(metadata_source_.Commit());
+}
+
+TEST_F(InMemoryMetadataSourceTest, TestRollbackToSavepoint) {
+  const ContextType type = ParseTextProtoOrDie<ContextType>("name: 'type'");
+  int64 type_id;
+  TF_ASSERT_OK(metadata_source_.Begin());
+  TF_ASSERT_OK(metadata_access_object_.CreateType(type, &type_id));
+  Context context;
+  context.set_type_id(type_id);
+  context.set_name("kept");
+  int64 context_id;
+  TF_ASSERT_OK(metadata_access_object_.CreateContext(context, &context_id));
+
+  TF_ASSERT_OK(metadata_source_.Savepoint());
+  context.set_name("undone");
+  TF_ASSERT_OK(metadata_access_object_.CreateContext(context, &context_id));
+  TF_ASSERT_OK(metadata_source_.RollbackToSavepoint());
+  TF_ASSERT_OK(metadata_source_.Commit());
+
+  TF_ASSERT_OK(metadata_source_.Begin());
+  std::vector<Context> contexts;
+  TF_ASSERT_OK(metadata_access_object_.FindContexts(&contexts));
+  ASSERT_EQ(contexts.size(), 1);
+  EXPECT_EQ(contexts[0].name(), "kept");
+  Context found_context;
+  EXPECT_EQ(metadata_access_object_
+                .FindContextByTypeIdAndName(type_id, "undone", &found_context)
+                .code(),
+            tensorflow::error::NOT_FOUND);
+  TF_ASSERT_OK(metadata_source_.Commit());
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,296 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/lineage_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace ml_metadata {
+namespace {
+
+// Pending edges are merged into the CSR arrays when they exceed this number
+// or a fraction of the compacted edges, whichever is larger. The removed edges
+// are dropped from the arrays by the same measure.
+constexpr int64 kMinPendingEdgesToCompact = 4096;
+constexpr int64 kCompactedToPendingEdgesRatio = 8;
+
+// Marks a target of the CSR arrays whose edge is removed. Node ids are never
+// negative.
+constexpr int64 kRemovedTarget = -1;
+
+// Returns the heap memory held by a vector.
+template <typename T>
+int64 VectorBytes(const std::vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
+}  // namespace
+
+void LineageIndex::Adjacency::Build(
+    std::vector<std::pair<int64, int64>>* edges) {
+  Clear();
+  std::sort(edges->begin(), edges->end());
+  edges->erase(std::unique(edges->begin(), edges->end()), edges->end());
+  if (edges->empty()) return;
+  const int64 max_from = edges->back().first;
+  offsets_.assign(max_from + 2, 0);
+  targets_.reserve(edges->size());
+  for (const std::pair<int64, int64>& edge : *edges) {
+    offsets_[edge.first + 1]++;
+    targets_.push_back(edge.second);
+  }
+  for (size_t i = 1; i < offsets_.size(); ++i) {
+    offsets_[i] += offsets_[i - 1];
+  }
+}
+
+void LineageIndex::Adjacency::Add(int64 from, int64 to) {
+  pending_[from].push_back(to);
+  ++num_pending_edges_;
+  MaybeCompact();
+}
+
+void LineageIndex::Adjacency::Append(int64 from,
+                                     std::vector<int64>* targets) const {
+  if (from >= 0 && from + 1 < static_cast<int64>(offsets_.size())) {
+    std::copy_if(targets_.begin() + offsets_[from],
+                 targets_.begin() + offsets_[from + 1],
+                 std::back_inserter(*targets),
+                 [](int64 target) { return target != kRemovedTarget; });
+  }
+  const auto it = pending_.find(from);
+  if (it != pending_.end()) {
+    targets->insert(targets->end(), it->second.begin(), it->second.end());
+  }
+}
+
+void LineageIndex::Adjacency::Remove(int64 from,
+                                     std::vector<int64>* targets) {
+  if (from >= 0 && from + 1 < static_cast<int64>(offsets_.size())) {
+    for (int64 i = offsets_[from]; i < offsets_[from + 1]; ++i) {
+      if (targets_[i] == kRemovedTarget) continue;
+      targets->push_back(targets_[i]);
+      targets_[i] = kRemovedTarget;
+      ++num_removed_edges_;
+    }
+  }
+  const auto it = pending_.find(from);
+  if (it != pending_.end()) {
+    targets->insert(targets->end(), it->second.begin(), it->second.end());
+    num_pending_edges_ -= it->second.size();
+    pending_.erase(it);
+  }
+  MaybeCompact();
+}
+
+void LineageIndex::Adjacency::RemoveEdge(int64 from, int64 to) {
+  if (from >= 0 && from + 1 < static_cast<int64>(offsets_.size())) {
+    const auto begin = targets_.begin() + offsets_[from];
+    const auto end = targets_.begin() + offsets_[from + 1];
+    const auto target = std::find(begin, end, to);
+    if (target != end) {
+      *target = kRemovedTarget;
+      ++num_removed_edges_;
+      MaybeCompact();
+      return;
+    }
+  }
+  const auto it = pending_.find(from);
+  if (it == pending_.end()) return;
+  const auto target = std::find(it->second.begin(), it->second.end(), to);
+  if (target == it->second.end()) return;
+  it->second.erase(target);
+  --num_pending_edges_;
+  if (it->second.empty()) pending_.erase(it);
+}
+
+void LineageIndex::Adjacency::Clear() {
+  std::vector<int64>().swap(offsets_);
+  std::vector<int64>().swap(targets_);
+  absl::flat_hash_map<int64, std::vector<int64>>().swap(pending_);
+  num_pending_edges_ = 0;
+  num_removed_edges_ = 0;
+}
+
+int64 LineageIndex::Adjacency::memory_bytes() const {
+  int64 bytes = VectorBytes(offsets_) + VectorBytes(targets_);
+  bytes += pending_.capacity() *
+           (sizeof(std::pair<const int64, std::vector<int64>>) + 1);
+  for (const auto& node_and_targets : pending_) {
+    bytes += VectorBytes(node_and_targets.second);
+  }
+  return bytes;
+}
+
+void LineageIndex::Adjacency::MaybeCompact() {
+  const int64 min_edges_to_compact =
+      std::max<int64>(kMinPendingEdgesToCompact,
+                      targets_.size() / kCompactedToPendingEdgesRatio);
+  if (num_pending_edges_ >= min_edges_to_compact ||
+      num_removed_edges_ >= min_edges_to_compact) {
+    Compact();
+  }
+}
+
+void LineageIndex::Adjacency::Compact() {
+  int64 max_from = static_cast<int64>(offsets_.size()) - 2;
+  for (const auto& node_and_targets : pending_) {
+    max_from = std::max(max_from, node_and_targets.first);
+  }
+  std::vector<int64> offsets(max_from + 2, 0);
+  std::vector<int64> targets;
+  targets.reserve(num_edges());
+  for (int64 from = 0; from <= max_from; ++from) {
+    Append(from, &targets);
+    offsets[from + 1] = targets.size();
+  }
+  offsets_.swap(offsets);
+  targets_.swap(targets);
+  absl::flat_hash_map<int64, std::vector<int64>>().swap(pending_);
+  num_pending_edges_ = 0;
+  num_removed_edges_ = 0;
+}
+
+LineageIndex::LineageIndex(const int64 max_memory_bytes)
+    : max_memory_bytes_(max_memory_bytes) {}
+
+bool LineageIndex::IsInputEvent(const Event::Type type) {
+  return type == Event::INPUT || type == Event::DECLARED_INPUT ||
+         type == Event::INTERNAL_INPUT;
+}
+
+bool LineageIndex::IsOutputEvent(const Event::Type type) {
+  return type == Event::OUTPUT || type == Event::DECLARED_OUTPUT ||
+         type == Event::INTERNAL_OUTPUT;
+}
+
+void LineageIndex::Build(const std::vector<Event>& events) {
+  std::vector<std::pair<int64, int64>> artifact_to_execution;
+  std::vector<std::pair<int64, int64>> execution_to_artifact;
+  artifact_to_execution.reserve(events.size());
+  execution_to_artifact.reserve(events.size());
+  for (bool is_input : {true, false}) {
+    artifact_to_execution.clear();
+    execution_to_artifact.clear();
+    for (const Event& event : events) {
+      if (!(is_input ? IsInputEvent(event.type())
+                     : IsOutputEvent(event.type()))) {
+        continue;
+      }
+      artifact_to_execution.push_back(
+          {event.artifact_id(), event.execution_id()});
+      execution_to_artifact.push_back(
+          {event.execution_id(), event.artifact_id()});
+    }
+    (is_input ? consumers_ : producers_).Build(&artifact_to_execution);
+    (is_input ? inputs_ : outputs_).Build(&execution_to_artifact);
+  }
+  enabled_ = true;
+  EnforceMemoryLimit();
+}
+
+void LineageIndex::AddEvents(const std::vector<Event>& events) {
+  if (!enabled_) return;
+  for (const Event& event : events) {
+    if (IsInputEvent(event.type())) {
+      consumers_.Add(event.artifact_id(), event.execution_id());
+      inputs_.Add(event.execution_id(), event.artifact_id());
+    } else if (IsOutputEvent(event.type())) {
+      producers_.Add(event.artifact_id(), event.execution_id());
+      outputs_.Add(event.execution_id(), event.artifact_id());
+    }
+  }
+  EnforceMemoryLimit();
+}
+
+void LineageIndex::RemoveNodes(const std::vector<int64>& artifact_ids,
+                               const std::vector<int64>& execution_ids) {
+  if (!enabled_) return;
+  std::vector<int64> ids;
+  for (const int64 artifact_id : artifact_ids) {
+    ids.clear();
+    consumers_.Remove(artifact_id, &ids);
+    for (const int64 execution_id : ids) {
+      inputs_.RemoveEdge(execution_id, artifact_id);
+    }
+    ids.clear();
+    producers_.Remove(artifact_id, &ids);
+    for (const int64 execution_id : ids) {
+      outputs_.RemoveEdge(execution_id, artifact_id);
+    }
+  }
+  for (const int64 execution_id : execution_ids) {
+    ids.clear();
+    inputs_.Remove(execution_id, &ids);
+    for (const int64 artifact_id : ids) {
+      consumers_.RemoveEdge(artifact_id, execution_id);
+    }
+    ids.clear();
+    outputs_.Remove(execution_id, &ids);
+    for (const int64 artifact_id : ids) {
+      producers_.RemoveEdge(artifact_id, execution_id);
+    }
+  }
+}
+
+void LineageIndex::AppendConsumers(int64 artifact_id,
+                                   std::vector<int64>* execution_ids) const {
+  consumers_.Append(artifact_id, execution_ids);
+}
+
+void LineageIndex::AppendProducers(int64 artifact_id,
+                                   std::vector<int64>* execution_ids) const {
+  producers_.Append(artifact_id, execution_ids);
+}
+
+void LineageIndex::AppendInputs(int64 execution_id,
+                                std::vector<int64>* artifact_ids) const {
+  inputs_.Append(execution_id, artifact_ids);
+}
+
+void LineageIndex::AppendOutputs(int64 execution_id,
+                                 std::vector<int64>* artifact_ids) const {
+  outputs_.Append(execution_id, artifact_ids);
+}
+
+int64 LineageIndex::num_edges() const {
+  return consumers_.num_edges() + producers_.num_edges();
+}
+
+int64 LineageIndex::memory_bytes() const {
+  return consumers_.memory_bytes() + producers_.memory_bytes() +
+         inputs_.memory_bytes() + outputs_.memory_bytes();
+}
+
+void LineageIndex::EnforceMemoryLimit() {
+  if (max_memory_bytes_ <= 0 || memory_bytes() <= max_memory_bytes_) return;
+  LOG(WARNING) << "The lineage index uses " << memory_bytes()
+               << " bytes, more than the limit of " << max_memory_bytes_
+               << " bytes. It is disabled, and lineage queries fall back to "
+                  "the metadata source.";
+  Clear();
+  enabled_ = false;
+}
+
+void LineageIndex::Clear() {
+  consumers_.Clear();
+  producers_.Clear();
+  inputs_.Clear();
+  outputs_.Clear();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,169 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_LINEAGE_INDEX_H_
+#define ML_METADATA_METADATA_STORE_LINEAGE_INDEX_H_
+
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// An in-memory index of the lineage graph formed by the events between
+// artifacts and executions. The edges are kept in compressed adjacency arrays
+// (CSR) keyed by node id, so that the neighbors of a node can be read without
+// any query to the metadata source.
+//
+// The index is built once from all stored events, and then updated with each
+// newly committed event and each deleted node. If its estimated memory grows
+// beyond `max_memory_bytes`, it drops all edges and stays disabled, and the
+// caller is expected to answer lineage queries from the metadata source
+// instead.
+//
+// It is thread-unsafe.
+class LineageIndex {
+ public:
+  // Creates an empty and disabled index. If `max_memory_bytes` is not
+  // positive, the index size is not limited.
+  explicit LineageIndex(int64 max_memory_bytes);
+
+  // default & copy constructors are disallowed.
+  LineageIndex() = delete;
+  LineageIndex(const LineageIndex&) = delete;
+  LineageIndex& operator=(const LineageIndex&) = delete;
+
+  // Returns true if the event type denotes an input of the execution, i.e.,
+  // the edge points from the artifact to the execution in the lineage graph.
+  static bool IsInputEvent(Event::Type type);
+
+  // Returns true if the event type denotes an output of the execution, i.e.,
+  // the edge points from the execution to the artifact. The events that are
+  // neither inputs nor outputs, e.g., UNKNOWN ones, are not lineage edges.
+  static bool IsOutputEvent(Event::Type type);
+
+  // Replaces the content of the index with the edges of the given events and
+  // enables it, unless the memory limit is exceeded.
+  void Build(const std::vector<Event>& events);
+
+  // Adds the edges of the given newly committed events. It is a no-op if the
+  // index is disabled.
+  void AddEvents(const std::vector<Event>& events);
+
+  // Removes the edges of the given deleted artifacts and executions, whose
+  // events are deleted along with them. The other edges are kept as they are.
+  // It is a no-op if the index is disabled.
+  void RemoveNodes(const std::vector<int64>& artifact_ids,
+                   const std::vector<int64>& execution_ids);
+
+  // Returns true if the index holds all edges and can answer queries.
+  bool enabled() const { return enabled_; }
+
+  // Appends the ids of the executions having `artifact_id` as an input.
+  void AppendConsumers(int64 artifact_id,
+                       std::vector<int64>* execution_ids) const;
+
+  // Appends the ids of the executions having `artifact_id` as an output.
+  void AppendProducers(int64 artifact_id,
+                       std::vector<int64>* execution_ids) const;
+
+  // Appends the ids of the input artifacts of `execution_id`.
+  void AppendInputs(int64 execution_id,
+                    std::vector<int64>* artifact_ids) const;
+
+  // Appends the ids of the output artifacts of `execution_id`.
+  void AppendOutputs(int64 execution_id,
+                     std::vector<int64>* artifact_ids) const;
+
+  // Returns the number of artifact-execution edges in the index.
+  int64 num_edges() const;
+
+  // Returns the estimated heap memory held by the index.
+  int64 memory_bytes() const;
+
+  int64 max_memory_bytes() const { return max_memory_bytes_; }
+
+ private:
+  // The directed edges from one kind of node to another. Edges known at
+  // build time are kept in CSR arrays; edges added later are kept in a small
+  // hash map and merged into the arrays once it grows. Removed edges of the
+  // arrays are marked, and dropped once they grow as well.
+  class Adjacency {
+   public:
+    // Replaces all edges with the given (from, to) pairs.
+    void Build(std::vector<std::pair<int64, int64>>* edges);
+
+    // Adds an edge, merging pending edges into the CSR arrays if needed.
+    void Add(int64 from, int64 to);
+
+    // Appends the targets of the edges starting at `from`.
+    void Append(int64 from, std::vector<int64>* targets) const;
+
+    // Removes the edges starting at `from`, and appends their targets.
+    void Remove(int64 from, std::vector<int64>* targets);
+
+    // Removes one edge from `from` to `to`, if there is one.
+    void RemoveEdge(int64 from, int64 to);
+
+    // Drops all edges and releases the memory.
+    void Clear();
+
+    int64 num_edges() const {
+      return targets_.size() - num_removed_edges_ + num_pending_edges_;
+    }
+
+    int64 memory_bytes() const;
+
+   private:
+    // Merges the pending edges into the CSR arrays, and drops the removed
+    // edges from them, if there are enough of either.
+    void MaybeCompact();
+
+    // Merges the pending edges into the CSR arrays, and drops the removed
+    // edges from them.
+    void Compact();
+
+    // offsets_[id] and offsets_[id + 1] delimit the targets of node `id`.
+    std::vector<int64> offsets_;
+    std::vector<int64> targets_;
+    absl::flat_hash_map<int64, std::vector<int64>> pending_;
+    int64 num_pending_edges_ = 0;
+    // The number of targets_ marked as removed.
+    int64 num_removed_edges_ = 0;
+  };
+
+  // Disables the index and drops all edges if the memory limit is exceeded.
+  void EnforceMemoryLimit();
+
+  // Drops all edges.
+  void Clear();
+
+  const int64 max_memory_bytes_;
+  bool enabled_ = false;
+  // artifact -> executions having the artifact as an input.
+  Adjacency consumers_;
+  // artifact -> executions having the artifact as an output.
+  Adjacency producers_;
+  // execution -> input artifacts.
+  Adjacency inputs_;
+  // execution -> output artifacts.
+  Adjacency outputs_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_LINEAGE_INDEX_H_
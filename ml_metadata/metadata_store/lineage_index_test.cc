@@ -0,0 +1,188 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/lineage_index.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+Event CreateEvent(int64 artifact_id, int64 execution_id, Event::Type type) {
+  Event event;
+  event.set_artifact_id(artifact_id);
+  event.set_execution_id(execution_id);
+  event.set_type(type);
+  return event;
+}
+
+TEST(LineageIndexTest, BuildAndLookup) {
+  LineageIndex index(/*max_memory_bytes=*/0);
+  EXPECT_FALSE(index.enabled());
+  // a1 -> e1 -> a2 -> e2 -> a3
+  index.Build({CreateEvent(1, 1, Event::INPUT),
+               CreateEvent(2, 1, Event::OUTPUT),
+               CreateEvent(2, 2, Event::DECLARED_INPUT),
+               CreateEvent(3, 2, Event::INTERNAL_OUTPUT),
+               // duplicated edges are dropped when building the index.
+               CreateEvent(1, 1, Event::INPUT),
+               // events of unknown direction are not lineage edges.
+               CreateEvent(3, 3, Event::UNKNOWN)});
+  EXPECT_TRUE(index.enabled());
+  EXPECT_EQ(index.num_edges(), 4);
+  EXPECT_GT(index.memory_bytes(), 0);
+
+  std::vector<int64> ids;
+  index.AppendConsumers(2, &ids);
+  EXPECT_THAT(ids, UnorderedElementsAre(2));
+  ids.clear();
+  index.AppendProducers(2, &ids);
+  EXPECT_THAT(ids, UnorderedElementsAre(1));
+  ids.clear();
+  index.AppendInputs(2, &ids);
+  EXPECT_THAT(ids, UnorderedElementsAre(2));
+  ids.clear();
+  index.AppendOutputs(2, &ids);
+  EXPECT_THAT(ids, UnorderedElementsAre(3));
+  ids.clear();
+  index.AppendConsumers(3, &ids);
+  index.AppendInputs(3, &ids);
+  index.AppendProducers(100, &ids);
+  index.AppendOutputs(-1, &ids);
+  EXPECT_THAT(ids, IsEmpty());
+}
+
+TEST(LineageIndexTest, AddEvents) {
+  LineageIndex index(/*max_memory_bytes=*/0);
+  // Events are ignored before the index is built.
+  index.AddEvents({CreateEvent(1, 1, Event::INPUT)});
+  EXPECT_EQ(index.num_edges(), 0);
+
+  index.Build({CreateEvent(1, 1, Event::INPUT)});
+  // Adds enough edges to have both compacted and pending edges.
+  std::vector<Event> events;
+  for (int64 i = 2; i < 10000; i++) {
+    events.push_back(CreateEvent(i, 1, Event::OUTPUT));
+  }
+  index.AddEvents(events);
+  index.AddEvents({CreateEvent(1, 10000, Event::INPUT),
+                   CreateEvent(1, 10001, Event::UNKNOWN)});
+  EXPECT_EQ(index.num_edges(), 10000);
+
+  std::vector<int64> ids;
+  index.AppendOutputs(1, &ids);
+  EXPECT_EQ(ids.size(), 9998);
+  ids.clear();
+  index.AppendConsumers(1, &ids);
+  EXPECT_THAT(ids, UnorderedElementsAre(1, 10000));
+  ids.clear();
+  index.AppendProducers(9999, &ids);
+  EXPECT_THAT(ids, UnorderedElementsAre(1));
+}
+
+TEST(LineageIndexTest, RemoveNodes) {
+  LineageIndex index(/*max_memory_bytes=*/0);
+  // Nodes are ignored before the index is built.
+  index.RemoveNodes({1}, {1});
+
+  // a1 -> e1 -> a2 -> e2 -> a3, and a1 -> e2.
+  index.Build({CreateEvent(1, 1, Event::INPUT),
+               CreateEvent(2, 1, Event::OUTPUT),
+               CreateEvent(2, 2, Event::INPUT),
+               CreateEvent(1, 2, Event::INPUT)});
+  // The added edges are pending, and removed as well.
+  index.AddEvents({CreateEvent(3, 2, Event::OUTPUT),
+                   CreateEvent(4, 3, Event::OUTPUT)});
+  EXPECT_EQ(index.num_edges(), 6);
+  const int64 memory_bytes = index.memory_bytes();
+
+  index.RemoveNodes(/*artifact_ids=*/{2, 4}, /*execution_ids=*/{});
+  EXPECT_EQ(index.num_edges(), 3);
+  std::vector<int64> ids;
+  index.AppendOutputs(1, &ids);
+  index.AppendOutputs(3, &ids);
+  index.AppendConsumers(2, &ids);
+  index.AppendProducers(4, &ids);
+  EXPECT_THAT(ids, IsEmpty());
+  index.AppendInputs(2, &ids);
+  EXPECT_THAT(ids, UnorderedElementsAre(1));
+  ids.clear();
+  index.AppendConsumers(1, &ids);
+  EXPECT_THAT(ids, UnorderedElementsAre(1, 2));
+
+  index.RemoveNodes(/*artifact_ids=*/{}, /*execution_ids=*/{2});
+  EXPECT_EQ(index.num_edges(), 1);
+  ids.clear();
+  index.AppendConsumers(1, &ids);
+  EXPECT_THAT(ids, UnorderedElementsAre(1));
+  ids.clear();
+  index.AppendProducers(3, &ids);
+  index.AppendInputs(2, &ids);
+  index.AppendOutputs(2, &ids);
+  EXPECT_THAT(ids, IsEmpty());
+  // The edges are removed in place, without rebuilding the index.
+  EXPECT_LE(index.memory_bytes(), memory_bytes);
+  EXPECT_TRUE(index.enabled());
+}
+
+TEST(LineageIndexTest, RemoveNodesCompactsRemovedEdges) {
+  LineageIndex index(/*max_memory_bytes=*/0);
+  std::vector<Event> events;
+  std::vector<int64> artifact_ids;
+  for (int64 i = 1; i <= 10000; i++) {
+    events.push_back(CreateEvent(i, i % 10, Event::INPUT));
+    if (i % 2 == 0) artifact_ids.push_back(i);
+  }
+  index.Build(events);
+  const int64 memory_bytes = index.memory_bytes();
+  index.RemoveNodes(artifact_ids, /*execution_ids=*/{});
+  EXPECT_EQ(index.num_edges(), 5000);
+  EXPECT_LT(index.memory_bytes(), memory_bytes);
+  std::vector<int64> ids;
+  index.AppendInputs(3, &ids);
+  EXPECT_EQ(ids.size(), 1000);
+  for (const int64 id : ids) {
+    EXPECT_EQ(id % 2, 1);
+  }
+}
+
+TEST(LineageIndexTest, DisabledWhenExceedingMemoryLimit) {
+  LineageIndex index(/*max_memory_bytes=*/1024);
+  index.Build({CreateEvent(1, 1, Event::INPUT)});
+  EXPECT_TRUE(index.enabled());
+
+  std::vector<Event> events;
+  for (int64 i = 2; i < 1000; i++) {
+    events.push_back(CreateEvent(i, i, Event::OUTPUT));
+  }
+  index.AddEvents(events);
+  EXPECT_FALSE(index.enabled());
+  EXPECT_EQ(index.num_edges(), 0);
+  EXPECT_EQ(index.memory_bytes(), 0);
+
+  // The index stays disabled.
+  index.AddEvents({CreateEvent(1, 2, Event::INPUT)});
+  EXPECT_FALSE(index.enabled());
+  EXPECT_EQ(index.num_edges(), 0);
+}
+
+}  // namespace
+}  // namespace ml_metadata
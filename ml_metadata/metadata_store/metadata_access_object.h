@@ -15,7 +15,9 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_ACCESS_OBJECT_H_
 #define ML_METADATA_METADATA_STORE_METADATA_ACCESS_OBJECT_H_
 
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "ml_metadata/metadata_store/metadata_source.h"
@@ -108,6 +110,20 @@ class MetadataAccessObject {
   virtual tensorflow::Status UpdateType(const ExecutionType& type) = 0;
   virtual tensorflow::Status UpdateType(const ContextType& type) = 0;
 
+  // Creates the property table indexes for the data types of the
+  // `indexed_properties` of the stored type with the name of `type`, if they
+  // do not exist yet. CreateType and UpdateType only mark the properties as
+  // indexed. Creating an index implicitly commits the open transaction on some
+  // backends (e.g., MySQL), so it should be called in a transaction of its own
+  // once the type is committed.
+  // Returns NOT_FOUND error, if the type does not exist.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status CreatePropertyIndexes(
+      const ArtifactType& type) = 0;
+  virtual tensorflow::Status CreatePropertyIndexes(
+      const ExecutionType& type) = 0;
+  virtual tensorflow::Status CreatePropertyIndexes(const ContextType& type) = 0;
+
   // Queries a type by an id. A type is one of
   // {ArtifactType, ExecutionType, ContextType}
   // Returns NOT_FOUND error, if the given type_id cannot be found.
@@ -153,28 +169,72 @@ class MetadataAccessObject {
   virtual tensorflow::Status CreateArtifact(const Artifact& artifact,
                                             int64* artifact_id) = 0;
 
-  // Queries an artifact by an id.
+  // Creates the artifacts in order, and returns the assigned ids index-aligned
+  // with `artifacts`. Each distinct ArtifactType is looked up once, and the
+  // artifacts and their properties are inserted in bulk.
+  // Returns the errors of CreateArtifact.
+  virtual tensorflow::Status CreateArtifacts(
+      const std::vector<Artifact>& artifacts,
+      std::vector<int64>* artifact_ids) = 0;
+
+  // Queries an artifact by an id. If a `read_mask` is given, only the fields
+  // it selects are set, and the properties it does not select are not read.
+  // The other queries of artifacts, executions and contexts take the
+  // `read_mask` in the same way.
+  // Returns INVALID_ARGUMENT error, if the read_mask has an unknown path.
   // Returns NOT_FOUND error, if the given artifact_id cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
-  virtual tensorflow::Status FindArtifactById(int64 artifact_id,
-                                              Artifact* artifact) = 0;
+  virtual tensorflow::Status FindArtifactById(
+      int64 artifact_id, Artifact* artifact,
+      const NodeReadMask* read_mask = nullptr) = 0;
 
   // Queries artifacts stored in the metadata source
   // Returns detailed INTERNAL error, if query execution fails.
   virtual tensorflow::Status FindArtifacts(
-      std::vector<Artifact>* artifacts) = 0;
+      std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) = 0;
 
   // Queries artifacts by a given type_id.
   // Returns NOT_FOUND error, if the given artifact_type_id cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual tensorflow::Status FindArtifactsByTypeId(
-      int64 artifact_type_id, std::vector<Artifact>* artifacts) = 0;
+      int64 artifact_type_id, std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) = 0;
 
   // Queries artifacts by a given uri with exact match.
   // Returns NOT_FOUND error, if the given uri cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual tensorflow::Status FindArtifactsByURI(
-      absl::string_view uri, std::vector<Artifact>* artifacts) = 0;
+      absl::string_view uri, std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) = 0;
+
+  // Queries the artifacts of a type_id with the given names, in the order of
+  // their ids. The names that are not found are skipped.
+  // Returns NOT_FOUND error, if none of the names can be found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status FindArtifactsByTypeIdAndNames(
+      int64 type_id, const std::vector<std::string>& names,
+      std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) = 0;
+
+  // Queries artifacts satisfying all the predicates of the filter.
+  // Returns INVALID_ARGUMENT error, if a predicate is malformed or does not
+  //   apply to artifacts.
+  // Returns NOT_FOUND error, if no artifact can be found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status FindArtifactsByFilter(
+      const NodeFilter& filter, std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) = 0;
+
+  // Counts the artifacts satisfying all the predicates of the filter, grouped
+  // by the distinct values of the `group_by` attributes. Without `group_by`,
+  // a single count is returned; otherwise a count for each non-empty group.
+  // Returns INVALID_ARGUMENT error, if the filter has a limit, or if a
+  //   predicate or an attribute does not apply to artifacts.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status CountArtifacts(
+      const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+      std::vector<NodeCount>* counts) = 0;
 
   // Updates an artifact.
   // Returns INVALID_ARGUMENT error, if the id field is not given.
@@ -186,6 +246,16 @@ class MetadataAccessObject {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual tensorflow::Status UpdateArtifact(const Artifact& artifact) = 0;
 
+  // Deletes the artifacts with the given ids along with their properties,
+  // events, event paths and attributions.
+  // Ids of no artifact are ignored. The number of rows of each table that are
+  // deleted, or would be deleted if `dry_run`, is added to
+  // `num_deleted_rows` by table name.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status DeleteArtifacts(
+      const std::vector<int64>& artifact_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows) = 0;
+
   // Creates an execution, returns the assigned execution id. The id field of
   // the execution is ignored.
   // Returns INVALID_ARGUMENT error, if the ExecutionType is not given.
@@ -198,22 +268,61 @@ class MetadataAccessObject {
   virtual tensorflow::Status CreateExecution(const Execution& execution,
                                              int64* execution_id) = 0;
 
+  // Creates the executions in order, and returns the assigned ids
+  // index-aligned with `executions`. Each distinct ExecutionType is looked up
+  // once, and the executions and their properties are inserted in bulk.
+  // Returns the errors of CreateExecution.
+  virtual tensorflow::Status CreateExecutions(
+      const std::vector<Execution>& executions,
+      std::vector<int64>* execution_ids) = 0;
+
   // Queries an entity by an id.
   // Returns NOT_FOUND error, if the given execution_id cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
-  virtual tensorflow::Status FindExecutionById(int64 execution_id,
-                                               Execution* execution) = 0;
+  virtual tensorflow::Status FindExecutionById(
+      int64 execution_id, Execution* execution,
+      const NodeReadMask* read_mask = nullptr) = 0;
 
   // Queries executions stored in the metadata source
   // Returns detailed INTERNAL error, if query execution fails.
   virtual tensorflow::Status FindExecutions(
-      std::vector<Execution>* executions) = 0;
+      std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) = 0;
 
   // Queries executions by a given type_id.
   // Returns NOT_FOUND error, if the given execution_type_id cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual tensorflow::Status FindExecutionsByTypeId(
-      int64 execution_type_id, std::vector<Execution>* executions) = 0;
+      int64 execution_type_id, std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) = 0;
+
+  // Queries the executions of a type_id with the given names, in the order of
+  // their ids. The names that are not found are skipped.
+  // Returns NOT_FOUND error, if none of the names can be found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status FindExecutionsByTypeIdAndNames(
+      int64 type_id, const std::vector<std::string>& names,
+      std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) = 0;
+
+  // Queries executions satisfying all the predicates of the filter.
+  // Returns INVALID_ARGUMENT error, if a predicate is malformed or does not
+  //   apply to executions.
+  // Returns NOT_FOUND error, if no execution can be found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status FindExecutionsByFilter(
+      const NodeFilter& filter, std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) = 0;
+
+  // Counts the executions satisfying all the predicates of the filter, grouped
+  // by the distinct values of the `group_by` attributes. Without `group_by`,
+  // a single count is returned; otherwise a count for each non-empty group.
+  // Returns INVALID_ARGUMENT error, if the filter has a limit, or if a
+  //   predicate or an attribute does not apply to executions.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status CountExecutions(
+      const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+      std::vector<NodeCount>* counts) = 0;
 
   // Updates an execution.
   // Returns INVALID_ARGUMENT error, if the id field is not given.
@@ -225,6 +334,16 @@ class MetadataAccessObject {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual tensorflow::Status UpdateExecution(const Execution& execution) = 0;
 
+  // Deletes the executions with the given ids along with their properties,
+  // events, event paths and associations.
+  // Ids of no execution are ignored. The number of rows of each table that are
+  // deleted, or would be deleted if `dry_run`, is added to
+  // `num_deleted_rows` by table name.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status DeleteExecutions(
+      const std::vector<int64>& execution_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows) = 0;
+
   // Creates a context, returns the assigned context id. The id field of the
   // context is ignored. The name field of the context must not be empty and it
   // should be unique in the same ContextType.
@@ -243,18 +362,41 @@ class MetadataAccessObject {
   // Queries a context by an id.
   // Returns NOT_FOUND error, if the given context_id cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
-  virtual tensorflow::Status FindContextById(int64 context_id,
-                                             Context* context) = 0;
+  virtual tensorflow::Status FindContextById(
+      int64 context_id, Context* context,
+      const NodeReadMask* read_mask = nullptr) = 0;
 
   // Queries contexts stored in the metadata source
   // Returns detailed INTERNAL error, if query execution fails.
-  virtual tensorflow::Status FindContexts(std::vector<Context>* contexts) = 0;
+  virtual tensorflow::Status FindContexts(
+      std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) = 0;
 
   // Queries contexts by a given type_id.
   // Returns NOT_FOUND error, if no context can be found.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual tensorflow::Status FindContextsByTypeId(
-      int64 context_type_id, std::vector<Context>* contexts) = 0;
+      int64 context_type_id, std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) = 0;
+
+  // Queries contexts satisfying all the predicates of the filter.
+  // Returns INVALID_ARGUMENT error, if a predicate is malformed or does not
+  //   apply to contexts.
+  // Returns NOT_FOUND error, if no context can be found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status FindContextsByFilter(
+      const NodeFilter& filter, std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) = 0;
+
+  // Counts the contexts satisfying all the predicates of the filter, grouped
+  // by the distinct values of the `group_by` attributes. Without `group_by`,
+  // a single count is returned; otherwise a count for each non-empty group.
+  // Returns INVALID_ARGUMENT error, if the filter has a limit, or if a
+  //   predicate or an attribute does not apply to contexts.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status CountContexts(
+      const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+      std::vector<NodeCount>* counts) = 0;
 
   // Queries a context by a type_id and a context name.
   // Returns NOT_FOUND error, if no context can be found.
@@ -262,6 +404,15 @@ class MetadataAccessObject {
   virtual tensorflow::Status FindContextByTypeIdAndName(
       int64 type_id, absl::string_view name, Context* context) = 0;
 
+  // Queries the contexts of a type_id with the given names, in the order of
+  // their ids. The names that are not found are skipped.
+  // Returns NOT_FOUND error, if none of the names can be found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status FindContextsByTypeIdAndNames(
+      int64 type_id, const std::vector<std::string>& names,
+      std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) = 0;
+
   // Updates a context.
   // Returns INVALID_ARGUMENT error, if the id field is not given.
   // Returns INVALID_ARGUMENT error, if no context is found with the given id.
@@ -272,6 +423,16 @@ class MetadataAccessObject {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual tensorflow::Status UpdateContext(const Context& context) = 0;
 
+  // Deletes the contexts with the given ids along with their properties,
+  // attributions and associations.
+  // Ids of no context are ignored. The number of rows of each table that are
+  // deleted, or would be deleted if `dry_run`, is added to
+  // `num_deleted_rows` by table name.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status DeleteContexts(
+      const std::vector<int64>& context_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows) = 0;
+
   // Creates an event, returns the assigned event id. If the event occurrence
   // time is not given, the insertion time is used.
   // TODO(huimiao) Allow to have a unknown event time.
@@ -281,6 +442,13 @@ class MetadataAccessObject {
   virtual tensorflow::Status CreateEvent(const Event& event,
                                          int64* event_id) = 0;
 
+  // Creates the events in bulk. The referenced artifacts and executions are
+  // validated together, and the events and their paths are inserted with
+  // multi-row statements. If the event occurrence time is not given, the
+  // insertion time is used.
+  // Returns the errors of CreateEvent.
+  virtual tensorflow::Status CreateEvents(const std::vector<Event>& events) = 0;
+
   // Queries the events associated with an artifact_id.
   // Returns INVALID_ARGUMENT error, if the `events` is null.
   // Returns NOT_FOUND error, if there are no events found with the `artifact`.
@@ -293,6 +461,19 @@ class MetadataAccessObject {
   virtual tensorflow::Status FindEventsByExecution(
       int64 execution_id, std::vector<Event>* events) = 0;
 
+  // Appends the events of any of the `execution_ids` to `events`, reading the
+  // events and their paths with one query each.
+  // Returns INVALID_ARGUMENT error, if the `events` is null.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status FindEventsByExecutions(
+      const std::vector<int64>& execution_ids, std::vector<Event>* events) = 0;
+
+  // Queries all events with only their artifact_id, execution_id and type,
+  // i.e., the edges of the lineage graph, without reading event paths.
+  // Returns INVALID_ARGUMENT error, if the `events` is null.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status FindEventEdges(std::vector<Event>* events) = 0;
+
   // Creates an association, returns the assigned association id.
   // Returns INVALID_ARGUMENT error, if no context matches the context_id.
   // Returns INVALID_ARGUMENT error, if no execution matches the execution_id.
@@ -300,6 +481,16 @@ class MetadataAccessObject {
   virtual tensorflow::Status CreateAssociation(const Association& association,
                                                int64* association_id) = 0;
 
+  // Creates the associations that do not exist yet in bulk, and appends the
+  // created ones, without ids, to `created_associations`. An association given
+  // more than once is created once.
+  // Returns INVALID_ARGUMENT error, if a context_id or an execution_id is not
+  // given, or is not found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status CreateAssociationsIfNotExist(
+      const std::vector<Association>& associations,
+      std::vector<Association>* created_associations) = 0;
+
   // Queries the contexts that an execution_id is associated with.
   // Returns INVALID_ARGUMENT error, if the `contexts` is null.
   virtual tensorflow::Status FindContextsByExecution(
@@ -310,6 +501,14 @@ class MetadataAccessObject {
   virtual tensorflow::Status FindExecutionsByContext(
       int64 context_id, std::vector<Execution>* executions) = 0;
 
+  // Appends the associations of any of the `execution_ids` to `associations`,
+  // with one query.
+  // Returns INVALID_ARGUMENT error, if the `associations` is null.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status FindAssociationsByExecutions(
+      const std::vector<int64>& execution_ids,
+      std::vector<Association>* associations) = 0;
+
   // Creates an attribution, returns the assigned attribution id.
   // Returns INVALID_ARGUMENT error, if no context matches the context_id.
   // Returns INVALID_ARGUMENT error, if no artifact matches the artifact_id.
@@ -317,6 +516,16 @@ class MetadataAccessObject {
   virtual tensorflow::Status CreateAttribution(const Attribution& attribution,
                                                int64* attribution_id) = 0;
 
+  // Creates the attributions that do not exist yet in bulk, and appends the
+  // created ones, without ids, to `created_attributions`. An attribution given
+  // more than once is created once.
+  // Returns INVALID_ARGUMENT error, if a context_id or an artifact_id is not
+  // given, or is not found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status CreateAttributionsIfNotExist(
+      const std::vector<Attribution>& attributions,
+      std::vector<Attribution>* created_attributions) = 0;
+
   // Queries the contexts that an artifact_id is attributed to.
   // Returns INVALID_ARGUMENT error, if the `contexts` is null.
   virtual tensorflow::Status FindContextsByArtifact(
@@ -327,6 +536,29 @@ class MetadataAccessObject {
   virtual tensorflow::Status FindArtifactsByContext(
       int64 context_id, std::vector<Artifact>* artifacts) = 0;
 
+  // Appends the attributions of any of the `artifact_ids` to `attributions`,
+  // with one query.
+  // Returns INVALID_ARGUMENT error, if the `attributions` is null.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status FindAttributionsByArtifacts(
+      const std::vector<int64>& artifact_ids,
+      std::vector<Attribution>* attributions) = 0;
+
+  // Reads the id and the last sequence of the change log of the metadata
+  // source, which assigns the sequences of the changes of the store. If there
+  // is no change log yet, it is created with the id `new_log_id` and no
+  // changes.
+  // Returns DATA_LOSS error, if the change log cannot be parsed.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status InitChangeLog(int64 new_log_id, int64* log_id,
+                                           int64* last_sequence) = 0;
+
+  // Advances the last sequence of the change log by `num_changes`, and sets
+  // `last_sequence` to the advanced one. The change log should exist.
+  // Returns DATA_LOSS error, if the change log cannot be parsed.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual tensorflow::Status AdvanceChangeLog(int64 num_changes,
+                                              int64* last_sequence) = 0;
 
   // Resolves the schema version stored in the metadata source. The `db_version`
   // is set to 0, if it is a 0.13.2 release pre-existing database.
@@ -17,6 +17,8 @@ limitations under the License.
 #include <memory>
 
 #include "absl/memory/memory.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_access_object.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
 #include "ml_metadata/metadata_store/query_config_executor.h"
 #include "ml_metadata/metadata_store/rdbms_metadata_access_object.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -37,11 +39,31 @@ tensorflow::Status CreateRDBMSMetadataAccessObject(
     TF_RETURN_IF_ERROR(metadata_source->Connect());
   std::unique_ptr<QueryExecutor> executor =
       absl::WrapUnique(new QueryConfigExecutor(query_config, metadata_source));
-  *result =
-      absl::WrapUnique(new RDBMSMetadataAccessObject(std::move(executor)));
+  *result = absl::WrapUnique(new RDBMSMetadataAccessObject(
+      std::move(executor), query_config.pack_properties()));
   return tensorflow::Status::OK();
 }
 
+// Creates an InMemoryMetadataAccessObject on an InMemoryMetadataSource. The
+// query config only gives the library schema version.
+// Returns INVALID_ARGUMENT error, if the source is not an
+// InMemoryMetadataSource.
+tensorflow::Status CreateInMemoryMetadataAccessObject(
+    const MetadataSourceQueryConfig& query_config,
+    MetadataSource* const metadata_source,
+    std::unique_ptr<MetadataAccessObject>* result) {
+  InMemoryMetadataSource* const in_memory_source =
+      dynamic_cast<InMemoryMetadataSource*>(metadata_source);
+  if (in_memory_source == nullptr) {
+    return tensorflow::errors::InvalidArgument(
+        "FAKE_METADATA_SOURCE requires an InMemoryMetadataSource.");
+  }
+  if (!in_memory_source->is_connected())
+    TF_RETURN_IF_ERROR(in_memory_source->Connect());
+  *result = absl::make_unique<InMemoryMetadataAccessObject>(
+      in_memory_source, query_config.schema_version());
+  return tensorflow::Status::OK();
+}
 
 }  // namespace
 
@@ -53,6 +75,9 @@ tensorflow::Status CreateMetadataAccessObject(
     case UNKNOWN_METADATA_SOURCE:
       return tensorflow::errors::InvalidArgument(
           "Metadata source type is not specified.");
+    case FAKE_METADATA_SOURCE:
+      return CreateInMemoryMetadataAccessObject(query_config, metadata_source,
+                                                result);
     case MYSQL_METADATA_SOURCE:
       return CreateRDBMSMetadataAccessObject(query_config, metadata_source,
                                              result);
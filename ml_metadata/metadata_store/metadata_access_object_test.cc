@@ -14,11 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_access_object_test.h"
 
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "gflags/gflags.h"
 #include "google/protobuf/repeated_field.h"
 #include <gmock/gmock.h>
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
@@ -166,8 +172,30 @@ QueryConfigMetadataAccessObjectContainer::SetDatabaseVersionIncompatible() {
 namespace {
 
 using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
 using ::testing::UnorderedElementsAre;
 
+// Returns a filter with one predicate comparing `attribute` with an int value.
+NodeFilter IntAttributeFilter(const NodeFilter::Attribute attribute,
+                              const NodeFilter::Operator op,
+                              const int64 value) {
+  NodeFilter filter;
+  NodeFilter::Predicate* predicate = filter.add_predicates();
+  predicate->set_attribute(attribute);
+  predicate->set_op(op);
+  predicate->mutable_value()->set_int_value(value);
+  return filter;
+}
+
+// Returns the ids of the `nodes`.
+template <typename Node>
+std::vector<int64> IdsOf(const std::vector<Node>& nodes) {
+  std::vector<int64> ids;
+  for (const Node& node : nodes) ids.push_back(node.id());
+  return ids;
+}
+
 TEST_P(MetadataAccessObjectTest, InitMetadataSourceCheckSchemaVersion) {
   TF_ASSERT_OK(Init());
   int64 schema_version;
@@ -414,6 +442,59 @@ TEST_P(MetadataAccessObjectTest, UpdateTypeError) {
   }
 }
 
+TEST_P(MetadataAccessObjectTest, TypeWithIndexedProperties) {
+  TF_ASSERT_OK(Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'type1'
+    properties { key: 'p_int' value: INT }
+    properties { key: 'p_string' value: STRING }
+    properties { key: 'p_double' value: DOUBLE }
+    indexed_properties: 'p_string')");
+  int64 type_id = -1;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(type, &type_id));
+  type.set_id(type_id);
+  ArtifactType got_type;
+  TF_ASSERT_OK(metadata_access_object_->FindTypeById(type_id, &got_type));
+  EXPECT_THAT(got_type, EqualsProto(type));
+
+  // indexes more properties, the existing indexed properties are kept.
+  ArtifactType update_type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'type1'
+    properties { key: 'p_new' value: INT }
+    indexed_properties: 'p_new'
+    indexed_properties: 'p_double')");
+  TF_ASSERT_OK(metadata_access_object_->UpdateType(update_type));
+  TF_ASSERT_OK(metadata_access_object_->FindTypeByName("type1", &got_type));
+  EXPECT_THAT(got_type.indexed_properties(),
+              ElementsAre("p_double", "p_new", "p_string"));
+
+  // the nodes of the type can still be filtered by the indexed properties.
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  (*artifact.mutable_properties())["p_string"].set_string_value("foo");
+  int64 artifact_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+  NodeFilter filter = ParseTextProtoOrDie<NodeFilter>(R"(
+    predicates { property: 'p_string' op: EQ value { string_value: 'foo' } })");
+  std::vector<Artifact> got_artifacts;
+  TF_ASSERT_OK(
+      metadata_access_object_->FindArtifactsByFilter(filter, &got_artifacts));
+  ASSERT_EQ(got_artifacts.size(), 1);
+  EXPECT_EQ(got_artifacts[0].id(), artifact_id);
+
+  // indexed properties must be defined in the type.
+  ContextType bad_type = ParseTextProtoOrDie<ContextType>(R"(
+    name: 'type2'
+    properties { key: 'p_int' value: INT }
+    indexed_properties: 'p_unknown')");
+  int64 bad_type_id;
+  EXPECT_EQ(metadata_access_object_->CreateType(bad_type, &bad_type_id).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  update_type.add_indexed_properties("p_unknown");
+  EXPECT_EQ(metadata_access_object_->UpdateType(update_type).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
 TEST_P(MetadataAccessObjectTest, FindTypeById) {
   TF_ASSERT_OK(Init());
   ArtifactType want_type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -824,6 +905,82 @@ TEST_P(MetadataAccessObjectTest, CreateArtifactError) {
       tensorflow::error::INVALID_ARGUMENT);
 }
 
+TEST_P(MetadataAccessObjectTest, CreateArtifactsAndExecutions) {
+  TF_ASSERT_OK(Init());
+  int64 artifact_type_id, execution_type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>(R"(
+        name: 'artifact_type'
+        properties { key: 'p' value: STRING }
+      )"),
+      &artifact_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ExecutionType>(R"(
+        name: 'execution_type'
+        properties { key: 'p' value: DOUBLE }
+      )"),
+      &execution_type_id));
+  std::vector<Artifact> want_artifacts(3);
+  for (int i = 0; i < want_artifacts.size(); ++i) {
+    want_artifacts[i].set_type_id(artifact_type_id);
+    want_artifacts[i].set_uri(absl::StrCat("uri_", i));
+    (*want_artifacts[i].mutable_properties())["p"].set_string_value(
+        absl::StrCat("'quoted' ", i));
+    (*want_artifacts[i].mutable_custom_properties())["c"].set_int_value(i);
+  }
+  // an artifact without properties, and one with a name and a state.
+  want_artifacts[1].clear_properties();
+  want_artifacts[1].clear_custom_properties();
+  want_artifacts[2].set_name("artifact_2");
+  want_artifacts[2].set_state(Artifact::LIVE);
+  std::vector<Execution> want_executions(3);
+  for (int i = 0; i < want_executions.size(); ++i) {
+    want_executions[i].set_type_id(execution_type_id);
+    (*want_executions[i].mutable_properties())["p"].set_double_value(i + 0.5);
+  }
+  want_executions[2].set_name("execution_2");
+  want_executions[2].set_last_known_state(Execution::COMPLETE);
+
+  // the first execution is created alone, so that the ids of the batch do not
+  // start from the first id.
+  int64 first_execution_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateExecution(want_executions[0],
+                                                         &first_execution_id));
+  want_executions[0].set_id(first_execution_id);
+  std::vector<int64> artifact_ids, execution_ids;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateArtifacts(want_artifacts, &artifact_ids));
+  TF_ASSERT_OK(metadata_access_object_->CreateExecutions(
+      {want_executions[1], want_executions[2]}, &execution_ids));
+  ASSERT_EQ(artifact_ids.size(), want_artifacts.size());
+  ASSERT_EQ(execution_ids.size(), 2);
+  for (int i = 0; i < want_artifacts.size(); ++i) {
+    want_artifacts[i].set_id(artifact_ids[i]);
+  }
+  want_executions[1].set_id(execution_ids[0]);
+  want_executions[2].set_id(execution_ids[1]);
+
+  std::vector<Artifact> artifacts;
+  TF_ASSERT_OK(metadata_access_object_->FindArtifacts(&artifacts));
+  EXPECT_THAT(artifacts, ElementsAre(EqualsProto(want_artifacts[0]),
+                                     EqualsProto(want_artifacts[1]),
+                                     EqualsProto(want_artifacts[2])));
+  std::vector<Execution> executions;
+  TF_ASSERT_OK(metadata_access_object_->FindExecutions(&executions));
+  EXPECT_THAT(executions, ElementsAre(EqualsProto(want_executions[0]),
+                                      EqualsProto(want_executions[1]),
+                                      EqualsProto(want_executions[2])));
+
+  // a node that does not align with its type fails the batch.
+  std::vector<Artifact> invalid_artifacts = {want_artifacts[0]};
+  invalid_artifacts[0].clear_id();
+  (*invalid_artifacts[0].mutable_properties())["p"].set_int_value(1);
+  EXPECT_EQ(metadata_access_object_
+                ->CreateArtifacts(invalid_artifacts, &artifact_ids)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
 TEST_P(MetadataAccessObjectTest, FindArtifactById) {
   TF_ASSERT_OK(Init());
   ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -984,6 +1141,819 @@ TEST_P(MetadataAccessObjectTest, FindArtifactsByURI) {
   EXPECT_THAT(artifacts[0], EqualsProto(want_artifact1));
 }
 
+TEST_P(MetadataAccessObjectTest, FindNodesByTypeIdAndNames) {
+  TF_ASSERT_OK(Init());
+  int64 artifact_type_id, execution_type_id, context_type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+      &artifact_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+      &execution_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+      &context_type_id));
+  std::vector<Artifact> want_artifacts(3);
+  for (int i = 0; i < want_artifacts.size(); ++i) {
+    Artifact& artifact = want_artifacts[i];
+    artifact.set_type_id(artifact_type_id);
+    artifact.set_uri("uri");
+    // the last artifact is unnamed.
+    if (i < 2) artifact.set_name(absl::StrCat("artifact_", i));
+    int64 artifact_id;
+    TF_ASSERT_OK(
+        metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+    artifact.set_id(artifact_id);
+  }
+  Execution want_execution;
+  want_execution.set_type_id(execution_type_id);
+  want_execution.set_name("execution");
+  int64 execution_id;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateExecution(want_execution, &execution_id));
+  want_execution.set_id(execution_id);
+  std::vector<Context> want_contexts(2);
+  for (int i = 0; i < want_contexts.size(); ++i) {
+    want_contexts[i].set_type_id(context_type_id);
+    want_contexts[i].set_name(absl::StrCat("context_", i));
+    int64 context_id;
+    TF_ASSERT_OK(
+        metadata_access_object_->CreateContext(want_contexts[i], &context_id));
+    want_contexts[i].set_id(context_id);
+  }
+
+  // the names are resolved in the order of the ids, and the unknown or
+  // repeated names are skipped.
+  std::vector<Artifact> artifacts;
+  TF_EXPECT_OK(metadata_access_object_->FindArtifactsByTypeIdAndNames(
+      artifact_type_id, {"artifact_1", "unknown", "artifact_0", "artifact_1"},
+      &artifacts));
+  EXPECT_THAT(artifacts, ElementsAre(EqualsProto(want_artifacts[0]),
+                                     EqualsProto(want_artifacts[1])));
+  std::vector<Execution> executions;
+  TF_EXPECT_OK(metadata_access_object_->FindExecutionsByTypeIdAndNames(
+      execution_type_id, {"execution"}, &executions));
+  EXPECT_THAT(executions, ElementsAre(EqualsProto(want_execution)));
+  std::vector<Context> contexts;
+  TF_EXPECT_OK(metadata_access_object_->FindContextsByTypeIdAndNames(
+      context_type_id, {"context_1"}, &contexts));
+  EXPECT_THAT(contexts, ElementsAre(EqualsProto(want_contexts[1])));
+
+  // a name is unique within a type only.
+  Artifact duplicate = want_artifacts[0];
+  duplicate.clear_id();
+  int64 duplicate_id;
+  EXPECT_FALSE(
+      metadata_access_object_->CreateArtifact(duplicate, &duplicate_id).ok());
+  executions.clear();
+  EXPECT_EQ(metadata_access_object_
+                ->FindExecutionsByTypeIdAndNames(artifact_type_id,
+                                                 {"execution"}, &executions)
+                .code(),
+            tensorflow::error::NOT_FOUND);
+  contexts.clear();
+  EXPECT_EQ(metadata_access_object_
+                ->FindContextsByTypeIdAndNames(context_type_id, {}, &contexts)
+                .code(),
+            tensorflow::error::NOT_FOUND);
+
+  // a renamed artifact is found by its new name only.
+  want_artifacts[1].set_name("renamed");
+  TF_ASSERT_OK(metadata_access_object_->UpdateArtifact(want_artifacts[1]));
+  artifacts.clear();
+  TF_EXPECT_OK(metadata_access_object_->FindArtifactsByTypeIdAndNames(
+      artifact_type_id, {"artifact_1", "renamed"}, &artifacts));
+  EXPECT_THAT(artifacts, ElementsAre(EqualsProto(want_artifacts[1])));
+}
+
+TEST_P(MetadataAccessObjectTest, FindArtifactsWithReadMask) {
+  TF_ASSERT_OK(Init());
+  const ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'p' value: INT }
+    properties { key: 'q' value: STRING }
+  )");
+  int64 type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(type, &type_id));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://testing/uri'
+    properties { key: 'p' value: { int_value: 1 } }
+    properties { key: 'q' value: { string_value: '2' } }
+    custom_properties { key: 'p' value: { double_value: 3.0 } }
+  )");
+  artifact.set_type_id(type_id);
+  int64 artifact_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+
+  const NodeReadMask uri_mask =
+      ParseTextProtoOrDie<NodeReadMask>("paths: 'id' paths: 'uri'");
+  Artifact got_artifact;
+  TF_ASSERT_OK(metadata_access_object_->FindArtifactById(
+      artifact_id, &got_artifact, &uri_mask));
+  Artifact want_artifact;
+  want_artifact.set_id(artifact_id);
+  want_artifact.set_uri("testuri://testing/uri");
+  EXPECT_THAT(got_artifact, EqualsProto(want_artifact));
+
+  const NodeReadMask property_mask =
+      ParseTextProtoOrDie<NodeReadMask>("paths: 'properties.p'");
+  std::vector<Artifact> artifacts;
+  TF_ASSERT_OK(metadata_access_object_->FindArtifactsByTypeId(
+      type_id, &artifacts, &property_mask));
+  ASSERT_EQ(artifacts.size(), 1);
+  EXPECT_THAT(artifacts[0], EqualsProto(ParseTextProtoOrDie<Artifact>(R"(
+                properties { key: 'p' value: { int_value: 1 } }
+              )")));
+
+  const NodeReadMask invalid_mask =
+      ParseTextProtoOrDie<NodeReadMask>("paths: 'unknown_field'");
+  artifacts.clear();
+  EXPECT_EQ(
+      metadata_access_object_->FindArtifacts(&artifacts, &invalid_mask).code(),
+      tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_P(MetadataAccessObjectTest, FindArtifactsByFilter) {
+  TF_ASSERT_OK(Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'model'
+    properties { key: 'accuracy' value: DOUBLE }
+    properties { key: 'span' value: INT }
+  )");
+  int64 type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(type, &type_id));
+  ArtifactType other_type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'dataset'
+    properties { key: 'span' value: INT }
+  )");
+  int64 other_type_id;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateType(other_type, &other_type_id));
+
+  std::vector<Artifact> want_artifacts = {
+      ParseTextProtoOrDie<Artifact>(R"(
+        uri: 'testuri://model/1'
+        properties { key: 'accuracy' value: { double_value: 0.8 } }
+        properties { key: 'span' value: { int_value: 1 } }
+      )"),
+      ParseTextProtoOrDie<Artifact>(R"(
+        uri: 'testuri://model/2'
+        properties { key: 'accuracy' value: { double_value: 0.95 } }
+        properties { key: 'span' value: { int_value: 2 } }
+        custom_properties { key: 'owner' value: { string_value: 'a' } }
+      )"),
+      ParseTextProtoOrDie<Artifact>(R"(
+        uri: 'testuri://dataset/2'
+        properties { key: 'span' value: { int_value: 2 } }
+      )")};
+  want_artifacts[0].set_type_id(type_id);
+  want_artifacts[1].set_type_id(type_id);
+  want_artifacts[2].set_type_id(other_type_id);
+  for (Artifact& artifact : want_artifacts) {
+    int64 artifact_id;
+    TF_ASSERT_OK(
+        metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+    artifact.set_id(artifact_id);
+  }
+
+  {
+    std::vector<Artifact> artifacts;
+    TF_EXPECT_OK(metadata_access_object_->FindArtifactsByFilter(
+        ParseTextProtoOrDie<NodeFilter>(R"(
+          predicates {
+            property: 'accuracy'
+            op: GT
+            value: { double_value: 0.9 }
+          }
+          predicates { attribute: TYPE op: EQ value: { string_value: 'model' } }
+        )"),
+        &artifacts));
+    EXPECT_THAT(artifacts, ElementsAre(EqualsProto(want_artifacts[1])));
+  }
+  {
+    std::vector<Artifact> artifacts;
+    TF_EXPECT_OK(metadata_access_object_->FindArtifactsByFilter(
+        ParseTextProtoOrDie<NodeFilter>(R"(
+          predicates { property: 'span' op: GE value: { int_value: 2 } }
+        )"),
+        &artifacts));
+    EXPECT_THAT(artifacts,
+                UnorderedElementsAre(EqualsProto(want_artifacts[1]),
+                                     EqualsProto(want_artifacts[2])));
+  }
+  {
+    std::vector<Artifact> artifacts;
+    TF_EXPECT_OK(metadata_access_object_->FindArtifactsByFilter(
+        ParseTextProtoOrDie<NodeFilter>(R"(
+          predicates { attribute: URI op: NE value: { string_value: 'x' } }
+        )"),
+        &artifacts));
+    EXPECT_EQ(artifacts.size(), 3);
+  }
+  {
+    // pages through the artifacts in the order of their ids.
+    NodeFilter filter = ParseTextProtoOrDie<NodeFilter>("limit: 2");
+    std::vector<Artifact> artifacts;
+    TF_EXPECT_OK(metadata_access_object_->FindArtifactsByFilter(filter,
+                                                                &artifacts));
+    EXPECT_THAT(artifacts, ElementsAre(EqualsProto(want_artifacts[0]),
+                                       EqualsProto(want_artifacts[1])));
+    NodeFilter::Predicate* predicate = filter.add_predicates();
+    predicate->set_attribute(NodeFilter::ID);
+    predicate->set_op(NodeFilter::GT);
+    predicate->mutable_value()->set_int_value(artifacts.back().id());
+    artifacts.clear();
+    TF_EXPECT_OK(metadata_access_object_->FindArtifactsByFilter(filter,
+                                                                &artifacts));
+    EXPECT_THAT(artifacts, ElementsAre(EqualsProto(want_artifacts[2])));
+  }
+  {
+    // a property stored as a custom property does not match, and vice versa.
+    std::vector<Artifact> artifacts;
+    TF_EXPECT_OK(metadata_access_object_->FindArtifactsByFilter(
+        ParseTextProtoOrDie<NodeFilter>(R"(
+          predicates {
+            custom_property: 'owner'
+            op: EQ
+            value: { string_value: 'a' }
+          }
+        )"),
+        &artifacts));
+    EXPECT_THAT(artifacts, ElementsAre(EqualsProto(want_artifacts[1])));
+    std::vector<Artifact> not_found_artifacts;
+    EXPECT_EQ(metadata_access_object_
+                  ->FindArtifactsByFilter(ParseTextProtoOrDie<NodeFilter>(R"(
+                    predicates {
+                      property: 'owner'
+                      op: EQ
+                      value: { string_value: 'a' }
+                    }
+                  )"),
+                                          &not_found_artifacts)
+                  .code(),
+              tensorflow::error::NOT_FOUND);
+  }
+}
+
+TEST_P(MetadataAccessObjectTest, FindNodesByAttributeFilter) {
+  TF_ASSERT_OK(Init());
+  int64 artifact_type_id, execution_type_id, context_type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+      &artifact_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+      &execution_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+      &context_type_id));
+
+  // The first nodes are created before the watermark, the second ones after.
+  std::vector<Artifact> artifacts(2);
+  std::vector<Execution> executions(2);
+  std::vector<Context> contexts(2);
+  int64 watermark = 0;
+  for (int i = 0; i < 2; i++) {
+    if (i == 1) {
+      absl::SleepFor(absl::Milliseconds(2));
+      watermark = absl::ToUnixMillis(absl::Now());
+      absl::SleepFor(absl::Milliseconds(2));
+    }
+    artifacts[i].set_type_id(artifact_type_id);
+    artifacts[i].set_name(absl::StrCat("artifact_", i));
+    artifacts[i].set_state(i == 0 ? Artifact::LIVE : Artifact::DELETED);
+    int64 id;
+    TF_ASSERT_OK(metadata_access_object_->CreateArtifact(artifacts[i], &id));
+    artifacts[i].set_id(id);
+    executions[i].set_type_id(execution_type_id);
+    executions[i].set_name(absl::StrCat("execution_", i));
+    executions[i].set_last_known_state(i == 0 ? Execution::COMPLETE
+                                              : Execution::RUNNING);
+    TF_ASSERT_OK(
+        metadata_access_object_->CreateExecution(executions[i], &id));
+    executions[i].set_id(id);
+    contexts[i].set_type_id(context_type_id);
+    contexts[i].set_name(absl::StrCat("context_", i));
+    TF_ASSERT_OK(metadata_access_object_->CreateContext(contexts[i], &id));
+    contexts[i].set_id(id);
+  }
+
+  std::vector<Artifact> got_artifacts;
+  TF_ASSERT_OK(metadata_access_object_->FindArtifactsByFilter(
+      ParseTextProtoOrDie<NodeFilter>(R"(
+        predicates {
+          attribute: NAME
+          op: EQ
+          value { string_value: 'artifact_1' }
+        }
+      )"),
+      &got_artifacts));
+  EXPECT_THAT(IdsOf(got_artifacts), ElementsAre(artifacts[1].id()));
+  got_artifacts.clear();
+  TF_ASSERT_OK(metadata_access_object_->FindArtifactsByFilter(
+      IntAttributeFilter(NodeFilter::STATE, NodeFilter::EQ, Artifact::LIVE),
+      &got_artifacts));
+  EXPECT_THAT(IdsOf(got_artifacts), ElementsAre(artifacts[0].id()));
+  got_artifacts.clear();
+  TF_ASSERT_OK(metadata_access_object_->FindArtifactsByFilter(
+      IntAttributeFilter(NodeFilter::CREATE_TIME_SINCE_EPOCH, NodeFilter::GE,
+                         watermark),
+      &got_artifacts));
+  EXPECT_THAT(IdsOf(got_artifacts), ElementsAre(artifacts[1].id()));
+
+  std::vector<Execution> got_executions;
+  TF_ASSERT_OK(metadata_access_object_->FindExecutionsByFilter(
+      ParseTextProtoOrDie<NodeFilter>(R"(
+        predicates {
+          attribute: NAME
+          op: EQ
+          value { string_value: 'execution_0' }
+        }
+      )"),
+      &got_executions));
+  EXPECT_THAT(IdsOf(got_executions), ElementsAre(executions[0].id()));
+  got_executions.clear();
+  TF_ASSERT_OK(metadata_access_object_->FindExecutionsByFilter(
+      IntAttributeFilter(NodeFilter::STATE, NodeFilter::EQ,
+                         Execution::RUNNING),
+      &got_executions));
+  EXPECT_THAT(IdsOf(got_executions), ElementsAre(executions[1].id()));
+  got_executions.clear();
+  TF_ASSERT_OK(metadata_access_object_->FindExecutionsByFilter(
+      IntAttributeFilter(NodeFilter::CREATE_TIME_SINCE_EPOCH, NodeFilter::LT,
+                         watermark),
+      &got_executions));
+  EXPECT_THAT(IdsOf(got_executions), ElementsAre(executions[0].id()));
+
+  std::vector<Context> got_contexts;
+  TF_ASSERT_OK(metadata_access_object_->FindContextsByFilter(
+      ParseTextProtoOrDie<NodeFilter>(R"(
+        predicates {
+          attribute: NAME
+          op: EQ
+          value { string_value: 'context_1' }
+        }
+      )"),
+      &got_contexts));
+  EXPECT_THAT(IdsOf(got_contexts), ElementsAre(contexts[1].id()));
+  got_contexts.clear();
+  TF_ASSERT_OK(metadata_access_object_->FindContextsByFilter(
+      IntAttributeFilter(NodeFilter::CREATE_TIME_SINCE_EPOCH, NodeFilter::LT,
+                         watermark),
+      &got_contexts));
+  EXPECT_THAT(IdsOf(got_contexts), ElementsAre(contexts[0].id()));
+
+  // An update moves the last update time of the node past the watermark, but
+  // not its create time.
+  artifacts[0].set_state(Artifact::MARKED_FOR_DELETION);
+  TF_ASSERT_OK(metadata_access_object_->UpdateArtifact(artifacts[0]));
+  executions[0].set_last_known_state(Execution::FAILED);
+  TF_ASSERT_OK(metadata_access_object_->UpdateExecution(executions[0]));
+  got_artifacts.clear();
+  TF_ASSERT_OK(metadata_access_object_->FindArtifactsByFilter(
+      IntAttributeFilter(NodeFilter::LAST_UPDATE_TIME_SINCE_EPOCH,
+                         NodeFilter::GE, watermark),
+      &got_artifacts));
+  EXPECT_THAT(IdsOf(got_artifacts),
+              UnorderedElementsAre(artifacts[0].id(), artifacts[1].id()));
+  got_executions.clear();
+  TF_ASSERT_OK(metadata_access_object_->FindExecutionsByFilter(
+      IntAttributeFilter(NodeFilter::LAST_UPDATE_TIME_SINCE_EPOCH,
+                         NodeFilter::GE, watermark),
+      &got_executions));
+  EXPECT_THAT(IdsOf(got_executions),
+              UnorderedElementsAre(executions[0].id(), executions[1].id()));
+  got_executions.clear();
+  TF_ASSERT_OK(metadata_access_object_->FindExecutionsByFilter(
+      IntAttributeFilter(NodeFilter::STATE, NodeFilter::EQ, Execution::FAILED),
+      &got_executions));
+  EXPECT_THAT(IdsOf(got_executions), ElementsAre(executions[0].id()));
+}
+
+TEST_P(MetadataAccessObjectTest, FindArtifactsUpdatedSince) {
+  TF_ASSERT_OK(Init());
+  const ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'type'
+    properties { key: 'p' value: INT }
+  )");
+  int64 type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(type, &type_id));
+  std::vector<Artifact> want_artifacts(3);
+  for (Artifact& artifact : want_artifacts) {
+    artifact.set_type_id(type_id);
+    artifact.set_uri("uri");
+    int64 artifact_id;
+    TF_ASSERT_OK(
+        metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+    artifact.set_id(artifact_id);
+  }
+  absl::SleepFor(absl::Milliseconds(2));
+  const int64 watermark = absl::ToUnixMillis(absl::Now());
+
+  // An update of the properties only also counts as an update of the node.
+  for (const int i : {0, 2}) {
+    (*want_artifacts[i].mutable_properties())["p"].set_int_value(i);
+    TF_ASSERT_OK(metadata_access_object_->UpdateArtifact(want_artifacts[i]));
+  }
+
+  // pages through the artifacts updated since the watermark.
+  NodeFilter filter = ParseTextProtoOrDie<NodeFilter>("limit: 1");
+  NodeFilter::Predicate* updated_since = filter.add_predicates();
+  updated_since->set_attribute(NodeFilter::LAST_UPDATE_TIME_SINCE_EPOCH);
+  updated_since->set_op(NodeFilter::GE);
+  updated_since->mutable_value()->set_int_value(watermark);
+  std::vector<Artifact> artifacts;
+  TF_EXPECT_OK(
+      metadata_access_object_->FindArtifactsByFilter(filter, &artifacts));
+  EXPECT_THAT(artifacts, ElementsAre(EqualsProto(want_artifacts[0])));
+  NodeFilter::Predicate* after_id = filter.add_predicates();
+  after_id->set_attribute(NodeFilter::ID);
+  after_id->set_op(NodeFilter::GT);
+  after_id->mutable_value()->set_int_value(artifacts.back().id());
+  artifacts.clear();
+  TF_EXPECT_OK(
+      metadata_access_object_->FindArtifactsByFilter(filter, &artifacts));
+  EXPECT_THAT(artifacts, ElementsAre(EqualsProto(want_artifacts[2])));
+  after_id->mutable_value()->set_int_value(artifacts.back().id());
+  artifacts.clear();
+  EXPECT_EQ(
+      metadata_access_object_->FindArtifactsByFilter(filter, &artifacts).code(),
+      tensorflow::error::NOT_FOUND);
+}
+
+TEST_P(MetadataAccessObjectTest, FindNodesByFilterError) {
+  TF_ASSERT_OK(Init());
+  std::vector<Artifact> artifacts;
+  // no operator
+  EXPECT_EQ(metadata_access_object_
+                ->FindArtifactsByFilter(ParseTextProtoOrDie<NodeFilter>(R"(
+                  predicates { property: 'p' value: { int_value: 1 } }
+                )"),
+                                        &artifacts)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  // no value
+  EXPECT_EQ(metadata_access_object_
+                ->FindArtifactsByFilter(ParseTextProtoOrDie<NodeFilter>(R"(
+                  predicates { property: 'p' op: EQ }
+                )"),
+                                        &artifacts)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  // mismatched value type of an attribute
+  EXPECT_EQ(metadata_access_object_
+                ->FindArtifactsByFilter(ParseTextProtoOrDie<NodeFilter>(R"(
+                  predicates {
+                    attribute: TYPE_ID
+                    op: EQ
+                    value: { string_value: '1' }
+                  }
+                )"),
+                                        &artifacts)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  // executions have no uri
+  std::vector<Execution> executions;
+  EXPECT_EQ(metadata_access_object_
+                ->FindExecutionsByFilter(ParseTextProtoOrDie<NodeFilter>(R"(
+                  predicates {
+                    attribute: URI
+                    op: EQ
+                    value: { string_value: 'a' }
+                  }
+                )"),
+                                         &executions)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  // contexts have no state
+  std::vector<Context> contexts;
+  EXPECT_EQ(metadata_access_object_
+                ->FindContextsByFilter(ParseTextProtoOrDie<NodeFilter>(R"(
+                  predicates { attribute: STATE op: EQ value: { int_value: 1 } }
+                )"),
+                                       &contexts)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_P(MetadataAccessObjectTest, CountNodes) {
+  TF_ASSERT_OK(Init());
+  int64 type1_id, type2_id, context_type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'type1'"), &type1_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'type2'"), &type2_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+      &context_type_id));
+  std::vector<int64> artifact_ids(3);
+  for (int i = 0; i < artifact_ids.size(); i++) {
+    Artifact artifact;
+    artifact.set_type_id(i < 2 ? type1_id : type2_id);
+    TF_ASSERT_OK(
+        metadata_access_object_->CreateArtifact(artifact, &artifact_ids[i]));
+  }
+  Context context;
+  context.set_type_id(context_type_id);
+  context.set_name("context");
+  int64 context_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateContext(context, &context_id));
+  for (const int64 artifact_id : {artifact_ids[0], artifact_ids[2]}) {
+    Attribution attribution;
+    attribution.set_artifact_id(artifact_id);
+    attribution.set_context_id(context_id);
+    int64 attribution_id;
+    TF_ASSERT_OK(metadata_access_object_->CreateAttribution(attribution,
+                                                            &attribution_id));
+  }
+
+  std::vector<NodeCount> counts;
+  TF_ASSERT_OK(
+      metadata_access_object_->CountArtifacts(NodeFilter(), {}, &counts));
+  EXPECT_THAT(counts, ElementsAre(EqualsProto(
+                          ParseTextProtoOrDie<NodeCount>("count: 3"))));
+
+  NodeCount want_type1_count;
+  want_type1_count.set_type_id(type1_id);
+  want_type1_count.set_count(2);
+  NodeCount want_type2_count;
+  want_type2_count.set_type_id(type2_id);
+  want_type2_count.set_count(1);
+  counts.clear();
+  TF_ASSERT_OK(metadata_access_object_->CountArtifacts(
+      NodeFilter(), {NodeCount::TYPE_ID}, &counts));
+  EXPECT_THAT(counts, UnorderedElementsAre(EqualsProto(want_type1_count),
+                                           EqualsProto(want_type2_count)));
+
+  // The artifacts in the context, by type.
+  NodeFilter filter = ParseTextProtoOrDie<NodeFilter>(
+      "predicates { attribute: CONTEXT_ID op: EQ }");
+  filter.mutable_predicates(0)->mutable_value()->set_int_value(context_id);
+  want_type1_count.set_count(1);
+  counts.clear();
+  TF_ASSERT_OK(metadata_access_object_->CountArtifacts(
+      filter, {NodeCount::TYPE_ID}, &counts));
+  EXPECT_THAT(counts, UnorderedElementsAre(EqualsProto(want_type1_count),
+                                           EqualsProto(want_type2_count)));
+  std::vector<Artifact> artifacts;
+  TF_ASSERT_OK(metadata_access_object_->FindArtifactsByFilter(filter,
+                                                              &artifacts));
+  ASSERT_EQ(artifacts.size(), 2);
+  EXPECT_EQ(artifacts[0].id(), artifact_ids[0]);
+  EXPECT_EQ(artifacts[1].id(), artifact_ids[2]);
+
+  // The artifacts without contexts are not counted, and the unset states are
+  // grouped together.
+  NodeCount want_context_count;
+  want_context_count.set_context_id(context_id);
+  want_context_count.set_count(2);
+  counts.clear();
+  TF_ASSERT_OK(metadata_access_object_->CountArtifacts(
+      NodeFilter(), {NodeCount::CONTEXT_ID, NodeCount::STATE}, &counts));
+  EXPECT_THAT(counts, ElementsAre(EqualsProto(want_context_count)));
+
+  counts.clear();
+  EXPECT_EQ(metadata_access_object_
+                ->CountContexts(NodeFilter(), {NodeCount::STATE}, &counts)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  EXPECT_EQ(metadata_access_object_
+                ->CountArtifacts(NodeFilter(),
+                                 {NodeCount::TYPE_ID, NodeCount::TYPE_ID},
+                                 &counts)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  EXPECT_EQ(metadata_access_object_
+                ->CountArtifacts(ParseTextProtoOrDie<NodeFilter>("limit: 1"),
+                                 {}, &counts)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  filter.mutable_predicates(0)->set_op(NodeFilter::NE);
+  EXPECT_EQ(
+      metadata_access_object_->FindArtifactsByFilter(filter, &artifacts).code(),
+      tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_P(MetadataAccessObjectTest, CountNodesByState) {
+  TF_ASSERT_OK(Init());
+  int64 type1_id, type2_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ExecutionType>("name: 'type1'"), &type1_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ExecutionType>("name: 'type2'"), &type2_id));
+  const std::vector<std::pair<int64, Execution::State>> executions = {
+      {type1_id, Execution::RUNNING},  {type1_id, Execution::RUNNING},
+      {type1_id, Execution::COMPLETE}, {type2_id, Execution::RUNNING},
+      {type2_id, Execution::UNKNOWN}};
+  for (const auto& type_and_state : executions) {
+    Execution execution;
+    execution.set_type_id(type_and_state.first);
+    if (type_and_state.second != Execution::UNKNOWN) {
+      execution.set_last_known_state(type_and_state.second);
+    }
+    int64 execution_id;
+    TF_ASSERT_OK(
+        metadata_access_object_->CreateExecution(execution, &execution_id));
+  }
+
+  // The executions without a state are grouped together.
+  std::vector<NodeCount> counts;
+  TF_ASSERT_OK(metadata_access_object_->CountExecutions(
+      NodeFilter(), {NodeCount::STATE}, &counts));
+  EXPECT_THAT(counts, UnorderedElementsAre(
+                          EqualsProto(ParseTextProtoOrDie<NodeCount>(
+                              "state: 2 count: 3")),
+                          EqualsProto(ParseTextProtoOrDie<NodeCount>(
+                              "state: 3 count: 1")),
+                          EqualsProto(ParseTextProtoOrDie<NodeCount>(
+                              "count: 1"))));
+
+  NodeCount want_type1_running_count;
+  want_type1_running_count.set_type_id(type1_id);
+  want_type1_running_count.set_state(Execution::RUNNING);
+  want_type1_running_count.set_count(2);
+  NodeCount want_type1_complete_count;
+  want_type1_complete_count.set_type_id(type1_id);
+  want_type1_complete_count.set_state(Execution::COMPLETE);
+  want_type1_complete_count.set_count(1);
+  NodeCount want_type2_running_count;
+  want_type2_running_count.set_type_id(type2_id);
+  want_type2_running_count.set_state(Execution::RUNNING);
+  want_type2_running_count.set_count(1);
+  NodeCount want_type2_unknown_count;
+  want_type2_unknown_count.set_type_id(type2_id);
+  want_type2_unknown_count.set_count(1);
+  counts.clear();
+  TF_ASSERT_OK(metadata_access_object_->CountExecutions(
+      NodeFilter(), {NodeCount::TYPE_ID, NodeCount::STATE}, &counts));
+  EXPECT_THAT(counts,
+              UnorderedElementsAre(EqualsProto(want_type1_running_count),
+                                   EqualsProto(want_type1_complete_count),
+                                   EqualsProto(want_type2_running_count),
+                                   EqualsProto(want_type2_unknown_count)));
+
+  // The running executions, by type.
+  want_type1_running_count.clear_state();
+  want_type2_running_count.clear_state();
+  counts.clear();
+  TF_ASSERT_OK(metadata_access_object_->CountExecutions(
+      ParseTextProtoOrDie<NodeFilter>(
+          "predicates { attribute: STATE op: EQ value { int_value: 2 } }"),
+      {NodeCount::TYPE_ID}, &counts));
+  EXPECT_THAT(counts,
+              UnorderedElementsAre(EqualsProto(want_type1_running_count),
+                                   EqualsProto(want_type2_running_count)));
+}
+
+TEST_P(MetadataAccessObjectTest, InitAndAdvanceChangeLog) {
+  TF_ASSERT_OK(Init());
+  int64 log_id, last_sequence;
+  TF_ASSERT_OK(metadata_access_object_->InitChangeLog(
+      /*new_log_id=*/7, &log_id, &last_sequence));
+  EXPECT_EQ(log_id, 7);
+  EXPECT_EQ(last_sequence, 0);
+  TF_ASSERT_OK(metadata_access_object_->AdvanceChangeLog(
+      /*num_changes=*/3, &last_sequence));
+  EXPECT_EQ(last_sequence, 3);
+  TF_ASSERT_OK(metadata_access_object_->AdvanceChangeLog(
+      /*num_changes=*/2, &last_sequence));
+  EXPECT_EQ(last_sequence, 5);
+  // The existing change log is kept.
+  TF_ASSERT_OK(metadata_access_object_->InitChangeLog(
+      /*new_log_id=*/8, &log_id, &last_sequence));
+  EXPECT_EQ(log_id, 7);
+  EXPECT_EQ(last_sequence, 5);
+}
+
+TEST_P(MetadataAccessObjectTest, DeleteNodes) {
+  TF_ASSERT_OK(Init());
+  int64 artifact_type_id, execution_type_id, context_type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>(
+          "name: 'artifact_type' properties { key: 'p' value: INT }"),
+      &artifact_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+      &execution_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+      &context_type_id));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    properties { key: 'p' value: { int_value: 1 } }
+    custom_properties { key: 'q' value: { string_value: '2' } }
+  )");
+  artifact.set_type_id(artifact_type_id);
+  int64 artifact1_id, artifact2_id;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateArtifact(artifact, &artifact1_id));
+  artifact.clear_properties();
+  artifact.clear_custom_properties();
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateArtifact(artifact, &artifact2_id));
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateExecution(execution, &execution_id));
+  Context context;
+  context.set_type_id(context_type_id);
+  context.set_name("context");
+  int64 context_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateContext(context, &context_id));
+  Event event = ParseTextProtoOrDie<Event>(R"(
+    type: INPUT
+    path { steps { index: 1 } steps { key: 'k' } }
+  )");
+  event.set_artifact_id(artifact1_id);
+  event.set_execution_id(execution_id);
+  int64 event_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateEvent(event, &event_id));
+  event.clear_path();
+  event.set_artifact_id(artifact2_id);
+  TF_ASSERT_OK(metadata_access_object_->CreateEvent(event, &event_id));
+  for (const int64 artifact_id : {artifact1_id, artifact2_id}) {
+    Attribution attribution;
+    attribution.set_artifact_id(artifact_id);
+    attribution.set_context_id(context_id);
+    int64 attribution_id;
+    TF_ASSERT_OK(metadata_access_object_->CreateAttribution(attribution,
+                                                            &attribution_id));
+  }
+  Association association;
+  association.set_execution_id(execution_id);
+  association.set_context_id(context_id);
+  int64 association_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateAssociation(association,
+                                                          &association_id));
+
+  // A dry run only counts the rows. Duplicated and unknown ids are ignored.
+  const std::vector<int64> artifact_ids = {artifact1_id, artifact1_id,
+                                           artifact2_id + 100};
+  const std::map<std::string, int64> want_artifact_rows = {
+      {"Artifact", 1}, {"ArtifactProperty", 2}, {"Event", 1},
+      {"EventPath", 2}, {"Attribution", 1}};
+  std::map<std::string, int64> num_deleted_rows;
+  TF_ASSERT_OK(metadata_access_object_->DeleteArtifacts(
+      artifact_ids, /*dry_run=*/true, &num_deleted_rows));
+  EXPECT_EQ(num_deleted_rows, want_artifact_rows);
+  Artifact found_artifact;
+  TF_EXPECT_OK(
+      metadata_access_object_->FindArtifactById(artifact1_id, &found_artifact));
+
+  num_deleted_rows.clear();
+  TF_ASSERT_OK(metadata_access_object_->DeleteArtifacts(
+      artifact_ids, /*dry_run=*/false, &num_deleted_rows));
+  EXPECT_EQ(num_deleted_rows, want_artifact_rows);
+  EXPECT_EQ(
+      metadata_access_object_->FindArtifactById(artifact1_id, &found_artifact)
+          .code(),
+      tensorflow::error::NOT_FOUND);
+  std::vector<Event> events;
+  TF_ASSERT_OK(
+      metadata_access_object_->FindEventsByExecution(execution_id, &events));
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].artifact_id(), artifact2_id);
+  std::vector<Artifact> artifacts;
+  TF_ASSERT_OK(
+      metadata_access_object_->FindArtifactsByContext(context_id, &artifacts));
+  ASSERT_EQ(artifacts.size(), 1);
+  EXPECT_EQ(artifacts[0].id(), artifact2_id);
+
+  // The nodes in a deleted context are kept.
+  num_deleted_rows.clear();
+  TF_ASSERT_OK(metadata_access_object_->DeleteContexts(
+      {context_id}, /*dry_run=*/false, &num_deleted_rows));
+  const std::map<std::string, int64> want_context_rows = {
+      {"Context", 1}, {"ContextProperty", 0}, {"Attribution", 1},
+      {"Association", 1}};
+  EXPECT_EQ(num_deleted_rows, want_context_rows);
+  std::vector<Context> contexts;
+  TF_ASSERT_OK(metadata_access_object_->FindContextsByArtifact(artifact2_id,
+                                                               &contexts));
+  EXPECT_THAT(contexts, ElementsAre());
+  Context found_context;
+  EXPECT_EQ(metadata_access_object_
+                ->FindContextByTypeIdAndName(context_type_id, "context",
+                                             &found_context)
+                .code(),
+            tensorflow::error::NOT_FOUND);
+
+  num_deleted_rows.clear();
+  TF_ASSERT_OK(metadata_access_object_->DeleteExecutions(
+      {execution_id}, /*dry_run=*/false, &num_deleted_rows));
+  const std::map<std::string, int64> want_execution_rows = {
+      {"Execution", 1}, {"ExecutionProperty", 0}, {"Event", 1},
+      {"EventPath", 0}, {"Association", 0}};
+  EXPECT_EQ(num_deleted_rows, want_execution_rows);
+  events.clear();
+  EXPECT_EQ(
+      metadata_access_object_->FindEventsByArtifact(artifact2_id, &events)
+          .code(),
+      tensorflow::error::NOT_FOUND);
+  TF_EXPECT_OK(
+      metadata_access_object_->FindArtifactById(artifact2_id, &found_artifact));
+}
+
 TEST_P(MetadataAccessObjectTest, UpdateArtifact) {
   TF_ASSERT_OK(Init());
   ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -1042,6 +2012,42 @@ TEST_P(MetadataAccessObjectTest, UpdateArtifact) {
   EXPECT_THAT(artifact, EqualsProto(want_artifact));
 }
 
+TEST_P(MetadataAccessObjectTest, UpdateArtifactState) {
+  TF_ASSERT_OK(Init());
+  int64 type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'test_type'"), &type_id));
+  Artifact want_artifact;
+  want_artifact.set_type_id(type_id);
+  want_artifact.set_uri("testuri://testing/uri");
+  want_artifact.set_state(Artifact::LIVE);
+  int64 artifact_id;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateArtifact(want_artifact, &artifact_id));
+  want_artifact.set_id(artifact_id);
+  want_artifact.set_state(Artifact::DELETED);
+  TF_ASSERT_OK(metadata_access_object_->UpdateArtifact(want_artifact));
+
+  Artifact artifact;
+  TF_EXPECT_OK(
+      metadata_access_object_->FindArtifactById(artifact_id, &artifact));
+  EXPECT_THAT(artifact, EqualsProto(want_artifact));
+  // The state and the recorded update time can be filtered on.
+  std::vector<Artifact> artifacts;
+  TF_EXPECT_OK(metadata_access_object_->FindArtifactsByFilter(
+      ParseTextProtoOrDie<NodeFilter>(R"(
+        predicates { attribute: STATE op: EQ value: { int_value: 4 } }
+        predicates {
+          attribute: LAST_UPDATE_TIME_SINCE_EPOCH
+          op: GT
+          value: { int_value: 0 }
+        }
+      )"),
+      &artifacts));
+  ASSERT_EQ(artifacts.size(), 1);
+  EXPECT_EQ(artifacts[0].id(), artifact_id);
+}
+
 TEST_P(MetadataAccessObjectTest, UpdateArtifactError) {
   TF_ASSERT_OK(Init());
   ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -1552,6 +2558,80 @@ TEST_P(MetadataAccessObjectTest, CreateAndUseAttribution) {
   EXPECT_EQ(got_executions.size(), 0);
 }
 
+TEST_P(MetadataAccessObjectTest, CreateContextEdgesIfNotExist) {
+  TF_ASSERT_OK(Init());
+  int64 artifact_type_id, execution_type_id, context_type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+      &artifact_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+      &execution_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+      &context_type_id));
+  std::vector<Artifact> artifacts(2);
+  for (Artifact& artifact : artifacts) artifact.set_type_id(artifact_type_id);
+  std::vector<int64> artifact_ids;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateArtifacts(artifacts, &artifact_ids));
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateExecution(execution, &execution_id));
+  Context context;
+  context.set_type_id(context_type_id);
+  context.set_name("context");
+  int64 context_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateContext(context, &context_id));
+
+  // an existing attribution and a repeated one are not created again.
+  Attribution attribution;
+  attribution.set_context_id(context_id);
+  attribution.set_artifact_id(artifact_ids[0]);
+  int64 attribution_id;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateAttribution(attribution, &attribution_id));
+  std::vector<Attribution> attributions(3, attribution);
+  attributions[1].set_artifact_id(artifact_ids[1]);
+  attributions[2].set_artifact_id(artifact_ids[1]);
+  std::vector<Attribution> created_attributions;
+  TF_ASSERT_OK(metadata_access_object_->CreateAttributionsIfNotExist(
+      attributions, &created_attributions));
+  EXPECT_THAT(created_attributions, ElementsAre(EqualsProto(attributions[1])));
+  std::vector<Artifact> got_artifacts;
+  TF_ASSERT_OK(metadata_access_object_->FindArtifactsByContext(context_id,
+                                                               &got_artifacts));
+  EXPECT_EQ(got_artifacts.size(), 2);
+
+  Association association;
+  association.set_context_id(context_id);
+  association.set_execution_id(execution_id);
+  std::vector<Association> created_associations;
+  TF_ASSERT_OK(metadata_access_object_->CreateAssociationsIfNotExist(
+      {association, association}, &created_associations));
+  EXPECT_THAT(created_associations, ElementsAre(EqualsProto(association)));
+  created_associations.clear();
+  TF_ASSERT_OK(metadata_access_object_->CreateAssociationsIfNotExist(
+      {association}, &created_associations));
+  EXPECT_THAT(created_associations, IsEmpty());
+
+  // the contexts and the nodes must exist.
+  association.set_execution_id(execution_id + 1);
+  EXPECT_EQ(metadata_access_object_
+                ->CreateAssociationsIfNotExist({association},
+                                               &created_associations)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  attribution.set_context_id(context_id + 1);
+  EXPECT_EQ(metadata_access_object_
+                ->CreateAttributionsIfNotExist({attribution},
+                                               &created_attributions)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
 // TODO(huimiao) Refactoring the test by setting up the types in utility methods
 TEST_P(MetadataAccessObjectTest, CreateAndFindEvent) {
   TF_ASSERT_OK(Init());
@@ -1623,6 +2703,15 @@ TEST_P(MetadataAccessObjectTest, CreateAndFindEvent) {
   TF_EXPECT_OK(metadata_access_object_->FindEventsByExecution(
       execution_id, &events_with_execution));
   EXPECT_EQ(events_with_execution.size(), 2);
+
+  // query the lineage edges without the event paths and times
+  std::vector<Event> event_edges;
+  TF_EXPECT_OK(metadata_access_object_->FindEventEdges(&event_edges));
+  event1.clear_path();
+  event1.clear_milliseconds_since_epoch();
+  event2.clear_milliseconds_since_epoch();
+  EXPECT_THAT(event_edges, UnorderedElementsAre(EqualsProto(event1),
+                                                EqualsProto(event2)));
 }
 
 TEST_P(MetadataAccessObjectTest, CreateEventError) {
@@ -1757,6 +2846,144 @@ TEST_P(MetadataAccessObjectTest, PutEventsWithPaths) {
   EXPECT_EQ(events_with_execution.size(), 2);
 }
 
+TEST_P(MetadataAccessObjectTest, CreateEventsWithPaths) {
+  TF_ASSERT_OK(Init());
+  int64 artifact_type_id, execution_type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+      &artifact_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+      &execution_type_id));
+  std::vector<Artifact> artifacts(2);
+  for (Artifact& artifact : artifacts) artifact.set_type_id(artifact_type_id);
+  std::vector<int64> artifact_ids;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateArtifacts(artifacts, &artifact_ids));
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateExecution(execution, &execution_id));
+
+  // the events created in bulk are mixed with the ones created one by one.
+  Event event = ParseTextProtoOrDie<Event>(R"(
+    type: INPUT
+    milliseconds_since_epoch: 1
+    path { steps { index: 1 } }
+  )");
+  event.set_artifact_id(artifact_ids[0]);
+  event.set_execution_id(execution_id);
+  int64 event_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateEvent(event, &event_id));
+  std::vector<Event> want_events = {event, event, event};
+  want_events[1].set_milliseconds_since_epoch(2);
+  want_events[1].mutable_path()->add_steps()->set_key("key");
+  want_events[2].set_artifact_id(artifact_ids[1]);
+  want_events[2].set_type(Event::OUTPUT);
+  want_events[2].set_milliseconds_since_epoch(3);
+  want_events[2].clear_path();
+  TF_ASSERT_OK(metadata_access_object_->CreateEvents(
+      {want_events[1], want_events[2]}));
+  want_events.push_back(event);
+  want_events[3].set_milliseconds_since_epoch(4);
+  want_events[3].mutable_path()->mutable_steps(0)->set_key("last");
+  TF_ASSERT_OK(metadata_access_object_->CreateEvent(want_events[3], &event_id));
+
+  std::vector<Event> events;
+  TF_ASSERT_OK(
+      metadata_access_object_->FindEventsByExecution(execution_id, &events));
+  EXPECT_THAT(events, UnorderedElementsAre(EqualsProto(want_events[0]),
+                                           EqualsProto(want_events[1]),
+                                           EqualsProto(want_events[2]),
+                                           EqualsProto(want_events[3])));
+
+  // the referenced nodes must exist.
+  Event unknown_artifact_event = event;
+  unknown_artifact_event.set_artifact_id(artifact_ids[1] + 1);
+  EXPECT_EQ(metadata_access_object_
+                ->CreateEvents({event, unknown_artifact_event})
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_P(MetadataAccessObjectTest, FindEdgesOfManyNodes) {
+  TF_ASSERT_OK(Init());
+  int64 artifact_type_id, execution_type_id, context_type_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+      &artifact_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+      &execution_type_id));
+  TF_ASSERT_OK(metadata_access_object_->CreateType(
+      ParseTextProtoOrDie<ContextType>("name: 'context_type'"),
+      &context_type_id));
+  std::vector<Artifact> artifacts(3);
+  for (Artifact& artifact : artifacts) artifact.set_type_id(artifact_type_id);
+  std::vector<int64> artifact_ids;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateArtifacts(artifacts, &artifact_ids));
+  std::vector<Execution> executions(3);
+  for (Execution& execution : executions) {
+    execution.set_type_id(execution_type_id);
+  }
+  std::vector<int64> execution_ids;
+  TF_ASSERT_OK(
+      metadata_access_object_->CreateExecutions(executions, &execution_ids));
+  Context context;
+  context.set_type_id(context_type_id);
+  context.set_name("context");
+  int64 context_id;
+  TF_ASSERT_OK(metadata_access_object_->CreateContext(context, &context_id));
+
+  // the last artifact and execution have no edges.
+  std::vector<Event> want_events(2);
+  std::vector<Attribution> want_attributions(2);
+  std::vector<Association> want_associations(2);
+  for (int i = 0; i < 2; i++) {
+    want_events[i].set_artifact_id(artifact_ids[i]);
+    want_events[i].set_execution_id(execution_ids[i]);
+    want_events[i].set_type(Event::INPUT);
+    want_events[i].set_milliseconds_since_epoch(i + 1);
+    want_events[i].mutable_path()->add_steps()->set_index(i);
+    want_attributions[i].set_artifact_id(artifact_ids[i]);
+    want_attributions[i].set_context_id(context_id);
+    want_associations[i].set_execution_id(execution_ids[i]);
+    want_associations[i].set_context_id(context_id);
+  }
+  TF_ASSERT_OK(metadata_access_object_->CreateEvents(want_events));
+  std::vector<Attribution> created_attributions;
+  TF_ASSERT_OK(metadata_access_object_->CreateAttributionsIfNotExist(
+      want_attributions, &created_attributions));
+  std::vector<Association> created_associations;
+  TF_ASSERT_OK(metadata_access_object_->CreateAssociationsIfNotExist(
+      want_associations, &created_associations));
+
+  std::vector<Event> events;
+  TF_ASSERT_OK(
+      metadata_access_object_->FindEventsByExecutions(execution_ids, &events));
+  EXPECT_THAT(events, UnorderedElementsAre(EqualsProto(want_events[0]),
+                                           EqualsProto(want_events[1])));
+  std::vector<Attribution> attributions;
+  TF_ASSERT_OK(metadata_access_object_->FindAttributionsByArtifacts(
+      artifact_ids, &attributions));
+  EXPECT_THAT(attributions,
+              UnorderedElementsAre(EqualsProto(want_attributions[0]),
+                                   EqualsProto(want_attributions[1])));
+  std::vector<Association> associations;
+  TF_ASSERT_OK(metadata_access_object_->FindAssociationsByExecutions(
+      {execution_ids[1], execution_ids[2]}, &associations));
+  EXPECT_THAT(associations, ElementsAre(EqualsProto(want_associations[1])));
+
+  // no ids and ids without edges find nothing.
+  events.clear();
+  TF_ASSERT_OK(metadata_access_object_->FindEventsByExecutions({}, &events));
+  TF_ASSERT_OK(metadata_access_object_->FindEventsByExecutions(
+      {execution_ids[2]}, &events));
+  EXPECT_THAT(events, IsEmpty());
+}
+
 TEST_P(MetadataAccessObjectTest, MigrateToCurrentLibVersion) {
   // setup the database of previous version.
   int64 lib_version = metadata_access_object_->GetLibraryVersion();
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_source.h"
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 
@@ -67,6 +68,7 @@ tensorflow::Status MetadataSource::Commit() {
     return tensorflow::errors::FailedPrecondition("Transaction not open.");
   TF_RETURN_IF_ERROR(CommitImpl());
   transaction_open_ = false;
+  savepoint_depth_ = 0;
   return tensorflow::Status::OK();
 }
 
@@ -78,9 +80,75 @@ tensorflow::Status MetadataSource::Rollback() {
     return tensorflow::errors::FailedPrecondition("Transaction not open.");
   TF_RETURN_IF_ERROR(RollbackImpl());
   transaction_open_ = false;
+  savepoint_depth_ = 0;
   return tensorflow::Status::OK();
 }
 
+tensorflow::Status MetadataSource::Savepoint() {
+  if (!is_connected_)
+    return tensorflow::errors::FailedPrecondition(
+        "No opened connection for querying.");
+  if (!transaction_open_)
+    return tensorflow::errors::FailedPrecondition("Transaction not open.");
+  TF_RETURN_IF_ERROR(SavepointImpl(savepoint_depth_ + 1));
+  savepoint_depth_++;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataSource::ReleaseSavepoint() {
+  if (savepoint_depth_ == 0)
+    return tensorflow::errors::FailedPrecondition("No savepoint is created.");
+  TF_RETURN_IF_ERROR(ReleaseSavepointImpl(savepoint_depth_));
+  savepoint_depth_--;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataSource::RollbackToSavepoint() {
+  if (savepoint_depth_ == 0)
+    return tensorflow::errors::FailedPrecondition("No savepoint is created.");
+  TF_RETURN_IF_ERROR(RollbackToSavepointImpl(savepoint_depth_));
+  return ReleaseSavepoint();
+}
+
+tensorflow::Status MetadataSource::SavepointImpl(const int depth) {
+  RecordSet record_set;
+  return ExecuteQuery(absl::StrCat("SAVEPOINT mlmd_savepoint_", depth),
+                      &record_set);
+}
+
+tensorflow::Status MetadataSource::ReleaseSavepointImpl(const int depth) {
+  RecordSet record_set;
+  return ExecuteQuery(absl::StrCat("RELEASE SAVEPOINT mlmd_savepoint_", depth),
+                      &record_set);
+}
+
+tensorflow::Status MetadataSource::RollbackToSavepointImpl(const int depth) {
+  RecordSet record_set;
+  return ExecuteQuery(
+      absl::StrCat("ROLLBACK TO SAVEPOINT mlmd_savepoint_", depth),
+      &record_set);
+}
+
+tensorflow::Status MetadataSource::Backup(const std::string& destination_uri,
+                                          const int pages_per_step,
+                                          const absl::Duration step_interval,
+                                          absl::Mutex* step_lock,
+                                          int64* num_pages) {
+  if (!is_connected_)
+    return tensorflow::errors::FailedPrecondition(
+        "No opened connection for backup.");
+  return BackupImpl(destination_uri, pages_per_step, step_interval, step_lock,
+                    num_pages);
+}
+
+tensorflow::Status MetadataSource::BackupImpl(
+    const std::string& destination_uri, const int pages_per_step,
+    const absl::Duration step_interval, absl::Mutex* step_lock,
+    int64* num_pages) {
+  return tensorflow::errors::Unimplemented(
+      "The metadata source does not support backups.");
+}
+
 ScopedTransaction::ScopedTransaction(MetadataSource* metadata_source)
     : committed_(false), metadata_source_(metadata_source) {
   CHECK(metadata_source->is_connected());
@@ -119,6 +187,17 @@ tensorflow::Status ExecuteTransaction(
         "To use ExecuteTransaction, the metadata_source should be created and "
         "connected");
   }
+  if (metadata_source->transaction_open()) {
+    TF_RETURN_IF_ERROR(metadata_source->Savepoint());
+    tensorflow::Status transaction_status = transaction();
+    if (transaction_status.ok()) {
+      transaction_status.Update(metadata_source->ReleaseSavepoint());
+    }
+    if (!transaction_status.ok()) {
+      transaction_status.Update(metadata_source->RollbackToSavepoint());
+    }
+    return transaction_status;
+  }
   TF_RETURN_IF_ERROR(metadata_source->Begin());
   tensorflow::Status transaction_status = transaction();
   if (transaction_status.ok()) {
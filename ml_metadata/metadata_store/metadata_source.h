@@ -19,6 +19,8 @@ limitations under the License.
 #include <memory>
 #include <string>
 
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -101,6 +103,39 @@ class MetadataSource {
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
   tensorflow::Status Rollback();
 
+  // Creates a savepoint in the open transaction. The queries executed after it
+  // can be kept by ReleaseSavepoint() or undone by RollbackToSavepoint(),
+  // without ending the transaction. Savepoints can be nested; releasing and
+  // rolling back apply to the latest savepoint.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  tensorflow::Status Savepoint();
+
+  // Releases the latest savepoint and keeps the changes made after it.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if there is no savepoint.
+  tensorflow::Status ReleaseSavepoint();
+
+  // Rolls back the changes made after the latest savepoint and releases it.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if there is no savepoint.
+  tensorflow::Status RollbackToSavepoint();
+
+  // Copies the database to the database at `destination_uri`, while other
+  // connections can keep using it. The copy runs in steps of `pages_per_step`
+  // pages, and waits for `step_interval` after each step. If `pages_per_step`
+  // is not positive, all pages are copied in one step. Sets `num_pages` to the
+  // number of pages copied. The database is read through the connection of
+  // the source. If a `step_lock` is given, each step holds it, so that the
+  // threads holding it can use the source between the steps.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns INVALID_ARGUMENT error, if `destination_uri` is the database.
+  // Returns UNIMPLEMENTED error, if the backend does not support backups.
+  // Returns detailed INTERNAL error, if the backup fails.
+  tensorflow::Status Backup(const std::string& destination_uri,
+                            int pages_per_step, absl::Duration step_interval,
+                            absl::Mutex* step_lock, int64* num_pages);
+
   // Utility method to escape characters specific to the metadata source. The
   // returned string is used to bind text parameters for query composition. The
   // escaping characters and method depends on the metadata source backend.
@@ -108,9 +143,12 @@ class MetadataSource {
 
   bool is_connected() const { return is_connected_; }
 
- protected:
   bool transaction_open() const { return transaction_open_; }
 
+  // The number of savepoints in the open transaction.
+  int savepoint_depth() const { return savepoint_depth_; }
+
+ protected:
   void set_transaction_open(bool transaction_open) {
     transaction_open_ = transaction_open;
   }
@@ -135,8 +173,26 @@ class MetadataSource {
   // Implementation of a transaction rollback.
   virtual tensorflow::Status RollbackImpl() = 0;
 
+  // Implementations of creating, releasing and rolling back to the savepoint
+  // at `depth` of the open transaction. SQL backends keep the defaults, which
+  // run the SAVEPOINT, RELEASE SAVEPOINT and ROLLBACK TO SAVEPOINT queries.
+  virtual tensorflow::Status SavepointImpl(int depth);
+  virtual tensorflow::Status ReleaseSavepointImpl(int depth);
+  virtual tensorflow::Status RollbackToSavepointImpl(int depth);
+
+  // Implementation of an online backup, which uses the connection of the
+  // source only while holding the `step_lock`, if one is given. Backends
+  // without backups keep the default, which returns UNIMPLEMENTED error.
+  virtual tensorflow::Status BackupImpl(const std::string& destination_uri,
+                                        int pages_per_step,
+                                        absl::Duration step_interval,
+                                        absl::Mutex* step_lock,
+                                        int64* num_pages);
+
   bool is_connected_ = false;
   bool transaction_open_ = false;
+  // The number of savepoints in the open transaction.
+  int savepoint_depth_ = 0;
 };
 
 // A scoped transaction. When it is destroyed, if Commit has not been called,
@@ -191,6 +247,10 @@ class ScopedTransaction {
 // `transaction` issues ExecuteQuery with the same `metadata_source`.
 // Similar to ScopedTransaction, MetadataSource::Commit/Rollback/Close should
 // not be called within the `transaction` callback.
+// If a transaction is already open on the `metadata_source`, e.g., when many
+// writes are grouped into one commit, the `transaction` runs within a
+// savepoint instead, so that its failure only undoes its own changes, and its
+// changes are committed together with the enclosing transaction.
 //
 // Returns FAILED_PRECONDITION if metadata_source is null or not connected.
 // Returns detailed internal errors of transaction, Begin, Rollback and Commit.
@@ -170,6 +170,23 @@ TEST(MetadataSourceTest, TestRollbackWithoutConnect) {
   EXPECT_EQ(s.code(), tensorflow::error::FAILED_PRECONDITION);
 }
 
+TEST(MetadataSourceTest, TestSavepointWithoutBegin) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source,
+              ExecuteQueryImpl(::testing::_, ::testing::_))
+      .Times(0);
+  EXPECT_EQ(mock_metadata_source.Savepoint().code(),
+            tensorflow::error::FAILED_PRECONDITION);
+  TF_EXPECT_OK(mock_metadata_source.Connect());
+  // A savepoint outside a transaction would implicitly begin one on SQLite.
+  EXPECT_EQ(mock_metadata_source.Savepoint().code(),
+            tensorflow::error::FAILED_PRECONDITION);
+  EXPECT_EQ(mock_metadata_source.ReleaseSavepoint().code(),
+            tensorflow::error::FAILED_PRECONDITION);
+  EXPECT_EQ(mock_metadata_source.RollbackToSavepoint().code(),
+            tensorflow::error::FAILED_PRECONDITION);
+}
+
 TEST(MetadataSourceTest, TestBeginWithoutConnect) {
   MockMetadataSource mock_metadata_source;
   EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(0);
@@ -217,6 +234,52 @@ TEST(MetadataSourceTest, TestExecuteTransactionRollback) {
   EXPECT_EQ(got_status.code(), want_status.code());
 }
 
+TEST(MetadataSourceTest, TestExecuteTransactionNested) {
+  MockMetadataSource mock_metadata_source;
+  TF_EXPECT_OK(mock_metadata_source.Connect());
+  std::string query = "some query";
+  RecordSet result;
+  tensorflow::Status want_status =
+      tensorflow::errors::Internal("Some internal error afterwards");
+
+  {
+    ::testing::InSequence call_seq;
+    EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(1);
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("SAVEPOINT mlmd_savepoint_1", ::testing::_));
+    EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl(query, &result));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("RELEASE SAVEPOINT mlmd_savepoint_1",
+                                 ::testing::_));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("SAVEPOINT mlmd_savepoint_1", ::testing::_));
+    EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl(query, &result))
+        .WillOnce(::testing::Return(want_status));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("ROLLBACK TO SAVEPOINT mlmd_savepoint_1",
+                                 ::testing::_));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("RELEASE SAVEPOINT mlmd_savepoint_1",
+                                 ::testing::_));
+    EXPECT_CALL(mock_metadata_source, CommitImpl()).Times(1);
+  }
+  EXPECT_CALL(mock_metadata_source, RollbackImpl()).Times(0);
+  // the nested transactions run within savepoints of the enclosing one.
+  TF_EXPECT_OK(ExecuteTransaction(
+      &mock_metadata_source, [&]() -> tensorflow::Status {
+        TF_EXPECT_OK(ExecuteTransaction(
+            &mock_metadata_source, [&]() -> tensorflow::Status {
+              return mock_metadata_source.ExecuteQuery(query, &result);
+            }));
+        tensorflow::Status got_status = ExecuteTransaction(
+            &mock_metadata_source, [&]() -> tensorflow::Status {
+              return mock_metadata_source.ExecuteQuery(query, &result);
+            });
+        EXPECT_EQ(got_status.code(), want_status.code());
+        return tensorflow::Status::OK();
+      }));
+}
+
 TEST(MetadataSourceTest, TestExecuteTransactionError) {
   MockMetadataSource mock_metadata_source;
   std::string query = "some query";
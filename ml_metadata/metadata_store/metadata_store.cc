@@ -14,9 +14,24 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_store.h"
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/util/message_differencer.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_access_object_factory.h"
+#include "ml_metadata/metadata_store/node_read_mask.h"
+#include "ml_metadata/metadata_store/store_snapshot.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 
@@ -87,6 +102,38 @@ tensorflow::Status UpsertType(const T& type, bool can_add_fields,
   return metadata_access_object->UpdateType(type);
 }
 
+// Creates the property table indexes of the indexed properties of the
+// committed `type`, if any. It runs in a transaction of its own, as creating
+// an index implicitly commits the open transaction on some backends (e.g.,
+// MySQL), which would break the atomicity of the type writes.
+template <typename T>
+tensorflow::Status CreatePropertyIndexes(
+    const T& type, MetadataSource* metadata_source,
+    MetadataAccessObject* metadata_access_object) {
+  if (type.indexed_properties().empty()) return tensorflow::Status::OK();
+  return ExecuteTransaction(
+      metadata_source, [&type, metadata_access_object]() {
+        return metadata_access_object->CreatePropertyIndexes(type);
+      });
+}
+
+// Returns INVALID_ARGUMENT error, if `path` is not an absolute file path, or
+// has empty, . or .. segments, e.g., the root directory.
+tensorflow::Status CheckAbsolutePath(absl::string_view path) {
+  if (!absl::StartsWith(path, "/")) {
+    return tensorflow::errors::InvalidArgument("Not an absolute path: ", path);
+  }
+  absl::string_view relative_path = path.substr(1);
+  absl::ConsumeSuffix(&relative_path, "/");
+  for (absl::string_view segment : absl::StrSplit(relative_path, '/')) {
+    if (segment.empty() || segment == "." || segment == "..") {
+      return tensorflow::errors::InvalidArgument(
+          "The path has empty, . or .. segments: ", path);
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
 // Updates or inserts an artifact. If the artifact.id is given, it updates the
 // stored artifact, otherwise, it creates a new artifact.
 tensorflow::Status UpsertArtifact(const Artifact& artifact,
@@ -135,35 +182,524 @@ tensorflow::Status UpsertContext(const Context& context,
   return tensorflow::Status::OK();
 }
 
-// Inserts an association. If the association already exists it returns OK.
-tensorflow::Status InsertAssociationIfNotExist(
-    int64 context_id, int64 execution_id,
-    MetadataAccessObject* metadata_access_object) {
+// Returns true if the property maps have the same values.
+bool HaveSameValues(
+    const google::protobuf::Map<std::string, Value>& values,
+    const google::protobuf::Map<std::string, Value>& other_values) {
+  if (values.size() != other_values.size()) return false;
+  for (const auto& value : values) {
+    const auto it = other_values.find(value.first);
+    if (it == other_values.end() ||
+        !google::protobuf::util::MessageDifferencer::Equals(value.second,
+                                                            it->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A context upserted once by PutExecutionBatch, with its context id.
+struct UpsertedContext {
+  int64 id;
+  const Context* context;
+};
+
+// Upserts a context unless it is already upserted, as recorded by
+// `upserted_contexts`, which maps the id of a given context, or the type id
+// and name of a new one, to the upserted context. Sets `upserted` to whether
+// the context is upserted by the call.
+// Returns INVALID_ARGUMENT error, if the upserted context has different
+// properties or custom properties.
+tensorflow::Status UpsertContextOnce(
+    const Context& context, MetadataAccessObject* metadata_access_object,
+    std::map<std::string, UpsertedContext>* upserted_contexts,
+    int64* context_id, bool* upserted) {
+  const std::string key =
+      context.has_id()
+          ? absl::StrCat("id:", context.id())
+          : absl::StrCat("type_id:", context.type_id(), ":", context.name());
+  const auto it = upserted_contexts->find(key);
+  *upserted = it == upserted_contexts->end();
+  if (!*upserted) {
+    const Context& upserted_context = *it->second.context;
+    if (!HaveSameValues(context.properties(), upserted_context.properties()) ||
+        !HaveSameValues(context.custom_properties(),
+                        upserted_context.custom_properties())) {
+      return tensorflow::errors::InvalidArgument(
+          "The context is given more than once with different properties: ",
+          context.DebugString());
+    }
+    *context_id = it->second.id;
+    return tensorflow::Status::OK();
+  }
+  TF_RETURN_IF_ERROR(
+      UpsertContext(context, metadata_access_object, context_id));
+  upserted_contexts->emplace(key, UpsertedContext{*context_id, &context});
+  return tensorflow::Status::OK();
+}
+
+// Appends the association of the context with the execution, and the
+// attributions of the context to the artifacts of a PutExecutionResponse.
+void AppendContextEdges(const int64 context_id,
+                        const PutExecutionResponse& response,
+                        std::vector<Association>* associations,
+                        std::vector<Attribution>* attributions) {
   Association association;
-  association.set_execution_id(execution_id);
   association.set_context_id(context_id);
-  int64 dummy_assocation_id;
-  tensorflow::Status status = metadata_access_object->CreateAssociation(
-      association, &dummy_assocation_id);
-  if (!status.ok() && !tensorflow::errors::IsAlreadyExists(status)) {
-    return status;
+  association.set_execution_id(response.execution_id());
+  associations->push_back(association);
+  for (const int64 artifact_id : response.artifact_ids()) {
+    Attribution attribution;
+    attribution.set_context_id(context_id);
+    attribution.set_artifact_id(artifact_id);
+    attributions->push_back(attribution);
+  }
+}
+
+// Returns the change of upserting a node with `node_id`. The node is created
+// if it has no id, and updated otherwise.
+Change UpsertChange(const Artifact& artifact, const int64 artifact_id) {
+  Change change;
+  change.set_type(artifact.has_id() ? Change::UPDATE : Change::CREATE);
+  *change.mutable_artifact() = artifact;
+  change.mutable_artifact()->set_id(artifact_id);
+  return change;
+}
+
+Change UpsertChange(const Execution& execution, const int64 execution_id) {
+  Change change;
+  change.set_type(execution.has_id() ? Change::UPDATE : Change::CREATE);
+  *change.mutable_execution() = execution;
+  change.mutable_execution()->set_id(execution_id);
+  return change;
+}
+
+Change UpsertChange(const Context& context, const int64 context_id) {
+  Change change;
+  change.set_type(context.has_id() ? Change::UPDATE : Change::CREATE);
+  *change.mutable_context() = context;
+  change.mutable_context()->set_id(context_id);
+  return change;
+}
+
+// Returns the change of creating a node with its id, e.g., by ImportStore, or
+// an event, attribution or association.
+Change CreationChange(const Artifact& artifact) {
+  Change change;
+  change.set_type(Change::CREATE);
+  *change.mutable_artifact() = artifact;
+  return change;
+}
+
+Change CreationChange(const Execution& execution) {
+  Change change;
+  change.set_type(Change::CREATE);
+  *change.mutable_execution() = execution;
+  return change;
+}
+
+Change CreationChange(const Context& context) {
+  Change change;
+  change.set_type(Change::CREATE);
+  *change.mutable_context() = context;
+  return change;
+}
+
+Change CreationChange(const Event& event) {
+  Change change;
+  change.set_type(Change::CREATE);
+  *change.mutable_event() = event;
+  return change;
+}
+
+Change CreationChange(const Attribution& attribution) {
+  Change change;
+  change.set_type(Change::CREATE);
+  *change.mutable_attribution() = attribution;
+  return change;
+}
+
+Change CreationChange(const Association& association) {
+  Change change;
+  change.set_type(Change::CREATE);
+  *change.mutable_association() = association;
+  return change;
+}
+
+// Returns the change of deleting the node with `node_id`, whose field in the
+// change is set by `mutable_node`, e.g., Change::mutable_artifact.
+template <typename Node>
+Change DeletionChange(Node* (Change::*mutable_node)(), const int64 node_id) {
+  Change change;
+  change.set_type(Change::DELETE);
+  (change.*mutable_node)()->set_id(node_id);
+  return change;
+}
+
+// Parses the `read_mask` of a request for the nodes of `Node`, if one is
+// given. Otherwise the parsed mask selects every field.
+template <typename Node>
+tensorflow::Status ParseReadMask(const NodeReadMask* read_mask,
+                                 ParsedNodeReadMask* parsed_read_mask) {
+  if (read_mask == nullptr) return tensorflow::Status::OK();
+  return ParsedNodeReadMask::Parse<Node>(*read_mask, parsed_read_mask);
+}
+
+// Finds the artifact with the given id in the node cache if one is given, or
+// else in the metadata source, and caches it. If a `read_mask` is given, only
+// the selected fields are read, and the partial artifact is not cached. A
+// cached artifact is masked by the `parsed_read_mask` of the `read_mask`.
+tensorflow::Status FindArtifactById(
+    const int64 artifact_id, MetadataAccessObject* metadata_access_object,
+    NodeCache* node_cache, Artifact* artifact,
+    const NodeReadMask* read_mask = nullptr,
+    const ParsedNodeReadMask* parsed_read_mask = nullptr) {
+  if (node_cache != nullptr && node_cache->GetArtifact(artifact_id, artifact)) {
+    if (parsed_read_mask != nullptr) parsed_read_mask->Apply(artifact);
+    return tensorflow::Status::OK();
+  }
+  TF_RETURN_IF_ERROR(metadata_access_object->FindArtifactById(
+      artifact_id, artifact, read_mask));
+  if (node_cache != nullptr && read_mask == nullptr) {
+    node_cache->PutArtifact(*artifact);
   }
   return tensorflow::Status::OK();
 }
 
-// Inserts an attribution. If the attribution already exists it returns OK.
-tensorflow::Status InsertAttributionIfNotExist(
-    int64 context_id, int64 artifact_id,
-    MetadataAccessObject* metadata_access_object) {
-  Attribution attribution;
-  attribution.set_artifact_id(artifact_id);
-  attribution.set_context_id(context_id);
-  int64 dummy_attribution_id;
-  tensorflow::Status status = metadata_access_object->CreateAttribution(
-      attribution, &dummy_attribution_id);
-  if (!status.ok() && !tensorflow::errors::IsAlreadyExists(status)) {
+// Finds the execution with the given id in the node cache if one is given, or
+// else in the metadata source, and caches it. If a `read_mask` is given, only
+// the selected fields are read, and the partial execution is not cached. A
+// cached execution is masked by the `parsed_read_mask` of the `read_mask`.
+tensorflow::Status FindExecutionById(
+    const int64 execution_id, MetadataAccessObject* metadata_access_object,
+    NodeCache* node_cache, Execution* execution,
+    const NodeReadMask* read_mask = nullptr,
+    const ParsedNodeReadMask* parsed_read_mask = nullptr) {
+  if (node_cache != nullptr &&
+      node_cache->GetExecution(execution_id, execution)) {
+    if (parsed_read_mask != nullptr) parsed_read_mask->Apply(execution);
+    return tensorflow::Status::OK();
+  }
+  TF_RETURN_IF_ERROR(metadata_access_object->FindExecutionById(
+      execution_id, execution, read_mask));
+  if (node_cache != nullptr && read_mask == nullptr) {
+    node_cache->PutExecution(*execution);
+  }
+  return tensorflow::Status::OK();
+}
+
+// Finds the context with the given id in the node cache if one is given, or
+// else in the metadata source, and caches it. If a `read_mask` is given, only
+// the selected fields are read, and the partial context is not cached. A
+// cached context is masked by the `parsed_read_mask` of the `read_mask`.
+tensorflow::Status FindContextById(
+    const int64 context_id, MetadataAccessObject* metadata_access_object,
+    NodeCache* node_cache, Context* context,
+    const NodeReadMask* read_mask = nullptr,
+    const ParsedNodeReadMask* parsed_read_mask = nullptr) {
+  if (node_cache != nullptr && node_cache->GetContext(context_id, context)) {
+    if (parsed_read_mask != nullptr) parsed_read_mask->Apply(context);
+    return tensorflow::Status::OK();
+  }
+  TF_RETURN_IF_ERROR(
+      metadata_access_object->FindContextById(context_id, context, read_mask));
+  if (node_cache != nullptr && read_mask == nullptr) {
+    node_cache->PutContext(*context);
+  }
+  return tensorflow::Status::OK();
+}
+
+// Returns the attributes to group the counts by, from the repeated enum field
+// of a count request.
+std::vector<NodeCount::GroupBy> GetGroupBy(
+    const google::protobuf::RepeatedField<int>& group_by) {
+  std::vector<NodeCount::GroupBy> attributes;
+  attributes.reserve(group_by.size());
+  for (const int attribute : group_by) {
+    attributes.push_back(static_cast<NodeCount::GroupBy>(attribute));
+  }
+  return attributes;
+}
+
+// Moves the messages to the end of the repeated field. The messages are swapped
+// into the field instead of deep copied, and `messages` is cleared.
+template <typename T>
+void MoveToRepeatedField(std::vector<T>* messages,
+                         google::protobuf::RepeatedPtrField<T>* field) {
+  field->Reserve(field->size() + messages->size());
+  for (T& message : *messages) {
+    field->Add()->Swap(&message);
+  }
+  messages->clear();
+}
+
+// Returns a copy of the filter which additionally requires the nodes to have
+// the given type id.
+NodeFilter FilterWithTypeId(const NodeFilter& filter, const int64 type_id) {
+  NodeFilter filter_with_type_id = filter;
+  NodeFilter::Predicate* predicate = filter_with_type_id.add_predicates();
+  predicate->set_attribute(NodeFilter::TYPE_ID);
+  predicate->set_op(NodeFilter::EQ);
+  predicate->mutable_value()->set_int_value(type_id);
+  return filter_with_type_id;
+}
+
+// The number of node ids deleted in a transaction, if a deletion request has
+// no chunk size.
+constexpr int64 kDefaultDeletionChunkSize = 1000;
+
+// Deletes a chunk of nodes with their dependent rows, and adds the number of
+// rows deleted from each table.
+using DeleteNodesFn = std::function<tensorflow::Status(
+    const std::vector<int64>& node_ids, std::map<std::string, int64>*)>;
+
+// Deletes the distinct `node_ids` in a transaction per chunk of at most
+// `chunk_size` ids, so that the locks of the metadata source are not held for
+// the whole deletion. The counts of each committed chunk are added to
+// `num_deleted_rows`, and `on_chunk_committed` is called with its ids. The
+// chunks committed before an error stay deleted.
+tensorflow::Status DeleteNodesInChunks(
+    const ExecuteTransactionFn& execute_transaction,
+    const google::protobuf::RepeatedField<google::protobuf::int64>& node_ids,
+    int64 chunk_size,
+    const DeleteNodesFn& delete_nodes,
+    const std::function<void(const std::vector<int64>&)>& on_chunk_committed,
+    google::protobuf::Map<std::string, google::protobuf::int64>*
+        num_deleted_rows) {
+  if (chunk_size <= 0) chunk_size = kDefaultDeletionChunkSize;
+  std::vector<int64> ids(node_ids.begin(), node_ids.end());
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  const int64 num_ids = ids.size();
+  for (int64 begin = 0; begin < num_ids; begin += chunk_size) {
+    const std::vector<int64> chunk(
+        ids.begin() + begin,
+        ids.begin() + std::min<int64>(begin + chunk_size, num_ids));
+    std::map<std::string, int64> chunk_num_deleted_rows;
+    TF_RETURN_IF_ERROR(execute_transaction(
+        [&delete_nodes, &chunk,
+         &chunk_num_deleted_rows]() -> tensorflow::Status {
+          return delete_nodes(chunk, &chunk_num_deleted_rows);
+        }));
+    for (const auto& table_and_num_rows : chunk_num_deleted_rows) {
+      (*num_deleted_rows)[table_and_num_rows.first] +=
+          table_and_num_rows.second;
+    }
+    on_chunk_committed(chunk);
+  }
+  return tensorflow::Status::OK();
+}
+
+// The ids of the nodes deleted in a chunk of the compaction.
+struct CompactionChunk {
+  std::vector<int64> artifact_ids;
+  std::vector<int64> execution_ids;
+  std::vector<int64> context_ids;
+
+  int64 size() const {
+    return artifact_ids.size() + execution_ids.size() + context_ids.size();
+  }
+};
+
+// Returns a filter of at most `limit` nodes of the type of the `policy` which
+// are not updated since its max age before `now_millis`. The nodes whose last
+// update time is unknown, i.e., 0, are never matched.
+NodeFilter RetentionFilter(const CompactionConfig::RetentionPolicy& policy,
+                           const int64 now_millis, const int64 limit) {
+  NodeFilter filter;
+  NodeFilter::Predicate* type = filter.add_predicates();
+  type->set_attribute(NodeFilter::TYPE);
+  type->set_op(NodeFilter::EQ);
+  type->mutable_value()->set_string_value(policy.type_name());
+  NodeFilter::Predicate* update_time = filter.add_predicates();
+  update_time->set_attribute(NodeFilter::LAST_UPDATE_TIME_SINCE_EPOCH);
+  update_time->set_op(NodeFilter::LE);
+  update_time->mutable_value()->set_int_value(
+      now_millis - policy.max_age_seconds() * 1000);
+  NodeFilter::Predicate* known_update_time = filter.add_predicates();
+  known_update_time->set_attribute(NodeFilter::LAST_UPDATE_TIME_SINCE_EPOCH);
+  known_update_time->set_op(NodeFilter::GT);
+  known_update_time->mutable_value()->set_int_value(0);
+  filter.set_limit(limit);
+  return filter;
+}
+
+// Appends the ids of the nodes found by `find_nodes`, which returns NOT_FOUND
+// if there are none.
+template <typename Node>
+tensorflow::Status AppendNodeIds(
+    const std::function<tensorflow::Status(std::vector<Node>*)>& find_nodes,
+    std::vector<int64>* node_ids) {
+  std::vector<Node> nodes;
+  const tensorflow::Status status = find_nodes(&nodes);
+  if (!status.ok() && !tensorflow::errors::IsNotFound(status)) return status;
+  for (const Node& node : nodes) {
+    node_ids->push_back(node.id());
+  }
+  return tensorflow::Status::OK();
+}
+
+// Moves the nodes of the type named `type_name` with the given `names` to
+// `field`. The nodes are found in one query by `find_nodes`, which is given
+// the type id. Nothing is found if the type does not exist.
+template <typename Type, typename Node>
+tensorflow::Status FindNodesByTypeAndNames(
+    const std::string& type_name,
+    const google::protobuf::RepeatedPtrField<std::string>& names,
+    const std::function<tensorflow::Status(
+        int64, const std::vector<std::string>&, std::vector<Node>*)>&
+        find_nodes,
+    MetadataAccessObject* metadata_access_object,
+    google::protobuf::RepeatedPtrField<Node>* field) {
+  if (names.empty()) return tensorflow::Status::OK();
+  Type type;
+  tensorflow::Status status =
+      metadata_access_object->FindTypeByName(type_name, &type);
+  if (tensorflow::errors::IsNotFound(status)) {
+    return tensorflow::Status::OK();
+  } else if (!status.ok()) {
     return status;
   }
+  std::vector<Node> nodes;
+  status = find_nodes(type.id(),
+                      std::vector<std::string>(names.begin(), names.end()),
+                      &nodes);
+  if (!status.ok() && !tensorflow::errors::IsNotFound(status)) return status;
+  MoveToRepeatedField(&nodes, field);
+  return tensorflow::Status::OK();
+}
+
+// Returns INVALID_ARGUMENT if a retention policy of `config` has no positive
+// max age, which would delete every node of its type.
+tensorflow::Status ValidateCompactionConfig(const CompactionConfig& config) {
+  for (const auto* policies : {&config.execution_retention_policies(),
+                               &config.context_retention_policies()}) {
+    for (const CompactionConfig::RetentionPolicy& policy : *policies) {
+      if (policy.max_age_seconds() <= 0) {
+        return tensorflow::errors::InvalidArgument(
+            "The max_age_seconds of a retention policy must be positive: ",
+            policy.DebugString());
+      }
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+// Finds at most `chunk_size` nodes that are due for compaction by `config` at
+// `now_millis`. Only the ids of the nodes are read.
+tensorflow::Status FindCompactionChunk(
+    const CompactionConfig& config, const int64 chunk_size,
+    const int64 now_millis, MetadataAccessObject* metadata_access_object,
+    CompactionChunk* chunk) {
+  NodeReadMask id_mask;
+  id_mask.add_paths("id");
+  if (config.delete_deleted_artifacts()) {
+    NodeFilter filter;
+    NodeFilter::Predicate* state = filter.add_predicates();
+    state->set_attribute(NodeFilter::STATE);
+    state->set_op(NodeFilter::EQ);
+    state->mutable_value()->set_int_value(Artifact::DELETED);
+    filter.set_limit(chunk_size);
+    TF_RETURN_IF_ERROR(AppendNodeIds<Artifact>(
+        [metadata_access_object, &filter,
+         &id_mask](std::vector<Artifact>* artifacts) {
+          return metadata_access_object->FindArtifactsByFilter(
+              filter, artifacts, &id_mask);
+        },
+        &chunk->artifact_ids));
+  }
+  for (const CompactionConfig::RetentionPolicy& policy :
+       config.execution_retention_policies()) {
+    const NodeFilter filter =
+        RetentionFilter(policy, now_millis, chunk_size - chunk->size());
+    if (filter.limit() <= 0) break;
+    TF_RETURN_IF_ERROR(AppendNodeIds<Execution>(
+        [metadata_access_object, &filter,
+         &id_mask](std::vector<Execution>* executions) {
+          return metadata_access_object->FindExecutionsByFilter(
+              filter, executions, &id_mask);
+        },
+        &chunk->execution_ids));
+  }
+  for (const CompactionConfig::RetentionPolicy& policy :
+       config.context_retention_policies()) {
+    const NodeFilter filter =
+        RetentionFilter(policy, now_millis, chunk_size - chunk->size());
+    if (filter.limit() <= 0) break;
+    TF_RETURN_IF_ERROR(AppendNodeIds<Context>(
+        [metadata_access_object, &filter,
+         &id_mask](std::vector<Context>* contexts) {
+          return metadata_access_object->FindContextsByFilter(
+              filter, contexts, &id_mask);
+        },
+        &chunk->context_ids));
+  }
+  return tensorflow::Status::OK();
+}
+
+// Appends the ids of the nodes adjacent to a node in the lineage graph.
+using LineageNeighborsFn =
+    std::function<tensorflow::Status(int64 node_id, std::vector<int64>*)>;
+
+// Traverses the lineage graph breadth-first from the nodes in the request,
+// following at most request.max_hops events, and sets the ids of the visited
+// nodes other than the starting ones in the response. `artifact_neighbors`
+// gives the executions adjacent to an artifact, and `execution_neighbors`
+// gives the artifacts adjacent to an execution.
+tensorflow::Status TraverseLineage(
+    const GetLineageNodesRequest& request,
+    const LineageNeighborsFn& artifact_neighbors,
+    const LineageNeighborsFn& execution_neighbors,
+    GetLineageNodesResponse* response) {
+  absl::flat_hash_set<int64> visited_artifacts(request.artifact_ids().begin(),
+                                               request.artifact_ids().end());
+  absl::flat_hash_set<int64> visited_executions(
+      request.execution_ids().begin(), request.execution_ids().end());
+  std::vector<int64> artifact_frontier(visited_artifacts.begin(),
+                                       visited_artifacts.end());
+  std::vector<int64> execution_frontier(visited_executions.begin(),
+                                        visited_executions.end());
+  std::vector<int64> reached_artifacts;
+  std::vector<int64> reached_executions;
+  std::vector<int64> neighbors;
+  for (int hops = 0; request.max_hops() <= 0 || hops < request.max_hops();
+       ++hops) {
+    if (artifact_frontier.empty() && execution_frontier.empty()) break;
+    std::vector<int64> next_artifact_frontier;
+    std::vector<int64> next_execution_frontier;
+    for (const int64 artifact_id : artifact_frontier) {
+      neighbors.clear();
+      TF_RETURN_IF_ERROR(artifact_neighbors(artifact_id, &neighbors));
+      for (const int64 execution_id : neighbors) {
+        if (visited_executions.insert(execution_id).second) {
+          next_execution_frontier.push_back(execution_id);
+        }
+      }
+    }
+    for (const int64 execution_id : execution_frontier) {
+      neighbors.clear();
+      TF_RETURN_IF_ERROR(execution_neighbors(execution_id, &neighbors));
+      for (const int64 artifact_id : neighbors) {
+        if (visited_artifacts.insert(artifact_id).second) {
+          next_artifact_frontier.push_back(artifact_id);
+        }
+      }
+    }
+    reached_artifacts.insert(reached_artifacts.end(),
+                             next_artifact_frontier.begin(),
+                             next_artifact_frontier.end());
+    reached_executions.insert(reached_executions.end(),
+                              next_execution_frontier.begin(),
+                              next_execution_frontier.end());
+    artifact_frontier.swap(next_artifact_frontier);
+    execution_frontier.swap(next_execution_frontier);
+  }
+  std::sort(reached_artifacts.begin(), reached_artifacts.end());
+  std::sort(reached_executions.begin(), reached_executions.end());
+  response->mutable_artifact_ids()->Add(reached_artifacts.begin(),
+                                        reached_artifacts.end());
+  response->mutable_execution_ids()->Add(reached_executions.begin(),
+                                         reached_executions.end());
   return tensorflow::Status::OK();
 }
 
@@ -194,7 +730,7 @@ tensorflow::Status MetadataStore::PutTypes(const PutTypesRequest& request,
   if (!request.all_fields_match()) {
     return tensorflow::errors::Unimplemented("Must match all fields.");
   }
-  return ExecuteTransaction(
+  TF_RETURN_IF_ERROR(ExecuteTransaction(
       metadata_source_.get(),
       [this, &request, &response]() -> tensorflow::Status {
         for (const ArtifactType& artifact_type : request.artifact_types()) {
@@ -219,7 +755,20 @@ tensorflow::Status MetadataStore::PutTypes(const PutTypesRequest& request,
           response->add_context_type_ids(context_type_id);
         }
         return tensorflow::Status::OK();
-      });
+      }));
+  for (const ArtifactType& artifact_type : request.artifact_types()) {
+    TF_RETURN_IF_ERROR(CreatePropertyIndexes(
+        artifact_type, metadata_source_.get(), metadata_access_object_.get()));
+  }
+  for (const ExecutionType& execution_type : request.execution_types()) {
+    TF_RETURN_IF_ERROR(CreatePropertyIndexes(
+        execution_type, metadata_source_.get(), metadata_access_object_.get()));
+  }
+  for (const ContextType& context_type : request.context_types()) {
+    TF_RETURN_IF_ERROR(CreatePropertyIndexes(
+        context_type, metadata_source_.get(), metadata_access_object_.get()));
+  }
+  return tensorflow::Status::OK();
 }
 
 tensorflow::Status MetadataStore::PutArtifactType(
@@ -230,7 +779,7 @@ tensorflow::Status MetadataStore::PutArtifactType(
   if (!request.all_fields_match()) {
     return tensorflow::errors::Unimplemented("Must match all fields.");
   }
-  return ExecuteTransaction(
+  TF_RETURN_IF_ERROR(ExecuteTransaction(
       metadata_source_.get(),
       [this, &request, &response]() -> tensorflow::Status {
         int64 type_id;
@@ -239,7 +788,9 @@ tensorflow::Status MetadataStore::PutArtifactType(
                                       metadata_access_object_.get(), &type_id));
         response->set_type_id(type_id);
         return tensorflow::Status::OK();
-      });
+      }));
+  return CreatePropertyIndexes(request.artifact_type(), metadata_source_.get(),
+                               metadata_access_object_.get());
 }
 
 tensorflow::Status MetadataStore::PutExecutionType(
@@ -251,7 +802,7 @@ tensorflow::Status MetadataStore::PutExecutionType(
   if (!request.all_fields_match()) {
     return tensorflow::errors::Unimplemented("Must match all fields.");
   }
-  return ExecuteTransaction(
+  TF_RETURN_IF_ERROR(ExecuteTransaction(
       metadata_source_.get(),
       [this, &request, &response]() -> tensorflow::Status {
         int64 type_id;
@@ -260,7 +811,9 @@ tensorflow::Status MetadataStore::PutExecutionType(
                                       metadata_access_object_.get(), &type_id));
         response->set_type_id(type_id);
         return tensorflow::Status::OK();
-      });
+      }));
+  return CreatePropertyIndexes(request.execution_type(), metadata_source_.get(),
+                               metadata_access_object_.get());
 }
 
 tensorflow::Status MetadataStore::PutContextType(
@@ -271,7 +824,7 @@ tensorflow::Status MetadataStore::PutContextType(
   if (!request.all_fields_match()) {
     return tensorflow::errors::Unimplemented("Must match all fields.");
   }
-  return ExecuteTransaction(
+  TF_RETURN_IF_ERROR(ExecuteTransaction(
       metadata_source_.get(),
       [this, &request, &response]() -> tensorflow::Status {
         int64 type_id;
@@ -280,7 +833,9 @@ tensorflow::Status MetadataStore::PutContextType(
                                       metadata_access_object_.get(), &type_id));
         response->set_type_id(type_id);
         return tensorflow::Status::OK();
-      });
+      }));
+  return CreatePropertyIndexes(request.context_type(), metadata_source_.get(),
+                               metadata_access_object_.get());
 }
 
 tensorflow::Status MetadataStore::GetArtifactType(
@@ -325,7 +880,7 @@ tensorflow::Status MetadataStore::GetArtifactTypesByID(
           const tensorflow::Status status =
               metadata_access_object_->FindTypeById(type_id, &artifact_type);
           if (status.ok()) {
-            *response->mutable_artifact_types()->Add() = artifact_type;
+            response->add_artifact_types()->Swap(&artifact_type);
           } else if (!tensorflow::errors::IsNotFound(status)) {
             return status;
           }
@@ -345,7 +900,7 @@ tensorflow::Status MetadataStore::GetExecutionTypesByID(
           const tensorflow::Status status =
               metadata_access_object_->FindTypeById(type_id, &execution_type);
           if (status.ok()) {
-            *response->mutable_execution_types()->Add() = execution_type;
+            response->add_execution_types()->Swap(&execution_type);
           } else if (!tensorflow::errors::IsNotFound(status)) {
             return status;
           }
@@ -365,7 +920,7 @@ tensorflow::Status MetadataStore::GetContextTypesByID(
           const tensorflow::Status status =
               metadata_access_object_->FindTypeById(type_id, &context_type);
           if (status.ok()) {
-            *response->mutable_context_types()->Add() = context_type;
+            response->add_context_types()->Swap(&context_type);
           } else if (!tensorflow::errors::IsNotFound(status)) {
             return status;
           }
@@ -380,12 +935,20 @@ tensorflow::Status MetadataStore::GetArtifactsByID(
   return ExecuteTransaction(
       metadata_source_.get(),
       [this, &request, &response]() -> tensorflow::Status {
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
+        // The mask is parsed once for the cached artifacts of the request.
+        ParsedNodeReadMask parsed_read_mask;
+        TF_RETURN_IF_ERROR(
+            ParseReadMask<Artifact>(read_mask, &parsed_read_mask));
         for (const int64 artifact_id : request.artifact_ids()) {
           Artifact artifact;
           const tensorflow::Status status =
-              metadata_access_object_->FindArtifactById(artifact_id, &artifact);
+              FindArtifactById(artifact_id, metadata_access_object_.get(),
+                               node_cache_.get(), &artifact, read_mask,
+                               &parsed_read_mask);
           if (status.ok()) {
-            *response->mutable_artifacts()->Add() = artifact;
+            response->add_artifacts()->Swap(&artifact);
           } else if (!tensorflow::errors::IsNotFound(status)) {
             return status;
           }
@@ -400,13 +963,20 @@ tensorflow::Status MetadataStore::GetExecutionsByID(
   return ExecuteTransaction(
       metadata_source_.get(),
       [this, &request, &response]() -> tensorflow::Status {
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
+        // The mask is parsed once for the cached executions of the request.
+        ParsedNodeReadMask parsed_read_mask;
+        TF_RETURN_IF_ERROR(
+            ParseReadMask<Execution>(read_mask, &parsed_read_mask));
         for (const int64 execution_id : request.execution_ids()) {
           Execution execution;
           const tensorflow::Status status =
-              metadata_access_object_->FindExecutionById(execution_id,
-                                                         &execution);
+              FindExecutionById(execution_id, metadata_access_object_.get(),
+                                node_cache_.get(), &execution, read_mask,
+                                &parsed_read_mask);
           if (status.ok()) {
-            *response->mutable_executions()->Add() = execution;
+            response->add_executions()->Swap(&execution);
           } else if (!tensorflow::errors::IsNotFound(status)) {
             return status;
           }
@@ -420,12 +990,20 @@ tensorflow::Status MetadataStore::GetContextsByID(
   return ExecuteTransaction(
       metadata_source_.get(),
       [this, &request, &response]() -> tensorflow::Status {
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
+        // The mask is parsed once for the cached contexts of the request.
+        ParsedNodeReadMask parsed_read_mask;
+        TF_RETURN_IF_ERROR(
+            ParseReadMask<Context>(read_mask, &parsed_read_mask));
         for (const int64 context_id : request.context_ids()) {
           Context context;
           const tensorflow::Status status =
-              metadata_access_object_->FindContextById(context_id, &context);
+              FindContextById(context_id, metadata_access_object_.get(),
+                              node_cache_.get(), &context, read_mask,
+                              &parsed_read_mask);
           if (status.ok()) {
-            *response->mutable_contexts()->Add() = context;
+            response->add_contexts()->Swap(&context);
           } else if (!tensorflow::errors::IsNotFound(status)) {
             return status;
           }
@@ -436,13 +1014,14 @@ tensorflow::Status MetadataStore::GetContextsByID(
 
 tensorflow::Status MetadataStore::PutArtifacts(
     const PutArtifactsRequest& request, PutArtifactsResponse* response) {
-  return ExecuteTransaction(
-      metadata_source_.get(),
+  return ExecuteWriteTransaction(
       [this, &request, &response]() -> tensorflow::Status {
         for (const Artifact& artifact : request.artifacts()) {
           int64 artifact_id = -1;
           TF_RETURN_IF_ERROR(UpsertArtifact(
               artifact, metadata_access_object_.get(), &artifact_id));
+          if (node_cache_ != nullptr) node_cache_->EraseArtifact(artifact_id);
+          RecordChange(UpsertChange(artifact, artifact_id));
           response->add_artifact_ids(artifact_id);
         }
         return tensorflow::Status::OK();
@@ -451,13 +1030,14 @@ tensorflow::Status MetadataStore::PutArtifacts(
 
 tensorflow::Status MetadataStore::PutExecutions(
     const PutExecutionsRequest& request, PutExecutionsResponse* response) {
-  return ExecuteTransaction(
-      metadata_source_.get(),
+  return ExecuteWriteTransaction(
       [this, &request, &response]() -> tensorflow::Status {
         for (const Execution& execution : request.executions()) {
           int64 execution_id = -1;
           TF_RETURN_IF_ERROR(UpsertExecution(
               execution, metadata_access_object_.get(), &execution_id));
+          if (node_cache_ != nullptr) node_cache_->EraseExecution(execution_id);
+          RecordChange(UpsertChange(execution, execution_id));
           response->add_execution_ids(execution_id);
         }
         return tensorflow::Status::OK();
@@ -466,13 +1046,14 @@ tensorflow::Status MetadataStore::PutExecutions(
 
 tensorflow::Status MetadataStore::PutContexts(const PutContextsRequest& request,
                                               PutContextsResponse* response) {
-  return ExecuteTransaction(
-      metadata_source_.get(),
+  return ExecuteWriteTransaction(
       [this, &request, &response]() -> tensorflow::Status {
         for (const Context& context : request.contexts()) {
           int64 context_id = -1;
           TF_RETURN_IF_ERROR(UpsertContext(
               context, metadata_access_object_.get(), &context_id));
+          if (node_cache_ != nullptr) node_cache_->EraseContext(context_id);
+          RecordChange(UpsertChange(context, context_id));
           response->add_context_ids(context_id);
         }
         return tensorflow::Status::OK();
@@ -509,22 +1090,28 @@ tensorflow::Status MetadataStore::Create(
 
 tensorflow::Status MetadataStore::PutEvents(const PutEventsRequest& request,
                                             PutEventsResponse* response) {
-  return ExecuteTransaction(
-      metadata_source_.get(), [this, &request]() -> tensorflow::Status {
+  TF_RETURN_IF_ERROR(ExecuteWriteTransaction(
+      [this, &request]() -> tensorflow::Status {
+        TF_RETURN_IF_ERROR(metadata_access_object_->CreateEvents(
+            {request.events().begin(), request.events().end()}));
         for (const Event& event : request.events()) {
-          int64 dummy_event_id = -1;
-          TF_RETURN_IF_ERROR(
-              metadata_access_object_->CreateEvent(event, &dummy_event_id));
+          RecordChange(CreationChange(event));
         }
         return tensorflow::Status::OK();
-      });
+      }));
+  if (lineage_index_ != nullptr) {
+    lineage_index_->AddEvents(
+        std::vector<Event>(request.events().begin(), request.events().end()));
+  }
+  return tensorflow::Status::OK();
 }
 
 tensorflow::Status MetadataStore::PutExecution(
     const PutExecutionRequest& request, PutExecutionResponse* response) {
-  return ExecuteTransaction(
-      metadata_source_.get(),
-      [this, &request, &response]() -> tensorflow::Status {
+  // The events to add to the lineage index once the transaction commits.
+  std::vector<Event> created_events;
+  TF_RETURN_IF_ERROR(ExecuteWriteTransaction(
+      [this, &request, &response, &created_events]() -> tensorflow::Status {
         if (!request.has_execution()) {
           return tensorflow::errors::InvalidArgument("No execution is found: ",
                                                      request.DebugString());
@@ -534,6 +1121,8 @@ tensorflow::Status MetadataStore::PutExecution(
         int64 execution_id = -1;
         TF_RETURN_IF_ERROR(UpsertExecution(
             execution, metadata_access_object_.get(), &execution_id));
+        if (node_cache_ != nullptr) node_cache_->EraseExecution(execution_id);
+        RecordChange(UpsertChange(execution, execution_id));
         response->set_execution_id(execution_id);
         // 2. Upsert Artifacts and insert events
         for (const PutExecutionRequest::ArtifactAndEvent& artifact_and_event :
@@ -546,6 +1135,8 @@ tensorflow::Status MetadataStore::PutExecution(
           int64 artifact_id = -1;
           TF_RETURN_IF_ERROR(UpsertArtifact(
               artifact, metadata_access_object_.get(), &artifact_id));
+          if (node_cache_ != nullptr) node_cache_->EraseArtifact(artifact_id);
+          RecordChange(UpsertChange(artifact, artifact_id));
           response->add_artifact_ids(artifact_id);
           // insert event if any
           if (!artifact_and_event.has_event()) {
@@ -569,26 +1160,177 @@ tensorflow::Status MetadataStore::PutExecution(
                 request.DebugString());
           }
           event.set_execution_id(execution_id);
-          int64 dummy_event_id = -1;
-          TF_RETURN_IF_ERROR(
-              metadata_access_object_->CreateEvent(event, &dummy_event_id));
+          RecordChange(CreationChange(event));
+          created_events.push_back(std::move(event));
         }
+        TF_RETURN_IF_ERROR(
+            metadata_access_object_->CreateEvents(created_events));
         // 3. Upsert contexts and insert associations and attributions.
+        std::vector<Association> associations;
+        std::vector<Attribution> attributions;
         for (const Context& context : request.contexts()) {
           int64 context_id = -1;
           TF_RETURN_IF_ERROR(UpsertContext(
               context, metadata_access_object_.get(), &context_id));
+          if (node_cache_ != nullptr) node_cache_->EraseContext(context_id);
+          RecordChange(UpsertChange(context, context_id));
           response->add_context_ids(context_id);
+          AppendContextEdges(context_id, *response, &associations,
+                             &attributions);
+        }
+        return CreateContextEdgesIfNotExist(attributions, associations);
+      }));
+  if (lineage_index_ != nullptr) {
+    lineage_index_->AddEvents(created_events);
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::PutExecutionBatch(
+    const PutExecutionBatchRequest& request,
+    PutExecutionBatchResponse* response) {
+  // The events to add to the lineage index once the transaction commits.
+  std::vector<Event> created_events;
+  TF_RETURN_IF_ERROR(ExecuteWriteTransaction(
+      [this, &request, &response, &created_events]() -> tensorflow::Status {
+        response->Clear();
+        // 1. Update the given executions and artifacts, and collect the new
+        // ones to create them in bulk.
+        std::vector<Execution> new_executions;
+        std::vector<Artifact> new_artifacts;
+        for (const PutExecutionRequest& entry : request.executions()) {
+          if (!entry.has_execution()) {
+            return tensorflow::errors::InvalidArgument(
+                "No execution is found: ", entry.DebugString());
+          }
+          PutExecutionResponse* entry_response = response->add_executions();
+          if (entry.execution().has_id()) {
+            TF_RETURN_IF_ERROR(
+                metadata_access_object_->UpdateExecution(entry.execution()));
+            entry_response->set_execution_id(entry.execution().id());
+          } else {
+            new_executions.push_back(entry.execution());
+          }
+          for (const PutExecutionRequest::ArtifactAndEvent& artifact_and_event :
+               entry.artifact_event_pairs()) {
+            if (!artifact_and_event.has_artifact()) {
+              return tensorflow::errors::InvalidArgument(
+                  "Request has no artifact: ", entry.DebugString());
+            }
+            const Artifact& artifact = artifact_and_event.artifact();
+            if (artifact.has_id()) {
+              TF_RETURN_IF_ERROR(
+                  metadata_access_object_->UpdateArtifact(artifact));
+              entry_response->add_artifact_ids(artifact.id());
+            } else {
+              new_artifacts.push_back(artifact);
+              entry_response->add_artifact_ids(-1);
+            }
+          }
+        }
+        std::vector<int64> new_execution_ids;
+        TF_RETURN_IF_ERROR(metadata_access_object_->CreateExecutions(
+            new_executions, &new_execution_ids));
+        std::vector<int64> new_artifact_ids;
+        TF_RETURN_IF_ERROR(metadata_access_object_->CreateArtifacts(
+            new_artifacts, &new_artifact_ids));
+
+        // 2. Assign the ids of the new nodes, and insert the events in bulk.
+        auto next_execution_id = new_execution_ids.begin();
+        auto next_artifact_id = new_artifact_ids.begin();
+        for (int i = 0; i < request.executions_size(); ++i) {
+          const PutExecutionRequest& entry = request.executions(i);
+          PutExecutionResponse* entry_response =
+              response->mutable_executions(i);
+          const Execution& execution = entry.execution();
+          if (!execution.has_id()) {
+            entry_response->set_execution_id(*next_execution_id++);
+          }
+          const int64 execution_id = entry_response->execution_id();
+          if (node_cache_ != nullptr) node_cache_->EraseExecution(execution_id);
+          RecordChange(UpsertChange(execution, execution_id));
+          for (int j = 0; j < entry.artifact_event_pairs_size(); ++j) {
+            const PutExecutionRequest::ArtifactAndEvent& artifact_and_event =
+                entry.artifact_event_pairs(j);
+            const Artifact& artifact = artifact_and_event.artifact();
+            if (!artifact.has_id()) {
+              entry_response->set_artifact_ids(j, *next_artifact_id++);
+            }
+            const int64 artifact_id = entry_response->artifact_ids(j);
+            if (node_cache_ != nullptr) node_cache_->EraseArtifact(artifact_id);
+            RecordChange(UpsertChange(artifact, artifact_id));
+            if (!artifact_and_event.has_event()) continue;
+            Event event = artifact_and_event.event();
+            if (event.has_artifact_id() &&
+                (!artifact.has_id() || artifact_id != event.artifact_id())) {
+              return tensorflow::errors::InvalidArgument(
+                  "Request's event.artifact_id does not match with the given "
+                  "artifact: ",
+                  entry.DebugString());
+            }
+            event.set_artifact_id(artifact_id);
+            if (event.has_execution_id() &&
+                (!execution.has_id() || execution_id != event.execution_id())) {
+              return tensorflow::errors::InvalidArgument(
+                  "Request's event.execution_id does not match with the given "
+                  "execution: ",
+                  entry.DebugString());
+            }
+            event.set_execution_id(execution_id);
+            RecordChange(CreationChange(event));
+            created_events.push_back(std::move(event));
+          }
+        }
+        TF_RETURN_IF_ERROR(
+            metadata_access_object_->CreateEvents(created_events));
+
+        // 3. Upsert each context once, and insert the associations and
+        // attributions in bulk.
+        std::map<std::string, UpsertedContext> upserted_contexts;
+        const auto upsert_context =
+            [this, &upserted_contexts](
+                const Context& context,
+                int64* context_id) -> tensorflow::Status {
+          bool upserted = false;
           TF_RETURN_IF_ERROR(
-              InsertAssociationIfNotExist(context_id, response->execution_id(),
-                                          metadata_access_object_.get()));
-          for (const int64 artifact_id : response->artifact_ids()) {
-            TF_RETURN_IF_ERROR(InsertAttributionIfNotExist(
-                context_id, artifact_id, metadata_access_object_.get()));
+              UpsertContextOnce(context, metadata_access_object_.get(),
+                                &upserted_contexts, context_id, &upserted));
+          if (upserted) {
+            if (node_cache_ != nullptr) node_cache_->EraseContext(*context_id);
+            RecordChange(UpsertChange(context, *context_id));
           }
+          return tensorflow::Status::OK();
+        };
+        std::vector<Association> associations;
+        std::vector<Attribution> attributions;
+        for (const Context& context : request.contexts()) {
+          int64 context_id = -1;
+          TF_RETURN_IF_ERROR(upsert_context(context, &context_id));
+          response->add_context_ids(context_id);
         }
-        return tensorflow::Status::OK();
-      });
+        for (int i = 0; i < request.executions_size(); ++i) {
+          PutExecutionResponse* entry_response =
+              response->mutable_executions(i);
+          for (const Context& context : request.executions(i).contexts()) {
+            int64 context_id = -1;
+            TF_RETURN_IF_ERROR(upsert_context(context, &context_id));
+            entry_response->add_context_ids(context_id);
+          }
+          for (const int64 context_id : entry_response->context_ids()) {
+            AppendContextEdges(context_id, *entry_response, &associations,
+                               &attributions);
+          }
+          for (const int64 context_id : response->context_ids()) {
+            AppendContextEdges(context_id, *entry_response, &associations,
+                               &attributions);
+          }
+        }
+        return CreateContextEdgesIfNotExist(attributions, associations);
+      }));
+  if (lineage_index_ != nullptr) {
+    lineage_index_->AddEvents(created_events);
+  }
+  return tensorflow::Status::OK();
 }
 
 tensorflow::Status MetadataStore::GetEventsByExecutionIDs(
@@ -603,9 +1345,7 @@ tensorflow::Status MetadataStore::GetEventsByExecutionIDs(
               metadata_access_object_->FindEventsByExecution(execution_id,
                                                              &events);
           if (status.ok()) {
-            for (const Event& event : events) {
-              *response->mutable_events()->Add() = event;
-            }
+            MoveToRepeatedField(&events, response->mutable_events());
           } else if (!tensorflow::errors::IsNotFound(status)) {
             return status;
           }
@@ -626,9 +1366,7 @@ tensorflow::Status MetadataStore::GetEventsByArtifactIDs(
               metadata_access_object_->FindEventsByArtifact(artifact_id,
                                                             &events);
           if (status.ok()) {
-            for (const Event& event : events) {
-              *response->mutable_events()->Add() = event;
-            }
+            MoveToRepeatedField(&events, response->mutable_events());
           } else if (!tensorflow::errors::IsNotFound(status)) {
             return status;
           }
@@ -640,18 +1378,23 @@ tensorflow::Status MetadataStore::GetEventsByArtifactIDs(
 tensorflow::Status MetadataStore::GetExecutions(
     const GetExecutionsRequest& request, GetExecutionsResponse* response) {
   return ExecuteTransaction(
-      metadata_source_.get(), [this, &response]() -> tensorflow::Status {
+      metadata_source_.get(),
+      [this, &request, &response]() -> tensorflow::Status {
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
         std::vector<Execution> executions;
         const tensorflow::Status status =
-            metadata_access_object_->FindExecutions(&executions);
+            request.has_filter()
+                ? metadata_access_object_->FindExecutionsByFilter(
+                      request.filter(), &executions, read_mask)
+                : metadata_access_object_->FindExecutions(&executions,
+                                                          read_mask);
         if (tensorflow::errors::IsNotFound(status)) {
           return tensorflow::Status::OK();
         } else if (!status.ok()) {
           return status;
         }
-        for (const Execution& execution : executions) {
-          *response->mutable_executions()->Add() = execution;
-        }
+        MoveToRepeatedField(&executions, response->mutable_executions());
         return tensorflow::Status::OK();
       });
 }
@@ -659,18 +1402,22 @@ tensorflow::Status MetadataStore::GetExecutions(
 tensorflow::Status MetadataStore::GetArtifacts(
     const GetArtifactsRequest& request, GetArtifactsResponse* response) {
   return ExecuteTransaction(
-      metadata_source_.get(), [this, &response]() -> tensorflow::Status {
+      metadata_source_.get(),
+      [this, &request, &response]() -> tensorflow::Status {
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
         std::vector<Artifact> artifacts;
         const tensorflow::Status status =
-            metadata_access_object_->FindArtifacts(&artifacts);
+            request.has_filter()
+                ? metadata_access_object_->FindArtifactsByFilter(
+                      request.filter(), &artifacts, read_mask)
+                : metadata_access_object_->FindArtifacts(&artifacts, read_mask);
         if (tensorflow::errors::IsNotFound(status)) {
           return tensorflow::Status::OK();
         } else if (!status.ok()) {
           return status;
         }
-        for (const Artifact& artifact : artifacts) {
-          *response->mutable_artifacts()->Add() = artifact;
-        }
+        MoveToRepeatedField(&artifacts, response->mutable_artifacts());
         return tensorflow::Status::OK();
       });
 }
@@ -678,18 +1425,22 @@ tensorflow::Status MetadataStore::GetArtifacts(
 tensorflow::Status MetadataStore::GetContexts(const GetContextsRequest& request,
                                               GetContextsResponse* response) {
   return ExecuteTransaction(
-      metadata_source_.get(), [this, &response]() -> tensorflow::Status {
+      metadata_source_.get(),
+      [this, &request, &response]() -> tensorflow::Status {
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
         std::vector<Context> contexts;
         const tensorflow::Status status =
-            metadata_access_object_->FindContexts(&contexts);
+            request.has_filter()
+                ? metadata_access_object_->FindContextsByFilter(
+                      request.filter(), &contexts, read_mask)
+                : metadata_access_object_->FindContexts(&contexts, read_mask);
         if (tensorflow::errors::IsNotFound(status)) {
           return tensorflow::Status::OK();
         } else if (!status.ok()) {
           return status;
         }
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
-        }
+        MoveToRepeatedField(&contexts, response->mutable_contexts());
         return tensorflow::Status::OK();
       });
 }
@@ -707,9 +1458,8 @@ tensorflow::Status MetadataStore::GetArtifactTypes(
         } else if (!status.ok()) {
           return status;
         }
-        for (const ArtifactType& artifact_type : artifact_types) {
-          *response->mutable_artifact_types()->Add() = artifact_type;
-        }
+        MoveToRepeatedField(&artifact_types,
+                            response->mutable_artifact_types());
         return tensorflow::Status::OK();
       });
 }
@@ -727,9 +1477,8 @@ tensorflow::Status MetadataStore::GetExecutionTypes(
         } else if (!status.ok()) {
           return status;
         }
-        for (const ExecutionType& execution_type : execution_types) {
-          *response->mutable_execution_types()->Add() = execution_type;
-        }
+        MoveToRepeatedField(&execution_types,
+                            response->mutable_execution_types());
         return tensorflow::Status::OK();
       });
 }
@@ -746,9 +1495,8 @@ tensorflow::Status MetadataStore::GetContextTypes(
         } else if (!status.ok()) {
           return status;
         }
-        for (const ContextType& context_type : context_types) {
-          *response->mutable_context_types()->Add() = context_type;
-        }
+        MoveToRepeatedField(&context_types,
+                            response->mutable_context_types());
         return tensorflow::Status::OK();
       });
 }
@@ -761,18 +1509,19 @@ tensorflow::Status MetadataStore::GetArtifactsByURI(
       [this, &request, &response]() -> tensorflow::Status {
         absl::flat_hash_set<std::string> uris(request.uris().begin(),
                                               request.uris().end());
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
         for (const std::string& uri : uris) {
           std::vector<Artifact> artifacts;
           const tensorflow::Status status =
-              metadata_access_object_->FindArtifactsByURI(uri, &artifacts);
+              metadata_access_object_->FindArtifactsByURI(uri, &artifacts,
+                                                          read_mask);
           if (!status.ok() && !tensorflow::errors::IsNotFound(status)) {
             // If any none NotFound error returned, we do early stopping as
             // the query execution has internal db errors.
             return status;
           }
-          for (const Artifact& artifact : artifacts) {
-            *response->mutable_artifacts()->Add() = artifact;
-          }
+          MoveToRepeatedField(&artifacts, response->mutable_artifacts());
         }
         return tensorflow::Status::OK();
       });
@@ -792,17 +1541,22 @@ tensorflow::Status MetadataStore::GetArtifactsByType(
         } else if (!status.ok()) {
           return status;
         }
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
         std::vector<Artifact> artifacts;
-        status = metadata_access_object_->FindArtifactsByTypeId(
-            artifact_type.id(), &artifacts);
+        status = request.has_filter()
+                     ? metadata_access_object_->FindArtifactsByFilter(
+                           FilterWithTypeId(request.filter(),
+                                            artifact_type.id()),
+                           &artifacts, read_mask)
+                     : metadata_access_object_->FindArtifactsByTypeId(
+                           artifact_type.id(), &artifacts, read_mask);
         if (tensorflow::errors::IsNotFound(status)) {
           return tensorflow::Status::OK();
         } else if (!status.ok()) {
           return status;
         }
-        for (const Artifact& artifact : artifacts) {
-          *response->mutable_artifacts()->Add() = artifact;
-        }
+        MoveToRepeatedField(&artifacts, response->mutable_artifacts());
         return tensorflow::Status::OK();
       });
 }
@@ -821,17 +1575,22 @@ tensorflow::Status MetadataStore::GetExecutionsByType(
         } else if (!status.ok()) {
           return status;
         }
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
         std::vector<Execution> executions;
-        status = metadata_access_object_->FindExecutionsByTypeId(
-            execution_type.id(), &executions);
+        status = request.has_filter()
+                     ? metadata_access_object_->FindExecutionsByFilter(
+                           FilterWithTypeId(request.filter(),
+                                            execution_type.id()),
+                           &executions, read_mask)
+                     : metadata_access_object_->FindExecutionsByTypeId(
+                           execution_type.id(), &executions, read_mask);
         if (tensorflow::errors::IsNotFound(status)) {
           return tensorflow::Status::OK();
         } else if (!status.ok()) {
           return status;
         }
-        for (const Execution& execution : executions) {
-          *response->mutable_executions()->Add() = execution;
-        }
+        MoveToRepeatedField(&executions, response->mutable_executions());
         return tensorflow::Status::OK();
       });
 }
@@ -850,17 +1609,22 @@ tensorflow::Status MetadataStore::GetContextsByType(
         } else if (!status.ok()) {
           return status;
         }
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
         std::vector<Context> contexts;
-        status = metadata_access_object_->FindContextsByTypeId(
-            context_type.id(), &contexts);
+        status = request.has_filter()
+                     ? metadata_access_object_->FindContextsByFilter(
+                           FilterWithTypeId(request.filter(),
+                                            context_type.id()),
+                           &contexts, read_mask)
+                     : metadata_access_object_->FindContextsByTypeId(
+                           context_type.id(), &contexts, read_mask);
         if (tensorflow::errors::IsNotFound(status)) {
           return tensorflow::Status::OK();
         } else if (!status.ok()) {
           return status;
         }
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
-        }
+        MoveToRepeatedField(&contexts, response->mutable_contexts());
         return tensorflow::Status::OK();
       });
 }
@@ -868,6 +1632,14 @@ tensorflow::Status MetadataStore::GetContextsByType(
 tensorflow::Status MetadataStore::GetContextByTypeAndName(
     const GetContextByTypeAndNameRequest& request,
     GetContextByTypeAndNameResponse* response) {
+  // A cached context is returned without starting a transaction.
+  if (node_cache_ != nullptr &&
+      node_cache_->GetContextByTypeAndName(request.type_name(),
+                                           request.context_name(),
+                                           response->mutable_context())) {
+    return tensorflow::Status::OK();
+  }
+  response->clear_context();
   return ExecuteTransaction(
       metadata_source_.get(),
       [this, &request, &response]() -> tensorflow::Status {
@@ -887,27 +1659,84 @@ tensorflow::Status MetadataStore::GetContextByTypeAndName(
         } else if (!status.ok()) {
           return status;
         }
+        if (node_cache_ != nullptr) {
+          node_cache_->PutContextId(request.type_name(),
+                                    request.context_name(), context->id());
+          node_cache_->PutContext(*context);
+        }
         response->set_allocated_context(context);
         return tensorflow::Status::OK();
       });
 }
 
+tensorflow::Status MetadataStore::GetArtifactsByTypeAndNames(
+    const GetArtifactsByTypeAndNamesRequest& request,
+    GetArtifactsByTypeAndNamesResponse* response) {
+  return ExecuteTransaction(
+      metadata_source_.get(),
+      [this, &request, &response]() -> tensorflow::Status {
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
+        return FindNodesByTypeAndNames<ArtifactType, Artifact>(
+            request.type_name(), request.artifact_names(),
+            [this, read_mask](const int64 type_id,
+                              const std::vector<std::string>& names,
+                              std::vector<Artifact>* artifacts) {
+              return metadata_access_object_->FindArtifactsByTypeIdAndNames(
+                  type_id, names, artifacts, read_mask);
+            },
+            metadata_access_object_.get(), response->mutable_artifacts());
+      });
+}
+
+tensorflow::Status MetadataStore::GetExecutionsByTypeAndNames(
+    const GetExecutionsByTypeAndNamesRequest& request,
+    GetExecutionsByTypeAndNamesResponse* response) {
+  return ExecuteTransaction(
+      metadata_source_.get(),
+      [this, &request, &response]() -> tensorflow::Status {
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
+        return FindNodesByTypeAndNames<ExecutionType, Execution>(
+            request.type_name(), request.execution_names(),
+            [this, read_mask](const int64 type_id,
+                              const std::vector<std::string>& names,
+                              std::vector<Execution>* executions) {
+              return metadata_access_object_->FindExecutionsByTypeIdAndNames(
+                  type_id, names, executions, read_mask);
+            },
+            metadata_access_object_.get(), response->mutable_executions());
+      });
+}
+
+tensorflow::Status MetadataStore::GetContextsByTypeAndNames(
+    const GetContextsByTypeAndNamesRequest& request,
+    GetContextsByTypeAndNamesResponse* response) {
+  return ExecuteTransaction(
+      metadata_source_.get(),
+      [this, &request, &response]() -> tensorflow::Status {
+        const NodeReadMask* read_mask =
+            request.has_read_mask() ? &request.read_mask() : nullptr;
+        return FindNodesByTypeAndNames<ContextType, Context>(
+            request.type_name(), request.context_names(),
+            [this, read_mask](const int64 type_id,
+                              const std::vector<std::string>& names,
+                              std::vector<Context>* contexts) {
+              return metadata_access_object_->FindContextsByTypeIdAndNames(
+                  type_id, names, contexts, read_mask);
+            },
+            metadata_access_object_.get(), response->mutable_contexts());
+      });
+}
+
 tensorflow::Status MetadataStore::PutAttributionsAndAssociations(
     const PutAttributionsAndAssociationsRequest& request,
     PutAttributionsAndAssociationsResponse* response) {
-  return ExecuteTransaction(
-      metadata_source_.get(), [this, &request]() -> tensorflow::Status {
-        for (const Attribution& attribution : request.attributions()) {
-          TF_RETURN_IF_ERROR(InsertAttributionIfNotExist(
-              attribution.context_id(), attribution.artifact_id(),
-              metadata_access_object_.get()));
-        }
-        for (const Association& association : request.associations()) {
-          TF_RETURN_IF_ERROR(InsertAssociationIfNotExist(
-              association.context_id(), association.execution_id(),
-              metadata_access_object_.get()));
-        }
-        return tensorflow::Status::OK();
+  return ExecuteWriteTransaction(
+      [this, &request]() -> tensorflow::Status {
+        return CreateContextEdgesIfNotExist(
+            {request.attributions().begin(), request.attributions().end()},
+            {request.associations().begin(), request.associations().end()});
       });
 }
 
@@ -920,9 +1749,7 @@ tensorflow::Status MetadataStore::GetContextsByArtifact(
         std::vector<Context> contexts;
         TF_RETURN_IF_ERROR(metadata_access_object_->FindContextsByArtifact(
             request.artifact_id(), &contexts));
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
-        }
+        MoveToRepeatedField(&contexts, response->mutable_contexts());
         return tensorflow::Status::OK();
       });
 }
@@ -936,9 +1763,7 @@ tensorflow::Status MetadataStore::GetContextsByExecution(
         std::vector<Context> contexts;
         TF_RETURN_IF_ERROR(metadata_access_object_->FindContextsByExecution(
             request.execution_id(), &contexts));
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
-        }
+        MoveToRepeatedField(&contexts, response->mutable_contexts());
         return tensorflow::Status::OK();
       });
 }
@@ -952,9 +1777,7 @@ tensorflow::Status MetadataStore::GetArtifactsByContext(
         std::vector<Artifact> artifacts;
         TF_RETURN_IF_ERROR(metadata_access_object_->FindArtifactsByContext(
             request.context_id(), &artifacts));
-        for (const Artifact& artifact : artifacts) {
-          *response->mutable_artifacts()->Add() = artifact;
-        }
+        MoveToRepeatedField(&artifacts, response->mutable_artifacts());
         return tensorflow::Status::OK();
       });
 }
@@ -968,11 +1791,574 @@ tensorflow::Status MetadataStore::GetExecutionsByContext(
         std::vector<Execution> executions;
         TF_RETURN_IF_ERROR(metadata_access_object_->FindExecutionsByContext(
             request.context_id(), &executions));
-        for (const Execution& execution : executions) {
-          *response->mutable_executions()->Add() = execution;
+        MoveToRepeatedField(&executions, response->mutable_executions());
+        return tensorflow::Status::OK();
+      });
+}
+
+tensorflow::Status MetadataStore::CountArtifacts(
+    const CountArtifactsRequest& request, CountArtifactsResponse* response) {
+  return ExecuteTransaction(
+      metadata_source_.get(),
+      [this, &request, &response]() -> tensorflow::Status {
+        std::vector<NodeCount> counts;
+        TF_RETURN_IF_ERROR(metadata_access_object_->CountArtifacts(
+            request.filter(), GetGroupBy(request.group_by()), &counts));
+        MoveToRepeatedField(&counts, response->mutable_counts());
+        return tensorflow::Status::OK();
+      });
+}
+
+tensorflow::Status MetadataStore::CountExecutions(
+    const CountExecutionsRequest& request, CountExecutionsResponse* response) {
+  return ExecuteTransaction(
+      metadata_source_.get(),
+      [this, &request, &response]() -> tensorflow::Status {
+        std::vector<NodeCount> counts;
+        TF_RETURN_IF_ERROR(metadata_access_object_->CountExecutions(
+            request.filter(), GetGroupBy(request.group_by()), &counts));
+        MoveToRepeatedField(&counts, response->mutable_counts());
+        return tensorflow::Status::OK();
+      });
+}
+
+tensorflow::Status MetadataStore::CountContexts(
+    const CountContextsRequest& request, CountContextsResponse* response) {
+  return ExecuteTransaction(
+      metadata_source_.get(),
+      [this, &request, &response]() -> tensorflow::Status {
+        std::vector<NodeCount> counts;
+        TF_RETURN_IF_ERROR(metadata_access_object_->CountContexts(
+            request.filter(), GetGroupBy(request.group_by()), &counts));
+        MoveToRepeatedField(&counts, response->mutable_counts());
+        return tensorflow::Status::OK();
+      });
+}
+
+tensorflow::Status MetadataStore::DeleteArtifacts(
+    const DeleteArtifactsRequest& request, DeleteArtifactsResponse* response) {
+  return DeleteNodesInChunks(
+      [this](const std::function<tensorflow::Status()>& transaction) {
+        return ExecuteWriteTransaction(transaction);
+      },
+      request.artifact_ids(), request.chunk_size(),
+      [this, &request](const std::vector<int64>& artifact_ids,
+                       std::map<std::string, int64>* num_deleted_rows) {
+        TF_RETURN_IF_ERROR(metadata_access_object_->DeleteArtifacts(
+            artifact_ids, request.dry_run(), num_deleted_rows));
+        if (request.dry_run()) return tensorflow::Status::OK();
+        for (const int64 artifact_id : artifact_ids) {
+          RecordChange(DeletionChange(&Change::mutable_artifact, artifact_id));
+        }
+        return tensorflow::Status::OK();
+      },
+      [this, &request](const std::vector<int64>& artifact_ids) {
+        if (request.dry_run()) return;
+        if (lineage_index_ != nullptr) {
+          lineage_index_->RemoveNodes(artifact_ids, /*execution_ids=*/{});
+        }
+        if (node_cache_ == nullptr) return;
+        for (const int64 artifact_id : artifact_ids) {
+          node_cache_->EraseArtifact(artifact_id);
+        }
+      },
+      response->mutable_num_deleted_rows());
+}
+
+tensorflow::Status MetadataStore::DeleteExecutions(
+    const DeleteExecutionsRequest& request,
+    DeleteExecutionsResponse* response) {
+  return DeleteNodesInChunks(
+      [this](const std::function<tensorflow::Status()>& transaction) {
+        return ExecuteWriteTransaction(transaction);
+      },
+      request.execution_ids(), request.chunk_size(),
+      [this, &request](const std::vector<int64>& execution_ids,
+                       std::map<std::string, int64>* num_deleted_rows) {
+        TF_RETURN_IF_ERROR(metadata_access_object_->DeleteExecutions(
+            execution_ids, request.dry_run(), num_deleted_rows));
+        if (request.dry_run()) return tensorflow::Status::OK();
+        for (const int64 execution_id : execution_ids) {
+          RecordChange(
+              DeletionChange(&Change::mutable_execution, execution_id));
+        }
+        return tensorflow::Status::OK();
+      },
+      [this, &request](const std::vector<int64>& execution_ids) {
+        if (request.dry_run()) return;
+        if (lineage_index_ != nullptr) {
+          lineage_index_->RemoveNodes(/*artifact_ids=*/{}, execution_ids);
+        }
+        if (node_cache_ == nullptr) return;
+        for (const int64 execution_id : execution_ids) {
+          node_cache_->EraseExecution(execution_id);
+        }
+      },
+      response->mutable_num_deleted_rows());
+}
+
+tensorflow::Status MetadataStore::DeleteContexts(
+    const DeleteContextsRequest& request, DeleteContextsResponse* response) {
+  return DeleteNodesInChunks(
+      [this](const std::function<tensorflow::Status()>& transaction) {
+        return ExecuteWriteTransaction(transaction);
+      },
+      request.context_ids(), request.chunk_size(),
+      [this, &request](const std::vector<int64>& context_ids,
+                       std::map<std::string, int64>* num_deleted_rows) {
+        TF_RETURN_IF_ERROR(metadata_access_object_->DeleteContexts(
+            context_ids, request.dry_run(), num_deleted_rows));
+        if (request.dry_run()) return tensorflow::Status::OK();
+        for (const int64 context_id : context_ids) {
+          RecordChange(DeletionChange(&Change::mutable_context, context_id));
+        }
+        return tensorflow::Status::OK();
+      },
+      [this, &request](const std::vector<int64>& context_ids) {
+        if (request.dry_run() || node_cache_ == nullptr) return;
+        for (const int64 context_id : context_ids) {
+          node_cache_->EraseContext(context_id);
+        }
+      },
+      response->mutable_num_deleted_rows());
+}
+
+tensorflow::Status MetadataStore::CompactNextChunk(
+    const CompactionConfig& config, int64* num_deleted_nodes) {
+  TF_RETURN_IF_ERROR(ValidateCompactionConfig(config));
+  const int64 chunk_size =
+      config.chunk_size() > 0 ? config.chunk_size() : kDefaultDeletionChunkSize;
+  const int64 now_millis = absl::ToUnixMillis(absl::Now());
+  CompactionChunk chunk;
+  std::map<std::string, int64> num_deleted_rows;
+  TF_RETURN_IF_ERROR(ExecuteWriteTransaction(
+      [this, &config, chunk_size, now_millis, &chunk,
+       &num_deleted_rows]() -> tensorflow::Status {
+        chunk = CompactionChunk();
+        num_deleted_rows.clear();
+        TF_RETURN_IF_ERROR(FindCompactionChunk(config, chunk_size, now_millis,
+                                               metadata_access_object_.get(),
+                                               &chunk));
+        TF_RETURN_IF_ERROR(metadata_access_object_->DeleteArtifacts(
+            chunk.artifact_ids, /*dry_run=*/false, &num_deleted_rows));
+        TF_RETURN_IF_ERROR(metadata_access_object_->DeleteExecutions(
+            chunk.execution_ids, /*dry_run=*/false, &num_deleted_rows));
+        TF_RETURN_IF_ERROR(metadata_access_object_->DeleteContexts(
+            chunk.context_ids, /*dry_run=*/false, &num_deleted_rows));
+        for (const int64 artifact_id : chunk.artifact_ids) {
+          RecordChange(DeletionChange(&Change::mutable_artifact, artifact_id));
+        }
+        for (const int64 execution_id : chunk.execution_ids) {
+          RecordChange(
+              DeletionChange(&Change::mutable_execution, execution_id));
+        }
+        for (const int64 context_id : chunk.context_ids) {
+          RecordChange(DeletionChange(&Change::mutable_context, context_id));
         }
         return tensorflow::Status::OK();
+      }));
+  if (node_cache_ != nullptr) {
+    for (const int64 artifact_id : chunk.artifact_ids) {
+      node_cache_->EraseArtifact(artifact_id);
+    }
+    for (const int64 execution_id : chunk.execution_ids) {
+      node_cache_->EraseExecution(execution_id);
+    }
+    for (const int64 context_id : chunk.context_ids) {
+      node_cache_->EraseContext(context_id);
+    }
+  }
+  if (lineage_index_ != nullptr) {
+    lineage_index_->RemoveNodes(chunk.artifact_ids, chunk.execution_ids);
+  }
+  compaction_stats_.set_num_chunks(compaction_stats_.num_chunks() + 1);
+  compaction_stats_.set_num_deleted_artifacts(
+      compaction_stats_.num_deleted_artifacts() + chunk.artifact_ids.size());
+  compaction_stats_.set_num_deleted_executions(
+      compaction_stats_.num_deleted_executions() + chunk.execution_ids.size());
+  compaction_stats_.set_num_deleted_contexts(
+      compaction_stats_.num_deleted_contexts() + chunk.context_ids.size());
+  compaction_stats_.set_last_chunk_time_since_epoch(now_millis);
+  *num_deleted_nodes = chunk.size();
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::EnableLineageIndex(
+    const LineageIndexConfig& config) {
+  std::vector<Event> events;
+  TF_RETURN_IF_ERROR(ExecuteTransaction(
+      metadata_source_.get(), [this, &events]() -> tensorflow::Status {
+        return metadata_access_object_->FindEventEdges(&events);
+      }));
+  lineage_index_ = absl::make_unique<LineageIndex>(config.max_memory_bytes());
+  lineage_index_->Build(events);
+  LOG(INFO) << "Lineage index is built with " << lineage_index_->num_edges()
+            << " edges using " << lineage_index_->memory_bytes() << " bytes.";
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::GetLineageNodes(
+    const GetLineageNodesRequest& request, GetLineageNodesResponse* response) {
+  const bool upstream =
+      request.direction() != GetLineageNodesRequest::DOWNSTREAM;
+  const bool downstream =
+      request.direction() != GetLineageNodesRequest::UPSTREAM;
+  if (lineage_index_ != nullptr && lineage_index_->enabled()) {
+    num_index_traversals_++;
+    return TraverseLineage(
+        request,
+        [this, upstream, downstream](
+            int64 artifact_id,
+            std::vector<int64>* execution_ids) -> tensorflow::Status {
+          if (downstream) {
+            lineage_index_->AppendConsumers(artifact_id, execution_ids);
+          }
+          if (upstream) {
+            lineage_index_->AppendProducers(artifact_id, execution_ids);
+          }
+          return tensorflow::Status::OK();
+        },
+        [this, upstream, downstream](
+            int64 execution_id,
+            std::vector<int64>* artifact_ids) -> tensorflow::Status {
+          if (downstream) {
+            lineage_index_->AppendOutputs(execution_id, artifact_ids);
+          }
+          if (upstream) {
+            lineage_index_->AppendInputs(execution_id, artifact_ids);
+          }
+          return tensorflow::Status::OK();
+        },
+        response);
+  }
+  num_fallback_traversals_++;
+  return ExecuteTransaction(
+      metadata_source_.get(),
+      [this, &request, &response, upstream,
+       downstream]() -> tensorflow::Status {
+        return TraverseLineage(
+            request,
+            [this, upstream, downstream](
+                int64 artifact_id,
+                std::vector<int64>* execution_ids) -> tensorflow::Status {
+              std::vector<Event> events;
+              const tensorflow::Status status =
+                  metadata_access_object_->FindEventsByArtifact(artifact_id,
+                                                                &events);
+              if (!status.ok() && !tensorflow::errors::IsNotFound(status)) {
+                return status;
+              }
+              for (const Event& event : events) {
+                if ((downstream && LineageIndex::IsInputEvent(event.type())) ||
+                    (upstream && LineageIndex::IsOutputEvent(event.type()))) {
+                  execution_ids->push_back(event.execution_id());
+                }
+              }
+              return tensorflow::Status::OK();
+            },
+            [this, upstream, downstream](
+                int64 execution_id,
+                std::vector<int64>* artifact_ids) -> tensorflow::Status {
+              std::vector<Event> events;
+              const tensorflow::Status status =
+                  metadata_access_object_->FindEventsByExecution(execution_id,
+                                                                 &events);
+              if (!status.ok() && !tensorflow::errors::IsNotFound(status)) {
+                return status;
+              }
+              for (const Event& event : events) {
+                if ((upstream && LineageIndex::IsInputEvent(event.type())) ||
+                    (downstream && LineageIndex::IsOutputEvent(event.type()))) {
+                  artifact_ids->push_back(event.artifact_id());
+                }
+              }
+              return tensorflow::Status::OK();
+            },
+            response);
+      });
+}
+
+tensorflow::Status MetadataStore::EnableNodeCache(
+    const NodeCacheConfig& config) {
+  if (config.max_num_entries() <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The node cache needs a positive max_num_entries: ",
+        config.DebugString());
+  }
+  node_cache_ = absl::make_unique<NodeCache>(config.max_num_entries());
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::EnableChangeLog(
+    const ChangeLogConfig& config) {
+  if (config.max_num_changes() <= 0 || config.max_num_watchers() <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The change log needs a positive max_num_changes and "
+        "max_num_watchers: ",
+        config.DebugString());
+  }
+  // The log id of a new change log is its creation time.
+  int64 log_id = 0;
+  int64 last_sequence = 0;
+  TF_RETURN_IF_ERROR(ExecuteTransaction(
+      metadata_source_.get(), [this, &log_id, &last_sequence]() {
+        return metadata_access_object_->InitChangeLog(
+            absl::ToUnixMicros(absl::Now()), &log_id, &last_sequence);
+      }));
+  change_log_ = absl::make_unique<ChangeLog>(log_id, last_sequence,
+                                             config.max_num_changes(),
+                                             config.max_num_watchers());
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::GetChanges(const WatchChangesRequest& request,
+                                             WatchChangesResponse* response) {
+  if (change_log_ == nullptr) {
+    return tensorflow::errors::FailedPrecondition(
+        "The change log is not enabled.");
+  }
+  if (request.has_log_id() && request.log_id() != change_log_->log_id()) {
+    return tensorflow::errors::OutOfRange(
+        "The cursor is of the change log ", request.log_id(),
+        " instead of the current change log ", change_log_->log_id());
+  }
+  const int64 after_sequence = request.has_after_sequence()
+                                   ? request.after_sequence()
+                                   : change_log_->last_sequence();
+  const int64 max_num_changes = request.max_num_changes() > 0
+                                    ? request.max_num_changes()
+                                    : change_log_->max_num_changes();
+  std::vector<Change> changes;
+  TF_RETURN_IF_ERROR(
+      change_log_->Read(after_sequence, max_num_changes, &changes));
+  response->set_log_id(change_log_->log_id());
+  response->set_last_sequence(changes.empty() ? after_sequence
+                                              : changes.back().sequence());
+  MoveToRepeatedField(&changes, response->mutable_changes());
+  return tensorflow::Status::OK();
+}
+
+bool MetadataStore::WaitForChanges(const int64 after_sequence,
+                                   const absl::Duration timeout) {
+  if (change_log_ == nullptr) return false;
+  return change_log_->WaitForChanges(after_sequence, timeout);
+}
+
+tensorflow::Status MetadataStore::AddChangeWatcher() {
+  if (change_log_ == nullptr) {
+    return tensorflow::errors::FailedPrecondition(
+        "The change log is not enabled.");
+  }
+  return change_log_->AddWatcher();
+}
+
+void MetadataStore::RemoveChangeWatcher() {
+  if (change_log_ != nullptr) change_log_->RemoveWatcher();
+}
+
+tensorflow::Status MetadataStore::GetStoreStats(
+    const GetStoreStatsRequest& request, GetStoreStatsResponse* response) {
+  if (lineage_index_ != nullptr) {
+    LineageIndexStats* stats = response->mutable_lineage_index_stats();
+    stats->set_enabled(lineage_index_->enabled());
+    stats->set_num_edges(lineage_index_->num_edges());
+    stats->set_memory_bytes(lineage_index_->memory_bytes());
+    stats->set_max_memory_bytes(lineage_index_->max_memory_bytes());
+    stats->set_num_index_traversals(num_index_traversals_);
+    stats->set_num_fallback_traversals(num_fallback_traversals_);
+  }
+  if (node_cache_ != nullptr) {
+    NodeCacheStats* stats = response->mutable_node_cache_stats();
+    stats->set_num_entries(node_cache_->num_entries());
+    stats->set_max_num_entries(node_cache_->max_num_entries());
+    stats->set_num_hits(node_cache_->num_hits());
+    stats->set_num_misses(node_cache_->num_misses());
+  }
+  if (compaction_stats_.num_chunks() > 0) {
+    *response->mutable_compaction_stats() = compaction_stats_;
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::EnableBackups(const BackupConfig& config) {
+  absl::string_view directory = config.directory();
+  TF_RETURN_IF_ERROR(CheckAbsolutePath(directory));
+  absl::ConsumeSuffix(&directory, "/");
+  backup_directory_ = std::string(directory);
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::BackupStore(const BackupStoreRequest& request,
+                                              BackupStoreResponse* response,
+                                              absl::Mutex* step_lock) {
+  if (backup_directory_.empty()) {
+    return tensorflow::errors::FailedPrecondition(
+        "The backups are not enabled.");
+  }
+  if (request.destination_filename_uri().empty()) {
+    return tensorflow::errors::InvalidArgument(
+        "No destination_filename_uri is given.");
+  }
+  // The destination is opened as a plain path, so that the uri parameters,
+  // e.g., vfs, are not passed on.
+  absl::string_view destination_path = request.destination_filename_uri();
+  if (absl::ConsumePrefix(&destination_path, "file:") &&
+      absl::ConsumePrefix(&destination_path, "//")) {
+    // the authority should be empty or localhost.
+    absl::ConsumePrefix(&destination_path, "localhost");
+  }
+  if (destination_path.find_first_of("?#%") != absl::string_view::npos) {
+    return tensorflow::errors::InvalidArgument(
+        "The destination_filename_uri cannot have parameters or escapes: ",
+        request.destination_filename_uri());
+  }
+  TF_RETURN_IF_ERROR(CheckAbsolutePath(destination_path));
+  if (destination_path.substr(0, destination_path.rfind('/')) !=
+      backup_directory_) {
+    return tensorflow::errors::InvalidArgument(
+        "The destination_filename_uri is not directly within the backup "
+        "directory ",
+        backup_directory_, ": ", request.destination_filename_uri());
+  }
+  int64 num_pages = 0;
+  TF_RETURN_IF_ERROR(metadata_source_->Backup(
+      std::string(destination_path), request.pages_per_step(),
+      absl::Milliseconds(request.step_interval_millis()), step_lock,
+      &num_pages));
+  response->set_num_pages(num_pages);
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status MetadataStore::ExecuteGroupTransaction(
+    const std::vector<std::function<tensorflow::Status()>>& calls,
+    std::vector<tensorflow::Status>* statuses) {
+  statuses->assign(calls.size(), tensorflow::Status::OK());
+  // The calls use ExecuteTransaction as well, which runs them within
+  // savepoints of the group transaction.
+  const tensorflow::Status status = ExecuteWriteTransaction(
+      [&calls, &statuses]() -> tensorflow::Status {
+        for (int i = 0; i < calls.size(); ++i) {
+          (*statuses)[i] = calls[i]();
+        }
+        return tensorflow::Status::OK();
+      });
+  if (status.ok()) {
+    return tensorflow::Status::OK();
+  }
+  statuses->assign(calls.size(), status);
+  // The lineage index may have observed the events of the rolled back calls.
+  RebuildLineageIndex();
+  return status;
+}
+
+tensorflow::Status MetadataStore::ExportStore(
+    const int64 page_size, google::protobuf::io::ZeroCopyOutputStream* output) {
+  return ExportSnapshot(page_size, metadata_source_.get(),
+                        metadata_access_object_.get(), output);
+}
+
+tensorflow::Status MetadataStore::ImportStore(
+    const int64 batch_size, google::protobuf::io::ZeroCopyInputStream* input) {
+  // The events of a batch are added to the lineage index once it commits.
+  std::vector<Event> batch_events;
+  return ImportSnapshot(
+      batch_size,
+      [this, &batch_events](const std::function<tensorflow::Status()>&
+                                transaction) -> tensorflow::Status {
+        batch_events.clear();
+        TF_RETURN_IF_ERROR(ExecuteWriteTransaction(transaction));
+        if (lineage_index_ != nullptr) lineage_index_->AddEvents(batch_events);
+        return tensorflow::Status::OK();
+      },
+      metadata_access_object_.get(),
+      [this, &batch_events](const ImportedRecords& records) {
+        for (const Artifact& artifact : records.artifacts) {
+          RecordChange(CreationChange(artifact));
+        }
+        for (const Execution& execution : records.executions) {
+          RecordChange(CreationChange(execution));
+        }
+        for (const Context& context : records.contexts) {
+          RecordChange(CreationChange(context));
+        }
+        for (const Event& event : records.events) {
+          RecordChange(CreationChange(event));
+        }
+        for (const Attribution& attribution : records.attributions) {
+          RecordChange(CreationChange(attribution));
+        }
+        for (const Association& association : records.associations) {
+          RecordChange(CreationChange(association));
+        }
+        batch_events = records.events;
+      },
+      input);
+}
+
+tensorflow::Status MetadataStore::ExecuteWriteTransaction(
+    const std::function<tensorflow::Status()>& transaction) {
+  // The writes nested in the transaction of another one, e.g., of a group
+  // commit, are published along with it.
+  const bool is_nested = metadata_source_->transaction_open();
+  const size_t num_pending_changes = pending_changes_.size();
+  int64 last_sequence = 0;
+  const tensorflow::Status status = ExecuteTransaction(
+      metadata_source_.get(),
+      [this, &transaction, is_nested,
+       &last_sequence]() -> tensorflow::Status {
+        TF_RETURN_IF_ERROR(transaction());
+        if (is_nested || pending_changes_.empty()) {
+          return tensorflow::Status::OK();
+        }
+        // The sequences are committed along with the changes.
+        return metadata_access_object_->AdvanceChangeLog(
+            pending_changes_.size(), &last_sequence);
       });
+  if (!status.ok()) pending_changes_.resize(num_pending_changes);
+  if (!is_nested) PublishChanges(last_sequence);
+  return status;
+}
+
+void MetadataStore::RecordChange(Change change) {
+  if (change_log_ == nullptr) return;
+  pending_changes_.push_back(std::move(change));
+}
+
+tensorflow::Status MetadataStore::CreateContextEdgesIfNotExist(
+    const std::vector<Attribution>& attributions,
+    const std::vector<Association>& associations) {
+  std::vector<Attribution> created_attributions;
+  TF_RETURN_IF_ERROR(metadata_access_object_->CreateAttributionsIfNotExist(
+      attributions, &created_attributions));
+  for (const Attribution& attribution : created_attributions) {
+    RecordChange(CreationChange(attribution));
+  }
+  std::vector<Association> created_associations;
+  TF_RETURN_IF_ERROR(metadata_access_object_->CreateAssociationsIfNotExist(
+      associations, &created_associations));
+  for (const Association& association : created_associations) {
+    RecordChange(CreationChange(association));
+  }
+  return tensorflow::Status::OK();
+}
+
+void MetadataStore::PublishChanges(const int64 last_sequence) {
+  if (change_log_ != nullptr) {
+    change_log_->Append(last_sequence, std::move(pending_changes_));
+  }
+  pending_changes_.clear();
+}
+
+void MetadataStore::RebuildLineageIndex() {
+  if (lineage_index_ == nullptr) return;
+  LineageIndexConfig config;
+  config.set_max_memory_bytes(lineage_index_->max_memory_bytes());
+  const tensorflow::Status rebuild_status = EnableLineageIndex(config);
+  if (!rebuild_status.ok()) {
+    LOG(WARNING) << "Lineage index is dropped as it cannot be rebuilt: "
+                 << rebuild_status;
+    lineage_index_.reset();
+  }
 }
 
 MetadataStore::MetadataStore(
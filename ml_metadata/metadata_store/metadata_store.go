@@ -18,7 +18,9 @@ package mlmetadata
 
 import (
 	"errors"
+	"fmt"
 	"log"
+	"sync"
 
 	"github.com/golang/protobuf/proto"
 	wrap "ml_metadata/metadata_store/metadata_store_go_wrap"
@@ -28,36 +30,105 @@ import (
 
 // Store type provides a list of Go functions to access the methods defined in
 // metadata_store/metadata_store.h and proto/metadata_store_service.proto
-// It contains a pointer to the shared metadata_store cc library. The instance
-// of it should be created with NewStore and destroyed with store.Close to avoid
-// memory leak allocated in cc library.
+// It contains a pool of pointers to the shared metadata_store cc library, each
+// with its own connection to the database. Each call takes one of them from the
+// pool, so the Store can be used by many goroutines, and up to pool size calls
+// run in parallel. The instance of it should be created with NewStore or
+// NewPooledStore and destroyed with store.Close to avoid memory leak allocated
+// in cc library.
 type Store struct {
-	ptr wrap.Ml_metadata_MetadataStore
+	// Guards closed and size.
+	mu     sync.Mutex
+	closed bool
+	// The cc stores which are not used by any call.
+	pool chan wrap.Ml_metadata_MetadataStore
+	size int
 }
 
-// NewStore creates Store instance given a connection config.
+var errStoreClosed = errors.New("the Store is closed")
+
+// NewStore creates Store instance given a connection config. The calls to the
+// Store are serialized on one connection.
 func NewStore(config *mdpb.ConnectionConfig) (*Store, error) {
-	status := wrap.NewStatus()
-	defer wrap.DeleteStatus(status)
+	return NewPooledStore(config, 1)
+}
 
+// NewPooledStore creates Store instance with `poolSize` connections given a
+// connection config. An in-memory database cannot be shared by connections, so
+// `poolSize` must be 1 for a fake database or a sqlite database without a
+// filename_uri.
+func NewPooledStore(config *mdpb.ConnectionConfig, poolSize int) (*Store, error) {
+	if poolSize < 1 {
+		return nil, fmt.Errorf("poolSize must be positive, got %v", poolSize)
+	}
+	if poolSize > 1 && (config.GetFakeDatabase() != nil ||
+		(config.GetSqlite() != nil && config.GetSqlite().GetFilenameUri() == "")) {
+		return nil, errors.New("an in-memory database cannot be pooled")
+	}
 	b, err := proto.Marshal(config)
 	if err != nil {
 		log.Printf("Cannot marshal given connection config: %v. Error: %v\n", config, err)
 		return nil, err
 	}
-	s := wrap.CreateMetadataStore(string(b), status)
+	store := &Store{pool: make(chan wrap.Ml_metadata_MetadataStore, poolSize)}
+	for store.size < poolSize {
+		s, err := createMetadataStore(b)
+		if err != nil {
+			store.Close()
+			return nil, err
+		}
+		store.pool <- s
+		store.size++
+	}
+	return store, nil
+}
+
+func createMetadataStore(config []byte) (wrap.Ml_metadata_MetadataStore, error) {
+	status := wrap.NewStatus()
+	defer wrap.DeleteStatus(status)
+
+	s := wrap.CreateMetadataStore(string(config), status)
 	if !status.Ok() {
 		return nil, errors.New(status.Error_message())
 	}
-	return &Store{s}, nil
+	return s, nil
 }
 
-// Close frees allocated memory in cc library of the Store instance.
+// Close frees allocated memory in cc library of the Store instance. It waits
+// for the ongoing calls to finish. The calls waiting for a connection and the
+// calls after Close return an error. Close can be called more than once.
 func (store *Store) Close() {
-	if store.ptr != nil {
-		wrap.DestroyMetadataStore(store.ptr)
-		store.ptr = nil
+	store.mu.Lock()
+	if store.closed {
+		store.mu.Unlock()
+		return
+	}
+	store.closed = true
+	size := store.size
+	store.size = 0
+	store.mu.Unlock()
+	for ; size > 0; size-- {
+		wrap.DestroyMetadataStore(<-store.pool)
+	}
+	close(store.pool)
+}
+
+// acquire takes a cc store from the pool, which the caller returns to the pool
+// after its call. It returns an error if the Store is closed.
+func (store *Store) acquire() (wrap.Ml_metadata_MetadataStore, error) {
+	ptr, ok := <-store.pool
+	if !ok {
+		return nil, errStoreClosed
+	}
+	store.mu.Lock()
+	closed := store.closed
+	store.mu.Unlock()
+	if closed {
+		// Close is waiting for the cc store, so the pool is still open.
+		store.pool <- ptr
+		return nil, errStoreClosed
 	}
+	return ptr, nil
 }
 
 // ArtifactTypeID refers the id space of ArtifactType
@@ -590,7 +661,12 @@ func (store *Store) callMetadataStoreWrapMethod(fn metadataStoreMethod, req prot
 	if err != nil {
 		return err
 	}
-	wrt := fn(store.ptr, string(b), status)
+	ptr, err := store.acquire()
+	if err != nil {
+		return err
+	}
+	wrt := fn(ptr, string(b), status)
+	store.pool <- ptr
 	if !status.Ok() {
 		return errors.New(status.Error_message())
 	}
@@ -15,10 +15,18 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_H_
 #define ML_METADATA_METADATA_STORE_METADATA_STORE_H_
 
+#include <functional>
 #include <memory>
+#include <vector>
 
+#include "google/protobuf/io/zero_copy_stream.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/change_log.h"
+#include "ml_metadata/metadata_store/lineage_index.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/node_cache.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -306,6 +314,20 @@ class MetadataStore {
   tensorflow::Status PutExecution(const PutExecutionRequest& request,
                                   PutExecutionResponse* response);
 
+  // Records the executions in the request as PutExecution does, in a single
+  // transaction. The new executions and artifacts are created in bulk, and the
+  // shared `contexts` are associated with every execution and attributed to
+  // every artifact. A context given more than once, by id or by type and name,
+  // is upserted once.
+  //
+  // Returns a PutExecutionResponse per execution and a list of shared context
+  // ids index-aligned with the input.
+  // Returns the errors of PutExecution.
+  // Returns INVALID_ARGUMENT error, if a context given more than once has
+  // different properties or custom properties.
+  tensorflow::Status PutExecutionBatch(const PutExecutionBatchRequest& request,
+                                       PutExecutionBatchResponse* response);
+
   // Gets all events with matching execution ids.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status GetEventsByExecutionIDs(
@@ -325,14 +347,16 @@ class MetadataStore {
   tensorflow::Status GetArtifactsByID(const GetArtifactsByIDRequest& request,
                                       GetArtifactsByIDResponse* response);
 
-  // Gets all artifacts.
+  // Gets all artifacts, or only the ones satisfying request.filter if set.
+  // Returns INVALID_ARGUMENT error, if the filter is malformed.
   // Returns detailed INTERNAL error, if query execution fails.
-  // TODO(b/120853124): add predicates
   tensorflow::Status GetArtifacts(const GetArtifactsRequest& request,
                                   GetArtifactsResponse* response);
 
   // Gets all the artifacts of a given type. If no artifacts found, it returns
-  // OK and empty response.
+  // OK and empty response. If request.filter is set, only the artifacts
+  // satisfying it are returned.
+  // Returns INVALID_ARGUMENT error, if the filter is malformed.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status GetArtifactsByType(
       const GetArtifactsByTypeRequest& request,
@@ -351,14 +375,16 @@ class MetadataStore {
   tensorflow::Status GetExecutionsByID(const GetExecutionsByIDRequest& request,
                                        GetExecutionsByIDResponse* response);
 
-  // Gets all executions.
+  // Gets all executions, or only the ones satisfying request.filter if set.
+  // Returns INVALID_ARGUMENT error, if the filter is malformed.
   // Returns detailed INTERNAL error, if query execution fails.
-  // TODO(b/120853124): add predicates
   tensorflow::Status GetExecutions(const GetExecutionsRequest& request,
                                    GetExecutionsResponse* response);
 
   // Gets all the executions of a given type. If no executions found, it returns
-  // OK and empty response.
+  // OK and empty response. If request.filter is set, only the executions
+  // satisfying it are returned.
+  // Returns INVALID_ARGUMENT error, if the filter is malformed.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status GetExecutionsByType(
       const GetExecutionsByTypeRequest& request,
@@ -371,14 +397,16 @@ class MetadataStore {
   tensorflow::Status GetContextsByID(const GetContextsByIDRequest& request,
                                      GetContextsByIDResponse* response);
 
-  // Gets all contexts.
+  // Gets all contexts, or only the ones satisfying request.filter if set.
+  // Returns INVALID_ARGUMENT error, if the filter is malformed.
   // Returns detailed INTERNAL error, if query execution fails.
-  // TODO(b/120853124): add predicates
   tensorflow::Status GetContexts(const GetContextsRequest& request,
                                  GetContextsResponse* response);
 
   // Gets all the contexts of a given type. If no contexts found, it returns
-  // OK and empty response.
+  // OK and empty response. If request.filter is set, only the contexts
+  // satisfying it are returned.
+  // Returns INVALID_ARGUMENT error, if the filter is malformed.
   // Returns detailed INTERNAL error, if query execution fails.
   tensorflow::Status GetContextsByType(const GetContextsByTypeRequest& request,
                                        GetContextsByTypeResponse* response);
@@ -390,6 +418,30 @@ class MetadataStore {
       const GetContextByTypeAndNameRequest& request,
       GetContextByTypeAndNameResponse* response);
 
+  // Gets the artifacts of a given type with the given names, which are
+  // resolved in one query. The names that are not found are skipped. If the
+  // type is not found, it returns OK and empty response.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetArtifactsByTypeAndNames(
+      const GetArtifactsByTypeAndNamesRequest& request,
+      GetArtifactsByTypeAndNamesResponse* response);
+
+  // Gets the executions of a given type with the given names, which are
+  // resolved in one query. The names that are not found are skipped. If the
+  // type is not found, it returns OK and empty response.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetExecutionsByTypeAndNames(
+      const GetExecutionsByTypeAndNamesRequest& request,
+      GetExecutionsByTypeAndNamesResponse* response);
+
+  // Gets the contexts of a given type with the given names, which are
+  // resolved in one query. The names that are not found are skipped. If the
+  // type is not found, it returns OK and empty response.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetContextsByTypeAndNames(
+      const GetContextsByTypeAndNamesRequest& request,
+      GetContextsByTypeAndNamesResponse* response);
+
   // Inserts attribution and association relationships in the database.
   // The context_id, artifact_id, and execution_id must already exist.
   // If the relationship exists, this call does nothing. Once added, the
@@ -425,13 +477,245 @@ class MetadataStore {
       const GetExecutionsByContextRequest& request,
       GetExecutionsByContextResponse* response);
 
+  // Counts the artifacts satisfying request.filter, grouped by the distinct
+  // values of the request.group_by attributes. The counts are evaluated by
+  // the metadata source, without reading the artifacts.
+  // Returns INVALID_ARGUMENT error, if the filter has a limit, or if a
+  //   predicate or an attribute does not apply to artifacts.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status CountArtifacts(const CountArtifactsRequest& request,
+                                    CountArtifactsResponse* response);
+
+  // Counts the executions satisfying request.filter, grouped by the distinct
+  // values of the request.group_by attributes.
+  // Returns INVALID_ARGUMENT error, if the filter has a limit, or if a
+  //   predicate or an attribute does not apply to executions.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status CountExecutions(const CountExecutionsRequest& request,
+                                     CountExecutionsResponse* response);
+
+  // Counts the contexts satisfying request.filter, grouped by the distinct
+  // values of the request.group_by attributes.
+  // Returns INVALID_ARGUMENT error, if the filter has a limit, or if a
+  //   predicate or an attribute does not apply to contexts.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status CountContexts(const CountContextsRequest& request,
+                                   CountContextsResponse* response);
+
+  // Deletes the artifacts with request.artifact_ids, along with their
+  // properties, events, event paths and attributions. The ids are deleted in
+  // a transaction per chunk of request.chunk_size ids, and the chunks
+  // committed before an error stay deleted. The number of rows deleted from
+  // each table is returned, or only counted if request.dry_run.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status DeleteArtifacts(const DeleteArtifactsRequest& request,
+                                     DeleteArtifactsResponse* response);
+
+  // Deletes the executions with request.execution_ids, along with their
+  // properties, events, event paths and associations, in chunks as
+  // DeleteArtifacts does.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status DeleteExecutions(const DeleteExecutionsRequest& request,
+                                      DeleteExecutionsResponse* response);
+
+  // Deletes the contexts with request.context_ids, along with their
+  // properties, attributions and associations, in chunks as DeleteArtifacts
+  // does. The artifacts and executions in the contexts are kept.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status DeleteContexts(const DeleteContextsRequest& request,
+                                    DeleteContextsResponse* response);
+
+  // Deletes the next chunk of at most config.chunk_size nodes that are due
+  // for compaction by `config` in one transaction, along with the rows
+  // depending on them: the artifacts in the DELETED state, then the
+  // executions and the contexts of the types with a retention policy that
+  // are not updated within its max age. The nodes whose last update time is
+  // unknown are kept. Sets `num_deleted_nodes` to the number of nodes deleted,
+  // which is 0 once no node is due.
+  // Returns INVALID_ARGUMENT error, if a retention policy has no positive max
+  // age.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status CompactNextChunk(const CompactionConfig& config,
+                                     int64* num_deleted_nodes);
+
+  // Builds an in-memory lineage index from the stored events. The index is
+  // used by GetLineageNodes, and is updated by PutEvents and PutExecution. If
+  // the index grows beyond config.max_memory_bytes, it is disabled and the
+  // traversals query the metadata source instead.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status EnableLineageIndex(const LineageIndexConfig& config);
+
+  // Gets the ids of the artifacts and executions reachable from the given
+  // artifacts and executions, by following at most request.max_hops events in
+  // request.direction. The starting nodes are not part of the response.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status GetLineageNodes(const GetLineageNodesRequest& request,
+                                     GetLineageNodesResponse* response);
+
+  // Caches the artifacts, executions and contexts read by GetArtifactsByID,
+  // GetExecutionsByID, GetContextsByID and GetContextByTypeAndName. The nodes
+  // written by the Put methods are invalidated. A node cached by one read is
+  // returned by the later reads until the store writes the node, so the cache
+  // should be enabled only when the store is the sole writer of the metadata
+  // source.
+  // Returns INVALID_ARGUMENT error, if config.max_num_entries is not positive.
+  tensorflow::Status EnableNodeCache(const NodeCacheConfig& config);
+
+  // Records the changes committed by the writes of the store, i.e., the
+  // nodes, events, attributions and associations written by the Put methods
+  // and ImportStore, and the nodes deleted by the Delete methods and the
+  // compaction, in an in-memory change log of at most config.max_num_changes
+  // changes. Like the node cache, the log only observes the writes of the
+  // store. The id of the log and the sequences of the changes are stored in
+  // the metadata source, and the sequences are advanced in the transactions of
+  // the writes.
+  // Returns INVALID_ARGUMENT error, if config.max_num_changes or
+  //   config.max_num_watchers is not positive.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status EnableChangeLog(const ChangeLogConfig& config);
+
+  // Gets the changes after the cursor of the request from the change log.
+  // Unlike the other methods, it does not access the metadata source, and can
+  // be called concurrently with them once the change log is enabled.
+  // Returns FAILED_PRECONDITION error, if the change log is not enabled.
+  // Returns OUT_OF_RANGE error, if the cursor is of another change log, or the
+  // changes after it are dropped.
+  tensorflow::Status GetChanges(const WatchChangesRequest& request,
+                                WatchChangesResponse* response);
+
+  // Waits until the change log has a change after `after_sequence`, or the
+  // `timeout` expires. Returns true if there is such a change. Can be called
+  // concurrently with the other methods as GetChanges.
+  bool WaitForChanges(int64 after_sequence, absl::Duration timeout);
+
+  // Adds a watcher of the change log, which is removed by
+  // RemoveChangeWatcher. Can be called concurrently with the other methods as
+  // GetChanges.
+  // Returns FAILED_PRECONDITION error, if the change log is not enabled.
+  // Returns RESOURCE_EXHAUSTED error, if the change log has
+  //   config.max_num_watchers watchers already.
+  tensorflow::Status AddChangeWatcher();
+
+  // Removes a watcher added by AddChangeWatcher.
+  void RemoveChangeWatcher();
+
+  // Gets the runtime statistics of the store, e.g., the lineage index size.
+  tensorflow::Status GetStoreStats(const GetStoreStatsRequest& request,
+                                   GetStoreStatsResponse* response);
+
+  // Lets BackupStore write backups to the files directly within
+  // config.directory.
+  // Returns INVALID_ARGUMENT error, if config.directory is not an absolute
+  // path, or has . or .. segments.
+  tensorflow::Status EnableBackups(const BackupConfig& config);
+
+  // Copies the database of the store to request.destination_filename_uri,
+  // while the other connections to the database can keep reading and writing
+  // it between the steps of the copy. The database is read through the
+  // connection of the store. If a `step_lock` is given, each step of the copy
+  // holds it, so that the other methods can be called between the steps by
+  // the threads holding it.
+  // Returns FAILED_PRECONDITION error, if the backups are not enabled.
+  // Returns INVALID_ARGUMENT error, if no destination is given, the
+  // destination is not directly within the backup directory, or is the
+  // database of the store.
+  // Returns UNIMPLEMENTED error, if the metadata source is not SQLite.
+  // Returns ABORTED error, if the database stays locked by other connections,
+  // or the copy keeps being restarted by their writes.
+  // Returns detailed INTERNAL error, if the backup fails.
+  tensorflow::Status BackupStore(const BackupStoreRequest& request,
+                                 BackupStoreResponse* response,
+                                 absl::Mutex* step_lock = nullptr);
+
+  // Runs the `calls` of the store methods in one transaction of the metadata
+  // source, so that many small writes share one commit. Each call runs within
+  // its own savepoint: a failed call only undoes its own changes and its error
+  // is set in `statuses`, while the changes of the other calls are committed.
+  // Returns detailed INTERNAL error, if the shared transaction cannot begin or
+  // commit. Then none of the calls is persisted, and all `statuses` are set to
+  // the error.
+  tensorflow::Status ExecuteGroupTransaction(
+      const std::vector<std::function<tensorflow::Status()>>& calls,
+      std::vector<tensorflow::Status>* statuses);
+
+  // Writes all types, nodes, events, attributions and associations of the
+  // store to `output` as length-delimited StoreSnapshotRecord messages. The
+  // nodes are read in pages of `page_size` nodes, each in a transaction of its
+  // own. The nodes created during the export may be partially included.
+  // Returns INVALID_ARGUMENT error, if `page_size` is not positive.
+  // Returns INTERNAL error, if a record cannot be written to `output`.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status ExportStore(
+      int64 page_size, google::protobuf::io::ZeroCopyOutputStream* output);
+
+  // Imports a snapshot written by ExportStore from `input`, committing every
+  // `batch_size` records. The types with the names and properties of existing
+  // types are reused, and the nodes are created with new ids. The records
+  // created by each batch are recorded in the change log with their new ids.
+  // If an error is returned, the batches committed before it are kept.
+  // Returns INVALID_ARGUMENT error, if `batch_size` is not positive, or the
+  // snapshot is malformed.
+  // Returns ALREADY_EXISTS error, if an imported context has the type and name
+  // of an existing context, or an imported type has the name of an existing
+  // type with different properties.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status ImportStore(
+      int64 batch_size, google::protobuf::io::ZeroCopyInputStream* input);
+
  private:
   // To construct the object, see Create(...).
   MetadataStore(std::unique_ptr<MetadataSource> metadata_source,
                 std::unique_ptr<MetadataAccessObject> metadata_access_object);
 
+  // Rebuilds the lineage index if it is enabled, after the events of the
+  // metadata source are changed without it. The index is dropped if it cannot
+  // be rebuilt.
+  void RebuildLineageIndex();
+
+  // Runs `transaction` with ExecuteTransaction. The changes it records with
+  // RecordChange are assigned their sequences in the transaction, published
+  // to the change log once they are committed, and dropped if they are rolled
+  // back.
+  tensorflow::Status ExecuteWriteTransaction(
+      const std::function<tensorflow::Status()>& transaction);
+
+  // Records a change of the current write, if the change log is enabled.
+  void RecordChange(Change change);
+
+  // Creates the attributions and associations that do not exist yet in bulk,
+  // and records the changes of the created ones. Runs in the transaction of
+  // the caller.
+  tensorflow::Status CreateContextEdgesIfNotExist(
+      const std::vector<Attribution>& attributions,
+      const std::vector<Association>& associations);
+
+  // Publishes the recorded changes to the change log with the sequences up to
+  // `last_sequence`.
+  void PublishChanges(int64 last_sequence);
+
   std::unique_ptr<MetadataSource> metadata_source_;
   std::unique_ptr<MetadataAccessObject> metadata_access_object_;
+
+  // The lineage index, or null if it is not enabled.
+  std::unique_ptr<LineageIndex> lineage_index_;
+  // The number of GetLineageNodes calls answered by the lineage index and by
+  // querying the metadata source respectively.
+  int64 num_index_traversals_ = 0;
+  int64 num_fallback_traversals_ = 0;
+
+  // The progress of the compaction by CompactNextChunk.
+  CompactionStats compaction_stats_;
+
+  // The node cache, or null if it is not enabled.
+  std::unique_ptr<NodeCache> node_cache_;
+
+  // The directory of the backups, or empty if the backups are not enabled.
+  std::string backup_directory_;
+
+  // The change log, or null if it is not enabled.
+  std::unique_ptr<ChangeLog> change_log_;
+  // The changes recorded by the writes that are not committed yet.
+  std::vector<Change> pending_changes_;
 };
 
 }  // namespace ml_metadata
@@ -37,7 +37,12 @@ from tensorflow.python.framework import errors
 
 
 class MetadataStore(object):
-  """A store for the artifact metadata."""
+  """A store for the artifact metadata.
+
+  Serializes the calls to the same MetadataStore, so that threads can share
+  it. With a database connection, runs the calls to different MetadataStores
+  in parallel, as they release the GIL.
+  """
 
   def __init__(self,
                config: Union[metadata_store_pb2.ConnectionConfig,
@@ -15,6 +15,7 @@ limitations under the License.
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
 
 #include "absl/memory/memory.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #ifndef _WIN32
 #include "ml_metadata/metadata_store/mysql_metadata_source.h"
@@ -27,13 +28,25 @@ namespace ml_metadata {
 
 namespace {
 
+// Returns the query config of a store with the property layout of `config`.
+MetadataSourceQueryConfig WithPropertyStorage(
+    MetadataSourceQueryConfig query_config,
+    const PropertyStorageConfig& config) {
+  query_config.set_pack_properties(config.layout() ==
+                                   PropertyStorageConfig::PACKED_PROPERTIES);
+  return query_config;
+}
+
 #ifndef _WIN32
 tensorflow::Status CreateMySQLMetadataStore(
     const MySQLDatabaseConfig& config,
+    const PropertyStorageConfig& property_storage_config,
     const MigrationOptions& migration_options,
     std::unique_ptr<MetadataStore>* result) {
   TF_RETURN_IF_ERROR(MetadataStore::Create(
-      util::GetMySqlMetadataSourceQueryConfig(), migration_options,
+      WithPropertyStorage(util::GetMySqlMetadataSourceQueryConfig(),
+                          property_storage_config),
+      migration_options,
       absl::make_unique<MySqlMetadataSource>(config), result));
   return (*result)->InitMetadataStoreIfNotExists(
       migration_options.enable_upgrade_migration());
@@ -41,6 +54,7 @@ tensorflow::Status CreateMySQLMetadataStore(
 #else
 tensorflow::Status CreateMySQLMetadataStore(
     const MySQLDatabaseConfig& config,
+    const PropertyStorageConfig& property_storage_config,
     const MigrationOptions& migration_options,
     std::unique_ptr<MetadataStore>* result) {
   return tensorflow::errors::Unimplemented(
@@ -50,15 +64,27 @@ tensorflow::Status CreateMySQLMetadataStore(
 
 tensorflow::Status CreateSqliteMetadataStore(
     const SqliteMetadataSourceConfig& config,
+    const PropertyStorageConfig& property_storage_config,
     const MigrationOptions& migration_options,
     std::unique_ptr<MetadataStore>* result) {
   TF_RETURN_IF_ERROR(MetadataStore::Create(
-      util::GetSqliteMetadataSourceQueryConfig(), migration_options,
+      WithPropertyStorage(util::GetSqliteMetadataSourceQueryConfig(),
+                          property_storage_config),
+      migration_options,
       absl::make_unique<SqliteMetadataSource>(config), result));
   return (*result)->InitMetadataStoreIfNotExists(
       migration_options.enable_upgrade_migration());
 }
 
+tensorflow::Status CreateInMemoryMetadataStore(
+    const MigrationOptions& migration_options,
+    std::unique_ptr<MetadataStore>* result) {
+  TF_RETURN_IF_ERROR(MetadataStore::Create(
+      util::GetFakeMetadataSourceQueryConfig(), migration_options,
+      absl::make_unique<InMemoryMetadataSource>(), result));
+  return (*result)->InitMetadataStoreIfNotExists(
+      migration_options.enable_upgrade_migration());
+}
 
 }  // namespace
 
@@ -71,13 +97,14 @@ tensorflow::Status CreateMetadataStore(const ConnectionConfig& config,
       // Must specify a metadata store type.
       return tensorflow::errors::InvalidArgument("Unset");
     case ConnectionConfig::kFakeDatabase:
-      // Creates an in-memory SQLite database for testing.
-      return CreateSqliteMetadataStore(SqliteMetadataSourceConfig(), options,
-                                       result);
+      // Creates a native in-memory store, mostly for testing.
+      return CreateInMemoryMetadataStore(options, result);
     case ConnectionConfig::kMysql:
-      return CreateMySQLMetadataStore(config.mysql(), options, result);
+      return CreateMySQLMetadataStore(
+          config.mysql(), config.property_storage_config(), options, result);
     case ConnectionConfig::kSqlite:
-      return CreateSqliteMetadataStore(config.sqlite(), options, result);
+      return CreateSqliteMetadataStore(
+          config.sqlite(), config.property_storage_config(), options, result);
     default:
       return tensorflow::errors::Unimplemented("Unknown database type.");
   }
@@ -22,6 +22,7 @@ limitations under the License.
 #include "grpcpp/security/server_credentials.h"
 #include "grpcpp/server.h"
 #include "grpcpp/server_builder.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
@@ -219,8 +220,43 @@ int main(int argc, char** argv) {
   TF_CHECK_OK(status)
       << "MetadataStore cannot be created with the given connection config.";
 
-  ml_metadata::MetadataStoreServiceImpl metadata_store_service(
-      std::move(metadata_store));
+  if (server_config.has_lineage_index_config()) {
+    TF_CHECK_OK(metadata_store->EnableLineageIndex(
+        server_config.lineage_index_config()))
+        << "The lineage index cannot be built.";
+  }
+
+  if (server_config.has_node_cache_config()) {
+    TF_CHECK_OK(
+        metadata_store->EnableNodeCache(server_config.node_cache_config()))
+        << "The node cache cannot be enabled.";
+  }
+
+  if (server_config.has_change_log_config()) {
+    TF_CHECK_OK(
+        metadata_store->EnableChangeLog(server_config.change_log_config()))
+        << "The change log cannot be enabled.";
+  }
+
+  if (server_config.has_backup_config()) {
+    TF_CHECK_OK(metadata_store->EnableBackups(server_config.backup_config()))
+        << "The backups cannot be enabled.";
+  }
+
+  std::unique_ptr<ml_metadata::MetadataStoreServiceImpl> metadata_store_service;
+  if (server_config.has_group_commit_config()) {
+    metadata_store_service =
+        absl::make_unique<ml_metadata::MetadataStoreServiceImpl>(
+            std::move(metadata_store), server_config.group_commit_config());
+  } else {
+    metadata_store_service =
+        absl::make_unique<ml_metadata::MetadataStoreServiceImpl>(
+            std::move(metadata_store));
+  }
+
+  if (server_config.has_compaction_config()) {
+    metadata_store_service->StartCompaction(server_config.compaction_config());
+  }
 
   const string server_address = absl::StrCat("0.0.0.0:", FLAGS_grpc_port);
   ::grpc::ServerBuilder builder;
@@ -233,7 +269,7 @@ int main(int argc, char** argv) {
 
   builder.AddListeningPort(server_address, credentials);
   AddGrpcChannelArgs(FLAGS_grpc_channel_arguments, &builder);
-  builder.RegisterService(&metadata_store_service);
+  builder.RegisterService(metadata_store_service.get());
   std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
   LOG(INFO) << "Server listening on " << server_address;
 
@@ -15,7 +15,9 @@ limitations under the License.
 #include "ml_metadata/metadata_store/metadata_store_service_impl.h"
 
 #include "grpcpp/support/status_code_enum.h"
+#include "absl/memory/memory.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "tensorflow/core/lib/core/errors.h"
 
@@ -29,15 +31,152 @@ namespace {
                         status.error_message());
 }
 
+// Returns true if the compaction can run at `now` by the hour window of the
+// config.
+bool IsInCompactionWindow(const CompactionConfig& config,
+                          const absl::Time now) {
+  const int64 start = config.window_start_hour();
+  const int64 end = config.window_end_hour();
+  if (start == end) return true;
+  const int64 hour = absl::ToUnixSeconds(now) / 3600 % 24;
+  return start < end ? start <= hour && hour < end
+                     : start <= hour || hour < end;
+}
+
 }  // namespace
 
 MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     std::unique_ptr<MetadataStore> metadata_store)
-    : metadata_store_(std::move(metadata_store)) {
+    : metadata_store_(std::move(metadata_store)), enable_group_commit_(false) {
   CHECK(metadata_store_ != nullptr);
   TF_CHECK_OK(metadata_store_->InitMetadataStoreIfNotExists());
 }
 
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    std::unique_ptr<MetadataStore> metadata_store,
+    const GroupCommitConfig& group_commit_config)
+    : metadata_store_(std::move(metadata_store)),
+      enable_group_commit_(true),
+      group_commit_config_(group_commit_config) {
+  CHECK(metadata_store_ != nullptr);
+  CHECK_GT(group_commit_config_.max_batch_size(), 0);
+  TF_CHECK_OK(metadata_store_->InitMetadataStoreIfNotExists());
+}
+
+MetadataStoreServiceImpl::~MetadataStoreServiceImpl() {
+  if (compaction_thread_ == nullptr) return;
+  {
+    absl::MutexLock l(&compaction_lock_);
+    stop_compaction_ = true;
+  }
+  compaction_thread_->join();
+}
+
+void MetadataStoreServiceImpl::StartCompaction(
+    const CompactionConfig& compaction_config) {
+  CHECK(compaction_thread_ == nullptr);
+  compaction_thread_ = absl::make_unique<std::thread>(
+      [this, compaction_config]() { RunCompaction(compaction_config); });
+}
+
+bool MetadataStoreServiceImpl::WaitForCompactionStop(
+    const absl::Duration timeout) {
+  absl::MutexLock l(&compaction_lock_);
+  return compaction_lock_.AwaitWithTimeout(absl::Condition(&stop_compaction_),
+                                           timeout);
+}
+
+void MetadataStoreServiceImpl::RunCompaction(
+    const CompactionConfig& compaction_config) {
+  do {
+    const absl::Time round_start = absl::Now();
+    // Deletes the due nodes chunk by chunk, until none is left or the window
+    // closes.
+    while (IsInCompactionWindow(compaction_config, absl::Now())) {
+      int64 num_deleted_nodes = 0;
+      tensorflow::Status status;
+      {
+        absl::WriterMutexLock l(&lock_);
+        status = metadata_store_->CompactNextChunk(compaction_config,
+                                                   &num_deleted_nodes);
+      }
+      if (!status.ok()) {
+        LOG(WARNING) << "Compaction failed: " << status.error_message();
+        break;
+      }
+      if (num_deleted_nodes == 0) break;
+      if (WaitForCompactionStop(
+              absl::Milliseconds(compaction_config.chunk_interval_millis()))) {
+        return;
+      }
+    }
+    const absl::Time next_round_start =
+        round_start +
+        absl::Seconds(compaction_config.round_interval_seconds());
+    if (WaitForCompactionStop(next_round_start - absl::Now())) return;
+  } while (true);
+}
+
+::grpc::Status MetadataStoreServiceImpl::ExecuteWrite(
+    const std::function<tensorflow::Status(MetadataStore*)>& write) {
+  if (!enable_group_commit_) {
+    absl::WriterMutexLock l(&lock_);
+    return ToGRPCStatus(write(metadata_store_.get()));
+  }
+  PendingWrite pending_write;
+  pending_write.write = &write;
+  std::shared_ptr<WriteGroup> group;
+  {
+    absl::MutexLock l(&group_lock_);
+    if (open_group_ != nullptr &&
+        open_group_->writes.size() < open_group_->max_size) {
+      // joins the open group, and waits for its leader to execute it.
+      open_group_->writes.push_back(&pending_write);
+      group_lock_.Await(absl::Condition(&pending_write.done));
+      return ToGRPCStatus(pending_write.status);
+    }
+    // otherwise it leads a new group, and waits for the others to join.
+    group = std::make_shared<WriteGroup>();
+    group->max_size = group_commit_config_.max_batch_size();
+    group->writes.push_back(&pending_write);
+    open_group_ = group;
+    group_lock_.AwaitWithTimeout(
+        absl::Condition(
+            +[](WriteGroup* g) { return g->writes.size() >= g->max_size; },
+            group.get()),
+        absl::Microseconds(group_commit_config_.max_delay_micros()));
+    if (open_group_ == group) {
+      open_group_.reset();
+    }
+  }
+
+  // no more writes join the group once it is closed.
+  std::vector<tensorflow::Status> statuses;
+  {
+    absl::WriterMutexLock l(&lock_);
+    MetadataStore* metadata_store = metadata_store_.get();
+    std::vector<std::function<tensorflow::Status()>> calls;
+    calls.reserve(group->writes.size());
+    for (PendingWrite* pending : group->writes) {
+      calls.push_back([metadata_store, pending]() -> tensorflow::Status {
+        return (*pending->write)(metadata_store);
+      });
+    }
+    const tensorflow::Status status =
+        metadata_store->ExecuteGroupTransaction(calls, &statuses);
+    if (!status.ok()) {
+      LOG(WARNING) << "Group commit of " << calls.size()
+                   << " writes failed: " << status.error_message();
+    }
+  }
+  absl::MutexLock l(&group_lock_);
+  for (int i = 0; i < group->writes.size(); ++i) {
+    group->writes[i]->status = statuses[i];
+    group->writes[i]->done = true;
+  }
+  return ToGRPCStatus(pending_write.status);
+}
+
 ::grpc::Status MetadataStoreServiceImpl::PutArtifactType(
     ::grpc::ServerContext* context,
     const ::ml_metadata::PutArtifactTypeRequest* request,
@@ -198,9 +337,10 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const ::ml_metadata::PutArtifactsRequest* request,
     ::ml_metadata::PutArtifactsResponse* response) {
-  absl::WriterMutexLock l(&lock_);
-  const ::grpc::Status status =
-      ToGRPCStatus(metadata_store_->PutArtifacts(*request, response));
+  const ::grpc::Status status = ExecuteWrite(
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutArtifacts(*request, response);
+      });
   if (!status.ok()) {
     LOG(WARNING) << "PutArtifacts failed: " << status.error_message();
   }
@@ -211,9 +351,10 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const ::ml_metadata::PutExecutionsRequest* request,
     ::ml_metadata::PutExecutionsResponse* response) {
-  absl::WriterMutexLock l(&lock_);
-  const ::grpc::Status status =
-      ToGRPCStatus(metadata_store_->PutExecutions(*request, response));
+  const ::grpc::Status status = ExecuteWrite(
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutExecutions(*request, response);
+      });
   if (!status.ok()) {
     LOG(WARNING) << "PutExecutions failed: " << status.error_message();
   }
@@ -250,9 +391,10 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const ::ml_metadata::PutEventsRequest* request,
     ::ml_metadata::PutEventsResponse* response) {
-  absl::WriterMutexLock l(&lock_);
-  const ::grpc::Status status =
-      ToGRPCStatus(metadata_store_->PutEvents(*request, response));
+  const ::grpc::Status status = ExecuteWrite(
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutEvents(*request, response);
+      });
   if (!status.ok()) {
     LOG(WARNING) << "PutEvents failed: " << status.error_message();
   }
@@ -263,15 +405,30 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const ::ml_metadata::PutExecutionRequest* request,
     ::ml_metadata::PutExecutionResponse* response) {
-  absl::WriterMutexLock l(&lock_);
-  const ::grpc::Status status =
-      ToGRPCStatus(metadata_store_->PutExecution(*request, response));
+  const ::grpc::Status status = ExecuteWrite(
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutExecution(*request, response);
+      });
   if (!status.ok()) {
     LOG(WARNING) << "PutExecution failed: " << status.error_message();
   }
   return status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::PutExecutionBatch(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::PutExecutionBatchRequest* request,
+    ::ml_metadata::PutExecutionBatchResponse* response) {
+  const ::grpc::Status status = ExecuteWrite(
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutExecutionBatch(*request, response);
+      });
+  if (!status.ok()) {
+    LOG(WARNING) << "PutExecutionBatch failed: " << status.error_message();
+  }
+  return status;
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetEventsByArtifactIDs(
     ::grpc::ServerContext* context,
     const ::ml_metadata::GetEventsByArtifactIDsRequest* request,
@@ -368,9 +525,10 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const ::ml_metadata::PutContextsRequest* request,
     ::ml_metadata::PutContextsResponse* response) {
-  absl::WriterMutexLock l(&lock_);
-  const ::grpc::Status status =
-      ToGRPCStatus(metadata_store_->PutContexts(*request, response));
+  const ::grpc::Status status = ExecuteWrite(
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutContexts(*request, response);
+      });
   if (!status.ok()) {
     LOG(WARNING) << "PutContexts failed: " << status.error_message();
   }
@@ -430,13 +588,57 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetArtifactsByTypeAndNames(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::GetArtifactsByTypeAndNamesRequest* request,
+    ::ml_metadata::GetArtifactsByTypeAndNamesResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status = ToGRPCStatus(
+      metadata_store_->GetArtifactsByTypeAndNames(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "GetArtifactsByTypeAndNames failed: "
+                 << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetExecutionsByTypeAndNames(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::GetExecutionsByTypeAndNamesRequest* request,
+    ::ml_metadata::GetExecutionsByTypeAndNamesResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status = ToGRPCStatus(
+      metadata_store_->GetExecutionsByTypeAndNames(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "GetExecutionsByTypeAndNames failed: "
+                 << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetContextsByTypeAndNames(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::GetContextsByTypeAndNamesRequest* request,
+    ::ml_metadata::GetContextsByTypeAndNamesResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status = ToGRPCStatus(
+      metadata_store_->GetContextsByTypeAndNames(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "GetContextsByTypeAndNames failed: "
+                 << status.error_message();
+  }
+  return status;
+}
+
 ::grpc::Status MetadataStoreServiceImpl::PutAttributionsAndAssociations(
     ::grpc::ServerContext* context,
     const ::ml_metadata::PutAttributionsAndAssociationsRequest* request,
     ::ml_metadata::PutAttributionsAndAssociationsResponse* response) {
-  absl::WriterMutexLock l(&lock_);
-  const ::grpc::Status status = ToGRPCStatus(
-      metadata_store_->PutAttributionsAndAssociations(*request, response));
+  const ::grpc::Status status = ExecuteWrite(
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutAttributionsAndAssociations(*request,
+                                                              response);
+      });
   if (!status.ok()) {
     LOG(WARNING) << "PutAttributionsAndAssociations failed: "
                  << status.error_message();
@@ -496,4 +698,154 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::CountArtifacts(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::CountArtifactsRequest* request,
+    ::ml_metadata::CountArtifactsResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status =
+      ToGRPCStatus(metadata_store_->CountArtifacts(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "CountArtifacts failed: " << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::CountExecutions(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::CountExecutionsRequest* request,
+    ::ml_metadata::CountExecutionsResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status =
+      ToGRPCStatus(metadata_store_->CountExecutions(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "CountExecutions failed: " << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::CountContexts(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::CountContextsRequest* request,
+    ::ml_metadata::CountContextsResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status =
+      ToGRPCStatus(metadata_store_->CountContexts(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "CountContexts failed: " << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::DeleteArtifacts(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::DeleteArtifactsRequest* request,
+    ::ml_metadata::DeleteArtifactsResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status =
+      ToGRPCStatus(metadata_store_->DeleteArtifacts(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "DeleteArtifacts failed: " << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::DeleteExecutions(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::DeleteExecutionsRequest* request,
+    ::ml_metadata::DeleteExecutionsResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status =
+      ToGRPCStatus(metadata_store_->DeleteExecutions(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "DeleteExecutions failed: " << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::DeleteContexts(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::DeleteContextsRequest* request,
+    ::ml_metadata::DeleteContextsResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status =
+      ToGRPCStatus(metadata_store_->DeleteContexts(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "DeleteContexts failed: " << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetLineageNodes(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::GetLineageNodesRequest* request,
+    ::ml_metadata::GetLineageNodesResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status =
+      ToGRPCStatus(metadata_store_->GetLineageNodes(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "GetLineageNodes failed: " << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetStoreStats(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::GetStoreStatsRequest* request,
+    ::ml_metadata::GetStoreStatsResponse* response) {
+  absl::WriterMutexLock l(&lock_);
+  const ::grpc::Status status =
+      ToGRPCStatus(metadata_store_->GetStoreStats(*request, response));
+  if (!status.ok()) {
+    LOG(WARNING) << "GetStoreStats failed: " << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::BackupStore(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::BackupStoreRequest* request,
+    ::ml_metadata::BackupStoreResponse* response) {
+  const ::grpc::Status status =
+      ToGRPCStatus(metadata_store_->BackupStore(*request, response, &lock_));
+  if (!status.ok()) {
+    LOG(WARNING) << "BackupStore failed: " << status.error_message();
+  }
+  return status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::WatchChanges(
+    ::grpc::ServerContext* context,
+    const ::ml_metadata::WatchChangesRequest* request,
+    ::grpc::ServerWriter<::ml_metadata::WatchChangesResponse>* writer) {
+  const ::grpc::Status add_status =
+      ToGRPCStatus(metadata_store_->AddChangeWatcher());
+  if (!add_status.ok()) {
+    LOG(WARNING) << "WatchChanges failed: " << add_status.error_message();
+    return add_status;
+  }
+  ::grpc::Status status = ::grpc::Status::OK;
+  WatchChangesRequest cursor = *request;
+  while (!context->IsCancelled()) {
+    WatchChangesResponse response;
+    status = ToGRPCStatus(metadata_store_->GetChanges(cursor, &response));
+    if (!status.ok()) {
+      LOG(WARNING) << "WatchChanges failed: " << status.error_message();
+      break;
+    }
+    cursor.set_log_id(response.log_id());
+    cursor.set_after_sequence(response.last_sequence());
+    if (response.changes_size() == 0) {
+      // Wakes up periodically to notice the cancellation of the call.
+      metadata_store_->WaitForChanges(cursor.after_sequence(),
+                                      absl::Seconds(1));
+      continue;
+    }
+    // The client has gone away.
+    if (!writer->Write(response)) break;
+  }
+  metadata_store_->RemoveChangeWatcher();
+  return status;
+}
+
 }  // namespace ml_metadata
@@ -15,8 +15,14 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_SERVICE_IMPL_H_
 #define ML_METADATA_METADATA_STORE_METADATA_STORE_SERVICE_IMPL_H_
 
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
 #include "absl/synchronization/mutex.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.grpc.pb.h"
 
 namespace ml_metadata {
@@ -31,11 +37,26 @@ class MetadataStoreServiceImpl final
   explicit MetadataStoreServiceImpl(
       std::unique_ptr<MetadataStore> metadata_store);
 
+  // Creates a server that groups the concurrent write requests into shared
+  // transactions as configured by `group_commit_config`.
+  MetadataStoreServiceImpl(std::unique_ptr<MetadataStore> metadata_store,
+                           const GroupCommitConfig& group_commit_config);
+
   // default & copy constructors are disallowed.
   MetadataStoreServiceImpl() = delete;
   MetadataStoreServiceImpl(const MetadataStoreServiceImpl&) = delete;
   MetadataStoreServiceImpl& operator=(const MetadataStoreServiceImpl&) = delete;
 
+  // Stops the compaction if it is started.
+  ~MetadataStoreServiceImpl() override;
+
+  // Starts a background thread compacting the store as configured by
+  // `compaction_config`. Each chunk of the compaction holds the store like a
+  // request does, and the thread pauses between the chunks to let the
+  // requests through. It must be called at most once.
+  void StartCompaction(const CompactionConfig& compaction_config)
+      ABSL_LOCKS_EXCLUDED(lock_, compaction_lock_);
+
   ::grpc::Status PutArtifactType(
       ::grpc::ServerContext* context,
       const ::ml_metadata::PutArtifactTypeRequest* request,
@@ -141,6 +162,12 @@ class MetadataStoreServiceImpl final
                               ::ml_metadata::PutExecutionResponse* response)
       override ABSL_LOCKS_EXCLUDED(lock_);
 
+  ::grpc::Status PutExecutionBatch(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::PutExecutionBatchRequest* request,
+      ::ml_metadata::PutExecutionBatchResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
   ::grpc::Status GetEventsByArtifactIDs(
       ::grpc::ServerContext* context,
       const ::ml_metadata::GetEventsByArtifactIDsRequest* request,
@@ -210,6 +237,24 @@ class MetadataStoreServiceImpl final
       ::ml_metadata::GetContextByTypeAndNameResponse* response) override
       ABSL_LOCKS_EXCLUDED(lock_);
 
+  ::grpc::Status GetArtifactsByTypeAndNames(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::GetArtifactsByTypeAndNamesRequest* request,
+      ::ml_metadata::GetArtifactsByTypeAndNamesResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  ::grpc::Status GetExecutionsByTypeAndNames(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::GetExecutionsByTypeAndNamesRequest* request,
+      ::ml_metadata::GetExecutionsByTypeAndNamesResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  ::grpc::Status GetContextsByTypeAndNames(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::GetContextsByTypeAndNamesRequest* request,
+      ::ml_metadata::GetContextsByTypeAndNamesResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
   ::grpc::Status PutAttributionsAndAssociations(
       ::grpc::ServerContext* context,
       const ::ml_metadata::PutAttributionsAndAssociationsRequest* request,
@@ -240,9 +285,116 @@ class MetadataStoreServiceImpl final
       ::ml_metadata::GetExecutionsByContextResponse* response) override
       ABSL_LOCKS_EXCLUDED(lock_);
 
+  ::grpc::Status CountArtifacts(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::CountArtifactsRequest* request,
+      ::ml_metadata::CountArtifactsResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  ::grpc::Status CountExecutions(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::CountExecutionsRequest* request,
+      ::ml_metadata::CountExecutionsResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  ::grpc::Status CountContexts(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::CountContextsRequest* request,
+      ::ml_metadata::CountContextsResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  ::grpc::Status DeleteArtifacts(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::DeleteArtifactsRequest* request,
+      ::ml_metadata::DeleteArtifactsResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  ::grpc::Status DeleteExecutions(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::DeleteExecutionsRequest* request,
+      ::ml_metadata::DeleteExecutionsResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  ::grpc::Status DeleteContexts(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::DeleteContextsRequest* request,
+      ::ml_metadata::DeleteContextsResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  ::grpc::Status GetLineageNodes(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::GetLineageNodesRequest* request,
+      ::ml_metadata::GetLineageNodesResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  ::grpc::Status GetStoreStats(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::GetStoreStatsRequest* request,
+      ::ml_metadata::GetStoreStatsResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  // The backup holds the lock of the store for each step of the paced copy
+  // only, so the other calls are served between the steps.
+  ::grpc::Status BackupStore(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::BackupStoreRequest* request,
+      ::ml_metadata::BackupStoreResponse* response) override
+      ABSL_LOCKS_EXCLUDED(lock_);
+
+  // Writes the changes as they are committed, until the call is cancelled.
+  // The watch does not hold the lock of the store, which only serializes the
+  // writes to the change log it reads. The number of concurrent watches is
+  // bounded by the change log, as each of them holds a server thread.
+  ::grpc::Status WatchChanges(
+      ::grpc::ServerContext* context,
+      const ::ml_metadata::WatchChangesRequest* request,
+      ::grpc::ServerWriter<::ml_metadata::WatchChangesResponse>* writer)
+      override ABSL_LOCKS_EXCLUDED(lock_);
+
  private:
+  // A write request waiting for its group to be executed.
+  struct PendingWrite {
+    const std::function<tensorflow::Status(MetadataStore*)>* write;
+    tensorflow::Status status;
+    bool done = false;
+  };
+
+  // The write requests executed in one transaction.
+  struct WriteGroup {
+    int64 max_size;
+    std::vector<PendingWrite*> writes;
+  };
+
+  // Runs the `write` call of the store. If group commit is enabled, the call
+  // joins a group of the concurrent writes, which is executed in one
+  // transaction by the first request of the group, and returns after the
+  // group is committed.
+  ::grpc::Status ExecuteWrite(
+      const std::function<tensorflow::Status(MetadataStore*)>& write)
+      ABSL_LOCKS_EXCLUDED(lock_, group_lock_);
+
+  // Runs the compaction rounds until the compaction is stopped.
+  void RunCompaction(const CompactionConfig& compaction_config)
+      ABSL_LOCKS_EXCLUDED(lock_, compaction_lock_);
+
+  // Waits for the `timeout`, and returns true if the compaction is stopped in
+  // the meantime.
+  bool WaitForCompactionStop(absl::Duration timeout)
+      ABSL_LOCKS_EXCLUDED(compaction_lock_);
+
   absl::Mutex lock_;
   std::unique_ptr<MetadataStore> metadata_store_ ABSL_GUARDED_BY(lock_);
+
+  const bool enable_group_commit_;
+  const GroupCommitConfig group_commit_config_;
+  absl::Mutex group_lock_;
+  // The group that the incoming write requests join, or null if there is none.
+  std::shared_ptr<WriteGroup> open_group_ ABSL_GUARDED_BY(group_lock_);
+
+  absl::Mutex compaction_lock_;
+  bool stop_compaction_ ABSL_GUARDED_BY(compaction_lock_) = false;
+  // The thread running the compaction, or null if it is not started.
+  std::unique_ptr<std::thread> compaction_thread_;
 };
 
 }  // namespace ml_metadata
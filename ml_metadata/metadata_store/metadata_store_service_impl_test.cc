@@ -0,0 +1,205 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_service_impl.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAreArray;
+
+// The requests of a group wait for each other for up to a minute, so that the
+// tests only pass if the concurrent writes fill a group.
+constexpr int64 kMaxDelayMicros = 60 * 1000 * 1000;
+
+class MetadataStoreServiceImplTest : public ::testing::Test {
+ protected:
+  // Creates a service grouping up to `max_batch_size` writes, and an artifact
+  // type for the writes.
+  void CreateService(const int64 max_batch_size) {
+    std::unique_ptr<MetadataStore> metadata_store;
+    TF_CHECK_OK(MetadataStore::Create(
+        util::GetSqliteMetadataSourceQueryConfig(), {},
+        absl::make_unique<SqliteMetadataSource>(SqliteMetadataSourceConfig()),
+        &metadata_store));
+    GroupCommitConfig group_commit_config;
+    group_commit_config.set_max_batch_size(max_batch_size);
+    group_commit_config.set_max_delay_micros(kMaxDelayMicros);
+    service_ = absl::make_unique<MetadataStoreServiceImpl>(
+        std::move(metadata_store), group_commit_config);
+
+    const PutArtifactTypeRequest put_artifact_type_request =
+        ParseTextProtoOrDie<PutArtifactTypeRequest>(
+            R"(all_fields_match: true
+               artifact_type: { name: 'artifact_type' })");
+    PutArtifactTypeResponse put_artifact_type_response;
+    ASSERT_TRUE(service_
+                    ->PutArtifactType(/*context=*/nullptr,
+                                      &put_artifact_type_request,
+                                      &put_artifact_type_response)
+                    .ok());
+    type_id_ = put_artifact_type_response.type_id();
+  }
+
+  // Sends the requests from a thread each, and waits for all the responses.
+  void PutArtifactsConcurrently(
+      const std::vector<PutArtifactsRequest>& requests,
+      std::vector<PutArtifactsResponse>* responses,
+      std::vector<::grpc::Status>* statuses) {
+    responses->assign(requests.size(), PutArtifactsResponse());
+    statuses->assign(requests.size(), ::grpc::Status::OK);
+    std::vector<std::thread> writers;
+    for (int i = 0; i < requests.size(); ++i) {
+      writers.emplace_back([this, &requests, responses, statuses, i]() {
+        (*statuses)[i] = service_->PutArtifacts(
+            /*context=*/nullptr, &requests[i], &(*responses)[i]);
+      });
+    }
+    for (std::thread& writer : writers) {
+      writer.join();
+    }
+  }
+
+  // Returns the stored artifacts.
+  std::vector<Artifact> GetArtifacts() {
+    const GetArtifactsRequest request;
+    GetArtifactsResponse response;
+    EXPECT_TRUE(
+        service_->GetArtifacts(/*context=*/nullptr, &request, &response).ok());
+    return {response.artifacts().begin(), response.artifacts().end()};
+  }
+
+  std::unique_ptr<MetadataStoreServiceImpl> service_;
+  int64 type_id_ = 0;
+};
+
+TEST_F(MetadataStoreServiceImplTest, GroupsConcurrentWrites) {
+  constexpr int kNumWriters = 8;
+  CreateService(kNumWriters);
+  std::vector<PutArtifactsRequest> requests(kNumWriters);
+  for (int i = 0; i < kNumWriters; ++i) {
+    Artifact* artifact = requests[i].add_artifacts();
+    artifact->set_type_id(type_id_);
+    artifact->set_uri(absl::StrCat("uri_", i));
+  }
+  // The first writer leads the group until all the others join it; otherwise
+  // it would wait for kMaxDelayMicros.
+  const absl::Time start = absl::Now();
+  std::vector<PutArtifactsResponse> responses;
+  std::vector<::grpc::Status> statuses;
+  PutArtifactsConcurrently(requests, &responses, &statuses);
+  EXPECT_LT(absl::Now() - start, absl::Microseconds(kMaxDelayMicros));
+
+  std::vector<int64> want_ids;
+  for (int i = 0; i < kNumWriters; ++i) {
+    ASSERT_TRUE(statuses[i].ok()) << statuses[i].error_message();
+    ASSERT_THAT(responses[i].artifact_ids(), SizeIs(1));
+    want_ids.push_back(responses[i].artifact_ids(0));
+  }
+  std::vector<int64> got_ids;
+  for (const Artifact& artifact : GetArtifacts()) {
+    got_ids.push_back(artifact.id());
+  }
+  EXPECT_THAT(got_ids, UnorderedElementsAreArray(want_ids));
+}
+
+TEST_F(MetadataStoreServiceImplTest, FailedWriteOnlyRollsBackItself) {
+  constexpr int kNumWriters = 3;
+  CreateService(kNumWriters);
+  // The second write stores its first artifact before failing on the unknown
+  // type of its second one.
+  std::vector<PutArtifactsRequest> requests(kNumWriters);
+  for (PutArtifactsRequest& request : requests) {
+    request.add_artifacts()->set_type_id(type_id_);
+  }
+  requests[1].add_artifacts()->set_type_id(type_id_ + 1);
+  std::vector<PutArtifactsResponse> responses;
+  std::vector<::grpc::Status> statuses;
+  PutArtifactsConcurrently(requests, &responses, &statuses);
+
+  EXPECT_TRUE(statuses[0].ok()) << statuses[0].error_message();
+  EXPECT_EQ(statuses[1].error_code(), ::grpc::StatusCode::NOT_FOUND);
+  EXPECT_TRUE(statuses[2].ok()) << statuses[2].error_message();
+  ASSERT_THAT(responses[0].artifact_ids(), SizeIs(1));
+  ASSERT_THAT(responses[2].artifact_ids(), SizeIs(1));
+  std::vector<int64> got_ids;
+  for (const Artifact& artifact : GetArtifacts()) {
+    got_ids.push_back(artifact.id());
+  }
+  EXPECT_THAT(got_ids,
+              UnorderedElementsAreArray({responses[0].artifact_ids(0),
+                                         responses[2].artifact_ids(0)}));
+}
+
+TEST_F(MetadataStoreServiceImplTest, RespondsToEachWriteOfGroup) {
+  constexpr int kNumWriters = 4;
+  CreateService(kNumWriters);
+  // Each writer stores a different number of artifacts, so that a response
+  // sent to the wrong writer is told apart.
+  std::vector<PutArtifactsRequest> requests(kNumWriters);
+  for (int i = 0; i < kNumWriters; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      Artifact* artifact = requests[i].add_artifacts();
+      artifact->set_type_id(type_id_);
+      artifact->set_uri(absl::StrCat("uri_", i, "_", j));
+    }
+  }
+  std::vector<PutArtifactsResponse> responses;
+  std::vector<::grpc::Status> statuses;
+  PutArtifactsConcurrently(requests, &responses, &statuses);
+
+  // Every writer gets the ids of its own artifacts, in the order of its
+  // request.
+  for (int i = 0; i < kNumWriters; ++i) {
+    ASSERT_TRUE(statuses[i].ok()) << statuses[i].error_message();
+    ASSERT_THAT(responses[i].artifact_ids(), SizeIs(i + 1));
+    GetArtifactsByIDRequest get_request;
+    get_request.mutable_artifact_ids()->CopyFrom(responses[i].artifact_ids());
+    GetArtifactsByIDResponse get_response;
+    ASSERT_TRUE(service_
+                    ->GetArtifactsByID(/*context=*/nullptr, &get_request,
+                                       &get_response)
+                    .ok());
+    ASSERT_THAT(get_response.artifacts(), SizeIs(i + 1));
+    const auto& ids = responses[i].artifact_ids();
+    for (const Artifact& artifact : get_response.artifacts()) {
+      const auto it = std::find(ids.begin(), ids.end(), artifact.id());
+      ASSERT_NE(it, ids.end());
+      EXPECT_EQ(artifact.uri(),
+                absl::StrCat("uri_", i, "_", it - ids.begin()));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,82 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Binary that exports a metadata store to a snapshot file, or imports a
+// snapshot file into a metadata store. The snapshot is a stream of
+// length-delimited StoreSnapshotRecord messages defined in
+// third_party/ml_metadata/proto/metadata_store.proto.
+#include <fstream>
+#include <memory>
+
+#include "gflags/gflags.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+DEFINE_string(connection_config_file, "",
+              "The file name of an ascii ConnectionConfig protobuf of the "
+              "metadata store.");
+DEFINE_string(export_file, "",
+              "If non-empty, the store is exported to the file.");
+DEFINE_string(import_file, "",
+              "If non-empty, the file is imported into the store.");
+DEFINE_int64(page_size, 1000,
+             "The number of nodes read at a time when exporting.");
+DEFINE_int64(batch_size, 1000,
+             "The number of records committed at a time when importing.");
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  if (FLAGS_export_file.empty() == FLAGS_import_file.empty()) {
+    LOG(ERROR) << "Exactly one of --export_file and --import_file should be "
+                  "given.";
+    return -1;
+  }
+
+  ml_metadata::ConnectionConfig connection_config;
+  TF_CHECK_OK(tensorflow::ReadTextProto(tensorflow::Env::Default(),
+                                        FLAGS_connection_config_file,
+                                        &connection_config));
+  std::unique_ptr<ml_metadata::MetadataStore> metadata_store;
+  TF_CHECK_OK(ml_metadata::CreateMetadataStore(
+      connection_config, ml_metadata::MigrationOptions(), &metadata_store))
+      << "MetadataStore cannot be created with the given connection config.";
+
+  if (!FLAGS_export_file.empty()) {
+    std::ofstream file(FLAGS_export_file, std::ios::out | std::ios::binary);
+    CHECK(file) << "Cannot open " << FLAGS_export_file;
+    {
+      // The stream flushes its buffer to the file when it is destroyed.
+      google::protobuf::io::OstreamOutputStream output(&file);
+      TF_CHECK_OK(metadata_store->ExportStore(FLAGS_page_size, &output))
+          << "The store cannot be exported.";
+    }
+    file.close();
+    CHECK(file) << "Cannot write " << FLAGS_export_file;
+    LOG(INFO) << "The store is exported to " << FLAGS_export_file;
+  } else {
+    std::ifstream file(FLAGS_import_file, std::ios::in | std::ios::binary);
+    CHECK(file) << "Cannot open " << FLAGS_import_file;
+    google::protobuf::io::IstreamInputStream input(&file);
+    TF_CHECK_OK(metadata_store->ImportStore(FLAGS_batch_size, &input))
+        << "The snapshot cannot be imported.";
+    LOG(INFO) << FLAGS_import_file << " is imported into the store.";
+  }
+  return 0;
+}
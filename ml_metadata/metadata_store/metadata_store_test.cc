@@ -18,7 +18,9 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 #include "ml_metadata/metadata_store/test_util.h"
@@ -1132,6 +1134,121 @@ TEST_F(MetadataStoreTest, GetArtifactAndExecutionByTypesWithEmptyType) {
   EXPECT_THAT(get_executions_by_empty_type_response.executions(), SizeIs(0));
 }
 
+TEST_F(MetadataStoreTest, GetArtifactsWithFilter) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: {
+          name: 'model'
+          properties { key: 'accuracy' value: DOUBLE }
+        }
+        artifact_types: {
+          name: 'other_model'
+          properties { key: 'accuracy' value: DOUBLE }
+        }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 4; i++) {
+    Artifact* artifact = put_artifacts_request.add_artifacts();
+    artifact->set_type_id(put_types_response.artifact_type_ids(i % 2));
+    const double accuracy = 0.5 + 0.2 * i;
+    (*artifact->mutable_properties())["accuracy"].set_double_value(accuracy);
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+
+  const NodeFilter filter = ParseTextProtoOrDie<NodeFilter>(R"(
+    predicates { property: 'accuracy' op: GT value: { double_value: 0.8 } }
+  )");
+  GetArtifactsRequest get_artifacts_request;
+  *get_artifacts_request.mutable_filter() = filter;
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifacts(get_artifacts_request,
+                                             &get_artifacts_response));
+  std::vector<int64> got_ids;
+  for (const Artifact& artifact : get_artifacts_response.artifacts()) {
+    got_ids.push_back(artifact.id());
+  }
+  EXPECT_THAT(got_ids,
+              UnorderedElementsAre(put_artifacts_response.artifact_ids(2),
+                                   put_artifacts_response.artifact_ids(3)));
+
+  GetArtifactsByTypeRequest get_artifacts_by_type_request;
+  get_artifacts_by_type_request.set_type_name("other_model");
+  *get_artifacts_by_type_request.mutable_filter() = filter;
+  GetArtifactsByTypeResponse get_artifacts_by_type_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByType(
+      get_artifacts_by_type_request, &get_artifacts_by_type_response));
+  ASSERT_THAT(get_artifacts_by_type_response.artifacts(), SizeIs(1));
+  EXPECT_EQ(get_artifacts_by_type_response.artifacts(0).id(),
+            put_artifacts_response.artifact_ids(3));
+
+  // No artifact matches the filter.
+  get_artifacts_request.mutable_filter()
+      ->mutable_predicates(0)
+      ->mutable_value()
+      ->set_double_value(2.0);
+  get_artifacts_response.Clear();
+  TF_ASSERT_OK(metadata_store_->GetArtifacts(get_artifacts_request,
+                                             &get_artifacts_response));
+  EXPECT_THAT(get_artifacts_response.artifacts(), SizeIs(0));
+
+  // A malformed filter is rejected.
+  get_artifacts_request.mutable_filter()->mutable_predicates(0)->clear_op();
+  EXPECT_EQ(metadata_store_
+                ->GetArtifacts(get_artifacts_request, &get_artifacts_response)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_F(MetadataStoreTest, ExecuteGroupTransaction) {
+  const PutArtifactTypeRequest put_artifact_type_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(
+          R"(all_fields_match: true
+             artifact_type: { name: 'artifact_type' })");
+  PutArtifactTypeResponse put_artifact_type_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifactType(put_artifact_type_request,
+                                                &put_artifact_type_response));
+  const int64 type_id = put_artifact_type_response.type_id();
+
+  // The second write fails in the middle, and only its changes are undone.
+  PutArtifactsRequest request_1;
+  request_1.add_artifacts()->set_type_id(type_id);
+  PutArtifactsRequest request_2;
+  request_2.add_artifacts()->set_type_id(type_id);
+  request_2.add_artifacts()->set_type_id(type_id + 1);
+  PutArtifactsRequest request_3;
+  request_3.add_artifacts()->set_type_id(type_id);
+  std::vector<PutArtifactsResponse> responses(3);
+  std::vector<std::function<tensorflow::Status()>> calls;
+  for (const PutArtifactsRequest* request :
+       {&request_1, &request_2, &request_3}) {
+    PutArtifactsResponse* response = &responses[calls.size()];
+    calls.push_back([this, request, response]() {
+      return metadata_store_->PutArtifacts(*request, response);
+    });
+  }
+  std::vector<tensorflow::Status> statuses;
+  TF_ASSERT_OK(metadata_store_->ExecuteGroupTransaction(calls, &statuses));
+  ASSERT_THAT(statuses, SizeIs(3));
+  TF_EXPECT_OK(statuses[0]);
+  EXPECT_EQ(statuses[1].code(), tensorflow::error::NOT_FOUND);
+  TF_EXPECT_OK(statuses[2]);
+
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifacts(GetArtifactsRequest(),
+                                             &get_artifacts_response));
+  std::vector<int64> got_ids;
+  for (const Artifact& artifact : get_artifacts_response.artifacts()) {
+    got_ids.push_back(artifact.id());
+  }
+  EXPECT_THAT(got_ids, UnorderedElementsAre(responses[0].artifact_ids(0),
+                                            responses[2].artifact_ids(0)));
+}
+
 TEST_F(MetadataStoreTest, GetArtifactByURI) {
   const PutArtifactTypeRequest put_artifact_type_request =
       ParseTextProtoOrDie<PutArtifactTypeRequest>(
@@ -1650,6 +1767,165 @@ TEST_F(MetadataStoreTest, PutAndGetExecutionWithContext) {
   }
 }
 
+TEST_F(MetadataStoreTest, PutExecutionBatchWithSharedContexts) {
+  PutTypesRequest put_types_request = ParseTextProtoOrDie<PutTypesRequest>(R"(
+    artifact_types: { name: 'artifact_type' }
+    context_types: { name: 'context_type' }
+    execution_types: { name: 'execution_type' })");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  Context pipeline;
+  pipeline.set_type_id(put_types_response.context_type_ids(0));
+  pipeline.set_name("pipeline");
+  Context run;
+  run.set_type_id(put_types_response.context_type_ids(0));
+  run.set_name("run");
+
+  // prepares 2 executions, each with an output artifact and the `run` context,
+  // sharing the `pipeline` context.
+  PutExecutionBatchRequest put_execution_batch_request;
+  for (int i = 0; i < 2; ++i) {
+    PutExecutionRequest* entry = put_execution_batch_request.add_executions();
+    entry->mutable_execution()->set_type_id(
+        put_types_response.execution_type_ids(0));
+    PutExecutionRequest::ArtifactAndEvent* artifact_and_event =
+        entry->add_artifact_event_pairs();
+    artifact_and_event->mutable_artifact()->set_type_id(
+        put_types_response.artifact_type_ids(0));
+    artifact_and_event->mutable_event()->set_type(Event::OUTPUT);
+    *entry->add_contexts() = run;
+  }
+  *put_execution_batch_request.add_contexts() = pipeline;
+  PutExecutionBatchResponse put_execution_batch_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutionBatch(
+      put_execution_batch_request, &put_execution_batch_response));
+
+  ASSERT_THAT(put_execution_batch_response.executions(), SizeIs(2));
+  ASSERT_THAT(put_execution_batch_response.context_ids(), SizeIs(1));
+  const PutExecutionResponse& response1 =
+      put_execution_batch_response.executions(0);
+  const PutExecutionResponse& response2 =
+      put_execution_batch_response.executions(1);
+  EXPECT_NE(response1.execution_id(), response2.execution_id());
+  ASSERT_THAT(response1.artifact_ids(), SizeIs(1));
+  ASSERT_THAT(response2.artifact_ids(), SizeIs(1));
+  EXPECT_NE(response1.artifact_ids(0), response2.artifact_ids(0));
+  // the `run` context is inserted once.
+  ASSERT_THAT(response1.context_ids(), SizeIs(1));
+  ASSERT_THAT(response2.context_ids(), SizeIs(1));
+  EXPECT_EQ(response1.context_ids(0), response2.context_ids(0));
+  GetContextsResponse get_contexts_response;
+  TF_ASSERT_OK(metadata_store_->GetContexts({}, &get_contexts_response));
+  EXPECT_THAT(get_contexts_response.contexts(), SizeIs(2));
+
+  // both contexts relate to both executions, and the artifacts are attributed
+  // to the shared context.
+  for (const int64 context_id : {put_execution_batch_response.context_ids(0),
+                                 response1.context_ids(0)}) {
+    GetExecutionsByContextRequest get_executions_by_context_request;
+    get_executions_by_context_request.set_context_id(context_id);
+    GetExecutionsByContextResponse get_executions_by_context_response;
+    TF_ASSERT_OK(metadata_store_->GetExecutionsByContext(
+        get_executions_by_context_request,
+        &get_executions_by_context_response));
+    EXPECT_THAT(get_executions_by_context_response.executions(), SizeIs(2));
+  }
+  GetArtifactsByContextRequest get_artifacts_by_context_request;
+  get_artifacts_by_context_request.set_context_id(
+      put_execution_batch_response.context_ids(0));
+  GetArtifactsByContextResponse get_artifacts_by_context_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByContext(
+      get_artifacts_by_context_request, &get_artifacts_by_context_response));
+  EXPECT_THAT(get_artifacts_by_context_response.artifacts(), SizeIs(2));
+
+  // each execution has its output event.
+  GetEventsByExecutionIDsRequest get_events_request;
+  get_events_request.add_execution_ids(response1.execution_id());
+  get_events_request.add_execution_ids(response2.execution_id());
+  GetEventsByExecutionIDsResponse get_events_response;
+  TF_ASSERT_OK(metadata_store_->GetEventsByExecutionIDs(get_events_request,
+                                                        &get_events_response));
+  ASSERT_THAT(get_events_response.events(), SizeIs(2));
+  EXPECT_EQ(get_events_response.events(0).artifact_id(),
+            response1.artifact_ids(0));
+  EXPECT_EQ(get_events_response.events(1).artifact_id(),
+            response2.artifact_ids(0));
+
+  // a batch with an invalid execution writes nothing.
+  put_execution_batch_request.add_executions();
+  put_execution_batch_request.mutable_contexts(0)->set_name("another");
+  EXPECT_EQ(metadata_store_
+                ->PutExecutionBatch(put_execution_batch_request,
+                                    &put_execution_batch_response)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  get_contexts_response.Clear();
+  TF_ASSERT_OK(metadata_store_->GetContexts({}, &get_contexts_response));
+  EXPECT_THAT(get_contexts_response.contexts(), SizeIs(2));
+}
+
+TEST_F(MetadataStoreTest, PutExecutionBatchWithConflictingContexts) {
+  PutTypesRequest put_types_request = ParseTextProtoOrDie<PutTypesRequest>(R"(
+    context_types: {
+      name: 'context_type'
+      properties { key: 'p' value: INT }
+    }
+    execution_types: { name: 'execution_type' })");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  Context run;
+  run.set_type_id(put_types_response.context_type_ids(0));
+  run.set_name("run");
+  (*run.mutable_properties())["p"].set_int_value(1);
+  PutExecutionBatchRequest put_execution_batch_request;
+  for (int i = 0; i < 2; ++i) {
+    PutExecutionRequest* entry = put_execution_batch_request.add_executions();
+    entry->mutable_execution()->set_type_id(
+        put_types_response.execution_type_ids(0));
+    *entry->add_contexts() = run;
+  }
+  PutExecutionBatchResponse put_execution_batch_response;
+
+  // the same context is given twice with different properties.
+  (*put_execution_batch_request.mutable_executions(1)
+        ->mutable_contexts(0)
+        ->mutable_properties())["p"]
+      .set_int_value(2);
+  EXPECT_EQ(metadata_store_
+                ->PutExecutionBatch(put_execution_batch_request,
+                                    &put_execution_batch_response)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+
+  // or with different custom properties.
+  *put_execution_batch_request.mutable_executions(1)->mutable_contexts(0) =
+      run;
+  (*put_execution_batch_request.mutable_executions(1)
+        ->mutable_contexts(0)
+        ->mutable_custom_properties())["q"]
+      .set_string_value("custom");
+  EXPECT_EQ(metadata_store_
+                ->PutExecutionBatch(put_execution_batch_request,
+                                    &put_execution_batch_response)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  GetContextsResponse get_contexts_response;
+  TF_ASSERT_OK(metadata_store_->GetContexts({}, &get_contexts_response));
+  EXPECT_THAT(get_contexts_response.contexts(), SizeIs(0));
+
+  // the same context given twice with the same properties is upserted once.
+  *put_execution_batch_request.mutable_executions(1)->mutable_contexts(0) =
+      run;
+  TF_ASSERT_OK(metadata_store_->PutExecutionBatch(
+      put_execution_batch_request, &put_execution_batch_response));
+  TF_ASSERT_OK(metadata_store_->GetContexts({}, &get_contexts_response));
+  ASSERT_THAT(get_contexts_response.contexts(), SizeIs(1));
+  EXPECT_EQ(get_contexts_response.contexts(0).properties().at("p").int_value(),
+            1);
+}
+
 TEST_F(MetadataStoreTest, PutContextTypeGetContextType) {
   const PutContextTypeRequest put_request =
       ParseTextProtoOrDie<PutContextTypeRequest>(
@@ -2030,6 +2306,95 @@ TEST_F(MetadataStoreTest, PutContextGetContextsByTypeAndName) {
   EXPECT_FALSE(get_no_context_by_type_and_name_response.has_context());
 }
 
+// Test creating named nodes and then getting them by their type and names.
+TEST_F(MetadataStoreTest, PutNodesGetNodesByTypeAndNames) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'execution_type' }
+        context_types: { name: 'context_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+
+  PutArtifactsRequest put_artifacts_request =
+      ParseTextProtoOrDie<PutArtifactsRequest>(R"(
+        artifacts: { uri: 'uri_1' name: 'artifact_1' }
+        artifacts: { uri: 'uri_2' name: 'artifact_2' }
+        artifacts: { uri: 'uri_3' }
+      )");
+  for (Artifact& artifact : *put_artifacts_request.mutable_artifacts()) {
+    artifact.set_type_id(put_types_response.artifact_type_ids(0));
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  PutExecutionsRequest put_executions_request =
+      ParseTextProtoOrDie<PutExecutionsRequest>(R"(
+        executions: { name: 'execution' }
+      )");
+  put_executions_request.mutable_executions(0)->set_type_id(
+      put_types_response.execution_type_ids(0));
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutions(put_executions_request,
+                                              &put_executions_response));
+  PutContextsRequest put_contexts_request =
+      ParseTextProtoOrDie<PutContextsRequest>(R"(
+        contexts: { name: 'context' }
+      )");
+  put_contexts_request.mutable_contexts(0)->set_type_id(
+      put_types_response.context_type_ids(0));
+  PutContextsResponse put_contexts_response;
+  TF_ASSERT_OK(metadata_store_->PutContexts(put_contexts_request,
+                                            &put_contexts_response));
+
+  GetArtifactsByTypeAndNamesRequest get_artifacts_request =
+      ParseTextProtoOrDie<GetArtifactsByTypeAndNamesRequest>(R"(
+        type_name: 'artifact_type'
+        artifact_names: [ 'artifact_2', 'unknown', 'artifact_1' ]
+        read_mask { paths: 'id' }
+      )");
+  GetArtifactsByTypeAndNamesResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByTypeAndNames(
+      get_artifacts_request, &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(2));
+  EXPECT_EQ(get_artifacts_response.artifacts(0).id(),
+            put_artifacts_response.artifact_ids(0));
+  EXPECT_EQ(get_artifacts_response.artifacts(1).id(),
+            put_artifacts_response.artifact_ids(1));
+  EXPECT_FALSE(get_artifacts_response.artifacts(0).has_uri());
+
+  Execution want_execution = put_executions_request.executions(0);
+  want_execution.set_id(put_executions_response.execution_ids(0));
+  GetExecutionsByTypeAndNamesRequest get_executions_request;
+  get_executions_request.set_type_name("execution_type");
+  get_executions_request.add_execution_names("execution");
+  GetExecutionsByTypeAndNamesResponse get_executions_response;
+  TF_ASSERT_OK(metadata_store_->GetExecutionsByTypeAndNames(
+      get_executions_request, &get_executions_response));
+  EXPECT_THAT(get_executions_response.executions(),
+              ElementsAre(testing::EqualsProto(want_execution)));
+
+  Context want_context = put_contexts_request.contexts(0);
+  want_context.set_id(put_contexts_response.context_ids(0));
+  GetContextsByTypeAndNamesRequest get_contexts_request;
+  get_contexts_request.set_type_name("context_type");
+  get_contexts_request.add_context_names("context");
+  GetContextsByTypeAndNamesResponse get_contexts_response;
+  TF_ASSERT_OK(metadata_store_->GetContextsByTypeAndNames(
+      get_contexts_request, &get_contexts_response));
+  EXPECT_THAT(get_contexts_response.contexts(),
+              ElementsAre(testing::EqualsProto(want_context)));
+
+  // Test that nothing is found for an unknown type.
+  get_contexts_request.set_type_name("unknown_type");
+  GetContextsByTypeAndNamesResponse get_no_contexts_response;
+  TF_ASSERT_OK(metadata_store_->GetContextsByTypeAndNames(
+      get_contexts_request, &get_no_contexts_response));
+  EXPECT_THAT(get_no_contexts_response.contexts(), SizeIs(0));
+}
+
 TEST_F(MetadataStoreTest, PutAndUseAttributionsAndAssociations) {
   const PutTypesRequest put_types_request =
       ParseTextProtoOrDie<PutTypesRequest>(R"(
@@ -2173,5 +2538,1053 @@ TEST_F(MetadataStoreTest, PutAndUseAttributionsAndAssociations) {
                   testing::EqualsProto(want_artifact_2)));
 }
 
+// Checks the lineage traversals over a1 -> e1 -> a2 -> e2 -> a3 with and
+// without the lineage index.
+TEST_F(MetadataStoreTest, GetLineageNodes) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'execution_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 3; i++) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_types_response.artifact_type_ids(0));
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  const std::vector<int64> a(put_artifacts_response.artifact_ids().begin(),
+                             put_artifacts_response.artifact_ids().end());
+
+  // e1 is recorded with its events before the index is built.
+  PutExecutionRequest put_execution_request;
+  put_execution_request.mutable_execution()->set_type_id(
+      put_types_response.execution_type_ids(0));
+  PutExecutionRequest::ArtifactAndEvent* input =
+      put_execution_request.add_artifact_event_pairs();
+  input->mutable_artifact()->set_id(a[0]);
+  input->mutable_artifact()->set_type_id(
+      put_types_response.artifact_type_ids(0));
+  input->mutable_event()->set_type(Event::INPUT);
+  PutExecutionRequest::ArtifactAndEvent* output =
+      put_execution_request.add_artifact_event_pairs();
+  *output = *input;
+  output->mutable_artifact()->set_id(a[1]);
+  output->mutable_event()->set_type(Event::OUTPUT);
+  PutExecutionResponse put_execution_response;
+  TF_ASSERT_OK(metadata_store_->PutExecution(put_execution_request,
+                                             &put_execution_response));
+  const int64 e1 = put_execution_response.execution_id();
+
+  GetStoreStatsResponse stats_response;
+  TF_ASSERT_OK(metadata_store_->GetStoreStats({}, &stats_response));
+  EXPECT_FALSE(stats_response.has_lineage_index_stats());
+
+  // The index is built from the stored events; e2 is added to the index by
+  // PutExecution and PutEvents.
+  LineageIndexConfig config;
+  TF_ASSERT_OK(metadata_store_->EnableLineageIndex(config));
+  put_execution_request.clear_artifact_event_pairs();
+  put_execution_request.add_artifact_event_pairs()->mutable_artifact()->set_id(
+      a[2]);
+  put_execution_request.mutable_artifact_event_pairs(0)
+      ->mutable_artifact()
+      ->set_type_id(put_types_response.artifact_type_ids(0));
+  put_execution_request.mutable_artifact_event_pairs(0)
+      ->mutable_event()
+      ->set_type(Event::DECLARED_OUTPUT);
+  TF_ASSERT_OK(metadata_store_->PutExecution(put_execution_request,
+                                             &put_execution_response));
+  const int64 e2 = put_execution_response.execution_id();
+  PutEventsRequest put_events_request;
+  Event* event = put_events_request.add_events();
+  event->set_artifact_id(a[1]);
+  event->set_execution_id(e2);
+  event->set_type(Event::DECLARED_INPUT);
+  PutEventsResponse put_events_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutEvents(put_events_request, &put_events_response));
+
+  // The traversals from the index match the ones from the database.
+  for (const bool use_index : {true, false}) {
+    if (!use_index) {
+      // A limit smaller than any index disables it.
+      config.set_max_memory_bytes(1);
+      TF_ASSERT_OK(metadata_store_->EnableLineageIndex(config));
+    }
+    GetLineageNodesRequest request;
+    request.add_artifact_ids(a[0]);
+    request.set_direction(GetLineageNodesRequest::DOWNSTREAM);
+    GetLineageNodesResponse response;
+    TF_ASSERT_OK(metadata_store_->GetLineageNodes(request, &response));
+    EXPECT_THAT(response.artifact_ids(), ElementsAre(a[1], a[2]));
+    EXPECT_THAT(response.execution_ids(), ElementsAre(e1, e2));
+
+    request.set_max_hops(2);
+    response.Clear();
+    TF_ASSERT_OK(metadata_store_->GetLineageNodes(request, &response));
+    EXPECT_THAT(response.artifact_ids(), ElementsAre(a[1]));
+    EXPECT_THAT(response.execution_ids(), ElementsAre(e1));
+
+    request.Clear();
+    request.add_artifact_ids(a[1]);
+    request.set_direction(GetLineageNodesRequest::UPSTREAM);
+    response.Clear();
+    TF_ASSERT_OK(metadata_store_->GetLineageNodes(request, &response));
+    EXPECT_THAT(response.artifact_ids(), ElementsAre(a[0]));
+    EXPECT_THAT(response.execution_ids(), ElementsAre(e1));
+
+    request.Clear();
+    request.add_execution_ids(e2);
+    response.Clear();
+    TF_ASSERT_OK(metadata_store_->GetLineageNodes(request, &response));
+    EXPECT_THAT(response.artifact_ids(), ElementsAre(a[0], a[1], a[2]));
+    EXPECT_THAT(response.execution_ids(), ElementsAre(e1));
+
+    stats_response.Clear();
+    TF_ASSERT_OK(metadata_store_->GetStoreStats({}, &stats_response));
+    EXPECT_EQ(stats_response.lineage_index_stats().enabled(), use_index);
+    EXPECT_EQ(stats_response.lineage_index_stats().num_edges(),
+              use_index ? 4 : 0);
+  }
+  EXPECT_EQ(stats_response.lineage_index_stats().num_index_traversals(), 4);
+  EXPECT_EQ(stats_response.lineage_index_stats().num_fallback_traversals(), 4);
+}
+
+TEST_F(MetadataStoreTest, NodeCacheInvalidatedByPuts) {
+  NodeCacheConfig config;
+  config.set_max_num_entries(0);
+  EXPECT_EQ(metadata_store_->EnableNodeCache(config).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  config.set_max_num_entries(10);
+  TF_ASSERT_OK(metadata_store_->EnableNodeCache(config));
+
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+        context_types: { name: 'context_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  Artifact* artifact = put_artifacts_request.add_artifacts();
+  artifact->set_type_id(put_types_response.artifact_type_ids(0));
+  artifact->set_uri("uri1");
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  artifact->set_id(put_artifacts_response.artifact_ids(0));
+  PutContextsRequest put_contexts_request;
+  Context* context = put_contexts_request.add_contexts();
+  context->set_type_id(put_types_response.context_type_ids(0));
+  context->set_name("context1");
+  PutContextsResponse put_contexts_response;
+  TF_ASSERT_OK(metadata_store_->PutContexts(put_contexts_request,
+                                            &put_contexts_response));
+  context->set_id(put_contexts_response.context_ids(0));
+
+  // The second reads are answered by the cache.
+  GetArtifactsByIDRequest get_artifacts_request;
+  get_artifacts_request.add_artifact_ids(artifact->id());
+  GetContextByTypeAndNameRequest get_context_request;
+  get_context_request.set_type_name("context_type");
+  get_context_request.set_context_name("context1");
+  for (int i = 0; i < 2; i++) {
+    GetArtifactsByIDResponse get_artifacts_response;
+    TF_ASSERT_OK(metadata_store_->GetArtifactsByID(get_artifacts_request,
+                                                   &get_artifacts_response));
+    ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+    EXPECT_THAT(get_artifacts_response.artifacts(0),
+                testing::EqualsProto(*artifact));
+    GetContextByTypeAndNameResponse get_context_response;
+    TF_ASSERT_OK(metadata_store_->GetContextByTypeAndName(
+        get_context_request, &get_context_response));
+    EXPECT_THAT(get_context_response.context(),
+                testing::EqualsProto(*context));
+  }
+  GetStoreStatsResponse stats_response;
+  TF_ASSERT_OK(metadata_store_->GetStoreStats({}, &stats_response));
+  EXPECT_EQ(stats_response.node_cache_stats().num_entries(), 3);
+  EXPECT_EQ(stats_response.node_cache_stats().max_num_entries(), 10);
+  // Each read counts as a single lookup.
+  EXPECT_EQ(stats_response.node_cache_stats().num_hits(), 2);
+  EXPECT_EQ(stats_response.node_cache_stats().num_misses(), 2);
+
+  // The updated nodes are read from the database again.
+  artifact->set_uri("uri2");
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  context->set_name("context2");
+  TF_ASSERT_OK(metadata_store_->PutContexts(put_contexts_request,
+                                            &put_contexts_response));
+  GetArtifactsByIDResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByID(get_artifacts_request,
+                                                 &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+  EXPECT_THAT(get_artifacts_response.artifacts(0),
+              testing::EqualsProto(*artifact));
+  // The renamed context is not found by its old name.
+  GetContextByTypeAndNameResponse get_context_response;
+  TF_ASSERT_OK(metadata_store_->GetContextByTypeAndName(get_context_request,
+                                                        &get_context_response));
+  EXPECT_FALSE(get_context_response.has_context());
+  get_context_request.set_context_name("context2");
+  TF_ASSERT_OK(metadata_store_->GetContextByTypeAndName(get_context_request,
+                                                        &get_context_response));
+  EXPECT_THAT(get_context_response.context(), testing::EqualsProto(*context));
+}
+
+TEST_F(MetadataStoreTest, GetArtifactsWithReadMask) {
+  NodeCacheConfig config;
+  config.set_max_num_entries(10);
+  TF_ASSERT_OK(metadata_store_->EnableNodeCache(config));
+  const PutArtifactTypeRequest put_artifact_type_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+        artifact_type: {
+          name: 'artifact_type'
+          properties { key: 'p' value: STRING }
+        }
+      )");
+  PutArtifactTypeResponse put_artifact_type_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifactType(put_artifact_type_request,
+                                                &put_artifact_type_response));
+  PutArtifactsRequest put_artifacts_request =
+      ParseTextProtoOrDie<PutArtifactsRequest>(R"(
+        artifacts: {
+          uri: 'uri'
+          properties { key: 'p' value: { string_value: '1' } }
+          custom_properties { key: 'q' value: { int_value: 2 } }
+        }
+      )");
+  put_artifacts_request.mutable_artifacts(0)->set_type_id(
+      put_artifact_type_response.type_id());
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  Artifact want_artifact;
+  want_artifact.set_uri("uri");
+  (*want_artifact.mutable_properties())["p"].set_string_value("1");
+
+  // The masked artifact is read from the database and not cached, so the
+  // cached artifact read afterwards is complete, and it is masked on reads.
+  GetArtifactsByIDRequest get_artifacts_by_id_request =
+      ParseTextProtoOrDie<GetArtifactsByIDRequest>(R"(
+        read_mask { paths: 'uri' paths: 'properties' }
+      )");
+  get_artifacts_by_id_request.add_artifact_ids(
+      put_artifacts_response.artifact_ids(0));
+  GetArtifactsByIDResponse get_artifacts_by_id_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByID(
+      get_artifacts_by_id_request, &get_artifacts_by_id_response));
+  ASSERT_THAT(get_artifacts_by_id_response.artifacts(), SizeIs(1));
+  EXPECT_THAT(get_artifacts_by_id_response.artifacts(0),
+              testing::EqualsProto(want_artifact));
+  get_artifacts_by_id_request.clear_read_mask();
+  get_artifacts_by_id_response.Clear();
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByID(
+      get_artifacts_by_id_request, &get_artifacts_by_id_response));
+  ASSERT_THAT(get_artifacts_by_id_response.artifacts(), SizeIs(1));
+  EXPECT_EQ(get_artifacts_by_id_response.artifacts(0).custom_properties_size(),
+            1);
+  get_artifacts_by_id_request.mutable_read_mask()->add_paths("uri");
+  get_artifacts_by_id_request.mutable_read_mask()->add_paths("properties");
+  get_artifacts_by_id_response.Clear();
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByID(
+      get_artifacts_by_id_request, &get_artifacts_by_id_response));
+  ASSERT_THAT(get_artifacts_by_id_response.artifacts(), SizeIs(1));
+  EXPECT_THAT(get_artifacts_by_id_response.artifacts(0),
+              testing::EqualsProto(want_artifact));
+
+  GetArtifactsRequest get_artifacts_request =
+      ParseTextProtoOrDie<GetArtifactsRequest>(R"(
+        read_mask { paths: 'uri' paths: 'properties.p' }
+      )");
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifacts(get_artifacts_request,
+                                             &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+  EXPECT_THAT(get_artifacts_response.artifacts(0),
+              testing::EqualsProto(want_artifact));
+
+  get_artifacts_request.mutable_read_mask()->add_paths("unknown_field");
+  EXPECT_EQ(metadata_store_
+                ->GetArtifacts(get_artifacts_request, &get_artifacts_response)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+
+  // The mask of the request is validated once, whether its artifacts are
+  // cached or not.
+  get_artifacts_by_id_request.add_artifact_ids(
+      put_artifacts_response.artifact_ids(0));
+  get_artifacts_by_id_request.mutable_read_mask()->add_paths("unknown_field");
+  EXPECT_EQ(metadata_store_
+                ->GetArtifactsByID(get_artifacts_by_id_request,
+                                   &get_artifacts_by_id_response)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  get_artifacts_by_id_request.clear_artifact_ids();
+  EXPECT_EQ(metadata_store_
+                ->GetArtifactsByID(get_artifacts_by_id_request,
+                                   &get_artifacts_by_id_response)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_F(MetadataStoreTest, CountExecutionsByType) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        execution_types: { name: 'trainer' }
+        execution_types: { name: 'evaluator' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutExecutionsRequest put_executions_request;
+  for (const int64 type_id : {put_types_response.execution_type_ids(0),
+                              put_types_response.execution_type_ids(0),
+                              put_types_response.execution_type_ids(1)}) {
+    put_executions_request.add_executions()->set_type_id(type_id);
+  }
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutions(put_executions_request,
+                                              &put_executions_response));
+
+  CountExecutionsRequest count_request =
+      ParseTextProtoOrDie<CountExecutionsRequest>(R"(
+        filter {
+          predicates {
+            attribute: TYPE
+            op: EQ
+            value { string_value: 'trainer' }
+          }
+        }
+      )");
+  CountExecutionsResponse count_response;
+  TF_ASSERT_OK(metadata_store_->CountExecutions(count_request,
+                                                &count_response));
+  EXPECT_THAT(count_response, testing::EqualsProto(
+                                  ParseTextProtoOrDie<CountExecutionsResponse>(
+                                      "counts { count: 2 }")));
+
+  count_request.clear_filter();
+  count_request.add_group_by(NodeCount::TYPE_ID);
+  count_response.Clear();
+  TF_ASSERT_OK(metadata_store_->CountExecutions(count_request,
+                                                &count_response));
+  ASSERT_THAT(count_response.counts(), SizeIs(2));
+  int64 total = 0;
+  for (const NodeCount& count : count_response.counts()) {
+    EXPECT_EQ(count.count(),
+              count.type_id() == put_types_response.execution_type_ids(0) ? 2
+                                                                          : 1);
+    total += count.count();
+  }
+  EXPECT_EQ(total, 3);
+}
+
+TEST_F(MetadataStoreTest, DeleteArtifactsInChunks) {
+  NodeCacheConfig node_cache_config;
+  node_cache_config.set_max_num_entries(10);
+  TF_ASSERT_OK(metadata_store_->EnableNodeCache(node_cache_config));
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'execution_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 3; i++) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_types_response.artifact_type_ids(0));
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  const std::vector<int64> a(put_artifacts_response.artifact_ids().begin(),
+                             put_artifacts_response.artifact_ids().end());
+  PutExecutionRequest put_execution_request;
+  put_execution_request.mutable_execution()->set_type_id(
+      put_types_response.execution_type_ids(0));
+  PutExecutionRequest::ArtifactAndEvent* input =
+      put_execution_request.add_artifact_event_pairs();
+  input->mutable_artifact()->set_id(a[0]);
+  input->mutable_artifact()->set_type_id(
+      put_types_response.artifact_type_ids(0));
+  input->mutable_event()->set_type(Event::INPUT);
+  PutExecutionResponse put_execution_response;
+  TF_ASSERT_OK(metadata_store_->PutExecution(put_execution_request,
+                                             &put_execution_response));
+  TF_ASSERT_OK(metadata_store_->EnableLineageIndex(LineageIndexConfig()));
+  // Caches the artifacts.
+  GetArtifactsByIDRequest get_artifacts_request;
+  for (const int64 artifact_id : a) {
+    get_artifacts_request.add_artifact_ids(artifact_id);
+  }
+  GetArtifactsByIDResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByID(get_artifacts_request,
+                                                 &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(3));
+
+  DeleteArtifactsRequest delete_request;
+  delete_request.add_artifact_ids(a[0]);
+  delete_request.add_artifact_ids(a[1]);
+  delete_request.set_dry_run(true);
+  delete_request.set_chunk_size(1);
+  DeleteArtifactsResponse delete_response;
+  TF_ASSERT_OK(
+      metadata_store_->DeleteArtifacts(delete_request, &delete_response));
+  const DeleteArtifactsResponse want_delete_response =
+      ParseTextProtoOrDie<DeleteArtifactsResponse>(R"(
+        num_deleted_rows { key: 'Artifact' value: 2 }
+        num_deleted_rows { key: 'ArtifactProperty' value: 0 }
+        num_deleted_rows { key: 'Event' value: 1 }
+        num_deleted_rows { key: 'EventPath' value: 0 }
+        num_deleted_rows { key: 'Attribution' value: 0 }
+      )");
+  EXPECT_THAT(delete_response, testing::EqualsProto(want_delete_response));
+  get_artifacts_response.Clear();
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByID(get_artifacts_request,
+                                                 &get_artifacts_response));
+  EXPECT_THAT(get_artifacts_response.artifacts(), SizeIs(3));
+
+  // The deleted artifacts are evicted from the cache, and their events from
+  // the lineage index. The index is updated in place instead of being rebuilt
+  // from the stored events, so its memory is not reallocated.
+  GetStoreStatsResponse stats_response;
+  TF_ASSERT_OK(metadata_store_->GetStoreStats({}, &stats_response));
+  const int64 index_memory_bytes =
+      stats_response.lineage_index_stats().memory_bytes();
+  delete_request.set_dry_run(false);
+  delete_response.Clear();
+  TF_ASSERT_OK(
+      metadata_store_->DeleteArtifacts(delete_request, &delete_response));
+  EXPECT_THAT(delete_response, testing::EqualsProto(want_delete_response));
+  get_artifacts_response.Clear();
+  TF_ASSERT_OK(metadata_store_->GetArtifactsByID(get_artifacts_request,
+                                                 &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+  EXPECT_EQ(get_artifacts_response.artifacts(0).id(), a[2]);
+  GetLineageNodesRequest lineage_request;
+  lineage_request.add_execution_ids(put_execution_response.execution_id());
+  GetLineageNodesResponse lineage_response;
+  TF_ASSERT_OK(
+      metadata_store_->GetLineageNodes(lineage_request, &lineage_response));
+  EXPECT_THAT(lineage_response.artifact_ids(), ElementsAre());
+  stats_response.Clear();
+  TF_ASSERT_OK(metadata_store_->GetStoreStats({}, &stats_response));
+  EXPECT_TRUE(stats_response.lineage_index_stats().enabled());
+  EXPECT_EQ(stats_response.lineage_index_stats().num_edges(), 0);
+  EXPECT_EQ(stats_response.lineage_index_stats().memory_bytes(),
+            index_memory_bytes);
+}
+
+TEST_F(MetadataStoreTest, CompactNextChunk) {
+  // The update times of the nodes are set through a connection of its own.
+  const string filename_uri =
+      absl::StrCat(::testing::TempDir(), "metadata_store_compaction.db");
+  SqliteMetadataSourceConfig connection_config;
+  connection_config.set_filename_uri(filename_uri);
+  std::unique_ptr<MetadataStore> metadata_store;
+  TF_ASSERT_OK(MetadataStore::Create(
+      util::GetSqliteMetadataSourceQueryConfig(), {},
+      absl::make_unique<SqliteMetadataSource>(connection_config),
+      &metadata_store));
+  TF_ASSERT_OK(metadata_store->InitMetadataStore());
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'stale_type' }
+        execution_types: { name: 'kept_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store->PutTypes(put_types_request, &put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (const Artifact::State state : {Artifact::LIVE, Artifact::DELETED}) {
+    Artifact* artifact = put_artifacts_request.add_artifacts();
+    artifact->set_type_id(put_types_response.artifact_type_ids(0));
+    artifact->set_state(state);
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store->PutArtifacts(put_artifacts_request,
+                                            &put_artifacts_response));
+  PutExecutionsRequest put_executions_request;
+  for (const int64 type_id :
+       {put_types_response.execution_type_ids(0),
+        put_types_response.execution_type_ids(0),
+        put_types_response.execution_type_ids(1)}) {
+    put_executions_request.add_executions()->set_type_id(type_id);
+  }
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store->PutExecutions(put_executions_request,
+                                             &put_executions_response));
+  // The first execution is stale, and the update time of the second one is
+  // unknown, as for the nodes written before the times were recorded.
+  SqliteMetadataSource metadata_source(connection_config);
+  TF_ASSERT_OK(metadata_source.Connect());
+  TF_ASSERT_OK(metadata_source.Begin());
+  RecordSet record_set;
+  for (int i = 0; i < 2; i++) {
+    TF_ASSERT_OK(metadata_source.ExecuteQuery(
+        absl::StrCat("UPDATE `Execution` SET `last_update_time_since_epoch` = ",
+                     1 - i, " WHERE `id` = ",
+                     put_executions_response.execution_ids(i), ";"),
+        &record_set));
+  }
+  TF_ASSERT_OK(metadata_source.Commit());
+  TF_ASSERT_OK(metadata_source.Close());
+
+  int64 num_deleted_nodes;
+  EXPECT_EQ(metadata_store
+                ->CompactNextChunk(ParseTextProtoOrDie<CompactionConfig>(R"(
+                  execution_retention_policies {
+                    type_name: 'stale_type'
+                    max_age_seconds: 0
+                  }
+                )"),
+                                   &num_deleted_nodes)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+
+  // The DELETED artifact and the stale execution are deleted in two chunks.
+  const CompactionConfig config = ParseTextProtoOrDie<CompactionConfig>(R"(
+    execution_retention_policies { type_name: 'stale_type' max_age_seconds: 1 }
+    execution_retention_policies { type_name: 'kept_type' max_age_seconds: 60 }
+    chunk_size: 1
+  )");
+  TF_ASSERT_OK(metadata_store->CompactNextChunk(config, &num_deleted_nodes));
+  EXPECT_EQ(num_deleted_nodes, 1);
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(metadata_store->GetArtifacts({}, &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+  EXPECT_EQ(get_artifacts_response.artifacts(0).id(),
+            put_artifacts_response.artifact_ids(0));
+  TF_ASSERT_OK(metadata_store->CompactNextChunk(config, &num_deleted_nodes));
+  EXPECT_EQ(num_deleted_nodes, 1);
+  TF_ASSERT_OK(metadata_store->CompactNextChunk(config, &num_deleted_nodes));
+  EXPECT_EQ(num_deleted_nodes, 0);
+  GetExecutionsResponse get_executions_response;
+  TF_ASSERT_OK(metadata_store->GetExecutions({}, &get_executions_response));
+  ASSERT_THAT(get_executions_response.executions(), SizeIs(2));
+  EXPECT_EQ(get_executions_response.executions(0).id(),
+            put_executions_response.execution_ids(1));
+  EXPECT_EQ(get_executions_response.executions(1).id(),
+            put_executions_response.execution_ids(2));
+
+  GetStoreStatsResponse stats_response;
+  TF_ASSERT_OK(metadata_store->GetStoreStats({}, &stats_response));
+  EXPECT_EQ(stats_response.compaction_stats().num_chunks(), 3);
+  EXPECT_EQ(stats_response.compaction_stats().num_deleted_artifacts(), 1);
+  EXPECT_EQ(stats_response.compaction_stats().num_deleted_executions(), 1);
+  EXPECT_EQ(stats_response.compaction_stats().num_deleted_contexts(), 0);
+  EXPECT_GT(stats_response.compaction_stats().last_chunk_time_since_epoch(),
+            0);
+  metadata_store.reset();
+  TF_EXPECT_OK(tensorflow::Env::Default()->DeleteFile(filename_uri));
+}
+
+TEST_F(MetadataStoreTest, GetChangesFromCursor) {
+  WatchChangesRequest watch_request;
+  WatchChangesResponse watch_response;
+  EXPECT_EQ(metadata_store_->GetChanges(watch_request, &watch_response).code(),
+            tensorflow::error::FAILED_PRECONDITION);
+  ChangeLogConfig config;
+  config.set_max_num_changes(0);
+  EXPECT_EQ(metadata_store_->EnableChangeLog(config).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  config.set_max_num_changes(10);
+  TF_ASSERT_OK(metadata_store_->EnableChangeLog(config));
+  // Without a cursor, only the changes after the call are watched.
+  TF_ASSERT_OK(metadata_store_->GetChanges(watch_request, &watch_response));
+  EXPECT_THAT(watch_response.changes(), SizeIs(0));
+  EXPECT_EQ(watch_response.last_sequence(), 0);
+
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'execution_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  Artifact* artifact = put_artifacts_request.add_artifacts();
+  artifact->set_type_id(put_types_response.artifact_type_ids(0));
+  artifact->set_uri("uri");
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  const int64 artifact_id = put_artifacts_response.artifact_ids(0);
+  artifact->set_id(artifact_id);
+  artifact->set_uri("updated_uri");
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  // The failed writes are not recorded.
+  PutArtifactsRequest invalid_put_artifacts_request;
+  invalid_put_artifacts_request.add_artifacts()->set_type_id(
+      put_types_response.artifact_type_ids(0) + 100);
+  EXPECT_FALSE(metadata_store_
+                   ->PutArtifacts(invalid_put_artifacts_request,
+                                  &put_artifacts_response)
+                   .ok());
+  PutExecutionsRequest put_executions_request;
+  put_executions_request.add_executions()->set_type_id(
+      put_types_response.execution_type_ids(0));
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(metadata_store_->PutExecutions(put_executions_request,
+                                              &put_executions_response));
+  PutEventsRequest put_events_request;
+  Event* event = put_events_request.add_events();
+  event->set_artifact_id(artifact_id);
+  event->set_execution_id(put_executions_response.execution_ids(0));
+  event->set_type(Event::OUTPUT);
+  PutEventsResponse put_events_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutEvents(put_events_request, &put_events_response));
+  DeleteArtifactsRequest delete_request;
+  delete_request.add_artifact_ids(artifact_id);
+  DeleteArtifactsResponse delete_response;
+  TF_ASSERT_OK(
+      metadata_store_->DeleteArtifacts(delete_request, &delete_response));
+
+  watch_request.set_log_id(watch_response.log_id());
+  watch_request.set_after_sequence(watch_response.last_sequence());
+  watch_request.set_max_num_changes(2);
+  watch_response.Clear();
+  TF_ASSERT_OK(metadata_store_->GetChanges(watch_request, &watch_response));
+  ASSERT_THAT(watch_response.changes(), SizeIs(2));
+  EXPECT_THAT(watch_response.changes(0),
+              testing::EqualsProto(ParseTextProtoOrDie<Change>(absl::StrCat(
+                  "sequence: 1 type: CREATE artifact { id: ", artifact_id,
+                  " type_id: ", put_types_response.artifact_type_ids(0),
+                  " uri: 'uri' }"))));
+  EXPECT_EQ(watch_response.changes(1).type(), Change::UPDATE);
+  EXPECT_EQ(watch_response.changes(1).artifact().uri(), "updated_uri");
+  EXPECT_EQ(watch_response.last_sequence(), 2);
+
+  watch_request.set_after_sequence(watch_response.last_sequence());
+  watch_request.set_max_num_changes(0);
+  watch_response.Clear();
+  TF_ASSERT_OK(metadata_store_->GetChanges(watch_request, &watch_response));
+  ASSERT_THAT(watch_response.changes(), SizeIs(3));
+  EXPECT_EQ(watch_response.changes(0).type(), Change::CREATE);
+  EXPECT_EQ(watch_response.changes(0).execution().id(),
+            put_executions_response.execution_ids(0));
+  EXPECT_THAT(watch_response.changes(1).event(),
+              testing::EqualsProto(*event));
+  EXPECT_THAT(watch_response.changes(2),
+              testing::EqualsProto(ParseTextProtoOrDie<Change>(absl::StrCat(
+                  "sequence: 5 type: DELETE artifact { id: ", artifact_id,
+                  " }"))));
+  EXPECT_EQ(watch_response.last_sequence(), 5);
+
+  // The cursor of another change log is rejected.
+  watch_request.set_log_id(watch_response.log_id() + 1);
+  EXPECT_EQ(metadata_store_->GetChanges(watch_request, &watch_response).code(),
+            tensorflow::error::OUT_OF_RANGE);
+}
+
+TEST_F(MetadataStoreTest, ChangeLogContinuesAfterRestart) {
+  const string filename_uri =
+      absl::StrCat(::testing::TempDir(), "metadata_store_change_log.db");
+  SqliteMetadataSourceConfig connection_config;
+  connection_config.set_filename_uri(filename_uri);
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+      )");
+  WatchChangesRequest watch_request;
+  WatchChangesResponse watch_response;
+  for (int restart = 0; restart < 2; restart++) {
+    std::unique_ptr<MetadataStore> metadata_store;
+    TF_ASSERT_OK(MetadataStore::Create(
+        util::GetSqliteMetadataSourceQueryConfig(), {},
+        absl::make_unique<SqliteMetadataSource>(connection_config),
+        &metadata_store));
+    TF_ASSERT_OK(metadata_store->InitMetadataStoreIfNotExists());
+    TF_ASSERT_OK(metadata_store->EnableChangeLog(ChangeLogConfig()));
+    // The cursor of the previous process is resumed.
+    watch_response.Clear();
+    TF_ASSERT_OK(metadata_store->GetChanges(watch_request, &watch_response));
+    EXPECT_THAT(watch_response.changes(), SizeIs(0));
+    EXPECT_EQ(watch_response.last_sequence(), restart);
+    watch_request.set_log_id(watch_response.log_id());
+    watch_request.set_after_sequence(watch_response.last_sequence());
+
+    PutTypesResponse put_types_response;
+    TF_ASSERT_OK(
+        metadata_store->PutTypes(put_types_request, &put_types_response));
+    PutArtifactsRequest put_artifacts_request;
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_types_response.artifact_type_ids(0));
+    PutArtifactsResponse put_artifacts_response;
+    TF_ASSERT_OK(metadata_store->PutArtifacts(put_artifacts_request,
+                                              &put_artifacts_response));
+    watch_response.Clear();
+    TF_ASSERT_OK(metadata_store->GetChanges(watch_request, &watch_response));
+    ASSERT_THAT(watch_response.changes(), SizeIs(1));
+    EXPECT_EQ(watch_response.changes(0).sequence(), restart + 1);
+    EXPECT_EQ(watch_response.changes(0).artifact().id(),
+              put_artifacts_response.artifact_ids(0));
+    watch_request.set_after_sequence(watch_response.last_sequence());
+  }
+  TF_EXPECT_OK(tensorflow::Env::Default()->DeleteFile(filename_uri));
+}
+
+TEST_F(MetadataStoreTest, ChangeWatchersAreBounded) {
+  EXPECT_EQ(metadata_store_->AddChangeWatcher().code(),
+            tensorflow::error::FAILED_PRECONDITION);
+  ChangeLogConfig config;
+  config.set_max_num_watchers(0);
+  EXPECT_EQ(metadata_store_->EnableChangeLog(config).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  config.set_max_num_watchers(1);
+  TF_ASSERT_OK(metadata_store_->EnableChangeLog(config));
+  TF_ASSERT_OK(metadata_store_->AddChangeWatcher());
+  EXPECT_EQ(metadata_store_->AddChangeWatcher().code(),
+            tensorflow::error::RESOURCE_EXHAUSTED);
+  metadata_store_->RemoveChangeWatcher();
+  TF_EXPECT_OK(metadata_store_->AddChangeWatcher());
+}
+
+TEST_F(MetadataStoreTest, BackupStore) {
+  const string source_filename_uri =
+      absl::StrCat(::testing::TempDir(), "metadata_store_backup_source.db");
+  SqliteMetadataSourceConfig source_config;
+  source_config.set_filename_uri(source_filename_uri);
+  std::unique_ptr<MetadataStore> metadata_store;
+  TF_ASSERT_OK(MetadataStore::Create(
+      util::GetSqliteMetadataSourceQueryConfig(), {},
+      absl::make_unique<SqliteMetadataSource>(source_config),
+      &metadata_store));
+  TF_ASSERT_OK(metadata_store->InitMetadataStore());
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store->PutTypes(put_types_request, &put_types_response));
+  const string filename_uri =
+      absl::StrCat(::testing::TempDir(), "metadata_store_backup.db");
+  BackupStoreRequest backup_request;
+  backup_request.set_destination_filename_uri(filename_uri);
+  backup_request.set_pages_per_step(2);
+  backup_request.set_step_interval_millis(0);
+  BackupStoreResponse backup_response;
+  EXPECT_EQ(metadata_store->BackupStore(backup_request, &backup_response)
+                .code(),
+            tensorflow::error::FAILED_PRECONDITION);
+
+  BackupConfig backup_config;
+  backup_config.set_directory("backups");
+  EXPECT_EQ(metadata_store->EnableBackups(backup_config).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  backup_config.set_directory(::testing::TempDir());
+  TF_ASSERT_OK(metadata_store->EnableBackups(backup_config));
+  // The destination should be a new file directly within the directory.
+  for (const string& destination_filename_uri :
+       {string(), absl::StrCat(::testing::TempDir(), "sub/backup.db"),
+        absl::StrCat(::testing::TempDir(), "../backup.db"),
+        absl::StrCat(filename_uri, "?vfs=unix"), string("backup.db"),
+        source_filename_uri}) {
+    backup_request.set_destination_filename_uri(destination_filename_uri);
+    EXPECT_EQ(metadata_store->BackupStore(backup_request, &backup_response)
+                  .code(),
+              tensorflow::error::INVALID_ARGUMENT)
+        << destination_filename_uri;
+  }
+
+  backup_request.set_destination_filename_uri(
+      absl::StrCat("file://", filename_uri));
+  TF_ASSERT_OK(metadata_store->BackupStore(backup_request, &backup_response));
+  EXPECT_GT(backup_response.num_pages(), 0);
+  metadata_store.reset();
+  TF_EXPECT_OK(tensorflow::Env::Default()->DeleteFile(source_filename_uri));
+
+  // The backup is a store with the same types.
+  {
+    SqliteMetadataSourceConfig config;
+    config.set_filename_uri(filename_uri);
+    std::unique_ptr<MetadataStore> backup_store;
+    TF_ASSERT_OK(MetadataStore::Create(
+        util::GetSqliteMetadataSourceQueryConfig(), {},
+        absl::make_unique<SqliteMetadataSource>(config), &backup_store));
+    GetArtifactTypeRequest get_type_request;
+    get_type_request.set_type_name("artifact_type");
+    GetArtifactTypeResponse get_type_response;
+    TF_ASSERT_OK(
+        backup_store->GetArtifactType(get_type_request, &get_type_response));
+    EXPECT_EQ(get_type_response.artifact_type().id(),
+              put_types_response.artifact_type_ids(0));
+  }
+  TF_EXPECT_OK(tensorflow::Env::Default()->DeleteFile(filename_uri));
+}
+
+TEST_F(MetadataStoreTest, ExportStoreImportStore) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: {
+          name: 'artifact_type'
+          properties { key: 'p' value: INT }
+        }
+        execution_types: { name: 'execution_type' }
+        context_types: { name: 'context_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 3; i++) {
+    Artifact* artifact = put_artifacts_request.add_artifacts();
+    artifact->set_type_id(put_types_response.artifact_type_ids(0));
+    artifact->set_uri(absl::StrCat("uri", i));
+    (*artifact->mutable_properties())["p"].set_int_value(i);
+  }
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(metadata_store_->PutArtifacts(put_artifacts_request,
+                                             &put_artifacts_response));
+  PutExecutionRequest put_execution_request;
+  put_execution_request.mutable_execution()->set_type_id(
+      put_types_response.execution_type_ids(0));
+  PutExecutionRequest::ArtifactAndEvent* artifact_and_event =
+      put_execution_request.add_artifact_event_pairs();
+  *artifact_and_event->mutable_artifact() =
+      put_artifacts_request.artifacts(2);
+  artifact_and_event->mutable_artifact()->set_id(
+      put_artifacts_response.artifact_ids(2));
+  artifact_and_event->mutable_event()->set_type(Event::OUTPUT);
+  Context* context = put_execution_request.add_contexts();
+  context->set_type_id(put_types_response.context_type_ids(0));
+  context->set_name("context1");
+  PutExecutionResponse put_execution_response;
+  TF_ASSERT_OK(metadata_store_->PutExecution(put_execution_request,
+                                             &put_execution_response));
+
+  // The artifacts are read in two pages.
+  string snapshot;
+  {
+    google::protobuf::io::StringOutputStream output(&snapshot);
+    EXPECT_EQ(metadata_store_->ExportStore(0, &output).code(),
+              tensorflow::error::INVALID_ARGUMENT);
+    TF_ASSERT_OK(metadata_store_->ExportStore(2, &output));
+  }
+
+  // The target store has a node already, so the imported ids are remapped.
+  std::unique_ptr<MetadataStore> target_store;
+  TF_ASSERT_OK(MetadataStore::Create(
+      util::GetSqliteMetadataSourceQueryConfig(), {},
+      absl::make_unique<SqliteMetadataSource>(SqliteMetadataSourceConfig()),
+      &target_store));
+  TF_ASSERT_OK(target_store->InitMetadataStore());
+  const PutTypesRequest put_other_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        execution_types: { name: 'other_type' }
+      )");
+  PutTypesResponse put_other_types_response;
+  TF_ASSERT_OK(target_store->PutTypes(put_other_types_request,
+                                      &put_other_types_response));
+  PutExecutionsRequest put_executions_request;
+  put_executions_request.add_executions()->set_type_id(
+      put_other_types_response.execution_type_ids(0));
+  PutExecutionsResponse put_executions_response;
+  TF_ASSERT_OK(target_store->PutExecutions(put_executions_request,
+                                           &put_executions_response));
+
+  google::protobuf::io::ArrayInputStream input(snapshot.data(),
+                                               snapshot.size());
+  TF_ASSERT_OK(target_store->ImportStore(3, &input));
+
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(target_store->GetArtifacts({}, &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(3));
+  for (int i = 0; i < 3; i++) {
+    const Artifact& artifact = get_artifacts_response.artifacts(i);
+    EXPECT_EQ(artifact.uri(), absl::StrCat("uri", i));
+    EXPECT_EQ(artifact.properties().at("p").int_value(), i);
+  }
+  GetExecutionsResponse get_executions_response;
+  TF_ASSERT_OK(target_store->GetExecutions({}, &get_executions_response));
+  ASSERT_THAT(get_executions_response.executions(), SizeIs(2));
+  const int64 execution_id = get_executions_response.executions(1).id();
+  EXPECT_NE(execution_id, put_execution_response.execution_id());
+
+  GetEventsByExecutionIDsRequest get_events_request;
+  get_events_request.add_execution_ids(execution_id);
+  GetEventsByExecutionIDsResponse get_events_response;
+  TF_ASSERT_OK(target_store->GetEventsByExecutionIDs(get_events_request,
+                                                     &get_events_response));
+  ASSERT_THAT(get_events_response.events(), SizeIs(1));
+  EXPECT_EQ(get_events_response.events(0).artifact_id(),
+            get_artifacts_response.artifacts(2).id());
+  EXPECT_EQ(get_events_response.events(0).type(), Event::OUTPUT);
+
+  GetContextsResponse get_contexts_response;
+  TF_ASSERT_OK(target_store->GetContexts({}, &get_contexts_response));
+  ASSERT_THAT(get_contexts_response.contexts(), SizeIs(1));
+  EXPECT_EQ(get_contexts_response.contexts(0).name(), "context1");
+  GetArtifactsByContextRequest get_artifacts_by_context_request;
+  get_artifacts_by_context_request.set_context_id(
+      get_contexts_response.contexts(0).id());
+  GetArtifactsByContextResponse get_artifacts_by_context_response;
+  TF_ASSERT_OK(target_store->GetArtifactsByContext(
+      get_artifacts_by_context_request, &get_artifacts_by_context_response));
+  ASSERT_THAT(get_artifacts_by_context_response.artifacts(), SizeIs(1));
+  EXPECT_EQ(get_artifacts_by_context_response.artifacts(0).uri(), "uri2");
+  GetExecutionsByContextRequest get_executions_by_context_request;
+  get_executions_by_context_request.set_context_id(
+      get_contexts_response.contexts(0).id());
+  GetExecutionsByContextResponse get_executions_by_context_response;
+  TF_ASSERT_OK(target_store->GetExecutionsByContext(
+      get_executions_by_context_request, &get_executions_by_context_response));
+  ASSERT_THAT(get_executions_by_context_response.executions(), SizeIs(1));
+  EXPECT_EQ(get_executions_by_context_response.executions(0).id(),
+            execution_id);
+
+  // The imported context exists in the target store already.
+  google::protobuf::io::ArrayInputStream input_again(snapshot.data(),
+                                                     snapshot.size());
+  EXPECT_EQ(target_store->ImportStore(3, &input_again).code(),
+            tensorflow::error::ALREADY_EXISTS);
+
+  // The type with the same name and different properties is not reused.
+  std::unique_ptr<MetadataStore> other_store;
+  TF_ASSERT_OK(MetadataStore::Create(
+      util::GetSqliteMetadataSourceQueryConfig(), {},
+      absl::make_unique<SqliteMetadataSource>(SqliteMetadataSourceConfig()),
+      &other_store));
+  TF_ASSERT_OK(other_store->InitMetadataStore());
+  const PutTypesRequest put_different_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: {
+          name: 'artifact_type'
+          properties { key: 'p' value: STRING }
+        }
+      )");
+  PutTypesResponse put_different_types_response;
+  TF_ASSERT_OK(other_store->PutTypes(put_different_types_request,
+                                     &put_different_types_response));
+  google::protobuf::io::ArrayInputStream input_other(snapshot.data(),
+                                                     snapshot.size());
+  EXPECT_EQ(other_store->ImportStore(3, &input_other).code(),
+            tensorflow::error::ALREADY_EXISTS);
+}
+
+TEST_F(MetadataStoreTest, ImportStoreRecordsChanges) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'execution_type' }
+        context_types: { name: 'context_type' }
+      )");
+  PutTypesResponse put_types_response;
+  TF_ASSERT_OK(
+      metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutExecutionRequest put_execution_request;
+  put_execution_request.mutable_execution()->set_type_id(
+      put_types_response.execution_type_ids(0));
+  PutExecutionRequest::ArtifactAndEvent* artifact_and_event =
+      put_execution_request.add_artifact_event_pairs();
+  artifact_and_event->mutable_artifact()->set_type_id(
+      put_types_response.artifact_type_ids(0));
+  artifact_and_event->mutable_artifact()->set_uri("uri");
+  artifact_and_event->mutable_event()->set_type(Event::OUTPUT);
+  Context* context = put_execution_request.add_contexts();
+  context->set_type_id(put_types_response.context_type_ids(0));
+  context->set_name("context");
+  PutExecutionResponse put_execution_response;
+  TF_ASSERT_OK(metadata_store_->PutExecution(put_execution_request,
+                                             &put_execution_response));
+  string snapshot;
+  {
+    google::protobuf::io::StringOutputStream output(&snapshot);
+    TF_ASSERT_OK(metadata_store_->ExportStore(2, &output));
+  }
+
+  // The target store has an artifact already, so the imported ids are
+  // remapped.
+  std::unique_ptr<MetadataStore> target_store;
+  TF_ASSERT_OK(MetadataStore::Create(
+      util::GetSqliteMetadataSourceQueryConfig(), {},
+      absl::make_unique<SqliteMetadataSource>(SqliteMetadataSourceConfig()),
+      &target_store));
+  TF_ASSERT_OK(target_store->InitMetadataStore());
+  PutTypesResponse target_put_types_response;
+  TF_ASSERT_OK(
+      target_store->PutTypes(put_types_request, &target_put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  put_artifacts_request.add_artifacts()->set_type_id(
+      target_put_types_response.artifact_type_ids(0));
+  PutArtifactsResponse put_artifacts_response;
+  TF_ASSERT_OK(target_store->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+  TF_ASSERT_OK(target_store->EnableChangeLog(ChangeLogConfig()));
+  WatchChangesRequest watch_request;
+  WatchChangesResponse watch_response;
+  TF_ASSERT_OK(target_store->GetChanges(watch_request, &watch_response));
+
+  // Each record is imported in a batch of its own, so the changes follow the
+  // order of the snapshot.
+  google::protobuf::io::ArrayInputStream input(snapshot.data(),
+                                               snapshot.size());
+  TF_ASSERT_OK(target_store->ImportStore(1, &input));
+
+  GetArtifactsResponse get_artifacts_response;
+  TF_ASSERT_OK(target_store->GetArtifacts({}, &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(2));
+  const int64 artifact_id = get_artifacts_response.artifacts(1).id();
+  EXPECT_NE(artifact_id, put_execution_response.artifact_ids(0));
+  GetExecutionsResponse get_executions_response;
+  TF_ASSERT_OK(target_store->GetExecutions({}, &get_executions_response));
+  ASSERT_THAT(get_executions_response.executions(), SizeIs(1));
+  const int64 execution_id = get_executions_response.executions(0).id();
+  GetContextsResponse get_contexts_response;
+  TF_ASSERT_OK(target_store->GetContexts({}, &get_contexts_response));
+  ASSERT_THAT(get_contexts_response.contexts(), SizeIs(1));
+  const int64 context_id = get_contexts_response.contexts(0).id();
+
+  watch_request.set_log_id(watch_response.log_id());
+  watch_request.set_after_sequence(watch_response.last_sequence());
+  watch_response.Clear();
+  TF_ASSERT_OK(target_store->GetChanges(watch_request, &watch_response));
+  ASSERT_THAT(watch_response.changes(), SizeIs(6));
+  for (const Change& change : watch_response.changes()) {
+    EXPECT_EQ(change.type(), Change::CREATE);
+  }
+  EXPECT_EQ(watch_response.changes(0).context().id(), context_id);
+  EXPECT_EQ(watch_response.changes(0).context().name(), "context");
+  EXPECT_EQ(watch_response.changes(1).artifact().id(), artifact_id);
+  EXPECT_EQ(watch_response.changes(1).artifact().uri(), "uri");
+  EXPECT_THAT(watch_response.changes(2).attribution(),
+              testing::EqualsProto(ParseTextProtoOrDie<Attribution>(
+                  absl::StrCat("artifact_id: ", artifact_id,
+                               " context_id: ", context_id))));
+  EXPECT_EQ(watch_response.changes(3).execution().id(), execution_id);
+  EXPECT_THAT(watch_response.changes(4).association(),
+              testing::EqualsProto(ParseTextProtoOrDie<Association>(
+                  absl::StrCat("execution_id: ", execution_id,
+                               " context_id: ", context_id))));
+  EXPECT_EQ(watch_response.changes(5).event().artifact_id(), artifact_id);
+  EXPECT_EQ(watch_response.changes(5).event().execution_id(), execution_id);
+  EXPECT_EQ(watch_response.changes(5).event().type(), Event::OUTPUT);
+
+  // The failed import records no changes.
+  google::protobuf::io::ArrayInputStream input_again(snapshot.data(),
+                                                     snapshot.size());
+  EXPECT_EQ(target_store->ImportStore(1, &input_again).code(),
+            tensorflow::error::ALREADY_EXISTS);
+  watch_request.set_after_sequence(watch_response.last_sequence());
+  watch_response.Clear();
+  TF_ASSERT_OK(target_store->GetChanges(watch_request, &watch_response));
+  EXPECT_THAT(watch_response.changes(), SizeIs(0));
+}
+
 }  // namespace
 }  // namespace ml_metadata
@@ -16,7 +16,13 @@ limitations under the License.
 package mlmetadata
 
 import (
+	"fmt"
+	"io/ioutil"
 	"log"
+	"os"
+	"path/filepath"
+	"runtime"
+	"sync"
 	"testing"
 
 	"github.com/google/go-cmp/cmp"
@@ -1262,3 +1268,167 @@ func TestPutDuplicatedAttributionsAndEmptyAssociations(t *testing.T) {
 		t.Errorf("GetArtifactsByContext returned result is incorrect. want: %v, got: %v", wantArtifact, gotArtifacts[0])
 	}
 }
+
+// sqliteFileConfig returns the config of a sqlite database file in a new
+// temporary directory, and a function removing the directory.
+func sqliteFileConfig(tb testing.TB) (*mdpb.ConnectionConfig, func()) {
+	dir, err := ioutil.TempDir("", "mlmd")
+	if err != nil {
+		tb.Fatalf("Cannot create temporary directory: %v", err)
+	}
+	config := createConnectionConfig(fmt.Sprintf(
+		`sqlite { filename_uri: '%s' connection_mode: READWRITE_OPENCREATE }`,
+		filepath.Join(dir, "mlmd.db")))
+	return config, func() { os.RemoveAll(dir) }
+}
+
+func TestNewPooledStoreWithInMemoryDatabase(t *testing.T) {
+	if _, err := NewPooledStore(fakeDatabaseConfig(), 2); err == nil {
+		t.Errorf("NewPooledStore should fail for a fake database with pool size 2")
+	}
+	if _, err := NewPooledStore(createConnectionConfig(`sqlite {}`), 2); err == nil {
+		t.Errorf("NewPooledStore should fail for an in-memory sqlite database with pool size 2")
+	}
+	if _, err := NewPooledStore(fakeDatabaseConfig(), 0); err == nil {
+		t.Errorf("NewPooledStore should fail for pool size 0")
+	}
+}
+
+func TestPooledStoreConcurrentCalls(t *testing.T) {
+	config, cleanup := sqliteFileConfig(t)
+	defer cleanup()
+	store, err := NewPooledStore(config, 4)
+	if err != nil {
+		t.Fatalf("Cannot create Store: %v", err)
+	}
+	tid, err := insertArtifactType(store, `name: 'test_type_name'`)
+	if err != nil {
+		t.Fatalf("Cannot create artifact type: %v", err)
+	}
+
+	const numGoroutines, numArtifacts = 8, 10
+	artifacts := make([]*mdpb.Artifact, numArtifacts)
+	for i := range artifacts {
+		uri := fmt.Sprintf("uri_%v", i)
+		artifacts[i] = &mdpb.Artifact{TypeId: &tid, Uri: &uri}
+	}
+	aids, err := store.PutArtifacts(artifacts)
+	if err != nil {
+		t.Fatalf("PutArtifacts failed: %v", err)
+	}
+
+	// The goroutines share the 4 connections of the store.
+	var wg sync.WaitGroup
+	errs := make(chan error, numGoroutines*numArtifacts)
+	for g := 0; g < numGoroutines; g++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := 0; i < numArtifacts; i++ {
+				got, err := store.GetArtifactsByID(aids)
+				if err != nil {
+					errs <- err
+				} else if len(got) != numArtifacts {
+					errs <- fmt.Errorf("want %v artifacts, got %v", numArtifacts, len(got))
+				}
+			}
+		}()
+	}
+	wg.Wait()
+	close(errs)
+	for err := range errs {
+		t.Errorf("GetArtifactsByID failed: %v", err)
+	}
+
+	store.Close()
+	if _, err := store.GetArtifacts(); err == nil {
+		t.Errorf("GetArtifacts should fail after Close")
+	}
+}
+
+func TestPooledStoreCloseDuringCalls(t *testing.T) {
+	config, cleanup := sqliteFileConfig(t)
+	defer cleanup()
+	store, err := NewPooledStore(config, 2)
+	if err != nil {
+		t.Fatalf("Cannot create Store: %v", err)
+	}
+	tid, err := insertArtifactType(store, `name: 'test_type_name'`)
+	if err != nil {
+		t.Fatalf("Cannot create artifact type: %v", err)
+	}
+
+	// The calls racing with Close either succeed or fail as the Store is
+	// closed, and none of them uses a destroyed cc store.
+	const numGoroutines, numCalls = 8, 20
+	var wg sync.WaitGroup
+	errs := make(chan error, numGoroutines*numCalls)
+	for g := 0; g < numGoroutines; g++ {
+		wg.Add(1)
+		go func(g int) {
+			defer wg.Done()
+			for i := 0; i < numCalls; i++ {
+				uri := fmt.Sprintf("uri_%v_%v", g, i)
+				artifacts := []*mdpb.Artifact{{TypeId: &tid, Uri: &uri}}
+				if _, err := store.PutArtifacts(artifacts); err != nil && err != errStoreClosed {
+					errs <- err
+				}
+				if _, err := store.GetArtifactsByURI(uri); err != nil && err != errStoreClosed {
+					errs <- err
+				}
+			}
+		}(g)
+	}
+	store.Close()
+	store.Close()
+	wg.Wait()
+	close(errs)
+	for err := range errs {
+		t.Errorf("A call racing with Close failed: %v", err)
+	}
+	if _, err := store.GetArtifacts(); err != errStoreClosed {
+		t.Errorf("GetArtifacts after Close: want %v, got %v", errStoreClosed, err)
+	}
+}
+
+// BenchmarkPooledStoreGetArtifactsByID measures how the reads scale with
+// GOMAXPROCS, e.g., with `go test -bench=PooledStore -cpu=1,2,4,8`. The pool
+// has one connection per GOMAXPROCS.
+func BenchmarkPooledStoreGetArtifactsByID(b *testing.B) {
+	config, cleanup := sqliteFileConfig(b)
+	defer cleanup()
+	store, err := NewPooledStore(config, runtime.GOMAXPROCS(0))
+	if err != nil {
+		b.Fatalf("Cannot create Store: %v", err)
+	}
+	defer store.Close()
+	tid, err := insertArtifactType(store, `name: 'test_type_name' properties { key: 'p1' value: STRING }`)
+	if err != nil {
+		b.Fatalf("Cannot create artifact type: %v", err)
+	}
+	artifacts := make([]*mdpb.Artifact, 100)
+	for i := range artifacts {
+		uri := fmt.Sprintf("uri_%v", i)
+		artifacts[i] = &mdpb.Artifact{
+			TypeId: &tid,
+			Uri:    &uri,
+			Properties: map[string]*mdpb.Value{
+				`p1`: &mdpb.Value{Value: &mdpb.Value_StringValue{StringValue: uri}},
+			},
+		}
+	}
+	aids, err := store.PutArtifacts(artifacts)
+	if err != nil {
+		b.Fatalf("PutArtifacts failed: %v", err)
+	}
+
+	b.ResetTimer()
+	b.RunParallel(func(pb *testing.PB) {
+		for pb.Next() {
+			if _, err := store.GetArtifactsByID(aids); err != nil {
+				b.Errorf("GetArtifactsByID failed: %v", err)
+				return
+			}
+		}
+	})
+}
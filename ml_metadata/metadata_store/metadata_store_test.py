@@ -18,6 +18,7 @@ from __future__ import division
 from __future__ import print_function
 
 import os
+import threading
 import uuid
 
 from absl import flags
@@ -221,6 +222,32 @@ class MetadataStoreTest(absltest.TestCase):
     self.assertEqual(artifact_result.properties["bar"].string_value, "Hello")
     self.assertEqual(artifact_result.properties["foo"].int_value, 3)
 
+  def test_put_artifacts_from_threads(self):
+    store = _get_metadata_store()
+    artifact_type = _create_example_artifact_type(self._get_test_type_name())
+    type_id = store.put_artifact_type(artifact_type)
+    artifact_ids = []
+    lock = threading.Lock()
+
+    def put_artifacts(thread_index):
+      for i in range(10):
+        artifact = metadata_store_pb2.Artifact()
+        artifact.type_id = type_id
+        artifact.uri = "uri_{}_{}".format(thread_index, i)
+        [artifact_id] = store.put_artifacts([artifact])
+        with lock:
+          artifact_ids.append(artifact_id)
+
+    threads = [
+        threading.Thread(target=put_artifacts, args=(i,)) for i in range(4)
+    ]
+    for thread in threads:
+      thread.start()
+    for thread in threads:
+      thread.join()
+    self.assertLen(set(artifact_ids), 40)
+    self.assertLen(store.get_artifacts_by_id(artifact_ids), 40)
+
   def test_put_artifacts_get_artifacts(self):
     store = _get_metadata_store()
     artifact_type = _create_example_artifact_type(self._get_test_type_name())
@@ -0,0 +1,108 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/node_cache.h"
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace ml_metadata {
+
+NodeCache::NodeCache(const int64 max_num_entries)
+    : max_num_entries_(max_num_entries),
+      artifacts_(max_num_entries),
+      executions_(max_num_entries),
+      contexts_(max_num_entries),
+      context_ids_(max_num_entries) {
+  CHECK_GT(max_num_entries, 0);
+}
+
+bool NodeCache::CountLookup(const bool hit) {
+  if (hit) {
+    num_hits_++;
+  } else {
+    num_misses_++;
+  }
+  return hit;
+}
+
+bool NodeCache::GetArtifact(const int64 id, Artifact* artifact) {
+  const Artifact* cached = artifacts_.Get(id);
+  if (cached != nullptr) *artifact = *cached;
+  return CountLookup(cached != nullptr);
+}
+
+bool NodeCache::GetExecution(const int64 id, Execution* execution) {
+  const Execution* cached = executions_.Get(id);
+  if (cached != nullptr) *execution = *cached;
+  return CountLookup(cached != nullptr);
+}
+
+bool NodeCache::GetContext(const int64 id, Context* context) {
+  const Context* cached = contexts_.Get(id);
+  if (cached != nullptr) *context = *cached;
+  return CountLookup(cached != nullptr);
+}
+
+bool NodeCache::GetContextByTypeAndName(const string& type_name,
+                                        const string& context_name,
+                                        Context* context) {
+  const int64* context_id = context_ids_.Get({type_name, context_name});
+  const Context* cached =
+      context_id == nullptr ? nullptr : contexts_.Get(*context_id);
+  // contexts cannot change their types, but can be renamed.
+  const bool hit = cached != nullptr && cached->name() == context_name;
+  if (hit) *context = *cached;
+  return CountLookup(hit);
+}
+
+void NodeCache::PutArtifact(const Artifact& artifact) {
+  DCHECK(artifact.has_id());
+  artifacts_.Put(artifact.id(), artifact);
+}
+
+void NodeCache::PutExecution(const Execution& execution) {
+  DCHECK(execution.has_id());
+  executions_.Put(execution.id(), execution);
+}
+
+void NodeCache::PutContext(const Context& context) {
+  DCHECK(context.has_id());
+  contexts_.Put(context.id(), context);
+}
+
+void NodeCache::PutContextId(const string& type_name,
+                             const string& context_name,
+                             const int64 context_id) {
+  context_ids_.Put({type_name, context_name}, context_id);
+}
+
+void NodeCache::EraseArtifact(const int64 id) { artifacts_.Erase(id); }
+
+void NodeCache::EraseExecution(const int64 id) { executions_.Erase(id); }
+
+void NodeCache::EraseContext(const int64 id) { contexts_.Erase(id); }
+
+void NodeCache::Clear() {
+  artifacts_.Clear();
+  executions_.Clear();
+  contexts_.Clear();
+  context_ids_.Clear();
+}
+
+int64 NodeCache::num_entries() const {
+  return artifacts_.size() + executions_.size() + contexts_.size() +
+         context_ids_.size();
+}
+
+}  // namespace ml_metadata
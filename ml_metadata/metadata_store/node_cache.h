@@ -0,0 +1,157 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_NODE_CACHE_H_
+#define ML_METADATA_METADATA_STORE_NODE_CACHE_H_
+
+#include <list>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// A size-bounded cache of the artifacts, executions and contexts read from the
+// metadata source, and of the context ids looked up by context type name and
+// context name. Each kind of entry is evicted in least recently used order
+// once there are more than `max_num_entries` of them.
+//
+// The cache does not observe the metadata source. The owner is expected to
+// invalidate the nodes it writes, so the cache should be used only when the
+// owner is the sole writer of the metadata source.
+//
+// It is thread-unsafe.
+class NodeCache {
+ public:
+  // Creates an empty cache. `max_num_entries` is the maximum number of cached
+  // entries of each kind, and should be positive.
+  explicit NodeCache(int64 max_num_entries);
+
+  // default & copy constructors are disallowed.
+  NodeCache() = delete;
+  NodeCache(const NodeCache&) = delete;
+  NodeCache& operator=(const NodeCache&) = delete;
+
+  // Returns true and copies the cached node to the output, if the node with
+  // `id` is cached. Each lookup counts as a hit or a miss.
+  bool GetArtifact(int64 id, Artifact* artifact);
+  bool GetExecution(int64 id, Execution* execution);
+  bool GetContext(int64 id, Context* context);
+
+  // Returns true and copies the cached context to the output, if the context
+  // with `context_name` and the context type `type_name` is cached. The lookup
+  // counts as a single hit or miss. A context renamed since its id was cached
+  // is a miss.
+  bool GetContextByTypeAndName(const string& type_name,
+                               const string& context_name, Context* context);
+
+  // Caches the given node, which must have an id.
+  void PutArtifact(const Artifact& artifact);
+  void PutExecution(const Execution& execution);
+  void PutContext(const Context& context);
+
+  // Caches the id of the context with `context_name` and the context type
+  // `type_name`.
+  void PutContextId(const string& type_name, const string& context_name,
+                    int64 context_id);
+
+  // Removes the node with `id` if it is cached.
+  void EraseArtifact(int64 id);
+  void EraseExecution(int64 id);
+  void EraseContext(int64 id);
+
+  // Removes all entries. The hit and miss counters are kept.
+  void Clear();
+
+  // Returns the number of cached entries of all kinds.
+  int64 num_entries() const;
+
+  int64 max_num_entries() const { return max_num_entries_; }
+  int64 num_hits() const { return num_hits_; }
+  int64 num_misses() const { return num_misses_; }
+
+ private:
+  // A map evicting its least recently used entry when it is full.
+  template <typename Key, typename Value>
+  class LruMap {
+   public:
+    explicit LruMap(int64 capacity) : capacity_(capacity) {}
+
+    // Returns the value of `key` and marks it as the most recently used, or
+    // null if `key` is absent.
+    const Value* Get(const Key& key) {
+      auto it = index_.find(key);
+      if (it == index_.end()) return nullptr;
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return &it->second->second;
+    }
+
+    // Inserts or replaces the value of `key`.
+    void Put(const Key& key, const Value& value) {
+      auto it = index_.find(key);
+      if (it != index_.end()) {
+        it->second->second = value;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+      }
+      entries_.emplace_front(key, value);
+      index_[key] = entries_.begin();
+      if (size() > capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+      }
+    }
+
+    void Erase(const Key& key) {
+      auto it = index_.find(key);
+      if (it == index_.end()) return;
+      entries_.erase(it->second);
+      index_.erase(it);
+    }
+
+    void Clear() {
+      index_.clear();
+      entries_.clear();
+    }
+
+    int64 size() const { return index_.size(); }
+
+   private:
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    const int64 capacity_;
+    // The entries from the most to the least recently used.
+    Entries entries_;
+    absl::flat_hash_map<Key, typename Entries::iterator> index_;
+  };
+
+  // Counts the result of a lookup and returns it.
+  bool CountLookup(bool hit);
+
+  const int64 max_num_entries_;
+  LruMap<int64, Artifact> artifacts_;
+  LruMap<int64, Execution> executions_;
+  LruMap<int64, Context> contexts_;
+  // (context type name, context name) -> context id.
+  LruMap<std::pair<string, string>, int64> context_ids_;
+  int64 num_hits_ = 0;
+  int64 num_misses_ = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_NODE_CACHE_H_
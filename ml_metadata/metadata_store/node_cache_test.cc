@@ -0,0 +1,118 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/node_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+
+TEST(NodeCacheTest, GetAndPut) {
+  NodeCache cache(/*max_num_entries=*/10);
+  Artifact artifact;
+  EXPECT_FALSE(cache.GetArtifact(1, &artifact));
+
+  Artifact want_artifact;
+  want_artifact.set_id(1);
+  want_artifact.set_type_id(2);
+  want_artifact.set_uri("uri");
+  cache.PutArtifact(want_artifact);
+  Execution want_execution;
+  want_execution.set_id(1);
+  want_execution.set_type_id(3);
+  cache.PutExecution(want_execution);
+  Context want_context;
+  want_context.set_id(1);
+  want_context.set_type_id(4);
+  want_context.set_name("context");
+  cache.PutContext(want_context);
+  cache.PutContextId("context_type", "context", 1);
+
+  ASSERT_TRUE(cache.GetArtifact(1, &artifact));
+  EXPECT_THAT(artifact, EqualsProto(want_artifact));
+  Execution execution;
+  ASSERT_TRUE(cache.GetExecution(1, &execution));
+  EXPECT_THAT(execution, EqualsProto(want_execution));
+  Context context;
+  ASSERT_TRUE(cache.GetContext(1, &context));
+  EXPECT_THAT(context, EqualsProto(want_context));
+  context.Clear();
+  ASSERT_TRUE(
+      cache.GetContextByTypeAndName("context_type", "context", &context));
+  EXPECT_THAT(context, EqualsProto(want_context));
+  EXPECT_FALSE(
+      cache.GetContextByTypeAndName("context_type", "other", &context));
+  EXPECT_FALSE(cache.GetContext(2, &context));
+  // a renamed context is not found by its cached name.
+  want_context.set_name("renamed");
+  cache.PutContext(want_context);
+  EXPECT_FALSE(
+      cache.GetContextByTypeAndName("context_type", "context", &context));
+
+  EXPECT_EQ(cache.num_entries(), 4);
+  EXPECT_EQ(cache.num_hits(), 4);
+  EXPECT_EQ(cache.num_misses(), 4);
+}
+
+TEST(NodeCacheTest, EvictLeastRecentlyUsed) {
+  NodeCache cache(/*max_num_entries=*/2);
+  for (int64 id = 1; id <= 2; id++) {
+    Artifact artifact;
+    artifact.set_id(id);
+    cache.PutArtifact(artifact);
+  }
+  Artifact artifact;
+  // uses artifact 1, so that artifact 2 is evicted by artifact 3.
+  ASSERT_TRUE(cache.GetArtifact(1, &artifact));
+  artifact.set_id(3);
+  cache.PutArtifact(artifact);
+
+  EXPECT_EQ(cache.num_entries(), 2);
+  EXPECT_TRUE(cache.GetArtifact(1, &artifact));
+  EXPECT_FALSE(cache.GetArtifact(2, &artifact));
+  EXPECT_TRUE(cache.GetArtifact(3, &artifact));
+}
+
+TEST(NodeCacheTest, EraseAndClear) {
+  NodeCache cache(/*max_num_entries=*/10);
+  Artifact artifact;
+  artifact.set_id(1);
+  cache.PutArtifact(artifact);
+  Execution execution;
+  execution.set_id(1);
+  cache.PutExecution(execution);
+  Context context;
+  context.set_id(1);
+  cache.PutContext(context);
+
+  cache.EraseArtifact(1);
+  EXPECT_FALSE(cache.GetArtifact(1, &artifact));
+  EXPECT_TRUE(cache.GetExecution(1, &execution));
+  // erasing an absent node is a no-op.
+  cache.EraseArtifact(1);
+  EXPECT_EQ(cache.num_entries(), 2);
+
+  cache.Clear();
+  EXPECT_EQ(cache.num_entries(), 0);
+  EXPECT_FALSE(cache.GetContext(1, &context));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,114 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/node_read_mask.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr char kProperties[] = "properties";
+constexpr char kCustomProperties[] = "custom_properties";
+
+}  // namespace
+
+tensorflow::Status ParsedNodeReadMask::ParseForDescriptor(
+    const NodeReadMask& read_mask,
+    const google::protobuf::Descriptor* descriptor,
+    ParsedNodeReadMask* parsed_read_mask) {
+  *parsed_read_mask = ParsedNodeReadMask();
+  if (read_mask.paths().empty()) return tensorflow::Status::OK();
+  parsed_read_mask->selects_all_ = false;
+  for (const std::string& path : read_mask.paths()) {
+    std::vector<absl::string_view> parts =
+        absl::StrSplit(path, absl::MaxSplits('.', 1));
+    const std::string field_name(parts[0]);
+    if (descriptor->FindFieldByName(field_name) == nullptr) {
+      return tensorflow::errors::InvalidArgument(
+          "Unknown field ", field_name, " of ", descriptor->name(),
+          " in the read mask path: ", path);
+    }
+    PropertySelection* selection = nullptr;
+    if (field_name == kProperties) {
+      selection = &parsed_read_mask->properties_;
+    } else if (field_name == kCustomProperties) {
+      selection = &parsed_read_mask->custom_properties_;
+    }
+    if (parts.size() == 1) {
+      if (selection != nullptr) {
+        selection->all = true;
+      } else {
+        parsed_read_mask->fields_.insert(field_name);
+      }
+      continue;
+    }
+    if (selection == nullptr || parts[1].empty()) {
+      return tensorflow::errors::InvalidArgument(
+          "Only a property can be selected within a field, but got the read "
+          "mask path: ",
+          path);
+    }
+    selection->names.insert(std::string(parts[1]));
+  }
+  return tensorflow::Status::OK();
+}
+
+bool ParsedNodeReadMask::selects_some_properties() const {
+  return !properties_.all && !custom_properties_.all &&
+         !(properties_.empty() && custom_properties_.empty());
+}
+
+std::vector<std::string> ParsedNodeReadMask::GetSelectedPropertyNames() const {
+  std::vector<std::string> names(properties_.names.begin(),
+                                 properties_.names.end());
+  names.insert(names.end(), custom_properties_.names.begin(),
+               custom_properties_.names.end());
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+  return names;
+}
+
+void ParsedNodeReadMask::ClearUnselectedFields(
+    google::protobuf::Message* node) const {
+  const google::protobuf::Descriptor* descriptor = node->GetDescriptor();
+  const google::protobuf::Reflection* reflection = node->GetReflection();
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const google::protobuf::FieldDescriptor* field = descriptor->field(i);
+    if (field->name() == kProperties || field->name() == kCustomProperties ||
+        fields_.contains(field->name())) {
+      continue;
+    }
+    reflection->ClearField(node, field);
+  }
+}
+
+void ParsedNodeReadMask::FilterProperties(
+    const PropertySelection& selection,
+    google::protobuf::Map<std::string, Value>* properties) {
+  if (selection.all) return;
+  for (auto it = properties->begin(); it != properties->end();) {
+    if (selection.names.contains(it->first)) {
+      ++it;
+    } else {
+      it = properties->erase(it);
+    }
+  }
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,99 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_NODE_READ_MASK_H_
+#define ML_METADATA_METADATA_STORE_NODE_READ_MASK_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/map.h"
+#include "google/protobuf/message.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// A NodeReadMask parsed for a kind of nodes, i.e., Artifact, Execution or
+// Context. It tells which properties need to be read from the metadata
+// source, and clears the fields that are not selected from the nodes read.
+class ParsedNodeReadMask {
+ public:
+  // The properties of a kind, i.e., properties or custom properties, that are
+  // selected by the mask.
+  struct PropertySelection {
+    bool all = false;
+    absl::flat_hash_set<std::string> names;
+
+    bool empty() const { return !all && names.empty(); }
+  };
+
+  // Parses the `read_mask` for the nodes of `Node`.
+  // Returns INVALID_ARGUMENT error, if a path is not a field of the node, or
+  // selects a property of a field which is not a property map.
+  template <typename Node>
+  static tensorflow::Status Parse(const NodeReadMask& read_mask,
+                                  ParsedNodeReadMask* parsed_read_mask) {
+    return ParseForDescriptor(read_mask, Node::descriptor(), parsed_read_mask);
+  }
+
+  // Returns true if the mask selects every field.
+  bool selects_all() const { return selects_all_; }
+
+  const PropertySelection& properties() const { return properties_; }
+  const PropertySelection& custom_properties() const {
+    return custom_properties_;
+  }
+
+  // Returns true if only some properties or custom properties are selected,
+  // i.e., the properties can be read by their names.
+  bool selects_some_properties() const;
+
+  // Returns the names of the properties and custom properties selected by
+  // name, in sorted order.
+  std::vector<std::string> GetSelectedPropertyNames() const;
+
+  // Clears the fields of the node that are not selected.
+  template <typename Node>
+  void Apply(Node* node) const {
+    if (selects_all_) return;
+    ClearUnselectedFields(node);
+    FilterProperties(properties_, node->mutable_properties());
+    FilterProperties(custom_properties_, node->mutable_custom_properties());
+  }
+
+ private:
+  static tensorflow::Status ParseForDescriptor(
+      const NodeReadMask& read_mask,
+      const google::protobuf::Descriptor* descriptor,
+      ParsedNodeReadMask* parsed_read_mask);
+
+  // Clears the fields other than the property maps that are not selected.
+  void ClearUnselectedFields(google::protobuf::Message* node) const;
+
+  static void FilterProperties(
+      const PropertySelection& selection,
+      google::protobuf::Map<std::string, Value>* properties);
+
+  bool selects_all_ = true;
+  absl::flat_hash_set<std::string> fields_;
+  PropertySelection properties_;
+  PropertySelection custom_properties_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_NODE_READ_MASK_H_
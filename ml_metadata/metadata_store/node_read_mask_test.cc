@@ -0,0 +1,115 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/node_read_mask.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::ElementsAre;
+
+TEST(NodeReadMaskTest, EmptyMaskSelectsAll) {
+  ParsedNodeReadMask parsed_read_mask;
+  TF_ASSERT_OK(
+      ParsedNodeReadMask::Parse<Artifact>(NodeReadMask(), &parsed_read_mask));
+  EXPECT_TRUE(parsed_read_mask.selects_all());
+  const Artifact want_artifact = ParseTextProtoOrDie<Artifact>(R"(
+    id: 1 type_id: 2 uri: 'uri'
+    properties { key: 'p' value: { int_value: 1 } }
+  )");
+  Artifact artifact = want_artifact;
+  parsed_read_mask.Apply(&artifact);
+  EXPECT_THAT(artifact, EqualsProto(want_artifact));
+}
+
+TEST(NodeReadMaskTest, InvalidPaths) {
+  ParsedNodeReadMask parsed_read_mask;
+  const NodeReadMask unknown_field =
+      ParseTextProtoOrDie<NodeReadMask>("paths: 'uri'");
+  EXPECT_EQ(ParsedNodeReadMask::Parse<Execution>(unknown_field,
+                                                 &parsed_read_mask)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+  const NodeReadMask nested_field =
+      ParseTextProtoOrDie<NodeReadMask>("paths: 'uri.p'");
+  EXPECT_EQ(
+      ParsedNodeReadMask::Parse<Artifact>(nested_field, &parsed_read_mask)
+          .code(),
+      tensorflow::error::INVALID_ARGUMENT);
+  const NodeReadMask empty_property =
+      ParseTextProtoOrDie<NodeReadMask>("paths: 'properties.'");
+  EXPECT_EQ(
+      ParsedNodeReadMask::Parse<Context>(empty_property, &parsed_read_mask)
+          .code(),
+      tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST(NodeReadMaskTest, ApplyClearsUnselectedFields) {
+  const NodeReadMask read_mask = ParseTextProtoOrDie<NodeReadMask>(R"(
+    paths: 'id' paths: 'properties.p' paths: 'custom_properties.q'
+  )");
+  ParsedNodeReadMask parsed_read_mask;
+  TF_ASSERT_OK(ParsedNodeReadMask::Parse<Artifact>(read_mask,
+                                                   &parsed_read_mask));
+  EXPECT_FALSE(parsed_read_mask.selects_all());
+  EXPECT_TRUE(parsed_read_mask.selects_some_properties());
+  EXPECT_THAT(parsed_read_mask.GetSelectedPropertyNames(),
+              ElementsAre("p", "q"));
+
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    id: 1 type_id: 2 uri: 'uri'
+    properties { key: 'p' value: { int_value: 1 } }
+    properties { key: 'q' value: { int_value: 2 } }
+    custom_properties { key: 'q' value: { string_value: '3' } }
+  )");
+  parsed_read_mask.Apply(&artifact);
+  EXPECT_THAT(artifact, EqualsProto(ParseTextProtoOrDie<Artifact>(R"(
+                id: 1
+                properties { key: 'p' value: { int_value: 1 } }
+                custom_properties { key: 'q' value: { string_value: '3' } }
+              )")));
+}
+
+TEST(NodeReadMaskTest, SelectAllProperties) {
+  const NodeReadMask read_mask = ParseTextProtoOrDie<NodeReadMask>(R"(
+    paths: 'name' paths: 'custom_properties' paths: 'properties.p'
+  )");
+  ParsedNodeReadMask parsed_read_mask;
+  TF_ASSERT_OK(
+      ParsedNodeReadMask::Parse<Context>(read_mask, &parsed_read_mask));
+  EXPECT_FALSE(parsed_read_mask.selects_some_properties());
+  EXPECT_TRUE(parsed_read_mask.custom_properties().all);
+
+  Context context = ParseTextProtoOrDie<Context>(R"(
+    id: 1 type_id: 2 name: 'name'
+    properties { key: 'q' value: { int_value: 1 } }
+    custom_properties { key: 'q' value: { int_value: 2 } }
+  )");
+  parsed_read_mask.Apply(&context);
+  EXPECT_THAT(context, EqualsProto(ParseTextProtoOrDie<Context>(R"(
+                name: 'name'
+                custom_properties { key: 'q' value: { int_value: 2 } }
+              )")));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -19,7 +19,10 @@ limitations under the License.
 
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/util/json_util.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
@@ -30,8 +33,115 @@ limitations under the License.
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
 
 namespace ml_metadata {
+namespace {
+
+// The number of rows processed by each execution of a chunked upgrade query
+// that does not set its chunk_size.
+constexpr int64 kDefaultMigrationChunkSize = 10000;
+
+// The minimum interval between two progress reports of a chunked upgrade
+// query.
+constexpr absl::Duration kMigrationProgressLogInterval = absl::Seconds(10);
+
+// Parses the first value of the first record of the record set.
+// Returns INTERNAL error, if the value is missing or not an integer.
+tensorflow::Status ParseSingleInt64(const RecordSet& record_set,
+                                    int64* value) {
+  if (record_set.records_size() == 0 ||
+      record_set.records(0).values_size() == 0 ||
+      !absl::SimpleAtoi(record_set.records(0).values(0), value)) {
+    return tensorflow::errors::Internal("Expected a single integer, got: ",
+                                        record_set.DebugString());
+  }
+  return tensorflow::Status::OK();
+}
+
+// Returns the SQL comparison operator of a filter predicate.
+// Returns INVALID_ARGUMENT error, if the operator is unknown.
+tensorflow::Status GetComparisonOperator(const NodeFilter::Operator op,
+                                         std::string* comparison_operator) {
+  switch (op) {
+    case NodeFilter::EQ:
+      *comparison_operator = "=";
+      break;
+    case NodeFilter::NE:
+      *comparison_operator = "<>";
+      break;
+    case NodeFilter::LT:
+      *comparison_operator = "<";
+      break;
+    case NodeFilter::LE:
+      *comparison_operator = "<=";
+      break;
+    case NodeFilter::GT:
+      *comparison_operator = ">";
+      break;
+    case NodeFilter::GE:
+      *comparison_operator = ">=";
+      break;
+    default:
+      return tensorflow::errors::InvalidArgument(
+          "Unknown operator in the filter predicate: ", op);
+  }
+  return tensorflow::Status::OK();
+}
+
+// The tables and columns of a kind of nodes that the filters refer to.
+struct NodeTables {
+  std::string node_table;
+  std::string property_table;
+  std::string node_id_column;
+  // The columns of the optional attributes, empty if absent from the table.
+  std::string uri_column;
+  std::string state_column;
+  // The table relating the nodes to their contexts, empty for contexts.
+  std::string context_table;
+};
+
+NodeTables GetNodeTables(const TypeKind node_kind) {
+  NodeTables tables;
+  switch (node_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      tables.node_table = "Artifact";
+      tables.property_table = "ArtifactProperty";
+      tables.node_id_column = "artifact_id";
+      tables.uri_column = "uri";
+      tables.state_column = "state";
+      tables.context_table = "Attribution";
+      break;
+    case TypeKind::EXECUTION_TYPE:
+      tables.node_table = "Execution";
+      tables.property_table = "ExecutionProperty";
+      tables.node_id_column = "execution_id";
+      tables.state_column = "last_known_state";
+      tables.context_table = "Association";
+      break;
+    case TypeKind::CONTEXT_TYPE:
+      tables.node_table = "Context";
+      tables.property_table = "ContextProperty";
+      tables.node_id_column = "context_id";
+      break;
+  }
+  return tables;
+}
+
+// Returns the queries deleting the nodes of the given kind.
+const MetadataSourceQueryConfig::DeletionQueries& GetDeletionQueries(
+    const MetadataSourceQueryConfig& query_config, const TypeKind node_kind) {
+  switch (node_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      return query_config.delete_artifacts();
+    case TypeKind::EXECUTION_TYPE:
+      return query_config.delete_executions();
+    default:
+      return query_config.delete_contexts();
+  }
+}
+
+}  // namespace
 
 tensorflow::Status QueryConfigExecutor::InsertEventPath(
     int64 event_id, const Event::Path::Step& step) {
@@ -52,6 +162,35 @@ tensorflow::Status QueryConfigExecutor::InsertEventPath(
   return tensorflow::Status::OK();
 }
 
+tensorflow::Status QueryConfigExecutor::InsertEvents(
+    const std::vector<Event>& events, std::vector<int64>* event_ids) {
+  std::vector<std::string> rows;
+  rows.reserve(events.size());
+  for (const Event& event : events) {
+    rows.push_back(absl::StrCat(
+        "(", Bind(event.artifact_id()), ", ", Bind(event.execution_id()), ", ",
+        Bind(event.type()), ", ", Bind(event.milliseconds_since_epoch()), ")"));
+  }
+  return ExecuteMultiRowInsertion(query_config_.insert_events(), rows,
+                                  event_ids);
+}
+
+tensorflow::Status QueryConfigExecutor::InsertEventPaths(
+    const std::vector<std::pair<int64, Event::Path::Step>>& steps) {
+  std::vector<std::string> rows;
+  rows.reserve(steps.size());
+  for (const std::pair<int64, Event::Path::Step>& step : steps) {
+    // the column of the other step value case is NULL.
+    const bool is_index_step = step.second.has_index();
+    rows.push_back(absl::StrCat(
+        "(", Bind(step.first), ", ", Bind(is_index_step), ", ",
+        is_index_step ? Bind(step.second.index()) : "NULL", ", ",
+        is_index_step ? "NULL" : Bind(step.second.key()), ")"));
+  }
+  return ExecuteQuery(query_config_.insert_event_paths(),
+                      {absl::StrJoin(rows, ", ")});
+}
+
 tensorflow::Status QueryConfigExecutor::GetSchemaVersion(int64* db_version) {
   RecordSet record_set;
   tensorflow::Status maybe_schema_version_status =
@@ -126,20 +265,168 @@ tensorflow::Status QueryConfigExecutor::UpgradeMetadataSourceIfOutOfDate(
       return tensorflow::errors::Internal(
           "Cannot find migration_schemes to version ", to_version);
     }
+    TF_RETURN_IF_ERROR(
+        UpgradeSchemaVersion(to_version, migration_schemes.at(to_version)));
+    db_version = to_version;
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status QueryConfigExecutor::UpgradeSchemaVersion(
+    const int64 to_version,
+    const MetadataSourceQueryConfig::MigrationScheme& migration_scheme) {
+  const bool is_chunked = migration_scheme.chunked_upgrade_queries_size() > 0;
+  // The progress of an interrupted migration, if any.
+  bool is_resumed = false;
+  int64 chunked_query_index = 0;
+  int64 next_id = 0;
+  if (is_chunked) {
+    TF_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.create_migration_progress_table()));
+    RecordSet record_set;
+    TF_RETURN_IF_ERROR(ExecuteQuery(query_config_.select_migration_progress(),
+                                    {Bind(to_version)}, &record_set));
+    if (record_set.records_size() > 0) {
+      const RecordSet::Record& record = record_set.records(0);
+      if (record.values_size() != 2 ||
+          !absl::SimpleAtoi(record.values(0), &chunked_query_index) ||
+          !absl::SimpleAtoi(record.values(1), &next_id)) {
+        return tensorflow::errors::DataLoss(
+            "Cannot parse the progress of the migration to schema version ",
+            to_version, ": ", record.DebugString());
+      }
+      is_resumed = true;
+      LOG(INFO) << "Resuming the migration to schema version " << to_version
+                << " from chunked upgrade query " << chunked_query_index
+                << " at id " << next_id;
+    }
+  }
+  // The upgrade queries are committed along with the initial progress, so
+  // they are not executed again when the migration is resumed.
+  if (!is_resumed) {
+    for (const MetadataSourceQueryConfig::TemplateQuery& upgrade_query :
+         migration_scheme.upgrade_queries()) {
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          ExecuteQuery(upgrade_query.query()),
+          absl::StrCat("Upgrade query failed: ", upgrade_query.query()));
+    }
+  }
+  if (is_chunked) {
+    if (!is_resumed) {
+      TF_RETURN_IF_ERROR(
+          ExecuteQuery(query_config_.insert_migration_progress(),
+                       {Bind(to_version), Bind(chunked_query_index),
+                        Bind(next_id)}));
+      TF_RETURN_IF_ERROR(CommitMigrationProgress());
+    }
+    for (; chunked_query_index <
+           migration_scheme.chunked_upgrade_queries_size();
+         chunked_query_index++) {
+      TF_RETURN_IF_ERROR(ExecuteChunkedUpgradeQuery(
+          to_version, chunked_query_index,
+          migration_scheme.chunked_upgrade_queries(chunked_query_index),
+          next_id));
+      // Records that the chunked query is done, so that a resumed migration
+      // starts with the next one.
+      next_id = 0;
+      TF_RETURN_IF_ERROR(
+          ExecuteQuery(query_config_.update_migration_progress(),
+                       {Bind(to_version), Bind(chunked_query_index + 1),
+                        Bind(next_id)}));
+      TF_RETURN_IF_ERROR(CommitMigrationProgress());
+    }
     for (const MetadataSourceQueryConfig::TemplateQuery& upgrade_query :
-         migration_schemes.at(to_version).upgrade_queries()) {
+         migration_scheme.post_chunked_upgrade_queries()) {
       TF_RETURN_WITH_CONTEXT_IF_ERROR(
           ExecuteQuery(upgrade_query.query()),
           absl::StrCat("Upgrade query failed: ", upgrade_query.query()));
     }
+    TF_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.drop_migration_progress_table()));
+  }
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(
+      ExecuteQuery(query_config_.update_schema_version(), {Bind(to_version)}),
+      "Failed to update schema.");
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status QueryConfigExecutor::ExecuteChunkedUpgradeQuery(
+    const int64 to_version, const int64 chunked_query_index,
+    const MetadataSourceQueryConfig::MigrationScheme::ChunkedQuery&
+        chunked_query,
+    int64 next_id) {
+  const int64 chunk_size = chunked_query.chunk_size() > 0
+                               ? chunked_query.chunk_size()
+                               : kDefaultMigrationChunkSize;
+  RecordSet count_record_set;
+  TF_RETURN_IF_ERROR(ExecuteQuery(chunked_query.count_remaining_rows(),
+                                  {Bind(next_id)}, &count_record_set));
+  int64 num_remaining_rows = 0;
+  TF_RETURN_IF_ERROR(ParseSingleInt64(count_record_set, &num_remaining_rows));
+
+  const absl::Time start_time = absl::Now();
+  absl::Time last_log_time = start_time;
+  int64 num_processed_rows = 0;
+  while (true) {
+    RecordSet chunk_record_set;
+    TF_RETURN_IF_ERROR(ExecuteQuery(chunked_query.select_chunk_end(),
+                                    {Bind(next_id), Bind(chunk_size)},
+                                    &chunk_record_set));
+    // The chunk end is NULL or missing once all rows are processed.
+    int64 chunk_end = 0;
+    if (!ParseSingleInt64(chunk_record_set, &chunk_end).ok()) break;
+    int64 num_chunk_rows = 0;
+    if (chunk_record_set.records(0).values_size() < 2 ||
+        !absl::SimpleAtoi(chunk_record_set.records(0).values(1),
+                          &num_chunk_rows)) {
+      return tensorflow::errors::Internal(
+          "Cannot parse the number of rows of the chunk: ",
+          chunk_record_set.DebugString());
+    }
     TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        ExecuteQuery(query_config_.update_schema_version(), {Bind(to_version)}),
-        "Failed to update schema.");
-    db_version = to_version;
+        ExecuteQuery(chunked_query.query(), {Bind(next_id), Bind(chunk_end)}),
+        absl::StrCat("Chunked upgrade query failed: ",
+                     chunked_query.query().query()));
+    next_id = chunk_end + 1;
+    TF_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.update_migration_progress(),
+                     {Bind(to_version), Bind(chunked_query_index),
+                      Bind(next_id)}));
+    TF_RETURN_IF_ERROR(CommitMigrationProgress());
+
+    // Reports the throughput and the estimated time to process the rows
+    // counted at the start; rows inserted meanwhile are not estimated.
+    num_processed_rows += num_chunk_rows;
+    const absl::Time now = absl::Now();
+    if (now - last_log_time < kMigrationProgressLogInterval) continue;
+    last_log_time = now;
+    const double rows_per_second =
+        num_processed_rows / absl::ToDoubleSeconds(now - start_time);
+    const int64 num_left_rows =
+        std::max<int64>(num_remaining_rows - num_processed_rows, 0);
+    LOG(INFO) << "Migration to schema version " << to_version
+              << ", chunked upgrade query " << chunked_query_index
+              << ": processed " << num_processed_rows << " of "
+              << num_remaining_rows << " rows at " << rows_per_second
+              << " rows/s, ETA " << num_left_rows / rows_per_second << "s";
   }
+  LOG(INFO) << "Migration to schema version " << to_version
+            << ", chunked upgrade query " << chunked_query_index
+            << ": processed " << num_processed_rows << " rows in "
+            << absl::FormatDuration(absl::Now() - start_time);
   return tensorflow::Status::OK();
 }
 
+tensorflow::Status QueryConfigExecutor::CommitMigrationProgress() {
+  // Within a savepoint the transaction belongs to the caller, so the progress
+  // is committed along with it.
+  if (metadata_source_->savepoint_depth() > 0) {
+    return tensorflow::Status::OK();
+  }
+  TF_RETURN_IF_ERROR(metadata_source_->Commit());
+  return metadata_source_->Begin();
+}
+
 tensorflow::Status QueryConfigExecutor::SelectLastInsertID(
     int64* last_insert_id) {
   RecordSet record_set;
@@ -161,6 +448,66 @@ tensorflow::Status QueryConfigExecutor::SelectLastInsertID(
   return tensorflow::Status::OK();
 }
 
+tensorflow::Status QueryConfigExecutor::SelectFirstInsertID(
+    const int64 num_rows, int64* first_insert_id) {
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(ExecuteQuery(query_config_.select_first_insert_id(),
+                                  {Bind(num_rows)}, &record_set));
+  if (record_set.records_size() == 0 ||
+      record_set.records(0).values_size() == 0) {
+    return tensorflow::errors::Internal(
+        "Could not find first insert ID: no record");
+  }
+  if (!absl::SimpleAtoi(record_set.records(0).values(0), first_insert_id)) {
+    return tensorflow::errors::Internal(
+        "Could not parse first insert ID as string");
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status QueryConfigExecutor::SelectConsecutiveInsertIDs(
+    bool* consecutive) {
+  if (!consecutive_insert_ids_.has_value()) {
+    RecordSet record_set;
+    TF_RETURN_IF_ERROR(ExecuteQuery(
+        query_config_.select_consecutive_insert_ids(), {}, &record_set));
+    int64 value;
+    if (record_set.records_size() == 0 ||
+        record_set.records(0).values_size() == 0 ||
+        !absl::SimpleAtoi(record_set.records(0).values(0), &value)) {
+      return tensorflow::errors::Internal(
+          "Could not find whether the insert IDs are consecutive");
+    }
+    consecutive_insert_ids_ = value != 0;
+  }
+  *consecutive = *consecutive_insert_ids_;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status QueryConfigExecutor::ExecuteMultiRowInsertion(
+    const MetadataSourceQueryConfig::TemplateQuery& query,
+    const std::vector<std::string>& rows, std::vector<int64>* ids) {
+  ids->clear();
+  ids->reserve(rows.size());
+  bool consecutive = false;
+  TF_RETURN_IF_ERROR(SelectConsecutiveInsertIDs(&consecutive));
+  if (!consecutive) {
+    for (const std::string& row : rows) {
+      int64 id;
+      TF_RETURN_IF_ERROR(ExecuteQuerySelectLastInsertID(query, {row}, &id));
+      ids->push_back(id);
+    }
+    return tensorflow::Status::OK();
+  }
+  TF_RETURN_IF_ERROR(ExecuteQuery(query, {absl::StrJoin(rows, ", ")}));
+  int64 first_id;
+  TF_RETURN_IF_ERROR(SelectFirstInsertID(rows.size(), &first_id));
+  for (size_t i = 0; i < rows.size(); ++i) {
+    ids->push_back(first_id + i);
+  }
+  return tensorflow::Status::OK();
+}
+
 tensorflow::Status ml_metadata::QueryConfigExecutor::CheckTablesIn_V0_13_2() {
   return ExecuteQuery(query_config_.check_tables_in_v0_13_2());
 }
@@ -198,6 +545,25 @@ tensorflow::Status QueryConfigExecutor::DowngradeMetadataSource(
       return tensorflow::errors::Internal(
           "Cannot find migration_schemes to version ", to_version);
     }
+    for (const MetadataSourceQueryConfig::TemplateQuery& precondition :
+         migration_schemes.at(to_version).downgrade_preconditions()) {
+      RecordSet record_set;
+      TF_RETURN_IF_ERROR(ExecuteQuery(precondition, {}, &record_set));
+      bool holds = false;
+      if (record_set.records_size() != 1 ||
+          record_set.records(0).values_size() != 1 ||
+          !absl::SimpleAtob(record_set.records(0).values(0), &holds)) {
+        return tensorflow::errors::Internal(
+            "Unexpected result of downgrade precondition ",
+            precondition.query(), ": ", record_set.DebugString());
+      }
+      if (!holds) {
+        return tensorflow::errors::FailedPrecondition(
+            "Cannot downgrade to schema_version ", to_version,
+            ", as the stored data does not meet the precondition: ",
+            precondition.query());
+      }
+    }
     for (const MetadataSourceQueryConfig::TemplateQuery& downgrade_query :
          migration_schemes.at(to_version).downgrade_queries()) {
       TF_RETURN_WITH_CONTEXT_IF_ERROR(ExecuteQuery(downgrade_query),
@@ -225,6 +591,18 @@ std::string QueryConfigExecutor::Bind(absl::string_view value) {
   return absl::StrCat("'", metadata_source_->EscapeString(value), "'");
 }
 
+std::string QueryConfigExecutor::BindList(
+    const std::vector<std::string>& values) {
+  return absl::StrJoin(values, ", ",
+                       [this](std::string* out, const std::string& value) {
+                         absl::StrAppend(out, Bind(value));
+                       });
+}
+
+std::string QueryConfigExecutor::BindList(const std::vector<int64>& values) {
+  return absl::StrJoin(values, ", ");
+}
+
 std::string QueryConfigExecutor::Bind(int value) {
   return std::to_string(value);
 }
@@ -289,6 +667,58 @@ std::string QueryConfigExecutor::BindDataType(const Value& value) {
   }
 }
 
+std::string QueryConfigExecutor::BindPropertyRows(
+    const std::vector<NodePropertyRow>& rows) {
+  return absl::StrJoin(
+      rows, ", ", [this](std::string* out, const NodePropertyRow& row) {
+        std::string int_value = "NULL";
+        std::string double_value = "NULL";
+        std::string string_value = "NULL";
+        switch (row.value.value_case()) {
+          case Value::kIntValue:
+            int_value = BindValue(row.value);
+            break;
+          case Value::kDoubleValue:
+            double_value = BindValue(row.value);
+            break;
+          case Value::kStringValue:
+            string_value = BindValue(row.value);
+            break;
+          default:
+            LOG(FATAL) << "Unexpected oneof: " << row.value.DebugString();
+        }
+        absl::StrAppend(out, "(", Bind(row.node_id), ", ",
+                        Bind(absl::string_view(row.name)), ", ",
+                        Bind(row.is_custom_property), ", ", int_value, ", ",
+                        double_value, ", ", string_value, ")");
+      });
+}
+
+std::vector<std::string> QueryConfigExecutor::BindNodeRows(
+    const std::vector<NodeRow>& rows, const int64 create_time_since_epoch,
+    const bool has_uri) {
+  std::vector<std::string> bound_rows;
+  bound_rows.reserve(rows.size());
+  for (const NodeRow& row : rows) {
+    std::string out = absl::StrCat("(", Bind(row.type_id), ", ");
+    if (has_uri) absl::StrAppend(&out, Bind(row.uri), ", ");
+    absl::StrAppend(&out, row.state ? Bind(*row.state) : "NULL", ", ",
+                    BindName(row.name), ", ", Bind(create_time_since_epoch),
+                    ", ", Bind(create_time_since_epoch), ", ",
+                    BindPackedProperties(row.packed_properties), ")");
+    bound_rows.push_back(std::move(out));
+  }
+  return bound_rows;
+}
+
+std::string QueryConfigExecutor::BindIDPairRows(
+    const std::vector<std::pair<int64, int64>>& rows) {
+  return absl::StrJoin(
+      rows, ", ", [this](std::string* out, const std::pair<int64, int64>& row) {
+        absl::StrAppend(out, "(", Bind(row.first), ", ", Bind(row.second), ")");
+      });
+}
+
 std::string QueryConfigExecutor::Bind(bool exists,
                                       const google::protobuf::Message& message) {
   if (exists) {
@@ -367,6 +797,9 @@ tensorflow::Status QueryConfigExecutor::InitMetadataSource() {
       ExecuteQuery(query_config_.create_context_property_table()));
   TF_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_association_table()));
   TF_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_attribution_table()));
+  for (const char* node_table : {"Artifact", "Execution", "Context"}) {
+    TF_RETURN_IF_ERROR(CreateLastUpdateTimeIndexIfNotExists(node_table));
+  }
 
   int64 library_version = GetLibraryVersion();
   tensorflow::Status insert_schema_version_status =
@@ -392,8 +825,75 @@ tensorflow::Status QueryConfigExecutor::InitMetadataSourceIfNotExists(
   TF_RETURN_IF_ERROR(
       UpgradeMetadataSourceIfOutOfDate(enable_upgrade_migration));
   // if lib and db versions align, we check the required tables for the lib.
-  std::vector<tensorflow::Status> checks;
+  std::vector<std::string> missing_schema_error_messages;
+  size_t num_checks = 0;
+  if (query_config_.has_select_table_columns()) {
+    num_checks = query_config_.required_tables_size();
+    TF_RETURN_IF_ERROR(FindMissingTables(&missing_schema_error_messages));
+  } else {
+    TF_RETURN_IF_ERROR(CheckTablesOneByOne(&num_checks,
+                                           &missing_schema_error_messages));
+  }
+
+  // all table required by the current lib version exists
+  if (missing_schema_error_messages.empty()) return tensorflow::Status::OK();
+
+  // some table exists, but not all.
+  if (num_checks != missing_schema_error_messages.size()) {
+    return tensorflow::errors::Aborted(
+        "There are a subset of tables in MLMD instance. This may be due to "
+        "concurrent connection to the empty database. Please retry connection. "
+        "The following expected tables are missing: ",
+        absl::StrJoin(missing_schema_error_messages, "\n"));
+  }
+
+  // no table exists, then init the MetadataSource
+  return InitMetadataSource();
+}
+
+tensorflow::Status QueryConfigExecutor::FindMissingTables(
+    std::vector<std::string>* missing_table_messages) {
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.select_table_columns(), {}, &record_set));
+  // The names are compared case-insensitively, as catalogs may report them in
+  // lower case, e.g., MySQL with lower_case_table_names.
+  absl::flat_hash_map<std::string, absl::flat_hash_set<std::string>>
+      columns_by_table;
+  for (const RecordSet::Record& record : record_set.records()) {
+    if (record.values_size() != 2) {
+      return tensorflow::errors::Internal(
+          "Unexpected record of table columns: ", record.DebugString());
+    }
+    columns_by_table[absl::AsciiStrToLower(record.values(0))].insert(
+        absl::AsciiStrToLower(record.values(1)));
+  }
+  for (const MetadataSourceQueryConfig::TableSchema& table :
+       query_config_.required_tables()) {
+    auto it = columns_by_table.find(absl::AsciiStrToLower(table.name()));
+    if (it == columns_by_table.end()) {
+      missing_table_messages->push_back(
+          absl::StrCat("Table `", table.name(), "` does not exist."));
+      continue;
+    }
+    std::vector<std::string> missing_columns;
+    for (const std::string& column_name : table.column_names()) {
+      if (!it->second.contains(absl::AsciiStrToLower(column_name))) {
+        missing_columns.push_back(column_name);
+      }
+    }
+    if (!missing_columns.empty()) {
+      missing_table_messages->push_back(
+          absl::StrCat("Table `", table.name(), "` misses columns: ",
+                       absl::StrJoin(missing_columns, ", ")));
+    }
+  }
+  return tensorflow::Status::OK();
+}
 
+tensorflow::Status QueryConfigExecutor::CheckTablesOneByOne(
+    size_t* num_checks, std::vector<std::string>* missing_table_messages) {
+  std::vector<tensorflow::Status> checks;
   checks.push_back(CheckTypeTable());
   checks.push_back(CheckTypePropertyTable());
   checks.push_back(CheckArtifactTable());
@@ -407,27 +907,13 @@ tensorflow::Status QueryConfigExecutor::InitMetadataSourceIfNotExists(
   checks.push_back(CheckContextPropertyTable());
   checks.push_back(CheckAssociationTable());
   checks.push_back(CheckAttributionTable());
-  std::vector<std::string> missing_schema_error_messages;
   for (tensorflow::Status check : checks) {
     if (!check.ok()) {
-      missing_schema_error_messages.push_back(check.error_message());
+      missing_table_messages->push_back(check.error_message());
     }
   }
-
-  // all table required by the current lib version exists
-  if (missing_schema_error_messages.empty()) return tensorflow::Status::OK();
-
-  // some table exists, but not all.
-  if (checks.size() != missing_schema_error_messages.size()) {
-    return tensorflow::errors::Aborted(
-        "There are a subset of tables in MLMD instance. This may be due to "
-        "concurrent connection to the empty database. Please retry connection. "
-        "The following expected tables are missing: ",
-        absl::StrJoin(missing_schema_error_messages, "\n"));
-  }
-
-  // no table exists, then init the MetadataSource
-  return InitMetadataSource();
+  *num_checks = checks.size();
+  return tensorflow::Status::OK();
 }
 
 tensorflow::Status QueryConfigExecutor::InsertExecutionType(
@@ -441,4 +927,295 @@ tensorflow::Status QueryConfigExecutor::InsertExecutionType(
       execution_type_id);
 }
 
+tensorflow::Status QueryConfigExecutor::CreatePropertyIndexIfNotExists(
+    const TypeKind type_kind, const PropertyType property_type) {
+  std::string property_table;
+  switch (type_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      property_table = "ArtifactProperty";
+      break;
+    case TypeKind::EXECUTION_TYPE:
+      property_table = "ExecutionProperty";
+      break;
+    case TypeKind::CONTEXT_TYPE:
+      property_table = "ContextProperty";
+      break;
+  }
+  const MetadataSourceQueryConfig::TemplateQuery* create_index_query;
+  std::string value_column;
+  switch (property_type) {
+    case PropertyType::INT:
+      create_index_query = &query_config_.create_int_property_index();
+      value_column = "int_value";
+      break;
+    case PropertyType::DOUBLE:
+      create_index_query = &query_config_.create_double_property_index();
+      value_column = "double_value";
+      break;
+    case PropertyType::STRING:
+      create_index_query = &query_config_.create_string_property_index();
+      value_column = "string_value";
+      break;
+    default:
+      return tensorflow::errors::InvalidArgument(
+          "Cannot index a property of type: ",
+          PropertyType_Name(property_type));
+  }
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(ExecuteQuery(query_config_.check_property_index(),
+                                  {property_table, value_column},
+                                  &record_set));
+  if (record_set.records_size() > 0) {
+    return tensorflow::Status::OK();
+  }
+  return ExecuteQuery(*create_index_query, {property_table});
+}
+
+tensorflow::Status QueryConfigExecutor::CreateLastUpdateTimeIndexIfNotExists(
+    const std::string& node_table) {
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(ExecuteQuery(query_config_.check_property_index(),
+                                  {node_table, "last_update_time_since_epoch"},
+                                  &record_set));
+  if (record_set.records_size() > 0) {
+    return tensorflow::Status::OK();
+  }
+  return ExecuteQuery(query_config_.create_last_update_time_index(),
+                      {node_table});
+}
+
+tensorflow::Status QueryConfigExecutor::BuildNodeFilterClauses(
+    const TypeKind node_kind, const NodeFilter& filter,
+    std::vector<std::string>* joins, std::vector<std::string>* conditions) {
+  const NodeTables tables = GetNodeTables(node_kind);
+  bool join_type_table = false;
+  for (int i = 0; i < filter.predicates_size(); ++i) {
+    const NodeFilter::Predicate& predicate = filter.predicates(i);
+    std::string comparison_operator;
+    TF_RETURN_IF_ERROR(
+        GetComparisonOperator(predicate.op(), &comparison_operator));
+    const Value& value = predicate.value();
+    if (value.value_case() == Value::VALUE_NOT_SET) {
+      return tensorflow::errors::InvalidArgument(
+          "No value is given in the filter predicate: ",
+          predicate.DebugString());
+    }
+    switch (predicate.subject_case()) {
+      case NodeFilter::Predicate::kProperty:
+      case NodeFilter::Predicate::kCustomProperty: {
+        // The property table has at most one row per node and property name,
+        // so that each join keeps at most one row per node.
+        const bool is_custom_property = predicate.has_custom_property();
+        const std::string alias = absl::StrCat("p", i);
+        joins->push_back(absl::Substitute(
+            " JOIN `$0` AS `$1` ON `$1`.`$2` = `n`.`id` AND `$1`.`name` = $3 "
+            "AND `$1`.`is_custom_property` = $4 ",
+            tables.property_table, alias, tables.node_id_column,
+            Bind(is_custom_property ? predicate.custom_property()
+                                    : predicate.property()),
+            Bind(is_custom_property)));
+        conditions->push_back(absl::Substitute("`$0`.`$1` $2 $3", alias,
+                                               BindDataType(value),
+                                               comparison_operator,
+                                               BindValue(value)));
+        break;
+      }
+      case NodeFilter::Predicate::kAttribute: {
+        std::string column;
+        Value::ValueCase value_case = Value::kIntValue;
+        switch (predicate.attribute()) {
+          case NodeFilter::ID:
+            column = "`n`.`id`";
+            break;
+          case NodeFilter::TYPE_ID:
+            column = "`n`.`type_id`";
+            break;
+          case NodeFilter::TYPE:
+            column = "`t`.`name`";
+            value_case = Value::kStringValue;
+            join_type_table = true;
+            break;
+          case NodeFilter::NAME:
+            column = "`n`.`name`";
+            value_case = Value::kStringValue;
+            break;
+          case NodeFilter::URI:
+            if (!tables.uri_column.empty()) {
+              column = absl::StrCat("`n`.`", tables.uri_column, "`");
+            }
+            value_case = Value::kStringValue;
+            break;
+          case NodeFilter::STATE:
+            if (!tables.state_column.empty()) {
+              column = absl::StrCat("`n`.`", tables.state_column, "`");
+            }
+            break;
+          case NodeFilter::CONTEXT_ID:
+            // A node is related to a context at most once, so that the join
+            // keeps at most one row per node for an equality.
+            if (!tables.context_table.empty()) {
+              if (predicate.op() != NodeFilter::EQ) {
+                return tensorflow::errors::InvalidArgument(
+                    "Only EQ compares the CONTEXT_ID in the filter "
+                    "predicate: ",
+                    predicate.DebugString());
+              }
+              const std::string alias = absl::StrCat("c", i);
+              joins->push_back(absl::Substitute(
+                  " JOIN `$0` AS `$1` ON `$1`.`$2` = `n`.`id` ",
+                  tables.context_table, alias, tables.node_id_column));
+              column = absl::StrCat("`", alias, "`.`context_id`");
+            }
+            break;
+          case NodeFilter::CREATE_TIME_SINCE_EPOCH:
+            column = "`n`.`create_time_since_epoch`";
+            break;
+          case NodeFilter::LAST_UPDATE_TIME_SINCE_EPOCH:
+            column = "`n`.`last_update_time_since_epoch`";
+            break;
+          default:
+            return tensorflow::errors::InvalidArgument(
+                "Unknown attribute in the filter predicate: ",
+                predicate.DebugString());
+        }
+        if (column.empty()) {
+          return tensorflow::errors::InvalidArgument(
+              "The attribute ",
+              NodeFilter::Attribute_Name(predicate.attribute()),
+              " does not apply to ", tables.node_table);
+        }
+        if (value.value_case() != value_case) {
+          return tensorflow::errors::InvalidArgument(
+              "The value type does not match the attribute in the filter "
+              "predicate: ",
+              predicate.DebugString());
+        }
+        conditions->push_back(absl::Substitute(
+            "$0 $1 $2", column, comparison_operator, BindValue(value)));
+        break;
+      }
+      default:
+        return tensorflow::errors::InvalidArgument(
+            "No attribute or property is given in the filter predicate: ",
+            predicate.DebugString());
+    }
+  }
+  if (join_type_table) {
+    joins->push_back(" JOIN `Type` AS `t` ON `t`.`id` = `n`.`type_id` ");
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status QueryConfigExecutor::SelectNodeIDsByFilter(
+    const TypeKind node_kind, const NodeFilter& filter,
+    RecordSet* record_set) {
+  std::vector<std::string> joins;
+  std::vector<std::string> conditions;
+  TF_RETURN_IF_ERROR(
+      BuildNodeFilterClauses(node_kind, filter, &joins, &conditions));
+  const NodeTables tables = GetNodeTables(node_kind);
+  std::string query = absl::StrCat("SELECT `n`.`id` FROM `", tables.node_table,
+                                   "` AS `n` ", absl::StrJoin(joins, ""));
+  if (!conditions.empty()) {
+    absl::StrAppend(&query, " WHERE ", absl::StrJoin(conditions, " AND "));
+  }
+  // The ids are ordered, so that the results and the limit are deterministic.
+  absl::StrAppend(&query, " ORDER BY `n`.`id`");
+  if (filter.limit() > 0) {
+    absl::StrAppend(&query, " LIMIT ", filter.limit());
+  }
+  absl::StrAppend(&query, ";");
+  return ExecuteQuery(query, record_set);
+}
+
+tensorflow::Status QueryConfigExecutor::CountNodesByFilter(
+    const TypeKind node_kind, const NodeFilter& filter,
+    const std::vector<NodeCount::GroupBy>& group_by, RecordSet* record_set) {
+  if (filter.limit() > 0) {
+    return tensorflow::errors::InvalidArgument(
+        "The filter of a count cannot have a limit: ", filter.DebugString());
+  }
+  const NodeTables tables = GetNodeTables(node_kind);
+  std::vector<std::string> joins;
+  std::vector<std::string> conditions;
+  TF_RETURN_IF_ERROR(
+      BuildNodeFilterClauses(node_kind, filter, &joins, &conditions));
+  std::vector<std::string> group_columns;
+  absl::flat_hash_set<int> grouped;
+  for (const NodeCount::GroupBy attribute : group_by) {
+    if (!grouped.insert(attribute).second) {
+      return tensorflow::errors::InvalidArgument(
+          "The count is grouped by ", NodeCount::GroupBy_Name(attribute),
+          " more than once.");
+    }
+    std::string column;
+    switch (attribute) {
+      case NodeCount::TYPE_ID:
+        column = "`n`.`type_id`";
+        break;
+      case NodeCount::STATE:
+        if (!tables.state_column.empty()) {
+          column = absl::StrCat("`n`.`", tables.state_column, "`");
+        }
+        break;
+      case NodeCount::CONTEXT_ID:
+        if (!tables.context_table.empty()) {
+          joins.push_back(
+              absl::Substitute(" JOIN `$0` AS `g` ON `g`.`$1` = `n`.`id` ",
+                               tables.context_table, tables.node_id_column));
+          column = "`g`.`context_id`";
+        }
+        break;
+      default:
+        return tensorflow::errors::InvalidArgument(
+            "Unknown attribute to group the count by: ", attribute);
+    }
+    if (column.empty()) {
+      return tensorflow::errors::InvalidArgument(
+          "The count of ", tables.node_table, " cannot be grouped by ",
+          NodeCount::GroupBy_Name(attribute));
+    }
+    group_columns.push_back(column);
+  }
+
+  std::vector<std::string> select_columns = group_columns;
+  select_columns.push_back("COUNT(*)");
+  std::string query = absl::StrCat(
+      "SELECT ", absl::StrJoin(select_columns, ", "), " FROM `",
+      tables.node_table, "` AS `n` ", absl::StrJoin(joins, ""));
+  if (!conditions.empty()) {
+    absl::StrAppend(&query, " WHERE ", absl::StrJoin(conditions, " AND "));
+  }
+  if (!group_columns.empty()) {
+    absl::StrAppend(&query, " GROUP BY ", absl::StrJoin(group_columns, ", "));
+  }
+  absl::StrAppend(&query, ";");
+  return ExecuteQuery(query, record_set);
+}
+
+tensorflow::Status QueryConfigExecutor::CountRowsOfNodeDeletion(
+    const TypeKind node_kind, const std::vector<int64>& node_ids,
+    RecordSet* record_set) {
+  return ExecuteQuery(GetDeletionQueries(query_config_, node_kind).count_rows(),
+                      {BindList(node_ids)}, record_set);
+}
+
+tensorflow::Status QueryConfigExecutor::DeleteNodes(
+    const TypeKind node_kind, const std::vector<int64>& node_ids) {
+  const std::string bound_node_ids = BindList(node_ids);
+  for (const MetadataSourceQueryConfig::TemplateQuery& query :
+       GetDeletionQueries(query_config_, node_kind).delete_rows()) {
+    TF_RETURN_IF_ERROR(ExecuteQuery(query, {bound_node_ids}));
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status QueryConfigExecutor::SelectExistingNodeIDs(
+    const TypeKind node_kind, const std::vector<int64>& node_ids,
+    RecordSet* record_set) {
+  return ExecuteQuery(query_config_.select_existing_node_ids(),
+                      {GetNodeTables(node_kind).node_table, BindList(node_ids)},
+                      record_set);
+}
+
 }  // namespace ml_metadata
@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/query_executor.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
@@ -121,19 +122,58 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(type_id)}, record_set);
   }
 
+  tensorflow::Status UpdateTypePropertyIsIndexed(
+      int64 type_id, const absl::string_view property_name) final {
+    return ExecuteQuery(query_config_.update_type_property_is_indexed(),
+                        {Bind(type_id), Bind(property_name)});
+  }
+
+  tensorflow::Status SelectIndexedPropertyByTypeID(
+      int64 type_id, RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_indexed_property_by_type_id(),
+                        {Bind(type_id)}, record_set);
+  }
+
+  tensorflow::Status CreatePropertyIndexIfNotExists(
+      TypeKind type_kind, PropertyType property_type) final;
+
   // Queries the last inserted id.
   tensorflow::Status SelectLastInsertID(int64* id);
 
+  // Queries the id of the first of the `num_rows` rows inserted by the last
+  // multi-row insertion.
+  tensorflow::Status SelectFirstInsertID(int64 num_rows, int64* id);
+
+  // Queries whether the rows of a multi-row insertion get consecutive ids.
+  // The result is queried once per connection.
+  tensorflow::Status SelectConsecutiveInsertIDs(bool* consecutive);
+
   tensorflow::Status CheckArtifactTable() final {
     return ExecuteQuery(query_config_.check_artifact_table());
   }
 
-  tensorflow::Status InsertArtifact(int64 type_id,
-                                    const std::string& artifact_uri,
-                                    int64* artifact_id) final {
-    return ExecuteQuerySelectLastInsertID(query_config_.insert_artifact(),
-                                          {Bind(type_id), Bind(artifact_uri)},
-                                          artifact_id);
+  tensorflow::Status InsertArtifact(
+      int64 type_id, const std::string& artifact_uri,
+      const absl::optional<std::string>& name,
+      const absl::optional<Artifact::State>& state,
+      int64 create_time_since_epoch,
+      const absl::optional<std::string>& packed_properties,
+      int64* artifact_id) final {
+    return ExecuteQuerySelectLastInsertID(
+        query_config_.insert_artifact(),
+        {Bind(type_id), Bind(artifact_uri), BindState(state),
+         Bind(create_time_since_epoch), BindName(name),
+         BindPackedProperties(packed_properties)},
+        artifact_id);
+  }
+
+  tensorflow::Status InsertArtifacts(const std::vector<NodeRow>& artifacts,
+                                     int64 create_time_since_epoch,
+                                     std::vector<int64>* artifact_ids) final {
+    return ExecuteMultiRowInsertion(
+        query_config_.insert_artifacts(),
+        BindNodeRows(artifacts, create_time_since_epoch, /*has_uri=*/true),
+        artifact_ids);
   }
 
   tensorflow::Status SelectArtifactByID(int64 artifact_id,
@@ -154,10 +194,24 @@ class QueryConfigExecutor : public QueryExecutor {
                         record_set);
   }
 
-  tensorflow::Status UpdateArtifactDirect(int64 artifact_id, int64 type_id,
-                                          const std::string& uri) final {
+  tensorflow::Status SelectArtifactsByTypeIDAndNames(
+      int64 artifact_type_id, const std::vector<std::string>& names,
+      RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_artifacts_by_type_id_and_names(),
+                        {Bind(artifact_type_id), BindList(names)}, record_set);
+  }
+
+  tensorflow::Status UpdateArtifactDirect(
+      int64 artifact_id, int64 type_id, const std::string& uri,
+      const absl::optional<std::string>& name,
+      const absl::optional<Artifact::State>& state,
+      int64 last_update_time_since_epoch,
+      const absl::optional<std::string>& packed_properties) final {
     return ExecuteQuery(query_config_.update_artifact(),
-                        {Bind(artifact_id), Bind(type_id), Bind(uri)});
+                        {Bind(artifact_id), Bind(type_id), Bind(uri),
+                         BindState(state), Bind(last_update_time_since_epoch),
+                         BindName(name),
+                         BindPackedProperties(packed_properties)});
   }
 
   tensorflow::Status CheckArtifactPropertyTable() final {
@@ -173,12 +227,26 @@ class QueryConfigExecutor : public QueryExecutor {
                          BindValue(property_value)});
   }
 
+  tensorflow::Status InsertArtifactProperties(
+      const std::vector<NodePropertyRow>& properties) final {
+    return ExecuteQuery(query_config_.insert_artifact_properties(),
+                        {BindPropertyRows(properties)});
+  }
+
   tensorflow::Status SelectArtifactPropertyByArtifactID(
       int64 artifact_id, RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_artifact_property_by_artifact_id(),
                         {Bind(artifact_id)}, record_set);
   }
 
+  tensorflow::Status SelectArtifactPropertyByArtifactIDAndNames(
+      int64 artifact_id, const std::vector<std::string>& property_names,
+      RecordSet* record_set) final {
+    return ExecuteQuery(
+        query_config_.select_artifact_property_by_artifact_id_and_names(),
+        {Bind(artifact_id), BindList(property_names)}, record_set);
+  }
+
   tensorflow::Status UpdateArtifactProperty(
       int64 artifact_id, const absl::string_view property_name,
       const Value& property_value) final {
@@ -198,9 +266,27 @@ class QueryConfigExecutor : public QueryExecutor {
     return ExecuteQuery(query_config_.check_execution_table());
   }
 
-  tensorflow::Status InsertExecution(int64 type_id, int64* execution_id) final {
-    return ExecuteQuerySelectLastInsertID(query_config_.insert_execution(),
-                                          {Bind(type_id)}, execution_id);
+  tensorflow::Status InsertExecution(
+      int64 type_id, const absl::optional<std::string>& name,
+      const absl::optional<Execution::State>& last_known_state,
+      int64 create_time_since_epoch,
+      const absl::optional<std::string>& packed_properties,
+      int64* execution_id) final {
+    return ExecuteQuerySelectLastInsertID(
+        query_config_.insert_execution(),
+        {Bind(type_id), BindState(last_known_state),
+         Bind(create_time_since_epoch), BindName(name),
+         BindPackedProperties(packed_properties)},
+        execution_id);
+  }
+
+  tensorflow::Status InsertExecutions(const std::vector<NodeRow>& executions,
+                                      int64 create_time_since_epoch,
+                                      std::vector<int64>* execution_ids) final {
+    return ExecuteMultiRowInsertion(
+        query_config_.insert_executions(),
+        BindNodeRows(executions, create_time_since_epoch, /*has_uri=*/false),
+        execution_ids);
   }
 
   tensorflow::Status SelectExecutionByID(int64 execution_id,
@@ -215,10 +301,25 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(execution_type_id)}, record_set);
   }
 
-  tensorflow::Status UpdateExecutionDirect(int64 execution_id,
-                                           int64 type_id) final {
+  tensorflow::Status SelectExecutionsByTypeIDAndNames(
+      int64 execution_type_id, const std::vector<std::string>& names,
+      RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_executions_by_type_id_and_names(),
+                        {Bind(execution_type_id), BindList(names)},
+                        record_set);
+  }
+
+  tensorflow::Status UpdateExecutionDirect(
+      int64 execution_id, int64 type_id,
+      const absl::optional<std::string>& name,
+      const absl::optional<Execution::State>& last_known_state,
+      int64 last_update_time_since_epoch,
+      const absl::optional<std::string>& packed_properties) final {
     return ExecuteQuery(query_config_.update_execution(),
-                        {Bind(execution_id), Bind(type_id)});
+                        {Bind(execution_id), Bind(type_id),
+                         BindState(last_known_state),
+                         Bind(last_update_time_since_epoch), BindName(name),
+                         BindPackedProperties(packed_properties)});
   }
 
   tensorflow::Status CheckExecutionPropertyTable() final {
@@ -234,6 +335,12 @@ class QueryConfigExecutor : public QueryExecutor {
                          Bind(is_custom_property), BindValue(value)});
   }
 
+  tensorflow::Status InsertExecutionProperties(
+      const std::vector<NodePropertyRow>& properties) final {
+    return ExecuteQuery(query_config_.insert_execution_properties(),
+                        {BindPropertyRows(properties)});
+  }
+
   tensorflow::Status SelectExecutionPropertyByExecutionID(
       int64 execution_id, RecordSet* record_set) final {
     return ExecuteQuery(
@@ -241,6 +348,14 @@ class QueryConfigExecutor : public QueryExecutor {
         {Bind(execution_id)}, record_set);
   }
 
+  tensorflow::Status SelectExecutionPropertyByExecutionIDAndNames(
+      int64 execution_id, const std::vector<std::string>& property_names,
+      RecordSet* record_set) final {
+    return ExecuteQuery(
+        query_config_.select_execution_property_by_execution_id_and_names(),
+        {Bind(execution_id), BindList(property_names)}, record_set);
+  }
+
   tensorflow::Status UpdateExecutionProperty(int64 execution_id,
                                              const absl::string_view name,
                                              const Value& value) final {
@@ -259,11 +374,15 @@ class QueryConfigExecutor : public QueryExecutor {
     return ExecuteQuery(query_config_.check_context_table());
   }
 
-  tensorflow::Status InsertContext(int64 type_id, const std::string& name,
-                                   int64* context_id) final {
-    return ExecuteQuerySelectLastInsertID(query_config_.insert_context(),
-                                          {Bind(type_id), Bind(name)},
-                                          context_id);
+  tensorflow::Status InsertContext(
+      int64 type_id, const std::string& name, int64 create_time_since_epoch,
+      const absl::optional<std::string>& packed_properties,
+      int64* context_id) final {
+    return ExecuteQuerySelectLastInsertID(
+        query_config_.insert_context(),
+        {Bind(type_id), Bind(name), Bind(create_time_since_epoch),
+         BindPackedProperties(packed_properties)},
+        context_id);
   }
 
   tensorflow::Status SelectContextByID(int64 context_id,
@@ -286,12 +405,21 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(context_type_id), Bind(name)}, record_set);
   }
 
+  tensorflow::Status SelectContextsByTypeIDAndNames(
+      int64 context_type_id, const std::vector<std::string>& names,
+      RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_contexts_by_type_id_and_names(),
+                        {Bind(context_type_id), BindList(names)}, record_set);
+  }
+
   tensorflow::Status UpdateContextDirect(
       int64 existing_context_id, int64 type_id,
-      const std::string& context_name) final {
-    return ExecuteQuery(
-        query_config_.update_context(),
-        {Bind(existing_context_id), Bind(type_id), Bind(context_name)});
+      const std::string& context_name, int64 last_update_time_since_epoch,
+      const absl::optional<std::string>& packed_properties) final {
+    return ExecuteQuery(query_config_.update_context(),
+                        {Bind(existing_context_id), Bind(type_id),
+                         Bind(context_name), Bind(last_update_time_since_epoch),
+                         BindPackedProperties(packed_properties)});
   }
 
   tensorflow::Status CheckContextPropertyTable() final {
@@ -313,6 +441,14 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(context_id)}, record_set);
   }
 
+  tensorflow::Status SelectContextPropertyByContextIDAndNames(
+      int64 context_id, const std::vector<std::string>& property_names,
+      RecordSet* record_set) final {
+    return ExecuteQuery(
+        query_config_.select_context_property_by_context_id_and_names(),
+        {Bind(context_id), BindList(property_names)}, record_set);
+  }
+
   tensorflow::Status UpdateContextProperty(
       int64 context_id, const absl::string_view property_name,
       const Value& property_value) final {
@@ -342,6 +478,9 @@ class QueryConfigExecutor : public QueryExecutor {
         event_id);
   }
 
+  tensorflow::Status InsertEvents(const std::vector<Event>& events,
+                                  std::vector<int64>* event_ids) final;
+
   tensorflow::Status SelectEventByArtifactID(
       int64 artifact_id, RecordSet* event_record_set) final {
     return ExecuteQuery(query_config_.select_event_by_artifact_id(),
@@ -354,6 +493,13 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(execution_id)}, event_record_set);
   }
 
+  tensorflow::Status SelectEventsByExecutionIDs(
+      const std::vector<int64>& execution_ids,
+      RecordSet* event_record_set) final {
+    return ExecuteQuery(query_config_.select_events_by_execution_ids(),
+                        {BindList(execution_ids)}, event_record_set);
+  }
+
   tensorflow::Status CheckEventPathTable() final {
     return ExecuteQuery(query_config_.check_event_path_table());
   }
@@ -361,12 +507,21 @@ class QueryConfigExecutor : public QueryExecutor {
   tensorflow::Status InsertEventPath(int64 event_id,
                                      const Event::Path::Step& step) final;
 
+  tensorflow::Status InsertEventPaths(
+      const std::vector<std::pair<int64, Event::Path::Step>>& steps) final;
+
   tensorflow::Status SelectEventPathByEventID(int64 event_id,
                                               RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_event_path_by_event_id(),
                         {Bind(event_id)}, record_set);
   }
 
+  tensorflow::Status SelectEventPathsByEventIDs(
+      const std::vector<int64>& event_ids, RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_event_paths_by_event_ids(),
+                        {BindList(event_ids)}, record_set);
+  }
+
   tensorflow::Status CheckAssociationTable() final {
     return ExecuteQuery(query_config_.check_association_table());
   }
@@ -390,6 +545,26 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(execution_id)}, record_set);
   }
 
+  tensorflow::Status InsertAssociations(
+      const std::vector<std::pair<int64, int64>>& associations) final {
+    return ExecuteQuery(query_config_.insert_associations(),
+                        {BindIDPairRows(associations)});
+  }
+
+  tensorflow::Status SelectAssociationsByContextIDsAndExecutionIDs(
+      const std::vector<int64>& context_ids,
+      const std::vector<int64>& execution_ids, RecordSet* record_set) final {
+    return ExecuteQuery(
+        query_config_.select_associations_by_context_ids_and_execution_ids(),
+        {BindList(context_ids), BindList(execution_ids)}, record_set);
+  }
+
+  tensorflow::Status SelectAssociationsByExecutionIDs(
+      const std::vector<int64>& execution_ids, RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_associations_by_execution_ids(),
+                        {BindList(execution_ids)}, record_set);
+  }
+
   tensorflow::Status CheckAttributionTable() final {
     return ExecuteQuery(query_config_.check_attribution_table());
   }
@@ -414,6 +589,26 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(artifact_id)}, record_set);
   }
 
+  tensorflow::Status InsertAttributions(
+      const std::vector<std::pair<int64, int64>>& attributions) final {
+    return ExecuteQuery(query_config_.insert_attributions(),
+                        {BindIDPairRows(attributions)});
+  }
+
+  tensorflow::Status SelectAttributionsByContextIDsAndArtifactIDs(
+      const std::vector<int64>& context_ids,
+      const std::vector<int64>& artifact_ids, RecordSet* record_set) final {
+    return ExecuteQuery(
+        query_config_.select_attributions_by_context_ids_and_artifact_ids(),
+        {BindList(context_ids), BindList(artifact_ids)}, record_set);
+  }
+
+  tensorflow::Status SelectAttributionsByArtifactIDs(
+      const std::vector<int64>& artifact_ids, RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_attributions_by_artifact_ids(),
+                        {BindList(artifact_ids)}, record_set);
+  }
+
   tensorflow::Status CheckMLMDEnvTable() final {
     return ExecuteQuery(query_config_.check_mlmd_env_table());
   }
@@ -430,18 +625,70 @@ class QueryConfigExecutor : public QueryExecutor {
 
   tensorflow::Status CheckTablesIn_V0_13_2() final;
 
+  tensorflow::Status CreateChangeLogTable() final {
+    return ExecuteQuery(query_config_.create_change_log_table());
+  }
+
+  tensorflow::Status SelectChangeLog(RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_change_log(), {}, record_set);
+  }
+
+  tensorflow::Status InsertChangeLog(int64 log_id) final {
+    return ExecuteQuery(query_config_.insert_change_log(), {Bind(log_id)});
+  }
+
+  tensorflow::Status AdvanceChangeLog(int64 num_changes) final {
+    return ExecuteQuery(query_config_.advance_change_log(),
+                        {Bind(num_changes)});
+  }
+
   tensorflow::Status SelectAllArtifactIDs(RecordSet* set) final {
-    return ExecuteQuery("select `id` from `Artifact`;", set);
+    return ExecuteQuery("select `id` from `Artifact` order by `id`;", set);
   }
 
   tensorflow::Status SelectAllExecutionIDs(RecordSet* set) final {
-    return ExecuteQuery("select `id` from `Execution`;", set);
+    return ExecuteQuery("select `id` from `Execution` order by `id`;", set);
   }
 
   tensorflow::Status SelectAllContextIDs(RecordSet* set) final {
-    return ExecuteQuery("select `id` from `Context`;", set);
+    return ExecuteQuery("select `id` from `Context` order by `id`;", set);
   }
 
+  tensorflow::Status SelectAllEventEdges(RecordSet* set) final {
+    return ExecuteQuery(
+        "select `artifact_id`, `execution_id`, `type` from `Event`;", set);
+  }
+
+  tensorflow::Status SelectArtifactIDsByFilter(const NodeFilter& filter,
+                                               RecordSet* set) final {
+    return SelectNodeIDsByFilter(TypeKind::ARTIFACT_TYPE, filter, set);
+  }
+
+  tensorflow::Status SelectExecutionIDsByFilter(const NodeFilter& filter,
+                                                RecordSet* set) final {
+    return SelectNodeIDsByFilter(TypeKind::EXECUTION_TYPE, filter, set);
+  }
+
+  tensorflow::Status SelectContextIDsByFilter(const NodeFilter& filter,
+                                              RecordSet* set) final {
+    return SelectNodeIDsByFilter(TypeKind::CONTEXT_TYPE, filter, set);
+  }
+
+  tensorflow::Status CountNodesByFilter(
+      TypeKind node_kind, const NodeFilter& filter,
+      const std::vector<NodeCount::GroupBy>& group_by, RecordSet* set) final;
+
+  tensorflow::Status CountRowsOfNodeDeletion(
+      TypeKind node_kind, const std::vector<int64>& node_ids,
+      RecordSet* set) final;
+
+  tensorflow::Status DeleteNodes(TypeKind node_kind,
+                                 const std::vector<int64>& node_ids) final;
+
+  tensorflow::Status SelectExistingNodeIDs(TypeKind node_kind,
+                                           const std::vector<int64>& node_ids,
+                                           RecordSet* set) final;
+
   int64 GetLibraryVersion() final {
     CHECK_GT(query_config_.schema_version(), 0);
     return query_config_.schema_version();
@@ -454,6 +701,12 @@ class QueryConfigExecutor : public QueryExecutor {
   // Utility method to bind an string_view value to a SQL clause.
   std::string Bind(absl::string_view value);
 
+  // Utility method to bind a list of string values to a SQL IN clause.
+  std::string BindList(const std::vector<std::string>& values);
+
+  // Utility method to bind a list of int64 values to a SQL IN clause.
+  std::string BindList(const std::vector<int64>& values);
+
   // Utility method to bind an string_view value to a SQL clause.
   std::string Bind(const char* value);
 
@@ -477,9 +730,46 @@ class QueryConfigExecutor : public QueryExecutor {
   // Event::Type is an enum (integer), EscapeString is not applicable.
   std::string Bind(const Event::Type value);
 
+  // Utility method to bind an Artifact::State or Execution::State enum value
+  // to a SQL clause, or NULL if absent.
+  template <typename State>
+  std::string BindState(const absl::optional<State>& state) {
+    return state ? Bind(static_cast<int>(*state)) : "NULL";
+  }
+
+  // Utility method to bind the name of an artifact or an execution to a SQL
+  // clause, or NULL if absent.
+  std::string BindName(const absl::optional<std::string>& name) {
+    return name ? Bind(absl::string_view(*name)) : "NULL";
+  }
+
+  // Utility method to bind the packed properties of a node to a SQL clause,
+  // or NULL if its properties are stored as property rows.
+  std::string BindPackedProperties(
+      const absl::optional<std::string>& packed_properties) {
+    return packed_properties ? Bind(absl::string_view(*packed_properties))
+                             : "NULL";
+  }
+
   // Bind the value to a SQL clause.
   std::string BindValue(const Value& value);
   std::string BindDataType(const Value& value);
+
+  // Utility method to bind property rows to the VALUES clause of a multi-row
+  // insertion into a property table. In each row, the value columns other
+  // than the one of the property value are NULL.
+  std::string BindPropertyRows(const std::vector<NodePropertyRow>& rows);
+
+  // Utility method to bind node rows to the rows of the VALUES clause of a
+  // multi-row insertion into the Artifact or Execution table. The uri column
+  // is only bound if `has_uri`.
+  std::vector<std::string> BindNodeRows(const std::vector<NodeRow>& rows,
+                                        int64 create_time_since_epoch,
+                                        bool has_uri);
+
+  // Utility method to bind (id, id) rows to the VALUES clause of a multi-row
+  // insertion into the Attribution or Association table.
+  std::string BindIDPairRows(const std::vector<std::pair<int64, int64>>& rows);
   std::string Bind(bool exists, const google::protobuf::Message& message);
   // Utility method to bind an TypeKind to a SQL clause.
   // TypeKind is an enum (integer), EscapeString is not applicable.
@@ -534,6 +824,20 @@ class QueryConfigExecutor : public QueryExecutor {
     return SelectLastInsertID(last_insert_id);
   }
 
+  // Execute an insertion of the bound `rows` of a VALUES clause, and set
+  // `ids` to the ids of the inserted rows in order. The rows are inserted by
+  // one statement if the backend gives its rows consecutive ids, so that they
+  // can be derived from the first one. Otherwise, e.g., on MySQL with an
+  // auto_increment_increment other than 1 or the interleaved
+  // innodb_autoinc_lock_mode, they are inserted one at a time.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns detailed INTERNAL error, if query execution fails.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  // Returns INTERNAL error, if it cannot find the inserted IDs.
+  tensorflow::Status ExecuteMultiRowInsertion(
+      const MetadataSourceQueryConfig::TemplateQuery& query,
+      const std::vector<std::string>& rows, std::vector<int64>* ids);
+
   // Execute a query without arguments.
   // Results consist of zero or more rows represented in RecordSet.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
@@ -573,8 +877,76 @@ class QueryConfigExecutor : public QueryExecutor {
   // TODO(martinz): consider promoting to MetadataAccessObject.
   tensorflow::Status UpgradeMetadataSourceIfOutOfDate(bool enable_migration);
 
+  // Upgrades the database from `to_version` - 1 to `to_version` with the
+  // given migration scheme. If the scheme has chunked upgrade queries, the
+  // progress is kept in the migration progress table, and a migration
+  // interrupted after its first commit is resumed from the last chunk.
+  // Returns DATA_LOSS error, if the recorded progress cannot be parsed.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status UpgradeSchemaVersion(
+      int64 to_version,
+      const MetadataSourceQueryConfig::MigrationScheme& migration_scheme);
+
+  // Executes the `chunked_query` of the migration to `to_version` over the
+  // chunks of rows whose ids are not less than `next_id`, and commits the
+  // progress after each chunk. Logs the throughput and the estimated time
+  // left.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status ExecuteChunkedUpgradeQuery(
+      int64 to_version, int64 chunked_query_index,
+      const MetadataSourceQueryConfig::MigrationScheme::ChunkedQuery&
+          chunked_query,
+      int64 next_id);
+
+  // Verifies the `required_tables` of the query config with a single query of
+  // the catalog of the metadata source. Appends a message to
+  // `missing_table_messages` for each required table that does not exist or
+  // misses some of the required columns.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status FindMissingTables(
+      std::vector<std::string>* missing_table_messages);
+
+  // Verifies the required tables by querying each of them, for query configs
+  // without `select_table_columns`. Sets `num_checks` to the number of tables
+  // checked, and appends the errors of the failed checks to
+  // `missing_table_messages`.
+  tensorflow::Status CheckTablesOneByOne(
+      size_t* num_checks, std::vector<std::string>* missing_table_messages);
+
+  // Commits the open transaction and begins a new one, so that the progress
+  // of a migration survives an interruption. Does nothing within a
+  // savepoint, as the transaction is then owned by the caller.
+  tensorflow::Status CommitMigrationProgress();
+
+  // Creates the index of the node table on its last update time, unless it
+  // exists.
+  tensorflow::Status CreateLastUpdateTimeIndexIfNotExists(
+      const std::string& node_table);
+
+  // Compiles the predicates of the filter to the joins and the conditions of a
+  // query over the nodes of the given kind, aliased as `n`. Each property
+  // predicate joins the node table with its property table.
+  // Returns INVALID_ARGUMENT error, if a predicate is malformed or does not
+  // apply to the kind of nodes.
+  tensorflow::Status BuildNodeFilterClauses(
+      TypeKind node_kind, const NodeFilter& filter,
+      std::vector<std::string>* joins, std::vector<std::string>* conditions);
+
+  // Compiles the filter to a query selecting the ids of the nodes of the given
+  // kind, and runs the query.
+  // Returns INVALID_ARGUMENT error, if a predicate is malformed or does not
+  // apply to the kind of nodes.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status SelectNodeIDsByFilter(TypeKind node_kind,
+                                           const NodeFilter& filter,
+                                           RecordSet* record_set);
+
   MetadataSourceQueryConfig query_config_;
 
+  // Whether the rows of a multi-row insertion get consecutive ids, once it is
+  // queried.
+  absl::optional<bool> consecutive_insert_ids_;
+
   // This object does not own the MetadataSource.
   MetadataSource* metadata_source_;
 };
@@ -16,8 +16,11 @@ limitations under the License.
 #define ML_METADATA_METADATA_STORE_QUERY_EXECUTOR_H_
 
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/type_kind.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
@@ -26,6 +29,26 @@ limitations under the License.
 
 namespace ml_metadata {
 
+// A property of an artifact, execution or context, as a row of the property
+// table of the node.
+struct NodePropertyRow {
+  int64 node_id = 0;
+  std::string name;
+  bool is_custom_property = false;
+  Value value;
+};
+
+// An artifact or an execution, as a row of the node table. The `uri` is only
+// stored for artifacts, and the `state` of an execution is its last known
+// state. The absent fields are NULL.
+struct NodeRow {
+  int64 type_id = 0;
+  std::string uri;
+  absl::optional<std::string> name;
+  absl::optional<int> state;
+  absl::optional<std::string> packed_properties;
+};
+
 // A class wrapping a low-level interface to a database.
 // This contains both the queries and the method for executing them.
 // Most methods correspond to one or two queries, with a few exceptions
@@ -58,7 +81,9 @@ class QueryExecutor {
   // Upgrades the database schema version (db_v) to align with the library
   // schema version (lib_v). It retrieves db_v from the metadata source and
   // compares it with the lib_v in the given query_config, and runs migration
-  // queries if db_v < lib_v.
+  // queries if db_v < lib_v. Chunked upgrade queries commit the open
+  // transaction after each chunk, unless it is called within a savepoint, and
+  // an interrupted migration resumes from the last committed chunk.
   // Returns FAILED_PRECONDITION error, if db_v > lib_v for the case that the
   //   user use a database produced by a newer version of the library. In that
   //   case, downgrading the database may result in data loss. Often upgrading
@@ -155,13 +180,43 @@ class QueryExecutor {
   virtual tensorflow::Status SelectPropertyByTypeID(int64 type_id,
                                                     RecordSet* record_set) = 0;
 
+  // Marks a property of a type as indexed.
+  virtual tensorflow::Status UpdateTypePropertyIsIndexed(
+      int64 type_id, const absl::string_view property_name) = 0;
+
+  // Queries the names of the indexed properties of a type by the type_id.
+  // Returns a list of property names, ordered by name.
+  virtual tensorflow::Status SelectIndexedPropertyByTypeID(
+      int64 type_id, RecordSet* record_set) = 0;
+
+  // Creates the index of the property table of the given kind of nodes on
+  // (name, is_custom_property, <value column of the property_type>), if it
+  // does not exist yet.
+  // Returns INVALID_ARGUMENT error, if the property_type cannot be indexed.
+  virtual tensorflow::Status CreatePropertyIndexIfNotExists(
+      TypeKind type_kind, PropertyType property_type) = 0;
+
   // Checks the existence of the Artifact table.
   virtual tensorflow::Status CheckArtifactTable() = 0;
 
-  // Inserts an artifact into the database.
-  virtual tensorflow::Status InsertArtifact(int64 type_id,
-                                            const std::string& artifact_uri,
-                                            int64* artifact_id) = 0;
+  // Inserts an artifact into the database. The `name`, the `state` and the
+  // `packed_properties` are NULL if absent, and the creation time is also the
+  // last update time of the artifact.
+  virtual tensorflow::Status InsertArtifact(
+      int64 type_id, const std::string& artifact_uri,
+      const absl::optional<std::string>& name,
+      const absl::optional<Artifact::State>& state,
+      int64 create_time_since_epoch,
+      const absl::optional<std::string>& packed_properties,
+      int64* artifact_id) = 0;
+
+  // Inserts the artifacts, whose creation time is also their last update
+  // time, and sets `artifact_ids` to their ids in order. They are inserted
+  // with one statement if the backend gives its rows consecutive ids, and one
+  // at a time otherwise. `artifacts` should not be empty.
+  virtual tensorflow::Status InsertArtifacts(
+      const std::vector<NodeRow>& artifacts, int64 create_time_since_epoch,
+      std::vector<int64>* artifact_ids) = 0;
 
   // Queries an artifact from the Artifact table by its id.
   // Returns a list of records that can be converted to artifacts.
@@ -178,10 +233,20 @@ class QueryExecutor {
   virtual tensorflow::Status SelectArtifactsByURI(const absl::string_view uri,
                                                   RecordSet* record_set) = 0;
 
-  // Updates an artifact in the database.
-  virtual tensorflow::Status UpdateArtifactDirect(int64 artifact_id,
-                                                  int64 type_id,
-                                                  const std::string& uri) = 0;
+  // Queries the artifacts of a type with the given names from the database.
+  // Returns a list of artifact IDs.
+  virtual tensorflow::Status SelectArtifactsByTypeIDAndNames(
+      int64 artifact_type_id, const std::vector<std::string>& names,
+      RecordSet* record_set) = 0;
+
+  // Updates an artifact in the database. The `packed_properties` are NULL if
+  // absent.
+  virtual tensorflow::Status UpdateArtifactDirect(
+      int64 artifact_id, int64 type_id, const std::string& uri,
+      const absl::optional<std::string>& name,
+      const absl::optional<Artifact::State>& state,
+      int64 last_update_time_since_epoch,
+      const absl::optional<std::string>& packed_properties) = 0;
 
   // Checks the existence of the ArtifactProperty table.
   virtual tensorflow::Status CheckArtifactPropertyTable() = 0;
@@ -191,11 +256,22 @@ class QueryExecutor {
       int64 artifact_id, absl::string_view artifact_property_name,
       bool is_custom_property, const Value& property_value) = 0;
 
+  // Inserts the properties of one or more artifacts into the database with
+  // one statement. `properties` should not be empty.
+  virtual tensorflow::Status InsertArtifactProperties(
+      const std::vector<NodePropertyRow>& properties) = 0;
+
   // Queries properties of an artifact from the database by the
   // artifact id.
   virtual tensorflow::Status SelectArtifactPropertyByArtifactID(
       int64 artifact_id, RecordSet* record_set) = 0;
 
+  // Queries the properties of an artifact with the given names from the
+  // database by the artifact id.
+  virtual tensorflow::Status SelectArtifactPropertyByArtifactIDAndNames(
+      int64 artifact_id, const std::vector<std::string>& property_names,
+      RecordSet* record_set) = 0;
+
   // Updates a property of an artifact in the database.
   virtual tensorflow::Status UpdateArtifactProperty(
       int64 artifact_id, const absl::string_view property_name,
@@ -208,9 +284,21 @@ class QueryExecutor {
   // Checks the existence of the Execution table.
   virtual tensorflow::Status CheckExecutionTable() = 0;
 
-  // Inserts an execution into the database.
-  virtual tensorflow::Status InsertExecution(int64 type_id,
-                                             int64* execution_id) = 0;
+  // Inserts an execution into the database. The `name`, the
+  // `last_known_state` and the `packed_properties` are NULL if absent, and the
+  // creation time is also the last update time.
+  virtual tensorflow::Status InsertExecution(
+      int64 type_id, const absl::optional<std::string>& name,
+      const absl::optional<Execution::State>& last_known_state,
+      int64 create_time_since_epoch,
+      const absl::optional<std::string>& packed_properties,
+      int64* execution_id) = 0;
+
+  // Inserts the executions as InsertArtifacts does, and sets `execution_ids`
+  // to their ids in order. `executions` should not be empty.
+  virtual tensorflow::Status InsertExecutions(
+      const std::vector<NodeRow>& executions, int64 create_time_since_epoch,
+      std::vector<int64>* execution_ids) = 0;
 
   // Queries an execution from the database by its id. It has 1
   // parameter. The result can be parsed into an Execution.
@@ -221,9 +309,20 @@ class QueryExecutor {
   virtual tensorflow::Status SelectExecutionsByTypeID(
       int64 execution_type_id, RecordSet* record_set) = 0;
 
-  // Updates an execution in the database.
-  virtual tensorflow::Status UpdateExecutionDirect(int64 execution_id,
-                                                   int64 type_id) = 0;
+  // Queries the executions of a type with the given names from the database.
+  // Returns a list of execution IDs.
+  virtual tensorflow::Status SelectExecutionsByTypeIDAndNames(
+      int64 execution_type_id, const std::vector<std::string>& names,
+      RecordSet* record_set) = 0;
+
+  // Updates an execution in the database. The `packed_properties` are NULL if
+  // absent.
+  virtual tensorflow::Status UpdateExecutionDirect(
+      int64 execution_id, int64 type_id,
+      const absl::optional<std::string>& name,
+      const absl::optional<Execution::State>& last_known_state,
+      int64 last_update_time_since_epoch,
+      const absl::optional<std::string>& packed_properties) = 0;
 
   // Checks the existence of the ExecutionProperty table.
   virtual tensorflow::Status CheckExecutionPropertyTable() = 0;
@@ -233,10 +332,21 @@ class QueryExecutor {
       int64 execution_id, const absl::string_view name, bool is_custom_property,
       const Value& value) = 0;
 
+  // Inserts the properties of one or more executions into the database with
+  // one statement. `properties` should not be empty.
+  virtual tensorflow::Status InsertExecutionProperties(
+      const std::vector<NodePropertyRow>& properties) = 0;
+
   // Queries properties of an execution from the database by the execution id.
   virtual tensorflow::Status SelectExecutionPropertyByExecutionID(
       int64 execution_id, RecordSet* record_set) = 0;
 
+  // Queries the properties of an execution with the given names from the
+  // database by the execution id.
+  virtual tensorflow::Status SelectExecutionPropertyByExecutionIDAndNames(
+      int64 execution_id, const std::vector<std::string>& property_names,
+      RecordSet* record_set) = 0;
+
   // Updates a property of an execution from the database.
   virtual tensorflow::Status UpdateExecutionProperty(
       int64 execution_id, const absl::string_view name, const Value& value) = 0;
@@ -248,10 +358,12 @@ class QueryExecutor {
   // Checks the existence of the Context table.
   virtual tensorflow::Status CheckContextTable() = 0;
 
-  // Inserts a context into the database.
-  virtual tensorflow::Status InsertContext(int64 type_id,
-                                           const std::string& name,
-                                           int64* context_id) = 0;
+  // Inserts a context into the database. The `packed_properties` are NULL if
+  // absent, and the creation time is also the last update time of the context.
+  virtual tensorflow::Status InsertContext(
+      int64 type_id, const std::string& name, int64 create_time_since_epoch,
+      const absl::optional<std::string>& packed_properties,
+      int64* context_id) = 0;
 
   // Queries a context from the database by its id.
   virtual tensorflow::Status SelectContextByID(int64 context_id,
@@ -267,10 +379,18 @@ class QueryExecutor {
       const absl::string_view name,
       RecordSet* record_set) = 0;
 
-  // Updates a context in the Context table.
+  // Queries the contexts of a type with the given names from the Context
+  // table. Returns a list of context IDs.
+  virtual tensorflow::Status SelectContextsByTypeIDAndNames(
+      int64 context_type_id, const std::vector<std::string>& names,
+      RecordSet* record_set) = 0;
+
+  // Updates a context in the Context table. The `packed_properties` are NULL
+  // if absent.
   virtual tensorflow::Status UpdateContextDirect(
       int64 existing_context_id, int64 type_id,
-      const std::string& context_name) = 0;
+      const std::string& context_name, int64 last_update_time_since_epoch,
+      const absl::optional<std::string>& packed_properties) = 0;
 
   // Checks the existence of the ContextProperty table.
   virtual tensorflow::Status CheckContextPropertyTable() = 0;
@@ -286,6 +406,12 @@ class QueryExecutor {
   virtual tensorflow::Status SelectContextPropertyByContextID(
       int64 context_id, RecordSet* record_set) = 0;
 
+  // Queries the properties of a context with the given names from the
+  // database by the context id.
+  virtual tensorflow::Status SelectContextPropertyByContextIDAndNames(
+      int64 context_id, const std::vector<std::string>& property_names,
+      RecordSet* record_set) = 0;
+
   // Updates a property of a context in the database.
   virtual tensorflow::Status UpdateContextProperty(
       int64 context_id, const absl::string_view property_name,
@@ -304,6 +430,12 @@ class QueryExecutor {
                                          int64 event_time_milliseconds,
                                          int64* event_id) = 0;
 
+  // Inserts the events as InsertArtifacts does, and sets `event_ids` to their
+  // ids in order. The events should have their artifact_id, execution_id,
+  // type and milliseconds_since_epoch, and should not be empty.
+  virtual tensorflow::Status InsertEvents(const std::vector<Event>& events,
+                                          std::vector<int64>* event_ids) = 0;
+
   // Queries events from the Event table by its artifact id.
   virtual tensorflow::Status SelectEventByArtifactID(
       int64 artifact_id, RecordSet* event_record_set) = 0;
@@ -312,6 +444,11 @@ class QueryExecutor {
   virtual tensorflow::Status SelectEventByExecutionID(
       int64 execution_id, RecordSet* event_record_set) = 0;
 
+  // Queries the events of any of the executions. The ids should not be empty.
+  virtual tensorflow::Status SelectEventsByExecutionIDs(
+      const std::vector<int64>& execution_ids,
+      RecordSet* event_record_set) = 0;
+
   // Checks the existence of the EventPath table.
   virtual tensorflow::Status CheckEventPathTable() = 0;
 
@@ -319,10 +456,20 @@ class QueryExecutor {
   virtual tensorflow::Status InsertEventPath(int64 event_id,
                                              const Event::Path::Step& step) = 0;
 
+  // Inserts the (event id, step) path steps into the EventPath table with one
+  // statement. The steps should have an index or a key, and should not be
+  // empty.
+  virtual tensorflow::Status InsertEventPaths(
+      const std::vector<std::pair<int64, Event::Path::Step>>& steps) = 0;
+
   // Queries paths from the database by event id.
   virtual tensorflow::Status SelectEventPathByEventID(
       int64 event_id, RecordSet* record_set) = 0;
 
+  // Queries the paths of any of the events. The ids should not be empty.
+  virtual tensorflow::Status SelectEventPathsByEventIDs(
+      const std::vector<int64>& event_ids, RecordSet* record_set) = 0;
+
   // Checks the existence of the Association table.
   virtual tensorflow::Status CheckAssociationTable() = 0;
 
@@ -339,6 +486,22 @@ class QueryExecutor {
   virtual tensorflow::Status SelectAssociationByExecutionID(
       int64 execution_id, RecordSet* record_set) = 0;
 
+  // Inserts the (context id, execution id) associations with one statement,
+  // and skips the ones that already exist. `associations` should not be empty.
+  virtual tensorflow::Status InsertAssociations(
+      const std::vector<std::pair<int64, int64>>& associations) = 0;
+
+  // Queries the associations between any of the contexts and any of the
+  // executions. The ids should not be empty.
+  virtual tensorflow::Status SelectAssociationsByContextIDsAndExecutionIDs(
+      const std::vector<int64>& context_ids,
+      const std::vector<int64>& execution_ids, RecordSet* record_set) = 0;
+
+  // Queries the associations of any of the executions. The ids should not be
+  // empty.
+  virtual tensorflow::Status SelectAssociationsByExecutionIDs(
+      const std::vector<int64>& execution_ids, RecordSet* record_set) = 0;
+
   // Checks the existence of the Attribution table.
   virtual tensorflow::Status CheckAttributionTable() = 0;
 
@@ -355,6 +518,22 @@ class QueryExecutor {
   virtual tensorflow::Status SelectAttributionByArtifactID(
       int64 artifact_id, RecordSet* record_set) = 0;
 
+  // Inserts the (context id, artifact id) attributions with one statement,
+  // and skips the ones that already exist. `attributions` should not be empty.
+  virtual tensorflow::Status InsertAttributions(
+      const std::vector<std::pair<int64, int64>>& attributions) = 0;
+
+  // Queries the attributions between any of the contexts and any of the
+  // artifacts. The ids should not be empty.
+  virtual tensorflow::Status SelectAttributionsByContextIDsAndArtifactIDs(
+      const std::vector<int64>& context_ids,
+      const std::vector<int64>& artifact_ids, RecordSet* record_set) = 0;
+
+  // Queries the attributions of any of the artifacts. The ids should not be
+  // empty.
+  virtual tensorflow::Status SelectAttributionsByArtifactIDs(
+      const std::vector<int64>& artifact_ids, RecordSet* record_set) = 0;
+
   // Below is a list of fields required for metadata source migrations when
   // the library being used having different versions from a pre-existing
   // database.
@@ -381,6 +560,18 @@ class QueryExecutor {
   // The schema version and migration are introduced after that release.
   virtual tensorflow::Status CheckTablesIn_V0_13_2() = 0;
 
+  // Creates the change log table if it does not exist.
+  virtual tensorflow::Status CreateChangeLogTable() = 0;
+
+  // Queries the log id and the last sequence of the change log.
+  virtual tensorflow::Status SelectChangeLog(RecordSet* record_set) = 0;
+
+  // Inserts the change log with the given id and no changes.
+  virtual tensorflow::Status InsertChangeLog(int64 log_id) = 0;
+
+  // Advances the last sequence of the change log by `num_changes`.
+  virtual tensorflow::Status AdvanceChangeLog(int64 num_changes) = 0;
+
   // Note: these are not reflected in the original queries.
   // Select all artifact IDs.
   // Returns a list of IDs.
@@ -393,6 +584,56 @@ class QueryExecutor {
   // Select all context IDs.
   // Returns a list of IDs.
   virtual tensorflow::Status SelectAllContextIDs(RecordSet* set) = 0;
+
+  // Select the artifact id, execution id and type of all events.
+  virtual tensorflow::Status SelectAllEventEdges(RecordSet* set) = 0;
+
+  // Select the ids of the artifacts satisfying all predicates of the filter.
+  // Returns INVALID_ARGUMENT error, if a predicate is malformed or does not
+  // apply to artifacts.
+  virtual tensorflow::Status SelectArtifactIDsByFilter(const NodeFilter& filter,
+                                                       RecordSet* set) = 0;
+
+  // Select the ids of the executions satisfying all predicates of the filter.
+  // Returns INVALID_ARGUMENT error, if a predicate is malformed or does not
+  // apply to executions.
+  virtual tensorflow::Status SelectExecutionIDsByFilter(
+      const NodeFilter& filter, RecordSet* set) = 0;
+
+  // Select the ids of the contexts satisfying all predicates of the filter.
+  // Returns INVALID_ARGUMENT error, if a predicate is malformed or does not
+  // apply to contexts.
+  virtual tensorflow::Status SelectContextIDsByFilter(const NodeFilter& filter,
+                                                      RecordSet* set) = 0;
+
+  // Counts the nodes of the given kind satisfying all predicates of the
+  // filter, with COUNT(*) grouped by the `group_by` attributes. Each record
+  // has the values of the attributes in order, empty if NULL, followed by
+  // the count.
+  // Returns INVALID_ARGUMENT error, if the filter has a limit, or if a
+  // predicate or an attribute does not apply to the kind of nodes.
+  virtual tensorflow::Status CountNodesByFilter(
+      TypeKind node_kind, const NodeFilter& filter,
+      const std::vector<NodeCount::GroupBy>& group_by, RecordSet* set) = 0;
+
+  // Counts the rows deleted by DeleteNodes for the nodes of the given kind
+  // with the ids. The single record has a column per table, named after the
+  // table, with the number of its rows to be deleted.
+  virtual tensorflow::Status CountRowsOfNodeDeletion(
+      TypeKind node_kind, const std::vector<int64>& node_ids,
+      RecordSet* set) = 0;
+
+  // Deletes the nodes of the given kind with the ids, along with their
+  // properties, events, event paths, attributions and associations. The ids
+  // that are not found are ignored.
+  virtual tensorflow::Status DeleteNodes(
+      TypeKind node_kind, const std::vector<int64>& node_ids) = 0;
+
+  // Selects which of the ids are of the existing nodes of the given kind, with
+  // one record per found id. `node_ids` should not be empty.
+  virtual tensorflow::Status SelectExistingNodeIDs(
+      TypeKind node_kind, const std::vector<int64>& node_ids,
+      RecordSet* set) = 0;
 };
 
 }  // namespace ml_metadata
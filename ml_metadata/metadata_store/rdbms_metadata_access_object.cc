@@ -16,6 +16,9 @@ limitations under the License.
 #include "ml_metadata/metadata_store/rdbms_metadata_access_object.h"
 #endif
 
+#include <algorithm>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -30,6 +33,7 @@ limitations under the License.
 #include "absl/strings/substitute.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "absl/types/optional.h"
 // clang-format off
 #ifdef _WIN32
 #include "ml_metadata/metadata_store/rdbms_metadata_access_object.h" // NOLINT
@@ -121,7 +125,8 @@ tensorflow::Status ParseValueToField(
 
 // Converts a RecordSet in the query result to a MessageType. In the record at
 // the `record_index`, its value of each column is assigned to a message field
-// with the same field name as the column name.
+// with the same field name as the column name. A NULL value, read as empty,
+// leaves a non-string field unset.
 template <typename MessageType>
 tensorflow::Status ParseRecordSetToMessage(const RecordSet& record_set,
                                            MessageType* message,
@@ -132,10 +137,14 @@ tensorflow::Status ParseRecordSetToMessage(const RecordSet& record_set,
     const std::string& column_name = record_set.column_names(i);
     const google::protobuf::FieldDescriptor* field_descriptor =
         descriptor->FindFieldByName(column_name);
-    if (field_descriptor != nullptr) {
-      const std::string& value = record_set.records(record_index).values(i);
-      TF_RETURN_IF_ERROR(ParseValueToField(field_descriptor, value, message));
+    if (field_descriptor == nullptr) continue;
+    const std::string& value = record_set.records(record_index).values(i);
+    if (value.empty() &&
+        field_descriptor->cpp_type() !=
+            google::protobuf::FieldDescriptor::CPPTYPE_STRING) {
+      continue;
     }
+    TF_RETURN_IF_ERROR(ParseValueToField(field_descriptor, value, message));
   }
   return tensorflow::Status::OK();
 }
@@ -144,6 +153,7 @@ tensorflow::Status ParseRecordSetToMessage(const RecordSet& record_set,
 template <typename MessageType>
 tensorflow::Status ParseRecordSetToMessageArray(
     const RecordSet& record_set, std::vector<MessageType>* messages) {
+  messages->reserve(messages->size() + record_set.records_size());
   for (int i = 0; i < record_set.records_size(); i++) {
     messages->push_back(MessageType());
     TF_RETURN_IF_ERROR(
@@ -230,68 +240,318 @@ tensorflow::Status ValidatePropertiesWithType(const Node& node,
   return tensorflow::Status::OK();
 }
 
+// Returns the state of an artifact or the last known state of an execution,
+// or none if it is not given.
+absl::optional<Artifact::State> StateOf(const Artifact& artifact) {
+  if (!artifact.has_state()) return absl::nullopt;
+  return artifact.state();
+}
+
+absl::optional<Execution::State> StateOf(const Execution& execution) {
+  if (!execution.has_last_known_state()) return absl::nullopt;
+  return execution.last_known_state();
+}
+
+// The maximum number of rows inserted by one multi-row statement, which keeps
+// the statements within the query size limits of the SQL backends.
+constexpr size_t kMaxNumRowsPerInsert = 1000;
+
+// Appends the `properties` of the node with `node_id` to `rows`.
+void AppendPropertyRows(
+    const int64 node_id,
+    const google::protobuf::Map<std::string, Value>& properties,
+    const bool is_custom_property, std::vector<NodePropertyRow>* rows) {
+  for (const auto& property : properties) {
+    NodePropertyRow row;
+    row.node_id = node_id;
+    row.name = property.first;
+    row.is_custom_property = is_custom_property;
+    row.value = property.second;
+    rows->push_back(std::move(row));
+  }
+}
+
+// Returns the name of an artifact or an execution, or none if it is not given
+// or empty. The unnamed nodes are stored with a NULL name, which is not
+// subject to the unique constraint of the names within a type.
+template <typename Node>
+absl::optional<std::string> NameOf(const Node& node) {
+  if (node.name().empty()) return absl::nullopt;
+  return node.name();
+}
+
+// Returns the row of an artifact in the Artifact table, without its packed
+// properties.
+NodeRow ToNodeRow(const Artifact& artifact) {
+  NodeRow row;
+  row.type_id = artifact.type_id();
+  row.uri = artifact.uri();
+  row.name = NameOf(artifact);
+  if (artifact.has_state()) row.state = artifact.state();
+  return row;
+}
+
+// Returns the row of an execution in the Execution table, without its packed
+// properties.
+NodeRow ToNodeRow(const Execution& execution) {
+  NodeRow row;
+  row.type_id = execution.type_id();
+  row.name = NameOf(execution);
+  if (execution.has_last_known_state()) {
+    row.state = execution.last_known_state();
+  }
+  return row;
+}
+
+// Writes the JSON of the properties and the custom properties of the `node`,
+// which is stored in the `packed_properties` column of the packed nodes.
+// Returns INVALID_ARGUMENT error, if the properties cannot be written as JSON.
+template <typename Node>
+tensorflow::Status PackProperties(const Node& node,
+                                  std::string* packed_properties) {
+  Node properties;
+  *properties.mutable_properties() = node.properties();
+  *properties.mutable_custom_properties() = node.custom_properties();
+  if (!google::protobuf::util::MessageToJsonString(properties,
+                                                   packed_properties)
+           .ok()) {
+    return tensorflow::errors::InvalidArgument(
+        "Could not write properties to JSON: ", properties.DebugString());
+  }
+  return tensorflow::Status::OK();
+}
+
+// Sets the properties and the custom properties of the `node` from the JSON
+// `packed_properties`.
+// Returns INTERNAL error, if the JSON cannot be parsed.
+template <typename Node>
+tensorflow::Status UnpackProperties(const std::string& packed_properties,
+                                    Node* node) {
+  Node properties;
+  if (!google::protobuf::util::JsonStringToMessage(packed_properties,
+                                                   &properties)
+           .ok()) {
+    return tensorflow::errors::Internal("Failed to parse packed properties: ",
+                                        packed_properties);
+  }
+  node->mutable_properties()->swap(*properties.mutable_properties());
+  node->mutable_custom_properties()->swap(
+      *properties.mutable_custom_properties());
+  return tensorflow::Status::OK();
+}
+
+// Returns the `packed_properties` column of the node selected by its id, or
+// an empty string if the properties of the node are stored as property rows.
+std::string GetPackedProperties(const RecordSet& node_record_set) {
+  if (node_record_set.records_size() == 0) return "";
+  for (int i = 0; i < node_record_set.column_names_size(); ++i) {
+    if (node_record_set.column_names(i) == "packed_properties") {
+      return node_record_set.records(0).values(i);
+    }
+  }
+  return "";
+}
+
+// Returns the properties of the `node` which are indexed by its `type`. In the
+// packed layout, these are also stored as property rows to be filtered on.
+template <typename Node, typename Type>
+google::protobuf::Map<std::string, Value> IndexedPropertiesOf(
+    const Node& node, const Type& type) {
+  google::protobuf::Map<std::string, Value> indexed_properties;
+  for (const std::string& property_name : type.indexed_properties()) {
+    const auto it = node.properties().find(property_name);
+    if (it != node.properties().end()) {
+      indexed_properties[property_name] = it->second;
+    }
+  }
+  return indexed_properties;
+}
+
+// Parses the records of a count query, with the values of the `group_by`
+// attributes followed by the count, to `counts`.
+// Returns INTERNAL error, if a record is malformed.
+tensorflow::Status ParseNodeCounts(
+    const RecordSet& record_set,
+    const std::vector<NodeCount::GroupBy>& group_by,
+    std::vector<NodeCount>* counts) {
+  for (const RecordSet::Record& record : record_set.records()) {
+    if (record.values_size() != group_by.size() + 1) {
+      return tensorflow::errors::Internal("Malformed count record: ",
+                                          record.DebugString());
+    }
+    NodeCount count;
+    for (int i = 0; i < group_by.size(); ++i) {
+      // A NULL attribute is left unset.
+      if (record.values(i).empty()) continue;
+      int64 value;
+      if (!absl::SimpleAtoi(record.values(i), &value)) {
+        return tensorflow::errors::Internal("Malformed count record: ",
+                                            record.DebugString());
+      }
+      switch (group_by[i]) {
+        case NodeCount::TYPE_ID:
+          count.set_type_id(value);
+          break;
+        case NodeCount::STATE:
+          count.set_state(value);
+          break;
+        case NodeCount::CONTEXT_ID:
+          count.set_context_id(value);
+          break;
+        default:
+          break;
+      }
+    }
+    int64 num_nodes;
+    if (!absl::SimpleAtoi(record.values(group_by.size()), &num_nodes)) {
+      return tensorflow::errors::Internal("Malformed count record: ",
+                                          record.DebugString());
+    }
+    count.set_count(num_nodes);
+    counts->push_back(count);
+  }
+  return tensorflow::Status::OK();
+}
+
+// Parses the log id and the last sequence of the change log, if any, from the
+// `record_set`. Sets `found` to false if there is no change log.
+// Returns DATA_LOSS error, if the change log cannot be parsed.
+tensorflow::Status ParseChangeLog(const RecordSet& record_set, bool* found,
+                                  int64* log_id, int64* last_sequence) {
+  *found = record_set.records_size() > 0;
+  if (!*found) return tensorflow::Status::OK();
+  const RecordSet::Record& record = record_set.records(0);
+  if (record_set.records_size() > 1 || record.values_size() != 2 ||
+      !absl::SimpleAtoi(record.values(0), log_id) ||
+      !absl::SimpleAtoi(record.values(1), last_sequence)) {
+    return tensorflow::errors::DataLoss("Cannot parse the change log: ",
+                                        record_set.DebugString());
+  }
+  return tensorflow::Status::OK();
+}
+
 }  // namespace
 
-// Creates an Artifact (without properties).
+template <typename Node>
+tensorflow::Status RDBMSMetadataAccessObject::PackedPropertiesOf(
+    const Node& node, absl::optional<std::string>* packed_properties) {
+  packed_properties->reset();
+  if (!pack_properties_) return tensorflow::Status::OK();
+  std::string json;
+  TF_RETURN_IF_ERROR(PackProperties(node, &json));
+  *packed_properties = std::move(json);
+  return tensorflow::Status::OK();
+}
+
+// Creates an Artifact (without property rows).
 tensorflow::Status RDBMSMetadataAccessObject::CreateBasicNode(
     const Artifact& artifact, int64* node_id) {
-  return executor_->InsertArtifact(artifact.type_id(), artifact.uri(), node_id);
+  absl::optional<std::string> packed_properties;
+  TF_RETURN_IF_ERROR(PackedPropertiesOf(artifact, &packed_properties));
+  return executor_->InsertArtifact(
+      artifact.type_id(), artifact.uri(), NameOf(artifact), StateOf(artifact),
+      absl::ToUnixMillis(absl::Now()), packed_properties, node_id);
 }
 
-// Creates an Execution (without properties).
+// Creates an Execution (without property rows).
 tensorflow::Status RDBMSMetadataAccessObject::CreateBasicNode(
     const Execution& execution, int64* node_id) {
-  return executor_->InsertExecution(execution.type_id(), node_id);
+  absl::optional<std::string> packed_properties;
+  TF_RETURN_IF_ERROR(PackedPropertiesOf(execution, &packed_properties));
+  return executor_->InsertExecution(
+      execution.type_id(), NameOf(execution), StateOf(execution),
+      absl::ToUnixMillis(absl::Now()), packed_properties, node_id);
 }
 
-// Creates a Context (without properties).
+// Creates a Context (without property rows).
 tensorflow::Status RDBMSMetadataAccessObject::CreateBasicNode(
     const Context& context, int64* node_id) {
   if (!context.has_name() || context.name().empty()) {
     return tensorflow::errors::InvalidArgument(
         "Context name should not be empty");
   }
-  return executor_->InsertContext(context.type_id(), context.name(), node_id);
+  absl::optional<std::string> packed_properties;
+  TF_RETURN_IF_ERROR(PackedPropertiesOf(context, &packed_properties));
+  return executor_->InsertContext(context.type_id(), context.name(),
+                                  absl::ToUnixMillis(absl::Now()),
+                                  packed_properties, node_id);
 }
 
 // Lookup Artifact by id.
 tensorflow::Status RDBMSMetadataAccessObject::NodeLookups(
-    const Artifact& artifact, RecordSet* header, RecordSet* properties) {
+    const Artifact& artifact, const ParsedNodeReadMask* read_mask,
+    RecordSet* header, RecordSet* properties) {
   TF_RETURN_IF_ERROR(executor_->SelectArtifactByID(artifact.id(), header));
-  TF_RETURN_IF_ERROR(
-      executor_->SelectArtifactPropertyByArtifactID(artifact.id(), properties));
+  // the properties of a packed node are read along with it.
+  if (!GetPackedProperties(*header).empty()) return tensorflow::Status::OK();
+  if (read_mask == nullptr || read_mask->selects_all() ||
+      read_mask->properties().all || read_mask->custom_properties().all) {
+    return executor_->SelectArtifactPropertyByArtifactID(artifact.id(),
+                                                         properties);
+  }
+  if (read_mask->selects_some_properties()) {
+    return executor_->SelectArtifactPropertyByArtifactIDAndNames(
+        artifact.id(), read_mask->GetSelectedPropertyNames(), properties);
+  }
   return tensorflow::Status::OK();
 }
 
 // Generates a select queries for an Execution by id.
 tensorflow::Status RDBMSMetadataAccessObject::NodeLookups(
-    const Execution& execution, RecordSet* header, RecordSet* properties) {
+    const Execution& execution, const ParsedNodeReadMask* read_mask,
+    RecordSet* header, RecordSet* properties) {
   TF_RETURN_IF_ERROR(executor_->SelectExecutionByID(execution.id(), header));
-  TF_RETURN_IF_ERROR(executor_->SelectExecutionPropertyByExecutionID(
-      execution.id(), properties));
+  // the properties of a packed node are read along with it.
+  if (!GetPackedProperties(*header).empty()) return tensorflow::Status::OK();
+  if (read_mask == nullptr || read_mask->selects_all() ||
+      read_mask->properties().all || read_mask->custom_properties().all) {
+    return executor_->SelectExecutionPropertyByExecutionID(execution.id(),
+                                                           properties);
+  }
+  if (read_mask->selects_some_properties()) {
+    return executor_->SelectExecutionPropertyByExecutionIDAndNames(
+        execution.id(), read_mask->GetSelectedPropertyNames(), properties);
+  }
   return tensorflow::Status::OK();
 }
 
 // Lookup Context by id.
 tensorflow::Status RDBMSMetadataAccessObject::NodeLookups(
-    const Context& context, RecordSet* header, RecordSet* properties) {
+    const Context& context, const ParsedNodeReadMask* read_mask,
+    RecordSet* header, RecordSet* properties) {
   TF_RETURN_IF_ERROR(executor_->SelectContextByID(context.id(), header));
-  TF_RETURN_IF_ERROR(
-      executor_->SelectContextPropertyByContextID(context.id(), properties));
+  // the properties of a packed node are read along with it.
+  if (!GetPackedProperties(*header).empty()) return tensorflow::Status::OK();
+  if (read_mask == nullptr || read_mask->selects_all() ||
+      read_mask->properties().all || read_mask->custom_properties().all) {
+    return executor_->SelectContextPropertyByContextID(context.id(),
+                                                       properties);
+  }
+  if (read_mask->selects_some_properties()) {
+    return executor_->SelectContextPropertyByContextIDAndNames(
+        context.id(), read_mask->GetSelectedPropertyNames(), properties);
+  }
   return tensorflow::Status::OK();
 }
 
-// Update an Artifact's type_id and URI.
+// Update an Artifact's type_id, URI, name and state.
 tensorflow::Status RDBMSMetadataAccessObject::RunNodeUpdate(
     const Artifact& artifact) {
-  return executor_->UpdateArtifactDirect(artifact.id(), artifact.type_id(),
-                                         artifact.uri());
+  absl::optional<std::string> packed_properties;
+  TF_RETURN_IF_ERROR(PackedPropertiesOf(artifact, &packed_properties));
+  return executor_->UpdateArtifactDirect(
+      artifact.id(), artifact.type_id(), artifact.uri(), NameOf(artifact),
+      StateOf(artifact), absl::ToUnixMillis(absl::Now()), packed_properties);
 }
 
-// Update an Execution's type_id.
+// Update an Execution's type_id, name and last known state.
 tensorflow::Status RDBMSMetadataAccessObject::RunNodeUpdate(
     const Execution& execution) {
-  return executor_->UpdateExecutionDirect(execution.id(), execution.type_id());
+  absl::optional<std::string> packed_properties;
+  TF_RETURN_IF_ERROR(PackedPropertiesOf(execution, &packed_properties));
+  return executor_->UpdateExecutionDirect(
+      execution.id(), execution.type_id(), NameOf(execution),
+      StateOf(execution), absl::ToUnixMillis(absl::Now()), packed_properties);
 }
 
 // Update a Context's type id and name.
@@ -301,8 +561,32 @@ tensorflow::Status RDBMSMetadataAccessObject::RunNodeUpdate(
     return tensorflow::errors::InvalidArgument(
         "Context name should not be empty");
   }
+  absl::optional<std::string> packed_properties;
+  TF_RETURN_IF_ERROR(PackedPropertiesOf(context, &packed_properties));
   return executor_->UpdateContextDirect(context.id(), context.type_id(),
-                                        context.name());
+                                        context.name(),
+                                        absl::ToUnixMillis(absl::Now()),
+                                        packed_properties);
+}
+
+// Queries all the property rows of a node for a NodeType.
+template <typename NodeType>
+tensorflow::Status RDBMSMetadataAccessObject::SelectPropertyRows(
+    const int64 node_id, RecordSet* record_set) {
+  NodeType type;
+  const TypeKind type_kind = ResolveTypeKind(&type);
+  switch (type_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      return executor_->SelectArtifactPropertyByArtifactID(node_id,
+                                                           record_set);
+    case TypeKind::EXECUTION_TYPE:
+      return executor_->SelectExecutionPropertyByExecutionID(node_id,
+                                                             record_set);
+    case TypeKind::CONTEXT_TYPE:
+      return executor_->SelectContextPropertyByContextID(node_id, record_set);
+    default:
+      return tensorflow::errors::Internal("Unsupported TypeKind.");
+  }
 }
 
 // Runs a property insertion query for a NodeType.
@@ -330,6 +614,49 @@ tensorflow::Status RDBMSMetadataAccessObject::InsertProperty(
   }
 }
 
+template <typename NodeType>
+tensorflow::Status RDBMSMetadataAccessObject::InsertNodeRows(
+    const std::vector<NodeRow>& rows, std::vector<int64>* node_ids) {
+  NodeType node;
+  const TypeKind type_kind = ResolveTypeKind(&node);
+  const int64 create_time = absl::ToUnixMillis(absl::Now());
+  switch (type_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      return executor_->InsertArtifacts(rows, create_time, node_ids);
+    case TypeKind::EXECUTION_TYPE:
+      return executor_->InsertExecutions(rows, create_time, node_ids);
+    default:
+      return tensorflow::errors::Internal(
+          absl::StrCat("Unsupported TypeKind: ", type_kind));
+  }
+}
+
+template <typename NodeType>
+tensorflow::Status RDBMSMetadataAccessObject::InsertProperties(
+    const std::vector<NodePropertyRow>& properties) {
+  NodeType node;
+  const TypeKind type_kind = ResolveTypeKind(&node);
+  for (size_t begin = 0; begin < properties.size();
+       begin += kMaxNumRowsPerInsert) {
+    const std::vector<NodePropertyRow> chunk(
+        properties.begin() + begin,
+        properties.begin() +
+            std::min(properties.size(), begin + kMaxNumRowsPerInsert));
+    switch (type_kind) {
+      case TypeKind::ARTIFACT_TYPE:
+        TF_RETURN_IF_ERROR(executor_->InsertArtifactProperties(chunk));
+        break;
+      case TypeKind::EXECUTION_TYPE:
+        TF_RETURN_IF_ERROR(executor_->InsertExecutionProperties(chunk));
+        break;
+      default:
+        return tensorflow::errors::Internal(
+            absl::StrCat("Unsupported TypeKind: ", type_kind));
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
 // Generates a property update query for a NodeType.
 template <typename NodeType>
 tensorflow::Status RDBMSMetadataAccessObject::UpdateProperty(
@@ -438,6 +765,7 @@ tensorflow::Status RDBMSMetadataAccessObject::InsertTypeID(
 // ContextType}.
 // Returns INVALID_ARGUMENT error, if name field is not given.
 // Returns INVALID_ARGUMENT error, if any property type is unknown.
+// Returns INVALID_ARGUMENT error, if any indexed property is not defined.
 // Returns detailed INTERNAL error, if query execution fails.
 template <typename Type>
 tensorflow::Status RDBMSMetadataAccessObject::CreateTypeImpl(const Type& type,
@@ -467,6 +795,39 @@ tensorflow::Status RDBMSMetadataAccessObject::CreateTypeImpl(const Type& type,
     TF_RETURN_IF_ERROR(
         executor_->InsertTypeProperty(*type_id, property_name, property_type));
   }
+  return IndexTypePropertiesImpl(type, *type_id, type_properties);
+}
+
+// Marks the `indexed_properties` of a stored type as indexed. The property
+// table indexes are created by CreatePropertyIndexes, outside of the
+// transaction writing the type.
+// Returns INVALID_ARGUMENT error, if any indexed property is not defined.
+// Returns detailed INTERNAL error, if query execution fails.
+template <typename Type>
+tensorflow::Status RDBMSMetadataAccessObject::IndexTypePropertiesImpl(
+    const Type& type, const int64 type_id,
+    const google::protobuf::Map<std::string, PropertyType>& properties) {
+  for (const std::string& property_name : type.indexed_properties()) {
+    if (properties.find(property_name) == properties.end()) {
+      return tensorflow::errors::InvalidArgument(
+          "Indexed property ", property_name, " is not defined in the type.");
+    }
+    TF_RETURN_IF_ERROR(
+        executor_->UpdateTypePropertyIsIndexed(type_id, property_name));
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Type>
+tensorflow::Status RDBMSMetadataAccessObject::CreatePropertyIndexesImpl(
+    const Type& type) {
+  Type stored_type;
+  TF_RETURN_IF_ERROR(FindTypeImpl(type.name(), &stored_type));
+  const TypeKind type_kind = ResolveTypeKind(&stored_type);
+  for (const std::string& property_name : stored_type.indexed_properties()) {
+    TF_RETURN_IF_ERROR(executor_->CreatePropertyIndexIfNotExists(
+        type_kind, stored_type.properties().at(property_name)));
+  }
   return tensorflow::Status::OK();
 }
 
@@ -511,6 +872,13 @@ tensorflow::Status RDBMSMetadataAccessObject::FindTypesFromRecordSet(
 
     TF_RETURN_IF_ERROR(ParseRecordSetToMapField(property_record_set,
                                                 "properties", &types->at(i)));
+
+    RecordSet indexed_record_set;
+    TF_RETURN_IF_ERROR(executor_->SelectIndexedPropertyByTypeID(
+        types->at(i).id(), &indexed_record_set));
+    for (const RecordSet::Record& record : indexed_record_set.records()) {
+      types->at(i).add_indexed_properties(record.values(0));
+    }
   }
 
   return tensorflow::Status::OK();
@@ -558,8 +926,9 @@ tensorflow::Status RDBMSMetadataAccessObject::FindAllTypeInstancesImpl(
 // Returns INVALID_ARGUMENT error, if id field is given and is different.
 // Returns INVALID_ARGUMENT error, if any property type is unknown.
 // Returns ALREADY_EXISTS error, if any property type is different.
+// Returns INVALID_ARGUMENT error, if any indexed property is not defined.
 // Returns detailed INTERNAL error, if query execution fails.
-template <typename Type>
+template <typename Node, typename Type>
 tensorflow::Status RDBMSMetadataAccessObject::UpdateTypeImpl(const Type& type) {
   if (!type.has_name()) {
     return tensorflow::errors::InvalidArgument("No type name is specified.");
@@ -595,6 +964,101 @@ tensorflow::Status RDBMSMetadataAccessObject::UpdateTypeImpl(const Type& type) {
     TF_RETURN_IF_ERROR(executor_->InsertTypeProperty(
         stored_type.id(), property_name, property_type));
   }
+  // indexing is additive, the already indexed properties stay indexed.
+  google::protobuf::Map<std::string, PropertyType> properties(
+      stored_properties);
+  properties.insert(type.properties().begin(), type.properties().end());
+  TF_RETURN_IF_ERROR(
+      IndexTypePropertiesImpl(type, stored_type.id(), properties));
+  std::vector<std::string> newly_indexed_properties;
+  for (const std::string& property_name : type.indexed_properties()) {
+    if (std::find(stored_type.indexed_properties().begin(),
+                  stored_type.indexed_properties().end(),
+                  property_name) == stored_type.indexed_properties().end()) {
+      newly_indexed_properties.push_back(property_name);
+    }
+  }
+  return AddIndexedPropertyRowsImpl<Node, Type>(stored_type.id(),
+                                                newly_indexed_properties);
+}
+
+template <typename Node, typename NodeType>
+tensorflow::Status RDBMSMetadataAccessObject::AddIndexedPropertyRowsImpl(
+    const int64 type_id, const std::vector<std::string>& property_names) {
+  if (property_names.empty()) return tensorflow::Status::OK();
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(SelectNodeIDsByTypeID<NodeType>(type_id, &record_set));
+  const google::protobuf::Map<std::string, Value> prev_properties;
+  for (const RecordSet::Record& record : record_set.records()) {
+    int64 node_id;
+    CHECK(absl::SimpleAtoi(record.values(0), &node_id));
+    Node node;
+    bool is_packed = false;
+    TF_RETURN_IF_ERROR(
+        FindNodeImpl(node_id, &node, /*read_mask=*/nullptr, &is_packed));
+    // a node stored as property rows already has rows for all its properties.
+    if (!is_packed) continue;
+    google::protobuf::Map<std::string, Value> properties;
+    for (const std::string& property_name : property_names) {
+      const auto it = node.properties().find(property_name);
+      if (it != node.properties().end()) properties[it->first] = it->second;
+    }
+    TF_RETURN_IF_ERROR(ModifyProperties<NodeType>(
+        properties, prev_properties, node_id, /*is_custom_property=*/false));
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename NodeType>
+tensorflow::Status RDBMSMetadataAccessObject::SelectNodeIDsByTypeID(
+    const int64 type_id, RecordSet* record_set) {
+  NodeType type;
+  const TypeKind type_kind = ResolveTypeKind(&type);
+  switch (type_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      return executor_->SelectArtifactsByTypeID(type_id, record_set);
+    case TypeKind::EXECUTION_TYPE:
+      return executor_->SelectExecutionsByTypeID(type_id, record_set);
+    case TypeKind::CONTEXT_TYPE:
+      return executor_->SelectContextsByTypeID(type_id, record_set);
+    default:
+      return tensorflow::errors::Internal(
+          absl::StrCat("Unsupported TypeKind: ", type_kind));
+  }
+}
+
+template <typename NodeType>
+tensorflow::Status RDBMSMetadataAccessObject::CheckFilterIsIndexed(
+    const NodeFilter& filter) {
+  if (!pack_properties_) return tensorflow::Status::OK();
+  std::vector<NodeType> types;
+  bool types_found = false;
+  for (const NodeFilter::Predicate& predicate : filter.predicates()) {
+    if (predicate.has_custom_property()) {
+      return tensorflow::errors::InvalidArgument(
+          "Custom properties are packed and cannot be filtered on: ",
+          predicate.DebugString());
+    }
+    if (!predicate.has_property()) continue;
+    if (!types_found) {
+      TF_RETURN_IF_ERROR(FindAllTypeInstancesImpl(&types));
+      types_found = true;
+    }
+    for (const NodeType& type : types) {
+      if (type.properties().find(predicate.property()) ==
+          type.properties().end()) {
+        continue;
+      }
+      if (std::find(type.indexed_properties().begin(),
+                    type.indexed_properties().end(),
+                    predicate.property()) == type.indexed_properties().end()) {
+        return tensorflow::errors::InvalidArgument(
+            "Property ", predicate.property(), " is not indexed by type ",
+            type.name(), " and cannot be filtered on: ",
+            predicate.DebugString());
+      }
+    }
+  }
   return tensorflow::Status::OK();
 }
 
@@ -622,8 +1086,13 @@ tensorflow::Status RDBMSMetadataAccessObject::CreateNodeImpl(const Node& node,
   // insert a node and get the assigned id
   TF_RETURN_IF_ERROR(CreateBasicNode(node, node_id));
 
-  // insert properties
+  // insert properties. A packed node only has rows for its indexed properties.
   const google::protobuf::Map<std::string, Value> prev_properties;
+  if (pack_properties_) {
+    return ModifyProperties<NodeType>(IndexedPropertiesOf(node, node_type),
+                                      prev_properties, *node_id,
+                                      /*is_custom_property=*/false);
+  }
   TF_RETURN_IF_ERROR(ModifyProperties<NodeType>(node.properties(),
                                                 prev_properties, *node_id,
                                                 /*is_custom_property=*/false));
@@ -633,26 +1102,97 @@ tensorflow::Status RDBMSMetadataAccessObject::CreateNodeImpl(const Node& node,
   return tensorflow::Status::OK();
 }
 
+template <typename Node, typename NodeType>
+tensorflow::Status RDBMSMetadataAccessObject::CreateNodesImpl(
+    const std::vector<Node>& nodes, std::vector<int64>* node_ids) {
+  node_ids->clear();
+  node_ids->reserve(nodes.size());
+  // type id -> the type, looked up by the first node of the type.
+  std::map<int64, NodeType> node_types;
+  std::vector<NodeRow> rows;
+  rows.reserve(nodes.size());
+  for (const Node& node : nodes) {
+    if (!node.has_type_id())
+      return tensorflow::errors::InvalidArgument("Type id is missing.");
+    auto type_it = node_types.find(node.type_id());
+    if (type_it == node_types.end()) {
+      NodeType node_type;
+      TF_RETURN_IF_ERROR(FindTypeImpl(node.type_id(), &node_type));
+      type_it = node_types.emplace(node.type_id(), node_type).first;
+    }
+    TF_RETURN_IF_ERROR(ValidatePropertiesWithType(node, type_it->second));
+    rows.push_back(ToNodeRow(node));
+    TF_RETURN_IF_ERROR(
+        PackedPropertiesOf(node, &rows.back().packed_properties));
+  }
+
+  // the nodes of a chunk are inserted by one statement where the backend
+  // allows it.
+  for (size_t begin = 0; begin < rows.size(); begin += kMaxNumRowsPerInsert) {
+    const std::vector<NodeRow> chunk(
+        rows.begin() + begin,
+        rows.begin() + std::min(rows.size(), begin + kMaxNumRowsPerInsert));
+    std::vector<int64> chunk_ids;
+    TF_RETURN_IF_ERROR(InsertNodeRows<NodeType>(chunk, &chunk_ids));
+    node_ids->insert(node_ids->end(), chunk_ids.begin(), chunk_ids.end());
+  }
+
+  std::vector<NodePropertyRow> properties;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const Node& node = nodes[i];
+    const int64 node_id = (*node_ids)[i];
+    if (pack_properties_) {
+      AppendPropertyRows(node_id,
+                         IndexedPropertiesOf(node, node_types[node.type_id()]),
+                         /*is_custom_property=*/false, &properties);
+      continue;
+    }
+    AppendPropertyRows(node_id, node.properties(),
+                       /*is_custom_property=*/false, &properties);
+    AppendPropertyRows(node_id, node.custom_properties(),
+                       /*is_custom_property=*/true, &properties);
+  }
+  return InsertProperties<NodeType>(properties);
+}
+
 // Queries a `Node` which is one of {`Artifact`, `Execution`, `Context`} by
-// an id.
+// an id. The properties are read from the packed properties of the node, or
+// from the property rows if it has none.
 // Returns NOT_FOUND error, if the given id cannot be found.
 // Returns detailed INTERNAL error, if query execution fails.
 template <typename Node>
-tensorflow::Status RDBMSMetadataAccessObject::FindNodeImpl(const int64 node_id,
-                                                           Node* node) {
+tensorflow::Status RDBMSMetadataAccessObject::FindNodeImpl(
+    const int64 node_id, Node* node, const ParsedNodeReadMask* read_mask,
+    bool* is_packed) {
   node->set_id(node_id);
   RecordSet node_record_set;
   RecordSet properties_record_set;
 
-  TF_RETURN_IF_ERROR(
-      NodeLookups(*node, &node_record_set, &properties_record_set));
+  TF_RETURN_IF_ERROR(NodeLookups(*node, read_mask, &node_record_set,
+                                 &properties_record_set));
 
   if (node_record_set.records_size() == 0)
     return tensorflow::errors::NotFound(
         absl::StrCat("Cannot find record by given id ", node_id));
 
   TF_RETURN_IF_ERROR(ParseRecordSetToMessage(node_record_set, node));
+  // a NULL name, read as empty, is left unset.
+  if (node->name().empty()) node->clear_name();
+  const std::string packed_properties = GetPackedProperties(node_record_set);
+  if (is_packed != nullptr) *is_packed = !packed_properties.empty();
+  if (!packed_properties.empty()) {
+    TF_RETURN_IF_ERROR(UnpackProperties(packed_properties, node));
+  } else {
+    TF_RETURN_IF_ERROR(ParsePropertiesRecordSet(properties_record_set, node));
+  }
+  // the unselected fields are cleared once the properties are parsed.
+  if (read_mask != nullptr) read_mask->Apply(node);
+  return tensorflow::Status::OK();
+}
 
+template <typename Node>
+tensorflow::Status RDBMSMetadataAccessObject::ParsePropertiesRecordSet(
+    const RecordSet& properties_record_set, Node* node) {
   // it is ok that there is no property associated with a node
   if (properties_record_set.records_size() == 0)
     return tensorflow::Status::OK();
@@ -685,7 +1225,13 @@ tensorflow::Status RDBMSMetadataAccessObject::FindNodeImpl(const int64 node_id,
 // Find nodes by ID, where the IDs are encoded in a record set.
 template <typename Node>
 tensorflow::Status RDBMSMetadataAccessObject::FindManyNodesImpl(
-    const RecordSet& record_set, std::vector<Node>* nodes) {
+    const RecordSet& record_set, std::vector<Node>* nodes,
+    const NodeReadMask* read_mask) {
+  ParsedNodeReadMask parsed_read_mask;
+  if (read_mask != nullptr) {
+    TF_RETURN_IF_ERROR(
+        ParsedNodeReadMask::Parse<Node>(*read_mask, &parsed_read_mask));
+  }
   if (record_set.records_size() == 0)
     return tensorflow::errors::NotFound(absl::StrCat("Cannot find any record"));
   nodes->reserve(record_set.records_size());
@@ -693,7 +1239,8 @@ tensorflow::Status RDBMSMetadataAccessObject::FindManyNodesImpl(
     int64 node_id;
     CHECK(absl::SimpleAtoi(record.values(0), &node_id));
     nodes->push_back(Node());
-    TF_RETURN_IF_ERROR(FindNodeImpl<Node>(node_id, &nodes->back()));
+    TF_RETURN_IF_ERROR(
+        FindNodeImpl<Node>(node_id, &nodes->back(), &parsed_read_mask));
   }
   return tensorflow::Status::OK();
 }
@@ -709,7 +1256,9 @@ tensorflow::Status RDBMSMetadataAccessObject::UpdateNodeImpl(const Node& node) {
     return tensorflow::errors::InvalidArgument("No id is given.");
 
   Node stored_node;
-  tensorflow::Status status = FindNodeImpl(node.id(), &stored_node);
+  bool is_packed;
+  tensorflow::Status status = FindNodeImpl(node.id(), &stored_node,
+                                           /*read_mask=*/nullptr, &is_packed);
   if (tensorflow::errors::IsNotFound(status)) {
     return tensorflow::errors::InvalidArgument(
         absl::StrCat("Cannot find the given id ", node.id()));
@@ -726,20 +1275,43 @@ tensorflow::Status RDBMSMetadataAccessObject::UpdateNodeImpl(const Node& node) {
   TF_RETURN_IF_ERROR(FindTypeImpl(type_id, &stored_type));
   TF_RETURN_IF_ERROR(ValidatePropertiesWithType(node, stored_type));
 
-  // update nodes, and update, insert, delete properties
-  google::protobuf::util::MessageDifferencer diff;
-  diff.IgnoreField(Node::descriptor()->FindFieldByName("properties"));
-  diff.IgnoreField(Node::descriptor()->FindFieldByName("custom_properties"));
-  if (!diff.Compare(node, stored_node)) {
+  // update nodes, and update, insert, delete properties. The node is also
+  // updated when only its properties change, so that its last update time
+  // covers the changes of the properties, and when it is stored in the other
+  // property layout, so that it is converted to the current one.
+  if (!google::protobuf::util::MessageDifferencer::Equals(node, stored_node) ||
+      is_packed != pack_properties_) {
     TF_RETURN_IF_ERROR(RunNodeUpdate(node));
   }
 
+  // the property rows of a packed node are its indexed properties, which are
+  // read from the rows rather than from its packed properties.
+  Node stored_rows;
+  if (is_packed) {
+    RecordSet properties_record_set;
+    TF_RETURN_IF_ERROR(
+        SelectPropertyRows<NodeType>(node.id(), &properties_record_set));
+    TF_RETURN_IF_ERROR(
+        ParsePropertiesRecordSet(properties_record_set, &stored_rows));
+  } else {
+    stored_rows.Swap(&stored_node);
+  }
+
   // modify properties
+  if (pack_properties_) {
+    const google::protobuf::Map<std::string, Value> no_custom_properties;
+    TF_RETURN_IF_ERROR(ModifyProperties<NodeType>(
+        IndexedPropertiesOf(node, stored_type), stored_rows.properties(),
+        node.id(), /*is_custom_property=*/false));
+    return ModifyProperties<NodeType>(no_custom_properties,
+                                      stored_rows.custom_properties(),
+                                      node.id(), /*is_custom_property=*/true);
+  }
   TF_RETURN_IF_ERROR(ModifyProperties<NodeType>(
-      node.properties(), stored_node.properties(), node.id(),
+      node.properties(), stored_rows.properties(), node.id(),
       /*is_custom_property=*/false));
   TF_RETURN_IF_ERROR(ModifyProperties<NodeType>(
-      node.custom_properties(), stored_node.custom_properties(), node.id(),
+      node.custom_properties(), stored_rows.custom_properties(), node.id(),
       /*is_custom_property=*/true));
   return tensorflow::Status::OK();
 }
@@ -752,32 +1324,38 @@ tensorflow::Status RDBMSMetadataAccessObject::FindEventsFromRecordSet(
     const RecordSet& event_record_set, std::vector<Event>* events) {
   if (events == nullptr)
     return tensorflow::errors::InvalidArgument("Given events is NULL.");
+  if (event_record_set.records_size() == 0) return tensorflow::Status::OK();
 
-  events->reserve(event_record_set.records_size());
+  const size_t first_event = events->size();
   TF_RETURN_IF_ERROR(ParseRecordSetToMessageArray(event_record_set, events));
+  // event id -> the index of the event in `events`.
+  std::map<int64, size_t> event_indexes;
+  std::vector<int64> event_ids;
+  event_ids.reserve(event_record_set.records_size());
+  for (int i = 0; i < event_record_set.records_size(); ++i) {
+    int64 event_id;
+    CHECK(absl::SimpleAtoi(event_record_set.records(i).values(0), &event_id));
+    event_indexes[event_id] = first_event + i;
+    event_ids.push_back(event_id);
+  }
+  RecordSet path_record_set;
+  TF_RETURN_IF_ERROR(
+      executor_->SelectEventPathsByEventIDs(event_ids, &path_record_set));
 
-  for (int i = 0; i < events->size(); ++i) {
-    CHECK_LT(i, event_record_set.records_size());
-    const RecordSet::Record& record = event_record_set.records()[i];
-    Event& event = (*events)[i];
+  // TODO(martinz): How do we know that these paths will be in the right
+  // order?
+  for (const RecordSet::Record& record : path_record_set.records()) {
     int64 event_id;
     CHECK(absl::SimpleAtoi(record.values(0), &event_id));
-    RecordSet path_record_set;
-    TF_RETURN_IF_ERROR(
-        executor_->SelectEventPathByEventID(event_id, &path_record_set));
-
-    // TODO(martinz): How do we know that these paths will be in the right
-    // order?
-    for (const RecordSet::Record& record : path_record_set.records()) {
-      bool is_index_step;
-      CHECK(absl::SimpleAtob(record.values(1), &is_index_step));
-      if (is_index_step) {
-        int64 step_index;
-        CHECK(absl::SimpleAtoi(record.values(2), &step_index));
-        event.mutable_path()->add_steps()->set_index(step_index);
-      } else {
-        event.mutable_path()->add_steps()->set_key(record.values(3));
-      }
+    Event& event = (*events)[event_indexes.at(event_id)];
+    bool is_index_step;
+    CHECK(absl::SimpleAtob(record.values(1), &is_index_step));
+    if (is_index_step) {
+      int64 step_index;
+      CHECK(absl::SimpleAtoi(record.values(2), &step_index));
+      event.mutable_path()->add_steps()->set_index(step_index);
+    } else {
+      event.mutable_path()->add_steps()->set_key(record.values(3));
     }
   }
   return tensorflow::Status::OK();
@@ -806,6 +1384,7 @@ tensorflow::Status RDBMSMetadataAccessObject::FindContextsByNodeImpl(
   }
 
   contexts->clear();
+  contexts->reserve(node_ids.records_size());
   for (const RecordSet::Record& record : node_ids.records()) {
     contexts->push_back(Context());
     Context& curr_context = contexts->back();
@@ -817,6 +1396,101 @@ tensorflow::Status RDBMSMetadataAccessObject::FindContextsByNodeImpl(
   return tensorflow::Status::OK();
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::CheckNodeIDsExist(
+    const TypeKind node_kind, const std::vector<int64>& node_ids) {
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(
+      executor_->SelectExistingNodeIDs(node_kind, node_ids, &record_set));
+  if (static_cast<size_t>(record_set.records_size()) == node_ids.size()) {
+    return tensorflow::Status::OK();
+  }
+  std::set<int64> found_node_ids;
+  for (const RecordSet::Record& record : record_set.records()) {
+    int64 node_id;
+    CHECK(absl::SimpleAtoi(record.values(0), &node_id));
+    found_node_ids.insert(node_id);
+  }
+  std::string node_name;
+  switch (node_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      node_name = "Artifact";
+      break;
+    case TypeKind::EXECUTION_TYPE:
+      node_name = "Execution";
+      break;
+    default:
+      node_name = "Context";
+  }
+  for (const int64 node_id : node_ids) {
+    if (found_node_ids.count(node_id) == 0) {
+      return tensorflow::errors::InvalidArgument(node_name,
+                                                 " id not found: ", node_id);
+    }
+  }
+  return tensorflow::Status::OK();
+}
+
+template <typename Node>
+tensorflow::Status RDBMSMetadataAccessObject::CreateContextEdgesIfNotExistImpl(
+    const std::vector<std::pair<int64, int64>>& edges,
+    std::vector<std::pair<int64, int64>>* created_edges) {
+  if (edges.empty()) return tensorflow::Status::OK();
+  constexpr bool is_artifact = std::is_same<Node, Artifact>::value;
+
+  std::set<int64> context_id_set;
+  std::set<int64> node_id_set;
+  for (const std::pair<int64, int64>& edge : edges) {
+    context_id_set.insert(edge.first);
+    node_id_set.insert(edge.second);
+  }
+  const std::vector<int64> context_ids(context_id_set.begin(),
+                                       context_id_set.end());
+  const std::vector<int64> node_ids(node_id_set.begin(), node_id_set.end());
+  TF_RETURN_IF_ERROR(CheckNodeIDsExist(TypeKind::CONTEXT_TYPE, context_ids));
+  TF_RETURN_IF_ERROR(CheckNodeIDsExist(
+      is_artifact ? TypeKind::ARTIFACT_TYPE : TypeKind::EXECUTION_TYPE,
+      node_ids));
+
+  // the existing edges among the contexts and the nodes are skipped, as well
+  // as the repeated ones.
+  RecordSet record_set;
+  if (is_artifact) {
+    TF_RETURN_IF_ERROR(executor_->SelectAttributionsByContextIDsAndArtifactIDs(
+        context_ids, node_ids, &record_set));
+  } else {
+    TF_RETURN_IF_ERROR(
+        executor_->SelectAssociationsByContextIDsAndExecutionIDs(
+            context_ids, node_ids, &record_set));
+  }
+  std::set<std::pair<int64, int64>> skipped_edges;
+  for (const RecordSet::Record& record : record_set.records()) {
+    std::pair<int64, int64> edge;
+    CHECK(absl::SimpleAtoi(record.values(1), &edge.first));
+    CHECK(absl::SimpleAtoi(record.values(2), &edge.second));
+    skipped_edges.insert(edge);
+  }
+  std::vector<std::pair<int64, int64>> new_edges;
+  for (const std::pair<int64, int64>& edge : edges) {
+    if (skipped_edges.insert(edge).second) new_edges.push_back(edge);
+  }
+
+  for (size_t begin = 0; begin < new_edges.size();
+       begin += kMaxNumRowsPerInsert) {
+    const std::vector<std::pair<int64, int64>> chunk(
+        new_edges.begin() + begin,
+        new_edges.begin() +
+            std::min(new_edges.size(), begin + kMaxNumRowsPerInsert));
+    if (is_artifact) {
+      TF_RETURN_IF_ERROR(executor_->InsertAttributions(chunk));
+    } else {
+      TF_RETURN_IF_ERROR(executor_->InsertAssociations(chunk));
+    }
+  }
+  created_edges->insert(created_edges->end(), new_edges.begin(),
+                        new_edges.end());
+  return tensorflow::Status::OK();
+}
+
 // Queries nodes related to a context. Node is either `Artifact` or `Execution`.
 // Returns INVALID_ARGUMENT error, if the `nodes` is null.
 template <typename Node>
@@ -838,6 +1512,7 @@ tensorflow::Status RDBMSMetadataAccessObject::FindNodesByContextImpl(
   }
 
   nodes->clear();
+  nodes->reserve(record_set.records_size());
   for (const RecordSet::Record& record : record_set.records()) {
     nodes->push_back(Node());
     Node& curr_node = nodes->back();
@@ -911,17 +1586,32 @@ tensorflow::Status RDBMSMetadataAccessObject::FindTypeByName(
 
 tensorflow::Status RDBMSMetadataAccessObject::UpdateType(
     const ArtifactType& type) {
-  return UpdateTypeImpl(type);
+  return UpdateTypeImpl<Artifact>(type);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::UpdateType(
     const ExecutionType& type) {
-  return UpdateTypeImpl(type);
+  return UpdateTypeImpl<Execution>(type);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::UpdateType(
     const ContextType& type) {
-  return UpdateTypeImpl(type);
+  return UpdateTypeImpl<Context>(type);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::CreatePropertyIndexes(
+    const ArtifactType& type) {
+  return CreatePropertyIndexesImpl(type);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::CreatePropertyIndexes(
+    const ExecutionType& type) {
+  return CreatePropertyIndexesImpl(type);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::CreatePropertyIndexes(
+    const ContextType& type) {
+  return CreatePropertyIndexesImpl(type);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::CreateArtifact(
@@ -929,11 +1619,22 @@ tensorflow::Status RDBMSMetadataAccessObject::CreateArtifact(
   return CreateNodeImpl<Artifact, ArtifactType>(artifact, artifact_id);
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::CreateArtifacts(
+    const std::vector<Artifact>& artifacts, std::vector<int64>* artifact_ids) {
+  return CreateNodesImpl<Artifact, ArtifactType>(artifacts, artifact_ids);
+}
+
 tensorflow::Status RDBMSMetadataAccessObject::CreateExecution(
     const Execution& execution, int64* execution_id) {
   return CreateNodeImpl<Execution, ExecutionType>(execution, execution_id);
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::CreateExecutions(
+    const std::vector<Execution>& executions,
+    std::vector<int64>* execution_ids) {
+  return CreateNodesImpl<Execution, ExecutionType>(executions, execution_ids);
+}
+
 tensorflow::Status RDBMSMetadataAccessObject::CreateContext(
     const Context& context, int64* context_id) {
   tensorflow::Status status =
@@ -947,18 +1648,32 @@ tensorflow::Status RDBMSMetadataAccessObject::CreateContext(
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::FindArtifactById(
-    const int64 artifact_id, Artifact* artifact) {
-  return FindNodeImpl(artifact_id, artifact);
+    const int64 artifact_id, Artifact* artifact,
+    const NodeReadMask* read_mask) {
+  if (read_mask == nullptr) return FindNodeImpl(artifact_id, artifact);
+  ParsedNodeReadMask parsed_read_mask;
+  TF_RETURN_IF_ERROR(
+      ParsedNodeReadMask::Parse<Artifact>(*read_mask, &parsed_read_mask));
+  return FindNodeImpl(artifact_id, artifact, &parsed_read_mask);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::FindExecutionById(
-    const int64 execution_id, Execution* execution) {
-  return FindNodeImpl(execution_id, execution);
+    const int64 execution_id, Execution* execution,
+    const NodeReadMask* read_mask) {
+  if (read_mask == nullptr) return FindNodeImpl(execution_id, execution);
+  ParsedNodeReadMask parsed_read_mask;
+  TF_RETURN_IF_ERROR(
+      ParsedNodeReadMask::Parse<Execution>(*read_mask, &parsed_read_mask));
+  return FindNodeImpl(execution_id, execution, &parsed_read_mask);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::FindContextById(
-    const int64 context_id, Context* context) {
-  return FindNodeImpl(context_id, context);
+    const int64 context_id, Context* context, const NodeReadMask* read_mask) {
+  if (read_mask == nullptr) return FindNodeImpl(context_id, context);
+  ParsedNodeReadMask parsed_read_mask;
+  TF_RETURN_IF_ERROR(
+      ParsedNodeReadMask::Parse<Context>(*read_mask, &parsed_read_mask));
+  return FindNodeImpl(context_id, context, &parsed_read_mask);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::UpdateArtifact(
@@ -976,6 +1691,54 @@ tensorflow::Status RDBMSMetadataAccessObject::UpdateContext(
   return UpdateNodeImpl<Context, ContextType>(context);
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::DeleteNodesImpl(
+    const TypeKind node_kind, const std::vector<int64>& node_ids,
+    const bool dry_run, std::map<std::string, int64>* num_deleted_rows) {
+  if (num_deleted_rows == nullptr)
+    return tensorflow::errors::InvalidArgument("Given counts is NULL.");
+  if (node_ids.empty()) return tensorflow::Status::OK();
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(
+      executor_->CountRowsOfNodeDeletion(node_kind, node_ids, &record_set));
+  if (record_set.records_size() != 1 ||
+      record_set.records(0).values_size() !=
+          record_set.column_names_size()) {
+    return tensorflow::errors::Internal("Malformed deletion counts: ",
+                                        record_set.DebugString());
+  }
+  for (int i = 0; i < record_set.column_names_size(); ++i) {
+    int64 num_rows;
+    if (!absl::SimpleAtoi(record_set.records(0).values(i), &num_rows)) {
+      return tensorflow::errors::Internal("Malformed deletion counts: ",
+                                          record_set.DebugString());
+    }
+    (*num_deleted_rows)[record_set.column_names(i)] += num_rows;
+  }
+  if (dry_run) return tensorflow::Status::OK();
+  return executor_->DeleteNodes(node_kind, node_ids);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::DeleteArtifacts(
+    const std::vector<int64>& artifact_ids, const bool dry_run,
+    std::map<std::string, int64>* num_deleted_rows) {
+  return DeleteNodesImpl(TypeKind::ARTIFACT_TYPE, artifact_ids, dry_run,
+                         num_deleted_rows);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::DeleteExecutions(
+    const std::vector<int64>& execution_ids, const bool dry_run,
+    std::map<std::string, int64>* num_deleted_rows) {
+  return DeleteNodesImpl(TypeKind::EXECUTION_TYPE, execution_ids, dry_run,
+                         num_deleted_rows);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::DeleteContexts(
+    const std::vector<int64>& context_ids, const bool dry_run,
+    std::map<std::string, int64>* num_deleted_rows) {
+  return DeleteNodesImpl(TypeKind::CONTEXT_TYPE, context_ids, dry_run,
+                         num_deleted_rows);
+}
+
 tensorflow::Status RDBMSMetadataAccessObject::CreateEvent(const Event& event,
 
                                                           int64* event_id) {
@@ -1016,6 +1779,70 @@ tensorflow::Status RDBMSMetadataAccessObject::CreateEvent(const Event& event,
   return tensorflow::Status::OK();
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::CreateEvents(
+    const std::vector<Event>& events) {
+  if (events.empty()) return tensorflow::Status::OK();
+  // validate the given events
+  std::set<int64> artifact_id_set;
+  std::set<int64> execution_id_set;
+  for (const Event& event : events) {
+    if (!event.has_artifact_id())
+      return tensorflow::errors::InvalidArgument(
+          "No artifact id is specified.");
+    if (!event.has_execution_id())
+      return tensorflow::errors::InvalidArgument(
+          "No execution id is specified.");
+    if (!event.has_type() || event.type() == Event::UNKNOWN)
+      return tensorflow::errors::InvalidArgument("No event type is specified.");
+    artifact_id_set.insert(event.artifact_id());
+    execution_id_set.insert(event.execution_id());
+  }
+  TF_RETURN_IF_ERROR(CheckNodeIDsExist(
+      TypeKind::ARTIFACT_TYPE,
+      std::vector<int64>(artifact_id_set.begin(), artifact_id_set.end())));
+  TF_RETURN_IF_ERROR(CheckNodeIDsExist(
+      TypeKind::EXECUTION_TYPE,
+      std::vector<int64>(execution_id_set.begin(), execution_id_set.end())));
+
+  const int64 event_time = absl::ToUnixMillis(absl::Now());
+  std::vector<Event> rows;
+  rows.reserve(events.size());
+  for (const Event& event : events) {
+    rows.push_back(Event());
+    Event& row = rows.back();
+    row.set_artifact_id(event.artifact_id());
+    row.set_execution_id(event.execution_id());
+    row.set_type(event.type());
+    row.set_milliseconds_since_epoch(event.has_milliseconds_since_epoch()
+                                         ? event.milliseconds_since_epoch()
+                                         : event_time);
+  }
+
+  // the events of a chunk are inserted by one statement where the backend
+  // allows it, and their paths are inserted with the ids they get.
+  std::vector<std::pair<int64, Event::Path::Step>> steps;
+  for (size_t begin = 0; begin < rows.size(); begin += kMaxNumRowsPerInsert) {
+    const size_t end = std::min(rows.size(), begin + kMaxNumRowsPerInsert);
+    const std::vector<Event> chunk(rows.begin() + begin, rows.begin() + end);
+    std::vector<int64> event_ids;
+    TF_RETURN_IF_ERROR(executor_->InsertEvents(chunk, &event_ids));
+    for (size_t i = begin; i < end; ++i) {
+      for (const Event::Path::Step& step : events[i].path().steps()) {
+        if (step.has_index() || step.has_key()) {
+          steps.emplace_back(event_ids[i - begin], step);
+        }
+      }
+    }
+  }
+  for (size_t begin = 0; begin < steps.size(); begin += kMaxNumRowsPerInsert) {
+    const std::vector<std::pair<int64, Event::Path::Step>> chunk(
+        steps.begin() + begin,
+        steps.begin() + std::min(steps.size(), begin + kMaxNumRowsPerInsert));
+    TF_RETURN_IF_ERROR(executor_->InsertEventPaths(chunk));
+  }
+  return tensorflow::Status::OK();
+}
+
 tensorflow::Status RDBMSMetadataAccessObject::FindEventsByArtifact(
     const int64 artifact_id, std::vector<Event>* events) {
   RecordSet event_record_set;
@@ -1040,6 +1867,27 @@ tensorflow::Status RDBMSMetadataAccessObject::FindEventsByExecution(
   return FindEventsFromRecordSet(event_record_set, events);
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::FindEventsByExecutions(
+    const std::vector<int64>& execution_ids, std::vector<Event>* events) {
+  if (events == nullptr)
+    return tensorflow::errors::InvalidArgument("Given events is NULL.");
+  if (execution_ids.empty()) return tensorflow::Status::OK();
+  RecordSet event_record_set;
+  TF_RETURN_IF_ERROR(executor_->SelectEventsByExecutionIDs(execution_ids,
+                                                           &event_record_set));
+  return FindEventsFromRecordSet(event_record_set, events);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::FindEventEdges(
+    std::vector<Event>* events) {
+  if (events == nullptr)
+    return tensorflow::errors::InvalidArgument("Given events is NULL.");
+  RecordSet event_record_set;
+  TF_RETURN_IF_ERROR(executor_->SelectAllEventEdges(&event_record_set));
+  events->reserve(event_record_set.records_size());
+  return ParseRecordSetToMessageArray(event_record_set, events);
+}
+
 tensorflow::Status RDBMSMetadataAccessObject::CreateAssociation(
     const Association& association, int64* association_id) {
   if (!association.has_context_id())
@@ -1070,6 +1918,31 @@ tensorflow::Status RDBMSMetadataAccessObject::CreateAssociation(
   return status;
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::CreateAssociationsIfNotExist(
+    const std::vector<Association>& associations,
+    std::vector<Association>* created_associations) {
+  std::vector<std::pair<int64, int64>> edges;
+  edges.reserve(associations.size());
+  for (const Association& association : associations) {
+    if (!association.has_context_id())
+      return tensorflow::errors::InvalidArgument("No context id is specified.");
+    if (!association.has_execution_id())
+      return tensorflow::errors::InvalidArgument(
+          "No execution id is specified");
+    edges.emplace_back(association.context_id(), association.execution_id());
+  }
+  std::vector<std::pair<int64, int64>> created_edges;
+  TF_RETURN_IF_ERROR(
+      CreateContextEdgesIfNotExistImpl<Execution>(edges, &created_edges));
+  for (const std::pair<int64, int64>& edge : created_edges) {
+    Association association;
+    association.set_context_id(edge.first);
+    association.set_execution_id(edge.second);
+    created_associations->push_back(association);
+  }
+  return tensorflow::Status::OK();
+}
+
 tensorflow::Status RDBMSMetadataAccessObject::FindContextsByExecution(
     int64 execution_id, std::vector<Context>* contexts) {
   return FindContextsByNodeImpl<Execution>(execution_id, contexts);
@@ -1080,6 +1953,18 @@ tensorflow::Status RDBMSMetadataAccessObject::FindExecutionsByContext(
   return FindNodesByContextImpl(context_id, executions);
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::FindAssociationsByExecutions(
+    const std::vector<int64>& execution_ids,
+    std::vector<Association>* associations) {
+  if (associations == nullptr)
+    return tensorflow::errors::InvalidArgument("Given associations is NULL.");
+  if (execution_ids.empty()) return tensorflow::Status::OK();
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(
+      executor_->SelectAssociationsByExecutionIDs(execution_ids, &record_set));
+  return ParseRecordSetToMessageArray(record_set, associations);
+}
+
 tensorflow::Status RDBMSMetadataAccessObject::CreateAttribution(
     const Attribution& attribution, int64* attribution_id) {
   if (!attribution.has_context_id())
@@ -1110,6 +1995,30 @@ tensorflow::Status RDBMSMetadataAccessObject::CreateAttribution(
   return status;
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::CreateAttributionsIfNotExist(
+    const std::vector<Attribution>& attributions,
+    std::vector<Attribution>* created_attributions) {
+  std::vector<std::pair<int64, int64>> edges;
+  edges.reserve(attributions.size());
+  for (const Attribution& attribution : attributions) {
+    if (!attribution.has_context_id())
+      return tensorflow::errors::InvalidArgument("No context id is specified.");
+    if (!attribution.has_artifact_id())
+      return tensorflow::errors::InvalidArgument("No artifact id is specified");
+    edges.emplace_back(attribution.context_id(), attribution.artifact_id());
+  }
+  std::vector<std::pair<int64, int64>> created_edges;
+  TF_RETURN_IF_ERROR(
+      CreateContextEdgesIfNotExistImpl<Artifact>(edges, &created_edges));
+  for (const std::pair<int64, int64>& edge : created_edges) {
+    Attribution attribution;
+    attribution.set_context_id(edge.first);
+    attribution.set_artifact_id(edge.second);
+    created_attributions->push_back(attribution);
+  }
+  return tensorflow::Status::OK();
+}
+
 tensorflow::Status RDBMSMetadataAccessObject::FindContextsByArtifact(
     int64 artifact_id, std::vector<Context>* contexts) {
   return FindContextsByNodeImpl<Artifact>(artifact_id, contexts);
@@ -1120,53 +2029,180 @@ tensorflow::Status RDBMSMetadataAccessObject::FindArtifactsByContext(
   return FindNodesByContextImpl(context_id, artifacts);
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::FindAttributionsByArtifacts(
+    const std::vector<int64>& artifact_ids,
+    std::vector<Attribution>* attributions) {
+  if (attributions == nullptr)
+    return tensorflow::errors::InvalidArgument("Given attributions is NULL.");
+  if (artifact_ids.empty()) return tensorflow::Status::OK();
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(
+      executor_->SelectAttributionsByArtifactIDs(artifact_ids, &record_set));
+  return ParseRecordSetToMessageArray(record_set, attributions);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::InitChangeLog(
+    const int64 new_log_id, int64* log_id, int64* last_sequence) {
+  TF_RETURN_IF_ERROR(executor_->CreateChangeLogTable());
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(executor_->SelectChangeLog(&record_set));
+  bool found = false;
+  TF_RETURN_IF_ERROR(
+      ParseChangeLog(record_set, &found, log_id, last_sequence));
+  if (found) return tensorflow::Status::OK();
+  TF_RETURN_IF_ERROR(executor_->InsertChangeLog(new_log_id));
+  *log_id = new_log_id;
+  *last_sequence = 0;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::AdvanceChangeLog(
+    const int64 num_changes, int64* last_sequence) {
+  TF_RETURN_IF_ERROR(executor_->AdvanceChangeLog(num_changes));
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(executor_->SelectChangeLog(&record_set));
+  bool found = false;
+  int64 log_id = 0;
+  TF_RETURN_IF_ERROR(
+      ParseChangeLog(record_set, &found, &log_id, last_sequence));
+  if (!found) {
+    return tensorflow::errors::DataLoss("The change log does not exist.");
+  }
+  return tensorflow::Status::OK();
+}
+
 tensorflow::Status RDBMSMetadataAccessObject::FindArtifacts(
-    std::vector<Artifact>* artifacts) {
+    std::vector<Artifact>* artifacts, const NodeReadMask* read_mask) {
   RecordSet record_set;
   TF_RETURN_IF_ERROR(executor_->SelectAllArtifactIDs(&record_set));
-  return FindManyNodesImpl(record_set, artifacts);
+  return FindManyNodesImpl(record_set, artifacts, read_mask);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::FindArtifactsByTypeId(
-    const int64 type_id, std::vector<Artifact>* artifacts) {
+    const int64 type_id, std::vector<Artifact>* artifacts,
+    const NodeReadMask* read_mask) {
   RecordSet record_set;
   TF_RETURN_IF_ERROR(executor_->SelectArtifactsByTypeID(type_id, &record_set));
-  return FindManyNodesImpl(record_set, artifacts);
+  return FindManyNodesImpl(record_set, artifacts, read_mask);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::FindExecutions(
-    std::vector<Execution>* executions) {
+    std::vector<Execution>* executions, const NodeReadMask* read_mask) {
   RecordSet record_set;
   TF_RETURN_IF_ERROR(executor_->SelectAllExecutionIDs(&record_set));
-  return FindManyNodesImpl(record_set, executions);
+  return FindManyNodesImpl(record_set, executions, read_mask);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::FindExecutionsByTypeId(
-    const int64 type_id, std::vector<Execution>* executions) {
+    const int64 type_id, std::vector<Execution>* executions,
+    const NodeReadMask* read_mask) {
   RecordSet record_set;
   TF_RETURN_IF_ERROR(executor_->SelectExecutionsByTypeID(type_id, &record_set));
-  return FindManyNodesImpl(record_set, executions);
+  return FindManyNodesImpl(record_set, executions, read_mask);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::FindExecutionsByTypeIdAndNames(
+    const int64 type_id, const std::vector<std::string>& names,
+    std::vector<Execution>* executions, const NodeReadMask* read_mask) {
+  if (names.empty())
+    return tensorflow::errors::NotFound("Cannot find any record");
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(
+      executor_->SelectExecutionsByTypeIDAndNames(type_id, names, &record_set));
+  return FindManyNodesImpl(record_set, executions, read_mask);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::FindContexts(
-    std::vector<Context>* contexts) {
+    std::vector<Context>* contexts, const NodeReadMask* read_mask) {
   RecordSet record_set;
   TF_RETURN_IF_ERROR(executor_->SelectAllContextIDs(&record_set));
-  return FindManyNodesImpl(record_set, contexts);
+  return FindManyNodesImpl(record_set, contexts, read_mask);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::FindContextsByTypeId(
-    const int64 type_id, std::vector<Context>* contexts) {
+    const int64 type_id, std::vector<Context>* contexts,
+    const NodeReadMask* read_mask) {
   RecordSet record_set;
   TF_RETURN_IF_ERROR(executor_->SelectContextsByTypeID(type_id, &record_set));
-  return FindManyNodesImpl(record_set, contexts);
+  return FindManyNodesImpl(record_set, contexts, read_mask);
 }
 
 tensorflow::Status RDBMSMetadataAccessObject::FindArtifactsByURI(
-    const absl::string_view uri, std::vector<Artifact>* artifacts) {
+    const absl::string_view uri, std::vector<Artifact>* artifacts,
+    const NodeReadMask* read_mask) {
   RecordSet record_set;
   TF_RETURN_IF_ERROR(executor_->SelectArtifactsByURI(uri, &record_set));
-  return FindManyNodesImpl(record_set, artifacts);
+  return FindManyNodesImpl(record_set, artifacts, read_mask);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::FindArtifactsByTypeIdAndNames(
+    const int64 type_id, const std::vector<std::string>& names,
+    std::vector<Artifact>* artifacts, const NodeReadMask* read_mask) {
+  // An empty IN list is not valid in all the SQL dialects.
+  if (names.empty())
+    return tensorflow::errors::NotFound("Cannot find any record");
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(
+      executor_->SelectArtifactsByTypeIDAndNames(type_id, names, &record_set));
+  return FindManyNodesImpl(record_set, artifacts, read_mask);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::FindArtifactsByFilter(
+    const NodeFilter& filter, std::vector<Artifact>* artifacts,
+    const NodeReadMask* read_mask) {
+  TF_RETURN_IF_ERROR(CheckFilterIsIndexed<ArtifactType>(filter));
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(executor_->SelectArtifactIDsByFilter(filter, &record_set));
+  return FindManyNodesImpl(record_set, artifacts, read_mask);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::CountArtifacts(
+    const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+    std::vector<NodeCount>* counts) {
+  TF_RETURN_IF_ERROR(CheckFilterIsIndexed<ArtifactType>(filter));
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(executor_->CountNodesByFilter(
+      TypeKind::ARTIFACT_TYPE, filter, group_by, &record_set));
+  return ParseNodeCounts(record_set, group_by, counts);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::FindExecutionsByFilter(
+    const NodeFilter& filter, std::vector<Execution>* executions,
+    const NodeReadMask* read_mask) {
+  TF_RETURN_IF_ERROR(CheckFilterIsIndexed<ExecutionType>(filter));
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(
+      executor_->SelectExecutionIDsByFilter(filter, &record_set));
+  return FindManyNodesImpl(record_set, executions, read_mask);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::CountExecutions(
+    const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+    std::vector<NodeCount>* counts) {
+  TF_RETURN_IF_ERROR(CheckFilterIsIndexed<ExecutionType>(filter));
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(executor_->CountNodesByFilter(
+      TypeKind::EXECUTION_TYPE, filter, group_by, &record_set));
+  return ParseNodeCounts(record_set, group_by, counts);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::FindContextsByFilter(
+    const NodeFilter& filter, std::vector<Context>* contexts,
+    const NodeReadMask* read_mask) {
+  TF_RETURN_IF_ERROR(CheckFilterIsIndexed<ContextType>(filter));
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(executor_->SelectContextIDsByFilter(filter, &record_set));
+  return FindManyNodesImpl(record_set, contexts, read_mask);
+}
+
+tensorflow::Status RDBMSMetadataAccessObject::CountContexts(
+    const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+    std::vector<NodeCount>* counts) {
+  TF_RETURN_IF_ERROR(CheckFilterIsIndexed<ContextType>(filter));
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(executor_->CountNodesByFilter(
+      TypeKind::CONTEXT_TYPE, filter, group_by, &record_set));
+  return ParseNodeCounts(record_set, group_by, counts);
 }
 
 
@@ -1190,4 +2226,15 @@ tensorflow::Status RDBMSMetadataAccessObject::FindContextByTypeIdAndName(
   return tensorflow::Status::OK();
 }
 
+tensorflow::Status RDBMSMetadataAccessObject::FindContextsByTypeIdAndNames(
+    const int64 type_id, const std::vector<std::string>& names,
+    std::vector<Context>* contexts, const NodeReadMask* read_mask) {
+  if (names.empty())
+    return tensorflow::errors::NotFound("Cannot find any record");
+  RecordSet record_set;
+  TF_RETURN_IF_ERROR(
+      executor_->SelectContextsByTypeIDAndNames(type_id, names, &record_set));
+  return FindManyNodesImpl(record_set, contexts, read_mask);
+}
+
 }  // namespace ml_metadata
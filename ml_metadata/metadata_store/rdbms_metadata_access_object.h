@@ -15,11 +15,16 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_RDBMS_METADATA_ACCESS_OBJECT_H_
 #define ML_METADATA_METADATA_STORE_RDBMS_METADATA_ACCESS_OBJECT_H_
 
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/node_read_mask.h"
 #include "ml_metadata/metadata_store/query_executor.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
@@ -39,9 +44,11 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
  public:
   virtual ~RDBMSMetadataAccessObject() = default;
 
-  // default & copy constructors are disallowed.
-  RDBMSMetadataAccessObject(std::unique_ptr<QueryExecutor> executor)
-      : executor_(std::move(executor)) {}
+  // If `pack_properties`, the properties of the created and updated nodes are
+  // packed into their node rows. See MetadataSourceQueryConfig.
+  RDBMSMetadataAccessObject(std::unique_ptr<QueryExecutor> executor,
+                            bool pack_properties = false)
+      : executor_(std::move(executor)), pack_properties_(pack_properties) {}
 
   // default & copy constructors are disallowed.
   RDBMSMetadataAccessObject() = delete;
@@ -88,6 +95,10 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   tensorflow::Status UpdateType(const ExecutionType& type) final;
   tensorflow::Status UpdateType(const ContextType& type) final;
 
+  tensorflow::Status CreatePropertyIndexes(const ArtifactType& type) final;
+  tensorflow::Status CreatePropertyIndexes(const ExecutionType& type) final;
+  tensorflow::Status CreatePropertyIndexes(const ContextType& type) final;
+
   tensorflow::Status FindTypeById(int64 type_id,
                                   ArtifactType* artifact_type) final;
   tensorflow::Status FindTypeById(int64 type_id,
@@ -110,73 +121,174 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   tensorflow::Status CreateArtifact(const Artifact& artifact,
                                     int64* artifact_id) final;
 
-  tensorflow::Status FindArtifactById(int64 artifact_id,
-                                      Artifact* artifact) final;
+  tensorflow::Status CreateArtifacts(const std::vector<Artifact>& artifacts,
+                                     std::vector<int64>* artifact_ids) final;
 
-  tensorflow::Status FindArtifacts(std::vector<Artifact>* artifacts) final;
+  tensorflow::Status FindArtifactById(
+      int64 artifact_id, Artifact* artifact,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindArtifacts(
+      std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) final;
 
   tensorflow::Status FindArtifactsByTypeId(
-      int64 artifact_type_id, std::vector<Artifact>* artifacts) final;
+      int64 artifact_type_id, std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindArtifactsByURI(
+      absl::string_view uri, std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) final;
 
-  tensorflow::Status FindArtifactsByURI(absl::string_view uri,
-                                        std::vector<Artifact>* artifacts) final;
+  tensorflow::Status FindArtifactsByTypeIdAndNames(
+      int64 type_id, const std::vector<std::string>& names,
+      std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindArtifactsByFilter(
+      const NodeFilter& filter, std::vector<Artifact>* artifacts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status CountArtifacts(
+      const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+      std::vector<NodeCount>* counts) final;
 
   tensorflow::Status UpdateArtifact(const Artifact& artifact) final;
 
+  tensorflow::Status DeleteArtifacts(
+      const std::vector<int64>& artifact_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows) final;
+
   tensorflow::Status CreateExecution(const Execution& execution,
                                      int64* execution_id) final;
 
-  tensorflow::Status FindExecutionById(int64 execution_id,
-                                       Execution* execution) final;
+  tensorflow::Status CreateExecutions(const std::vector<Execution>& executions,
+                                      std::vector<int64>* execution_ids) final;
 
-  tensorflow::Status FindExecutions(std::vector<Execution>* executions) final;
+  tensorflow::Status FindExecutionById(
+      int64 execution_id, Execution* execution,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindExecutions(
+      std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) final;
 
   tensorflow::Status FindExecutionsByTypeId(
-      int64 execution_type_id, std::vector<Execution>* executions) final;
+      int64 execution_type_id, std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindExecutionsByTypeIdAndNames(
+      int64 type_id, const std::vector<std::string>& names,
+      std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindExecutionsByFilter(
+      const NodeFilter& filter, std::vector<Execution>* executions,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status CountExecutions(
+      const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+      std::vector<NodeCount>* counts) final;
 
   tensorflow::Status UpdateExecution(const Execution& execution) final;
 
+  tensorflow::Status DeleteExecutions(
+      const std::vector<int64>& execution_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows) final;
+
   tensorflow::Status CreateContext(const Context& context,
                                    int64* context_id) final;
 
-  tensorflow::Status FindContextById(int64 context_id, Context* context) final;
+  tensorflow::Status FindContextById(
+      int64 context_id, Context* context,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindContexts(
+      std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) final;
+
+  tensorflow::Status FindContextsByTypeId(
+      int64 context_type_id, std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) final;
 
-  tensorflow::Status FindContexts(std::vector<Context>* contexts) final;
+  tensorflow::Status FindContextsByFilter(
+      const NodeFilter& filter, std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) final;
 
-  tensorflow::Status FindContextsByTypeId(int64 context_type_id,
-                                          std::vector<Context>* contexts) final;
+  tensorflow::Status CountContexts(
+      const NodeFilter& filter, const std::vector<NodeCount::GroupBy>& group_by,
+      std::vector<NodeCount>* counts) final;
 
   tensorflow::Status FindContextByTypeIdAndName(
       int64 type_id, absl::string_view name, Context* context) final;
 
+  tensorflow::Status FindContextsByTypeIdAndNames(
+      int64 type_id, const std::vector<std::string>& names,
+      std::vector<Context>* contexts,
+      const NodeReadMask* read_mask = nullptr) final;
+
   tensorflow::Status UpdateContext(const Context& context) final;
 
+  tensorflow::Status DeleteContexts(
+      const std::vector<int64>& context_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows) final;
+
   tensorflow::Status CreateEvent(const Event& event, int64* event_id) final;
 
+  tensorflow::Status CreateEvents(const std::vector<Event>& events) final;
+
   tensorflow::Status FindEventsByArtifact(int64 artifact_id,
                                           std::vector<Event>* events) final;
 
   tensorflow::Status FindEventsByExecution(int64 execution_id,
                                            std::vector<Event>* events) final;
 
+  tensorflow::Status FindEventsByExecutions(
+      const std::vector<int64>& execution_ids,
+      std::vector<Event>* events) final;
+
+  tensorflow::Status FindEventEdges(std::vector<Event>* events) final;
+
   tensorflow::Status CreateAssociation(const Association& association,
                                        int64* association_id) final;
 
+  tensorflow::Status CreateAssociationsIfNotExist(
+      const std::vector<Association>& associations,
+      std::vector<Association>* created_associations) final;
+
   tensorflow::Status FindContextsByExecution(
       int64 execution_id, std::vector<Context>* contexts) final;
 
   tensorflow::Status FindExecutionsByContext(
       int64 context_id, std::vector<Execution>* executions) final;
 
+  tensorflow::Status FindAssociationsByExecutions(
+      const std::vector<int64>& execution_ids,
+      std::vector<Association>* associations) final;
+
   tensorflow::Status CreateAttribution(const Attribution& attribution,
                                        int64* attribution_id) final;
 
+  tensorflow::Status CreateAttributionsIfNotExist(
+      const std::vector<Attribution>& attributions,
+      std::vector<Attribution>* created_attributions) final;
+
   tensorflow::Status FindContextsByArtifact(
       int64 artifact_id, std::vector<Context>* contexts) final;
 
   tensorflow::Status FindArtifactsByContext(
       int64 context_id, std::vector<Artifact>* artifacts) final;
 
+  tensorflow::Status FindAttributionsByArtifacts(
+      const std::vector<int64>& artifact_ids,
+      std::vector<Attribution>* attributions) final;
+
+  tensorflow::Status InitChangeLog(int64 new_log_id, int64* log_id,
+                                   int64* last_sequence) final;
+
+  tensorflow::Status AdvanceChangeLog(int64 num_changes,
+                                      int64* last_sequence) final;
+
   tensorflow::Status GetSchemaVersion(int64* db_version) final {
     return executor_->GetSchemaVersion(db_version);
   }
@@ -195,17 +307,21 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Creates a Context (without properties).
   tensorflow::Status CreateBasicNode(const Context& context, int64* node_id);
 
-  // Lookup Artifact by id.
-  tensorflow::Status NodeLookups(const Artifact& artifact, RecordSet* header,
-                                 RecordSet* properties);
+  // Lookup Artifact by id. The properties are read as selected by the
+  // `read_mask`, if one is given.
+  tensorflow::Status NodeLookups(const Artifact& artifact,
+                                 const ParsedNodeReadMask* read_mask,
+                                 RecordSet* header, RecordSet* properties);
 
   // Generates a select queries for an Execution by id.
-  tensorflow::Status NodeLookups(const Execution& execution, RecordSet* header,
-                                 RecordSet* properties);
+  tensorflow::Status NodeLookups(const Execution& execution,
+                                 const ParsedNodeReadMask* read_mask,
+                                 RecordSet* header, RecordSet* properties);
 
   // Lookup Context by id.
-  tensorflow::Status NodeLookups(const Context& context, RecordSet* header,
-                                 RecordSet* properties);
+  tensorflow::Status NodeLookups(const Context& context,
+                                 const ParsedNodeReadMask* read_mask,
+                                 RecordSet* header, RecordSet* properties);
 
   // Update an Artifact's type_id and URI.
   tensorflow::Status RunNodeUpdate(const Artifact& artifact);
@@ -216,6 +332,17 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Update a Context's type id and name.
   tensorflow::Status RunNodeUpdate(const Context& context);
 
+  // Sets the packed properties of the `node` if the properties are packed, or
+  // none if they are stored as property rows.
+  // Returns INVALID_ARGUMENT error, if the properties cannot be packed.
+  template <typename Node>
+  tensorflow::Status PackedPropertiesOf(
+      const Node& node, absl::optional<std::string>* packed_properties);
+
+  // Queries the property rows of a node of a NodeType.
+  template <typename NodeType>
+  tensorflow::Status SelectPropertyRows(int64 node_id, RecordSet* record_set);
+
   // Runs a property insertion query for a NodeType.
   template <typename NodeType>
   tensorflow::Status InsertProperty(const int64 node_id,
@@ -223,6 +350,18 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
                                     const bool is_custom_property,
                                     const Value& value);
 
+  // Inserts the rows of the nodes of a NodeType, with one statement where the
+  // backend allows it, and sets `node_ids` to their ids in order.
+  template <typename NodeType>
+  tensorflow::Status InsertNodeRows(const std::vector<NodeRow>& rows,
+                                    std::vector<int64>* node_ids);
+
+  // Inserts the property rows of the nodes of a NodeType in bulk, with one
+  // statement per chunk of rows.
+  template <typename NodeType>
+  tensorflow::Status InsertProperties(
+      const std::vector<NodePropertyRow>& properties);
+
   // Generates a property update query for a NodeType.
   template <typename NodeType>
   tensorflow::Status UpdateProperty(const int64 node_id,
@@ -261,10 +400,25 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // ContextType}.
   // Returns INVALID_ARGUMENT error, if name field is not given.
   // Returns INVALID_ARGUMENT error, if any property type is unknown.
+  // Returns INVALID_ARGUMENT error, if any indexed property is not defined.
   // Returns detailed INTERNAL error, if query execution fails.
   template <typename Type>
   tensorflow::Status CreateTypeImpl(const Type& type, int64* type_id);
 
+  // Marks the `indexed_properties` of a stored type as indexed.
+  // `properties` are all the properties of the stored type.
+  // Returns INVALID_ARGUMENT error, if any indexed property is not defined.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Type>
+  tensorflow::Status IndexTypePropertiesImpl(
+      const Type& type, int64 type_id,
+      const google::protobuf::Map<std::string, PropertyType>& properties);
+
+  // Creates the property table indexes of the indexed properties of a stored
+  // type, if not exist yet.
+  template <typename Type>
+  tensorflow::Status CreatePropertyIndexesImpl(const Type& type);
+
   // Generates a query to find type by id
   tensorflow::Status RunFindTypeByID(const int64 condition,
                                      const TypeKind type_kind,
@@ -305,10 +459,34 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Returns INVALID_ARGUMENT error, if id field is given and is different.
   // Returns INVALID_ARGUMENT error, if any property type is unknown.
   // Returns ALREADY_EXISTS error, if any property type is different.
+  // Returns INVALID_ARGUMENT error, if any indexed property is not defined.
   // Returns detailed INTERNAL error, if query execution fails.
-  template <typename Type>
+  template <typename Node, typename Type>
   tensorflow::Status UpdateTypeImpl(const Type& type);
 
+  // Adds the property rows of the newly indexed `property_names` to the
+  // packed nodes of the type with `type_id`, which only have rows for the
+  // properties that were indexed when they were written.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Node, typename NodeType>
+  tensorflow::Status AddIndexedPropertyRowsImpl(
+      int64 type_id, const std::vector<std::string>& property_names);
+
+  // Queries the ids of the nodes of a NodeType with the type `type_id`.
+  template <typename NodeType>
+  tensorflow::Status SelectNodeIDsByTypeID(int64 type_id,
+                                           RecordSet* record_set);
+
+  // Checks that the `filter` of the nodes of a NodeType can be answered from
+  // the property rows. In the packed layout, only the indexed properties are
+  // stored as rows, so a predicate on any other property would silently miss
+  // the packed nodes.
+  // Returns INVALID_ARGUMENT error, if the properties are packed and the
+  // filter has a predicate on a custom property, or on a property that a type
+  // of the kind defines without indexing it.
+  template <typename NodeType>
+  tensorflow::Status CheckFilterIsIndexed(const NodeFilter& filter);
+
   // Creates an `Node`, which is one of {`Artifact`, `Execution`, `Context`},
   // then returns the assigned node id. The node's id field is ignored. The node
   // should have a `NodeType`, which is one of {`ArtifactType`, `ExecutionType`,
@@ -318,17 +496,39 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   template <typename Node, typename NodeType>
   tensorflow::Status CreateNodeImpl(const Node& node, int64* node_id);
 
+  // Creates the `nodes` and returns their ids index-aligned with them. Each
+  // distinct `NodeType` is looked up once, and the nodes and their properties
+  // are inserted in bulk.
+  // Returns INVALID_ARGUMENT error, if a node does not align with its type.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Node, typename NodeType>
+  tensorflow::Status CreateNodesImpl(const std::vector<Node>& nodes,
+                                     std::vector<int64>* node_ids);
+
   // Queries a `Node` which is one of {`Artifact`, `Execution`, `Context`} by
-  // an id.
+  // an id. If a `read_mask` is given, only the selected fields are set. If
+  // `is_packed` is given, it is set to whether the properties of the node are
+  // packed.
   // Returns NOT_FOUND error, if the given id cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
   template <typename Node>
-  tensorflow::Status FindNodeImpl(const int64 node_id, Node* node);
+  tensorflow::Status FindNodeImpl(
+      const int64 node_id, Node* node,
+      const ParsedNodeReadMask* read_mask = nullptr,
+      bool* is_packed = nullptr);
+
+  // Parses the property records returned by NodeLookups into the `node`.
+  template <typename Node>
+  tensorflow::Status ParsePropertiesRecordSet(
+      const RecordSet& properties_record_set, Node* node);
 
-  // Find nodes by ID, where the IDs are encoded in a record set.
+  // Find nodes by ID, where the IDs are encoded in a record set. If a
+  // `read_mask` is given, only the selected fields are set.
+  // Returns INVALID_ARGUMENT error, if the read_mask has an unknown path.
   template <typename Node>
-  tensorflow::Status FindManyNodesImpl(const RecordSet& record_set,
-                                       std::vector<Node>* nodes);
+  tensorflow::Status FindManyNodesImpl(
+      const RecordSet& record_set, std::vector<Node>* nodes,
+      const NodeReadMask* read_mask = nullptr);
 
   // Updates a `Node` which is one of {`Artifact`, `Execution`, `Context`}.
   // Returns INVALID_ARGUMENT error, if the node cannot be found
@@ -337,9 +537,9 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   template <typename Node, typename NodeType>
   tensorflow::Status UpdateNodeImpl(const Node& node);
 
-  // Takes a record set that has one record per event and for each record:
-  //   parses it into an Event object
-  //   gets the path of the event from the database
+  // Takes a record set that has one record per event, parses the records into
+  // Event objects appended to `events`, and reads the paths of all the events
+  // with one query.
   // Returns INVALID_ARGUMENT error, if the `events` is null.
   tensorflow::Status FindEventsFromRecordSet(const RecordSet& event_record_set,
                                              std::vector<Event>* events);
@@ -351,13 +551,37 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   tensorflow::Status FindContextsByNodeImpl(const int64 node_id,
                                             std::vector<Context>* contexts);
 
+  // Returns INVALID_ARGUMENT error, if any of the distinct `node_ids` is not of
+  // an existing node of the kind.
+  tensorflow::Status CheckNodeIDsExist(TypeKind node_kind,
+                                       const std::vector<int64>& node_ids);
+
+  // Creates the (context id, node id) `edges` that do not exist yet, and
+  // appends the created ones to `created_edges`. Node is either `Artifact` or
+  // `Execution`, whose edges are attributions or associations respectively.
+  // Returns INVALID_ARGUMENT error, if a context or a node is not found.
+  template <typename Node>
+  tensorflow::Status CreateContextEdgesIfNotExistImpl(
+      const std::vector<std::pair<int64, int64>>& edges,
+      std::vector<std::pair<int64, int64>>* created_edges);
+
   // Queries nodes related to a context. Node is either `Artifact` or
   // `Execution`. Returns INVALID_ARGUMENT error, if the `nodes` is null.
   template <typename Node>
   tensorflow::Status FindNodesByContextImpl(const int64 context_id,
                                             std::vector<Node>* nodes);
 
+  // Counts the rows of each table depending on the nodes of the given kind
+  // with the ids, and deletes them unless `dry_run`.
+  // Returns detailed INTERNAL error, if query execution fails.
+  tensorflow::Status DeleteNodesImpl(
+      TypeKind node_kind, const std::vector<int64>& node_ids, bool dry_run,
+      std::map<std::string, int64>* num_deleted_rows);
+
   std::unique_ptr<QueryExecutor> executor_;
+
+  // Whether the properties of the created and updated nodes are packed.
+  const bool pack_properties_;
 };
 
 }  // namespace ml_metadata
@@ -15,14 +15,19 @@ limitations under the License.
 // Test suite for a SqliteMetadataSource based MetadataAccessObject.
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "ml_metadata/metadata_store/metadata_access_object_factory.h"
 #include "ml_metadata/metadata_store/metadata_access_object_test.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/util/metadata_source_query_config.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -62,6 +67,385 @@ class SqliteMetadataAccessObjectContainer
   std::unique_ptr<MetadataAccessObject> metadata_access_object_;
 };
 
+// Returns the single integer selected by `query`.
+int64 SelectInt64(MetadataSource* metadata_source, const std::string& query) {
+  RecordSet record_set;
+  TF_CHECK_OK(metadata_source->ExecuteQuery(query, &record_set));
+  int64 value = -1;
+  CHECK(absl::SimpleAtoi(record_set.records(0).values(0), &value));
+  return value;
+}
+
+TEST(SqliteChunkedMigrationTest, ResumeInterruptedMigration) {
+  SqliteMetadataSource metadata_source{SqliteMetadataSourceConfig()};
+  TF_ASSERT_OK(metadata_source.Connect());
+  MetadataSourceQueryConfig query_config =
+      util::GetSqliteMetadataSourceQueryConfig();
+  MetadataSourceQueryConfig::MigrationScheme& v5_scheme =
+      (*query_config.mutable_migration_schemes())[5];
+  for (auto& chunked_query : *v5_scheme.mutable_chunked_upgrade_queries()) {
+    chunked_query.set_chunk_size(2);
+  }
+  // Prepares a v4 database with 5 artifacts and 5 executions.
+  std::unique_ptr<MetadataAccessObject> metadata_access_object;
+  TF_ASSERT_OK(CreateMetadataAccessObject(query_config, &metadata_source,
+                                          &metadata_access_object));
+  TF_ASSERT_OK(metadata_source.Begin());
+  TF_ASSERT_OK(metadata_access_object->InitMetadataSource());
+  TF_ASSERT_OK(metadata_access_object->DowngradeMetadataSource(4));
+  RecordSet record_set;
+  for (int i = 1; i <= 5; i++) {
+    TF_ASSERT_OK(metadata_source.ExecuteQuery(
+        absl::StrCat("INSERT INTO `Artifact` (`type_id`, `uri`) "
+                     "VALUES (1, 'uri_",
+                     i, "');"),
+        &record_set));
+    TF_ASSERT_OK(metadata_source.ExecuteQuery(
+        "INSERT INTO `Execution` (`type_id`) VALUES (2);", &record_set));
+  }
+  TF_ASSERT_OK(metadata_source.Commit());
+
+  // Interrupts the migration once the artifacts and the first chunk of
+  // executions are copied.
+  MetadataSourceQueryConfig interrupted_query_config = query_config;
+  (*interrupted_query_config.mutable_migration_schemes())[5]
+      .add_upgrade_queries()
+      ->set_query(
+          "CREATE TRIGGER `Interrupt` BEFORE INSERT ON `ExecutionTemp` "
+          "WHEN NEW.`id` > 2 BEGIN SELECT RAISE(ABORT, 'interrupted'); END;");
+  std::unique_ptr<MetadataAccessObject> interrupted_metadata_access_object;
+  TF_ASSERT_OK(CreateMetadataAccessObject(interrupted_query_config,
+                                          &metadata_source,
+                                          &interrupted_metadata_access_object));
+  TF_ASSERT_OK(metadata_source.Begin());
+  EXPECT_FALSE(interrupted_metadata_access_object
+                   ->InitMetadataSourceIfNotExists(
+                       /*enable_upgrade_migration=*/true)
+                   .ok());
+  TF_ASSERT_OK(metadata_source.Rollback());
+
+  // The copied chunks are kept, and the schema version is not changed.
+  TF_ASSERT_OK(metadata_source.Begin());
+  int64 schema_version = 0;
+  TF_ASSERT_OK(metadata_access_object->GetSchemaVersion(&schema_version));
+  EXPECT_EQ(schema_version, 4);
+  EXPECT_EQ(
+      SelectInt64(&metadata_source, "SELECT COUNT(*) FROM `ArtifactTemp`;"),
+      5);
+  EXPECT_EQ(
+      SelectInt64(&metadata_source, "SELECT COUNT(*) FROM `ExecutionTemp`;"),
+      2);
+  EXPECT_EQ(SelectInt64(&metadata_source,
+                        "SELECT `chunked_query_index` "
+                        "FROM `MLMDEnvMigrationProgress`;"),
+            1);
+  EXPECT_EQ(SelectInt64(&metadata_source,
+                        "SELECT `next_id` FROM `MLMDEnvMigrationProgress`;"),
+            3);
+  TF_ASSERT_OK(
+      metadata_source.ExecuteQuery("DROP TRIGGER `Interrupt`;", &record_set));
+  // The rows written meanwhile by clients of the previous version are
+  // migrated, including the ones of the copied chunks.
+  for (const char* query :
+       {"UPDATE `Artifact` SET `uri` = 'uri_1_updated' WHERE `id` = 1;",
+        "DELETE FROM `Artifact` WHERE `id` = 2;",
+        "INSERT INTO `Artifact` (`type_id`, `uri`) VALUES (1, 'uri_6');",
+        "DELETE FROM `Execution` WHERE `id` = 1;",
+        "INSERT INTO `Execution` (`type_id`) VALUES (2);"}) {
+    TF_ASSERT_OK(metadata_source.ExecuteQuery(query, &record_set));
+  }
+  TF_ASSERT_OK(metadata_source.Commit());
+
+  // Resumes the migration, without executing the copied chunks again.
+  TF_ASSERT_OK(metadata_source.Begin());
+  TF_ASSERT_OK(metadata_access_object->InitMetadataSourceIfNotExists(
+      /*enable_upgrade_migration=*/true));
+  TF_ASSERT_OK(metadata_source.Commit());
+
+  TF_ASSERT_OK(metadata_source.Begin());
+  TF_ASSERT_OK(metadata_access_object->GetSchemaVersion(&schema_version));
+  EXPECT_EQ(schema_version, metadata_access_object->GetLibraryVersion());
+  std::vector<Artifact> artifacts;
+  TF_ASSERT_OK(metadata_access_object->FindArtifacts(&artifacts));
+  ASSERT_EQ(artifacts.size(), 5);
+  EXPECT_EQ(artifacts[0].id(), 1);
+  EXPECT_EQ(artifacts[0].uri(), "uri_1_updated");
+  for (int i = 1; i < 5; i++) {
+    EXPECT_EQ(artifacts[i].id(), i + 2);
+    EXPECT_EQ(artifacts[i].uri(), absl::StrCat("uri_", i + 2));
+  }
+  std::vector<Execution> executions;
+  TF_ASSERT_OK(metadata_access_object->FindExecutions(&executions));
+  ASSERT_EQ(executions.size(), 5);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(executions[i].id(), i + 2);
+  }
+  EXPECT_FALSE(metadata_source
+                   .ExecuteQuery("SELECT * FROM `MLMDEnvMigrationProgress`;",
+                                 &record_set)
+                   .ok());
+  TF_ASSERT_OK(metadata_source.Rollback());
+}
+
+TEST(SqlitePropertyIndexTest, CreatePropertyIndexesOutsideTypeWrites) {
+  SqliteMetadataSource metadata_source{SqliteMetadataSourceConfig()};
+  TF_ASSERT_OK(metadata_source.Connect());
+  std::unique_ptr<MetadataAccessObject> metadata_access_object;
+  TF_ASSERT_OK(CreateMetadataAccessObject(
+      util::GetSqliteMetadataSourceQueryConfig(), &metadata_source,
+      &metadata_access_object));
+  const std::string count_indexes_query =
+      "SELECT COUNT(*) FROM `sqlite_master` WHERE `type` = 'index' AND "
+      "`name` LIKE 'idx_ArtifactProperty_%_value';";
+  TF_ASSERT_OK(metadata_source.Begin());
+  TF_ASSERT_OK(metadata_access_object->InitMetadataSource());
+  const ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'type'
+    properties { key: 'p_int' value: INT }
+    properties { key: 'p_string' value: STRING }
+    indexed_properties: 'p_int'
+  )");
+  int64 type_id;
+  TF_ASSERT_OK(metadata_access_object->CreateType(type, &type_id));
+  // The type writes do not create indexes.
+  EXPECT_EQ(SelectInt64(&metadata_source, count_indexes_query), 0);
+  TF_ASSERT_OK(metadata_source.Commit());
+
+  TF_ASSERT_OK(metadata_source.Begin());
+  TF_ASSERT_OK(metadata_access_object->CreatePropertyIndexes(type));
+  EXPECT_EQ(SelectInt64(&metadata_source, count_indexes_query), 1);
+  ArtifactType updated_type = type;
+  updated_type.add_indexed_properties("p_string");
+  TF_ASSERT_OK(metadata_access_object->UpdateType(updated_type));
+  // The existing indexes are kept, and the new data type is indexed.
+  TF_ASSERT_OK(metadata_access_object->CreatePropertyIndexes(updated_type));
+  TF_ASSERT_OK(metadata_access_object->CreatePropertyIndexes(updated_type));
+  EXPECT_EQ(SelectInt64(&metadata_source, count_indexes_query), 2);
+  EXPECT_EQ(metadata_access_object
+                ->CreatePropertyIndexes(
+                    ParseTextProtoOrDie<ArtifactType>("name: 'unknown'"))
+                .code(),
+            tensorflow::error::NOT_FOUND);
+  TF_ASSERT_OK(metadata_source.Commit());
+}
+
+// Returns the artifact read by `metadata_access_object`.
+Artifact FindArtifact(MetadataAccessObject* metadata_access_object,
+                      int64 artifact_id) {
+  Artifact artifact;
+  TF_CHECK_OK(metadata_access_object->FindArtifactById(artifact_id, &artifact));
+  return artifact;
+}
+
+TEST(SqlitePackedPropertiesTest, ReadAndWritePackedNodes) {
+  SqliteMetadataSource metadata_source{SqliteMetadataSourceConfig()};
+  TF_ASSERT_OK(metadata_source.Connect());
+  MetadataSourceQueryConfig query_config =
+      util::GetSqliteMetadataSourceQueryConfig();
+  std::unique_ptr<MetadataAccessObject> rows_metadata_access_object;
+  TF_ASSERT_OK(CreateMetadataAccessObject(query_config, &metadata_source,
+                                          &rows_metadata_access_object));
+  query_config.set_pack_properties(true);
+  std::unique_ptr<MetadataAccessObject> metadata_access_object;
+  TF_ASSERT_OK(CreateMetadataAccessObject(query_config, &metadata_source,
+                                          &metadata_access_object));
+  TF_ASSERT_OK(metadata_source.Begin());
+  TF_ASSERT_OK(metadata_access_object->InitMetadataSource());
+  int64 type_id;
+  TF_ASSERT_OK(metadata_access_object->CreateType(
+      ParseTextProtoOrDie<ArtifactType>(R"(
+        name: 'type'
+        properties { key: 'indexed' value: INT }
+        properties { key: 'packed' value: STRING }
+        indexed_properties: 'indexed'
+      )"),
+      &type_id));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'uri'
+    properties { key: 'indexed' value { int_value: 1 } }
+    properties { key: 'packed' value { string_value: 'a' } }
+    custom_properties { key: 'custom' value { double_value: 0.5 } }
+  )");
+  artifact.set_type_id(type_id);
+  int64 artifact_id;
+  TF_ASSERT_OK(metadata_access_object->CreateArtifact(artifact, &artifact_id));
+  std::vector<int64> artifact_ids;
+  TF_ASSERT_OK(
+      metadata_access_object->CreateArtifacts({artifact}, &artifact_ids));
+  ASSERT_EQ(artifact_ids.size(), 1);
+
+  // Only the indexed properties are stored as rows, and the packed properties
+  // are read in either layout.
+  EXPECT_EQ(SelectInt64(&metadata_source,
+                        "SELECT COUNT(*) FROM `ArtifactProperty`;"),
+            2);
+  for (const int64 id : {artifact_id, artifact_ids[0]}) {
+    artifact.set_id(id);
+    EXPECT_THAT(FindArtifact(metadata_access_object.get(), id),
+                EqualsProto(artifact));
+    EXPECT_THAT(FindArtifact(rows_metadata_access_object.get(), id),
+                EqualsProto(artifact));
+  }
+  NodeFilter filter = ParseTextProtoOrDie<NodeFilter>(R"(
+    predicates { property: 'indexed' op: EQ value { int_value: 1 } }
+  )");
+  std::vector<Artifact> artifacts;
+  TF_ASSERT_OK(metadata_access_object->FindArtifactsByFilter(filter,
+                                                             &artifacts));
+  EXPECT_EQ(artifacts.size(), 2);
+
+  // An update rewrites the packed properties and the rows of the indexed
+  // properties.
+  artifact.set_id(artifact_id);
+  (*artifact.mutable_properties())["indexed"].set_int_value(2);
+  artifact.mutable_custom_properties()->clear();
+  TF_ASSERT_OK(metadata_access_object->UpdateArtifact(artifact));
+  EXPECT_THAT(FindArtifact(metadata_access_object.get(), artifact_id),
+              EqualsProto(artifact));
+  (*filter.mutable_predicates(0)->mutable_value()).set_int_value(2);
+  artifacts.clear();
+  TF_ASSERT_OK(metadata_access_object->FindArtifactsByFilter(filter,
+                                                             &artifacts));
+  ASSERT_EQ(artifacts.size(), 1);
+  EXPECT_EQ(artifacts[0].id(), artifact_id);
+
+  // A packed node updated in the rows layout is converted to property rows,
+  // and back.
+  const std::string count_rows_query = absl::StrCat(
+      "SELECT COUNT(*) FROM `ArtifactProperty` WHERE `artifact_id` = ",
+      artifact_id, ";");
+  TF_ASSERT_OK(rows_metadata_access_object->UpdateArtifact(artifact));
+  EXPECT_EQ(SelectInt64(&metadata_source,
+                        "SELECT COUNT(*) FROM `Artifact` "
+                        "WHERE `packed_properties` IS NULL;"),
+            1);
+  EXPECT_EQ(SelectInt64(&metadata_source, count_rows_query), 2);
+  EXPECT_THAT(FindArtifact(metadata_access_object.get(), artifact_id),
+              EqualsProto(artifact));
+  TF_ASSERT_OK(metadata_access_object->UpdateArtifact(artifact));
+  EXPECT_EQ(SelectInt64(&metadata_source,
+                        "SELECT COUNT(*) FROM `Artifact` "
+                        "WHERE `packed_properties` IS NULL;"),
+            0);
+  EXPECT_EQ(SelectInt64(&metadata_source, count_rows_query), 1);
+  EXPECT_THAT(FindArtifact(rows_metadata_access_object.get(), artifact_id),
+              EqualsProto(artifact));
+
+  // The filters and counts on the packed properties are rejected, rather
+  // than missing the packed nodes.
+  for (const char* packed_filter :
+       {"predicates { property: 'packed' op: EQ value { string_value: 'a' } }",
+        "predicates { custom_property: 'custom' op: GT "
+        "             value { double_value: 0 } }"}) {
+    filter = ParseTextProtoOrDie<NodeFilter>(packed_filter);
+    EXPECT_EQ(
+        metadata_access_object->FindArtifactsByFilter(filter, &artifacts)
+            .code(),
+        tensorflow::error::INVALID_ARGUMENT);
+    std::vector<NodeCount> counts;
+    EXPECT_EQ(metadata_access_object->CountArtifacts(filter, {}, &counts)
+                  .code(),
+              tensorflow::error::INVALID_ARGUMENT);
+  }
+
+  // Once the type indexes the property, the packed nodes get its rows.
+  ArtifactType updated_type;
+  TF_ASSERT_OK(metadata_access_object->FindTypeById(type_id, &updated_type));
+  updated_type.add_indexed_properties("packed");
+  TF_ASSERT_OK(metadata_access_object->UpdateType(updated_type));
+  filter = ParseTextProtoOrDie<NodeFilter>(
+      "predicates { property: 'packed' op: EQ value { string_value: 'a' } }");
+  artifacts.clear();
+  TF_ASSERT_OK(metadata_access_object->FindArtifactsByFilter(filter,
+                                                             &artifacts));
+  EXPECT_EQ(artifacts.size(), 2);
+
+  // The schema is not downgraded while the packed properties would be lost.
+  EXPECT_EQ(metadata_access_object->DowngradeMetadataSource(7).code(),
+            tensorflow::error::FAILED_PRECONDITION);
+  TF_ASSERT_OK(metadata_source.Commit());
+}
+
+TEST(SqliteInsertIdsTest, InsertOneRowAtATimeWithoutConsecutiveIds) {
+  SqliteMetadataSource metadata_source{SqliteMetadataSourceConfig()};
+  TF_ASSERT_OK(metadata_source.Connect());
+  MetadataSourceQueryConfig query_config =
+      util::GetSqliteMetadataSourceQueryConfig();
+  query_config.mutable_select_consecutive_insert_ids()->set_query(
+      " SELECT 0; ");
+  std::unique_ptr<MetadataAccessObject> metadata_access_object;
+  TF_ASSERT_OK(CreateMetadataAccessObject(query_config, &metadata_source,
+                                          &metadata_access_object));
+  TF_ASSERT_OK(metadata_source.Begin());
+  TF_ASSERT_OK(metadata_access_object->InitMetadataSource());
+  // The triggers insert a row after each inserted artifact and event, so the
+  // ids of the rows of a multi-row insertion would not be consecutive.
+  TF_ASSERT_OK(metadata_source.ExecuteQuery(
+      "CREATE TRIGGER `artifact_gap` AFTER INSERT ON `Artifact` "
+      "WHEN NEW.`uri` <> 'gap' BEGIN "
+      "INSERT INTO `Artifact`(`type_id`, `uri`) VALUES (NEW.`type_id`, 'gap'); "
+      "END;",
+      nullptr));
+  TF_ASSERT_OK(metadata_source.ExecuteQuery(
+      "CREATE TRIGGER `event_gap` AFTER INSERT ON `Event` "
+      "WHEN NEW.`type` <> 0 BEGIN "
+      "INSERT INTO `Event`(`artifact_id`, `execution_id`, `type`) "
+      "VALUES (NEW.`artifact_id`, NEW.`execution_id`, 0); END;",
+      nullptr));
+  int64 artifact_type_id;
+  TF_ASSERT_OK(metadata_access_object->CreateType(
+      ParseTextProtoOrDie<ArtifactType>("name: 'artifact_type'"),
+      &artifact_type_id));
+  int64 execution_type_id;
+  TF_ASSERT_OK(metadata_access_object->CreateType(
+      ParseTextProtoOrDie<ExecutionType>("name: 'execution_type'"),
+      &execution_type_id));
+
+  std::vector<Artifact> artifacts(3);
+  for (int i = 0; i < 3; ++i) {
+    artifacts[i].set_type_id(artifact_type_id);
+    artifacts[i].set_uri(absl::StrCat("uri", i));
+  }
+  std::vector<int64> artifact_ids;
+  TF_ASSERT_OK(
+      metadata_access_object->CreateArtifacts(artifacts, &artifact_ids));
+  ASSERT_EQ(artifact_ids.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(FindArtifact(metadata_access_object.get(), artifact_ids[i]).uri(),
+              artifacts[i].uri());
+  }
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  std::vector<int64> execution_ids;
+  TF_ASSERT_OK(
+      metadata_access_object->CreateExecutions({execution}, &execution_ids));
+  ASSERT_EQ(execution_ids.size(), 1);
+
+  // The paths are inserted with the ids of their events.
+  std::vector<Event> events(2);
+  for (int i = 0; i < 2; ++i) {
+    events[i].set_artifact_id(artifact_ids[i]);
+    events[i].set_execution_id(execution_ids[0]);
+    events[i].set_type(Event::OUTPUT);
+    events[i].mutable_path()->add_steps()->set_index(i);
+  }
+  TF_ASSERT_OK(metadata_access_object->CreateEvents(events));
+  std::vector<Event> stored_events;
+  TF_ASSERT_OK(metadata_access_object->FindEventsByExecution(
+      execution_ids[0], &stored_events));
+  ASSERT_EQ(stored_events.size(), 4);
+  for (const Event& event : stored_events) {
+    if (event.type() == Event::UNKNOWN) {
+      EXPECT_FALSE(event.has_path());
+      continue;
+    }
+    ASSERT_EQ(event.path().steps_size(), 1);
+    EXPECT_EQ(artifact_ids[event.path().steps(0).index()],
+              event.artifact_id());
+  }
+  TF_ASSERT_OK(metadata_source.Commit());
+}
+
 }  // namespace
 
 INSTANTIATE_TEST_CASE_P(
@@ -15,6 +15,7 @@ limitations under the License.
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source_util.h"
@@ -64,6 +65,14 @@ struct WaitThenRetryOptions {
   absl::Duration max_retried_time;
 };
 
+// The default options, which are used by the connection and the backup steps.
+constexpr WaitThenRetryOptions kDefaultWaitThenRetryOptions = {
+    absl::Milliseconds(100), absl::Milliseconds(500)};
+
+// The number of times the writes of other connections can restart a backup
+// before it is aborted.
+constexpr int kMaxBackupRestarts = 10;
+
 // A callback of sqlite3_busy_handler. Concurrent access to a table may prevent
 // query to proceed, the callback returns zero to continue waiting, and non-zero
 // to abort the query and returns a SQLITE_BUSY error. The function takes a
@@ -72,8 +81,6 @@ struct WaitThenRetryOptions {
 // for each wait and 5 times at maximum (`max_retried_time`/`sleep_time`).
 // (see https://www.sqlite.org/c3ref/busy_handler.html for details)
 int WaitThenRetry(void* options, int retried_times) {
-  static constexpr WaitThenRetryOptions kDefaultWaitThenRetryOptions = {
-      absl::Milliseconds(100), absl::Milliseconds(500)};
   const WaitThenRetryOptions* opts =
       (options != nullptr) ? static_cast<WaitThenRetryOptions*>(options)
                            : &kDefaultWaitThenRetryOptions;
@@ -160,6 +167,95 @@ tensorflow::Status SqliteMetadataSource::RollbackImpl() {
   return RunStatement(kRollbackTransaction);
 }
 
+tensorflow::Status SqliteMetadataSource::BackupImpl(
+    const std::string& destination_uri, const int pages_per_step,
+    const absl::Duration step_interval, absl::Mutex* step_lock,
+    int64* num_pages) {
+  sqlite3* destination = nullptr;
+  if (sqlite3_open_v2(destination_uri.c_str(), &destination,
+                      SQLITE_OPEN_URI | SQLITE_OPEN_READWRITE |
+                          SQLITE_OPEN_CREATE,
+                      nullptr) != SQLITE_OK) {
+    std::string error_message = sqlite3_errmsg(destination);
+    sqlite3_close(destination);
+    return tensorflow::errors::Internal(
+        "Cannot open the sqlite3 backup database: ", error_message);
+  }
+  sqlite3_backup* backup = nullptr;
+  {
+    absl::MutexLockMaybe l(step_lock);
+    // The full paths of the database files resolve the different uris of the
+    // same file.
+    if (std::string(sqlite3_db_filename(db_, "main")) ==
+        sqlite3_db_filename(destination, "main")) {
+      sqlite3_close(destination);
+      return tensorflow::errors::InvalidArgument(
+          "Cannot backup the sqlite3 database to itself: ", destination_uri);
+    }
+    backup = sqlite3_backup_init(destination, "main", db_, "main");
+  }
+  if (backup == nullptr) {
+    std::string error_message = sqlite3_errmsg(destination);
+    sqlite3_close(destination);
+    return tensorflow::errors::Internal("Cannot start the sqlite3 backup: ",
+                                        error_message);
+  }
+  // Busy or locked steps are retried as long as a query waits for a lock. A
+  // write of another connection restarts the copy from the first page, which
+  // is detected by the number of remaining pages not shrinking.
+  absl::Duration busy_time;
+  int num_restarts = 0;
+  int remaining_pages = -1;
+  int last_remaining_pages;
+  int result;
+  while (true) {
+    {
+      absl::MutexLockMaybe l(step_lock);
+      result = sqlite3_backup_step(backup,
+                                   pages_per_step > 0 ? pages_per_step : -1);
+      last_remaining_pages = remaining_pages;
+      remaining_pages = sqlite3_backup_remaining(backup);
+    }
+    if (result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+      if (busy_time >= kDefaultWaitThenRetryOptions.max_retried_time) break;
+      absl::SleepFor(kDefaultWaitThenRetryOptions.sleep_time);
+      busy_time += kDefaultWaitThenRetryOptions.sleep_time;
+      continue;
+    }
+    busy_time = absl::ZeroDuration();
+    if (result != SQLITE_OK) break;
+    if (last_remaining_pages >= 0 && remaining_pages >= last_remaining_pages &&
+        ++num_restarts > kMaxBackupRestarts) {
+      break;
+    }
+    absl::SleepFor(step_interval);
+  }
+  int finish_result;
+  {
+    absl::MutexLockMaybe l(step_lock);
+    *num_pages = sqlite3_backup_pagecount(backup);
+    // Finishing the backup releases its resources, and returns the error of
+    // the last step if any.
+    finish_result = sqlite3_backup_finish(backup);
+  }
+  std::string error_message = sqlite3_errmsg(destination);
+  sqlite3_close(destination);
+  if (result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+    return tensorflow::errors::Aborted(
+        "The backup is aborted after max number of retries of locked steps.");
+  }
+  if (num_restarts > kMaxBackupRestarts) {
+    return tensorflow::errors::Aborted(
+        "The backup is aborted after ", kMaxBackupRestarts,
+        " restarts by the writes of other connections.");
+  }
+  if (result != SQLITE_DONE || finish_result != SQLITE_OK) {
+    return tensorflow::errors::Internal("Cannot backup sqlite3 database: ",
+                                        error_message);
+  }
+  return tensorflow::Status::OK();
+}
+
 std::string SqliteMetadataSource::EscapeString(absl::string_view value) const {
   return SqliteEscapeString(value);
 }
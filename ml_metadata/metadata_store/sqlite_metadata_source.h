@@ -61,6 +61,19 @@ class SqliteMetadataSource : public MetadataSource {
   // Begins a transaction
   tensorflow::Status BeginImpl() final;
 
+  // Copies the database with the sqlite3 online backup API. The backup reads
+  // through this connection, so its writes are copied along instead of
+  // restarting the backup, and in-memory databases can be backed up. A write
+  // of any other connection restarts the backup.
+  // (see https://www.sqlite.org/backup.html for details)
+  // Returns ABORTED error, if a step stays locked, or the backup is restarted
+  // too many times.
+  tensorflow::Status BackupImpl(const std::string& destination_uri,
+                                int pages_per_step,
+                                absl::Duration step_interval,
+                                absl::Mutex* step_lock,
+                                int64* num_pages) final;
+
   // Util methods to execute query.
   tensorflow::Status RunStatement(const std::string& query, RecordSet* results);
 
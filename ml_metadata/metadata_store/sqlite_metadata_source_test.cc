@@ -15,11 +15,16 @@ limitations under the License.
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 
 #include <memory>
+#include <string>
+#include <thread>  // NOLINT
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/test_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/env.h"
@@ -229,5 +234,81 @@ TEST_F(SqliteMetadataSourceTest, TestPhysicalFile) {
   EXPECT_THAT(query_results, EqualsProto(expected_results));
 }
 
+TEST_F(SqliteMetadataSourceTest, TestBackup) {
+  // The in-memory database is read through its own connection.
+  InitSchemaAndPopulateRows(metadata_source_.get());
+  filename_uri_ = absl::StrCat(::testing::TempDir(), "test_backup.db");
+  int64 num_pages = 0;
+  TF_ASSERT_OK(metadata_source_->Backup(filename_uri_, /*pages_per_step=*/1,
+                                        absl::ZeroDuration(),
+                                        /*step_lock=*/nullptr, &num_pages));
+  EXPECT_GT(num_pages, 1);
+  TF_ASSERT_OK(metadata_source_->Begin());
+  RecordSet expected_results;
+  TF_ASSERT_OK(
+      metadata_source_->ExecuteQuery("SELECT * FROM t1", &expected_results));
+  TF_ASSERT_OK(metadata_source_->Commit());
+
+  SqliteMetadataSourceConfig config;
+  config.set_filename_uri(filename_uri_);
+  config.set_connection_mode(SqliteMetadataSourceConfig::READONLY);
+  SqliteMetadataSource backup_source(config);
+  TF_ASSERT_OK(backup_source.Connect());
+  TF_ASSERT_OK(backup_source.Begin());
+  RecordSet query_results;
+  TF_ASSERT_OK(backup_source.ExecuteQuery("SELECT * FROM t1", &query_results));
+  TF_ASSERT_OK(backup_source.Commit());
+  EXPECT_THAT(query_results, EqualsProto(expected_results));
+  EXPECT_EQ(backup_source
+                .Backup(filename_uri_, /*pages_per_step=*/1,
+                        absl::ZeroDuration(), /*step_lock=*/nullptr,
+                        &num_pages)
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_F(SqliteMetadataSourceTest, TestBackupDuringWrites) {
+  const std::string source_filename_uri =
+      absl::StrCat(::testing::TempDir(), "test_backup_source.db");
+  SqliteMetadataSourceConfig source_config;
+  source_config.set_filename_uri(source_filename_uri);
+  SqliteMetadataSource source(source_config);
+  InitSchemaAndPopulateRows(&source);
+  TF_ASSERT_OK(source.Begin());
+  for (int i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(source.ExecuteQuery(
+        absl::StrCat("INSERT INTO t1 VALUES (", i, ", '",
+                     std::string(1000, 'v'), "')"),
+        nullptr));
+  }
+  TF_ASSERT_OK(source.Commit());
+
+  // The writes through the source connection between the steps are copied
+  // along, and do not restart the backup.
+  filename_uri_ = absl::StrCat(::testing::TempDir(), "test_backup.db");
+  absl::Mutex step_lock;
+  tensorflow::Status backup_status;
+  std::thread backup([&]() {
+    int64 num_pages = 0;
+    backup_status =
+        source.Backup(filename_uri_, /*pages_per_step=*/1,
+                      absl::Milliseconds(2), &step_lock, &num_pages);
+  });
+  for (int i = 0; i < 20; ++i) {
+    {
+      absl::MutexLock l(&step_lock);
+      TF_EXPECT_OK(source.Begin());
+      TF_EXPECT_OK(
+          source.ExecuteQuery("UPDATE t1 SET c2 = 'w' WHERE c1 = 1", nullptr));
+      TF_EXPECT_OK(source.Commit());
+    }
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  backup.join();
+  TF_EXPECT_OK(backup_status);
+  TF_ASSERT_OK(source.Close());
+  TF_ASSERT_OK(tensorflow::Env::Default()->DeleteFile(source_filename_uri));
+}
+
 }  // namespace
 }  // namespace ml_metadata
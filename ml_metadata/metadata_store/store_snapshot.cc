@@ -0,0 +1,572 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/store_snapshot.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/util/delimited_message_util.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace ml_metadata {
+namespace {
+
+using IdMap = absl::flat_hash_map<int64, int64>;
+
+void SetRecord(const ArtifactType& type, StoreSnapshotRecord* record) {
+  *record->mutable_artifact_type() = type;
+}
+void SetRecord(const ExecutionType& type, StoreSnapshotRecord* record) {
+  *record->mutable_execution_type() = type;
+}
+void SetRecord(const ContextType& type, StoreSnapshotRecord* record) {
+  *record->mutable_context_type() = type;
+}
+void SetRecord(const Artifact& artifact, StoreSnapshotRecord* record) {
+  *record->mutable_artifact() = artifact;
+}
+void SetRecord(const Execution& execution, StoreSnapshotRecord* record) {
+  *record->mutable_execution() = execution;
+}
+void SetRecord(const Context& context, StoreSnapshotRecord* record) {
+  *record->mutable_context() = context;
+}
+void SetRecord(const Event& event, StoreSnapshotRecord* record) {
+  *record->mutable_event() = event;
+}
+void SetRecord(const Attribution& attribution, StoreSnapshotRecord* record) {
+  *record->mutable_attribution() = attribution;
+}
+void SetRecord(const Association& association, StoreSnapshotRecord* record) {
+  *record->mutable_association() = association;
+}
+
+// Writes `message` to `output` as a length-delimited StoreSnapshotRecord.
+template <typename Message>
+tensorflow::Status WriteRecord(
+    const Message& message,
+    google::protobuf::io::ZeroCopyOutputStream* output) {
+  StoreSnapshotRecord record;
+  SetRecord(message, &record);
+  if (!google::protobuf::util::SerializeDelimitedToZeroCopyStream(record,
+                                                                  output)) {
+    return tensorflow::errors::Internal(
+        "Cannot write the store snapshot record.");
+  }
+  return tensorflow::Status::OK();
+}
+
+// Writes all types of a kind to `output`.
+template <typename Type>
+tensorflow::Status ExportTypes(
+    MetadataAccessObject* metadata_access_object,
+    google::protobuf::io::ZeroCopyOutputStream* output) {
+  std::vector<Type> types;
+  const tensorflow::Status status = metadata_access_object->FindTypes(&types);
+  if (tensorflow::errors::IsNotFound(status)) return tensorflow::Status::OK();
+  TF_RETURN_IF_ERROR(status);
+  for (const Type& type : types) TF_RETURN_IF_ERROR(WriteRecord(type, output));
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status FindNodesByFilter(
+    MetadataAccessObject* metadata_access_object, const NodeFilter& filter,
+    std::vector<Artifact>* artifacts) {
+  return metadata_access_object->FindArtifactsByFilter(filter, artifacts);
+}
+tensorflow::Status FindNodesByFilter(
+    MetadataAccessObject* metadata_access_object, const NodeFilter& filter,
+    std::vector<Execution>* executions) {
+  return metadata_access_object->FindExecutionsByFilter(filter, executions);
+}
+tensorflow::Status FindNodesByFilter(
+    MetadataAccessObject* metadata_access_object, const NodeFilter& filter,
+    std::vector<Context>* contexts) {
+  return metadata_access_object->FindContextsByFilter(filter, contexts);
+}
+
+// Calls `export_page` with all nodes of a kind in the order of their ids,
+// reading `page_size` nodes at a time. Each page is read and exported in a
+// transaction of its own, so that the export does not hold a transaction for
+// the whole store. `last_id` is set to the largest exported node id.
+template <typename Node>
+tensorflow::Status ExportNodes(
+    int64 page_size, MetadataSource* metadata_source,
+    MetadataAccessObject* metadata_access_object,
+    const std::function<tensorflow::Status(const std::vector<Node>&)>&
+        export_page,
+    int64* last_id) {
+  *last_id = 0;
+  NodeFilter filter;
+  filter.set_limit(page_size);
+  NodeFilter::Predicate* after_last_id = filter.add_predicates();
+  after_last_id->set_attribute(NodeFilter::ID);
+  after_last_id->set_op(NodeFilter::GT);
+  bool has_next_page = true;
+  while (has_next_page) {
+    after_last_id->mutable_value()->set_int_value(*last_id);
+    TF_RETURN_IF_ERROR(ExecuteTransaction(
+        metadata_source,
+        [&filter, &export_page, &has_next_page, last_id,
+         metadata_access_object]() -> tensorflow::Status {
+          std::vector<Node> nodes;
+          const tensorflow::Status status =
+              FindNodesByFilter(metadata_access_object, filter, &nodes);
+          if (tensorflow::errors::IsNotFound(status)) {
+            has_next_page = false;
+            return tensorflow::Status::OK();
+          }
+          TF_RETURN_IF_ERROR(status);
+          TF_RETURN_IF_ERROR(export_page(nodes));
+          for (const Node& node : nodes) {
+            *last_id = std::max<int64>(*last_id, node.id());
+          }
+          has_next_page = static_cast<int64>(nodes.size()) == filter.limit();
+          return tensorflow::Status::OK();
+        }));
+  }
+  return tensorflow::Status::OK();
+}
+
+// Returns the ids of the nodes.
+template <typename Node>
+std::vector<int64> NodeIds(const std::vector<Node>& nodes) {
+  std::vector<int64> ids;
+  ids.reserve(nodes.size());
+  for (const Node& node : nodes) ids.push_back(node.id());
+  return ids;
+}
+
+// Sets `new_id` to the id mapped from the exported `id`.
+// Returns INVALID_ARGUMENT error, if `id` has not been imported.
+tensorflow::Status RemapId(const IdMap& ids, absl::string_view kind, int64 id,
+                           int64* new_id) {
+  const auto it = ids.find(id);
+  if (it == ids.end()) {
+    return tensorflow::errors::InvalidArgument(absl::StrCat(
+        "The store snapshot refers to the ", kind, " with id ", id,
+        " before it is imported."));
+  }
+  *new_id = it->second;
+  return tensorflow::Status::OK();
+}
+
+// Returns true if the types have the same properties.
+template <typename Type>
+bool HaveSameProperties(const Type& type, const Type& other_type) {
+  if (type.properties_size() != other_type.properties_size()) return false;
+  for (const auto& property : type.properties()) {
+    const auto it = other_type.properties().find(property.first);
+    if (it == other_type.properties().end() || it->second != property.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reuses the type with the same name, or creates the type, and maps the
+// exported type id to the id in the metadata source. The created types with
+// indexed properties are appended to `indexed_types`.
+// Returns ALREADY_EXISTS error, if the type with the same name has different
+// properties.
+template <typename Type>
+tensorflow::Status ImportType(Type type,
+                              MetadataAccessObject* metadata_access_object,
+                              IdMap* type_ids,
+                              std::vector<Type>* indexed_types) {
+  Type stored_type;
+  const tensorflow::Status status =
+      metadata_access_object->FindTypeByName(type.name(), &stored_type);
+  int64 type_id = stored_type.id();
+  if (tensorflow::errors::IsNotFound(status)) {
+    const int64 exported_id = type.id();
+    type.clear_id();
+    TF_RETURN_IF_ERROR(metadata_access_object->CreateType(type, &type_id));
+    type.set_id(exported_id);
+    if (!type.indexed_properties().empty()) indexed_types->push_back(type);
+  } else {
+    TF_RETURN_IF_ERROR(status);
+    if (!HaveSameProperties(type, stored_type)) {
+      return tensorflow::errors::AlreadyExists(
+          absl::StrCat("The type ", type.name(),
+                       " already exists with different properties."));
+    }
+  }
+  (*type_ids)[type.id()] = type_id;
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status CreateNodes(MetadataAccessObject* metadata_access_object,
+                               const std::vector<Artifact>& artifacts,
+                               std::vector<int64>* node_ids) {
+  return metadata_access_object->CreateArtifacts(artifacts, node_ids);
+}
+tensorflow::Status CreateNodes(MetadataAccessObject* metadata_access_object,
+                               const std::vector<Execution>& executions,
+                               std::vector<int64>* node_ids) {
+  return metadata_access_object->CreateExecutions(executions, node_ids);
+}
+
+// Appends the node with its id cleared and its type id remapped to `nodes`,
+// and its exported id to `exported_ids`.
+template <typename Node>
+tensorflow::Status AddNode(Node node, const IdMap& type_ids,
+                           std::vector<Node>* nodes,
+                           std::vector<int64>* exported_ids) {
+  int64 type_id;
+  TF_RETURN_IF_ERROR(RemapId(type_ids, "type", node.type_id(), &type_id));
+  exported_ids->push_back(node.id());
+  node.clear_id();
+  node.set_type_id(type_id);
+  nodes->push_back(std::move(node));
+  return tensorflow::Status::OK();
+}
+
+// Creates the `nodes` in bulk, maps their `exported_ids` to the new ids, and
+// appends them with the new ids to `created_nodes`. The vectors are cleared.
+template <typename Node>
+tensorflow::Status CreateAddedNodes(
+    MetadataAccessObject* metadata_access_object, std::vector<Node>* nodes,
+    std::vector<int64>* exported_ids, IdMap* node_ids,
+    std::vector<Node>* created_nodes) {
+  if (nodes->empty()) return tensorflow::Status::OK();
+  std::vector<int64> new_ids;
+  TF_RETURN_IF_ERROR(CreateNodes(metadata_access_object, *nodes, &new_ids));
+  for (size_t i = 0; i < new_ids.size(); ++i) {
+    (*node_ids)[(*exported_ids)[i]] = new_ids[i];
+    (*nodes)[i].set_id(new_ids[i]);
+    created_nodes->push_back(std::move((*nodes)[i]));
+  }
+  nodes->clear();
+  exported_ids->clear();
+  return tensorflow::Status::OK();
+}
+
+// Imports the records of a snapshot, keeping the maps from the exported ids
+// to the ids in the metadata source. The consecutive records of artifacts,
+// executions, events, attributions and associations are buffered, and created
+// in bulk once a record of another kind is imported or Flush() is called. As
+// a snapshot lists the records after the records they refer to, the referred
+// nodes are created before the records referring to them are remapped.
+class SnapshotImporter {
+ public:
+  explicit SnapshotImporter(MetadataAccessObject* metadata_access_object)
+      : metadata_access_object_(metadata_access_object) {}
+
+  tensorflow::Status Import(const StoreSnapshotRecord& record) {
+    if (record.record_case() != buffered_record_case_) {
+      TF_RETURN_IF_ERROR(Flush());
+      buffered_record_case_ = record.record_case();
+    }
+    switch (record.record_case()) {
+      case StoreSnapshotRecord::kArtifactType:
+        return ImportType(record.artifact_type(), metadata_access_object_,
+                          &artifact_type_ids_, &indexed_artifact_types_);
+      case StoreSnapshotRecord::kExecutionType:
+        return ImportType(record.execution_type(), metadata_access_object_,
+                          &execution_type_ids_, &indexed_execution_types_);
+      case StoreSnapshotRecord::kContextType:
+        return ImportType(record.context_type(), metadata_access_object_,
+                          &context_type_ids_, &indexed_context_types_);
+      case StoreSnapshotRecord::kArtifact:
+        return AddNode(record.artifact(), artifact_type_ids_, &artifacts_,
+                       &exported_artifact_ids_);
+      case StoreSnapshotRecord::kExecution:
+        return AddNode(record.execution(), execution_type_ids_, &executions_,
+                       &exported_execution_ids_);
+      case StoreSnapshotRecord::kContext:
+        return ImportContext(record.context());
+      case StoreSnapshotRecord::kEvent:
+        return AddEvent(record.event());
+      case StoreSnapshotRecord::kAttribution:
+        return AddAttribution(record.attribution());
+      case StoreSnapshotRecord::kAssociation:
+        return AddAssociation(record.association());
+      default:
+        return tensorflow::errors::InvalidArgument(
+            "The store snapshot record is empty.");
+    }
+  }
+
+  // Creates the buffered records. It should be called before the transaction
+  // of a batch of records is committed.
+  tensorflow::Status Flush() {
+    TF_RETURN_IF_ERROR(CreateAddedNodes(
+        metadata_access_object_, &artifacts_, &exported_artifact_ids_,
+        &artifact_ids_, &imported_records_.artifacts));
+    TF_RETURN_IF_ERROR(CreateAddedNodes(
+        metadata_access_object_, &executions_, &exported_execution_ids_,
+        &execution_ids_, &imported_records_.executions));
+    if (!events_.empty()) {
+      TF_RETURN_IF_ERROR(metadata_access_object_->CreateEvents(events_));
+      std::move(events_.begin(), events_.end(),
+                std::back_inserter(imported_records_.events));
+      events_.clear();
+    }
+    if (!attributions_.empty()) {
+      TF_RETURN_IF_ERROR(metadata_access_object_->CreateAttributionsIfNotExist(
+          attributions_, &imported_records_.attributions));
+      attributions_.clear();
+    }
+    if (!associations_.empty()) {
+      TF_RETURN_IF_ERROR(metadata_access_object_->CreateAssociationsIfNotExist(
+          associations_, &imported_records_.associations));
+      associations_.clear();
+    }
+    return tensorflow::Status::OK();
+  }
+
+  // Returns the records created since the last call, and clears them.
+  ImportedRecords TakeImportedRecords() {
+    return std::exchange(imported_records_, ImportedRecords());
+  }
+
+  // Creates the property indexes of the indexed types imported since the last
+  // call. It runs in a transaction of its own once the types are committed, as
+  // creating an index implicitly commits the open transaction on some
+  // backends.
+  tensorflow::Status CreatePropertyIndexes(
+      const ExecuteTransactionFn& execute_transaction) {
+    if (indexed_artifact_types_.empty() && indexed_execution_types_.empty() &&
+        indexed_context_types_.empty()) {
+      return tensorflow::Status::OK();
+    }
+    TF_RETURN_IF_ERROR(execute_transaction([this]() -> tensorflow::Status {
+      for (const ArtifactType& type : indexed_artifact_types_) {
+        TF_RETURN_IF_ERROR(
+            metadata_access_object_->CreatePropertyIndexes(type));
+      }
+      for (const ExecutionType& type : indexed_execution_types_) {
+        TF_RETURN_IF_ERROR(
+            metadata_access_object_->CreatePropertyIndexes(type));
+      }
+      for (const ContextType& type : indexed_context_types_) {
+        TF_RETURN_IF_ERROR(
+            metadata_access_object_->CreatePropertyIndexes(type));
+      }
+      return tensorflow::Status::OK();
+    }));
+    indexed_artifact_types_.clear();
+    indexed_execution_types_.clear();
+    indexed_context_types_.clear();
+    return tensorflow::Status::OK();
+  }
+
+ private:
+  // Contexts are created one at a time, as an existing context with the same
+  // type and name is reported as an error.
+  tensorflow::Status ImportContext(Context context) {
+    const int64 exported_id = context.id();
+    int64 type_id;
+    TF_RETURN_IF_ERROR(
+        RemapId(context_type_ids_, "type", context.type_id(), &type_id));
+    context.clear_id();
+    context.set_type_id(type_id);
+    int64 context_id;
+    TF_RETURN_IF_ERROR(
+        metadata_access_object_->CreateContext(context, &context_id));
+    context_ids_[exported_id] = context_id;
+    context.set_id(context_id);
+    imported_records_.contexts.push_back(std::move(context));
+    return tensorflow::Status::OK();
+  }
+
+  tensorflow::Status AddEvent(Event event) {
+    int64 artifact_id;
+    int64 execution_id;
+    TF_RETURN_IF_ERROR(
+        RemapId(artifact_ids_, "artifact", event.artifact_id(), &artifact_id));
+    TF_RETURN_IF_ERROR(RemapId(execution_ids_, "execution",
+                               event.execution_id(), &execution_id));
+    event.set_artifact_id(artifact_id);
+    event.set_execution_id(execution_id);
+    events_.push_back(std::move(event));
+    return tensorflow::Status::OK();
+  }
+
+  tensorflow::Status AddAttribution(Attribution attribution) {
+    int64 artifact_id;
+    int64 context_id;
+    TF_RETURN_IF_ERROR(RemapId(artifact_ids_, "artifact",
+                               attribution.artifact_id(), &artifact_id));
+    TF_RETURN_IF_ERROR(RemapId(context_ids_, "context",
+                               attribution.context_id(), &context_id));
+    attribution.set_artifact_id(artifact_id);
+    attribution.set_context_id(context_id);
+    attributions_.push_back(std::move(attribution));
+    return tensorflow::Status::OK();
+  }
+
+  tensorflow::Status AddAssociation(Association association) {
+    int64 execution_id;
+    int64 context_id;
+    TF_RETURN_IF_ERROR(RemapId(execution_ids_, "execution",
+                               association.execution_id(), &execution_id));
+    TF_RETURN_IF_ERROR(RemapId(context_ids_, "context",
+                               association.context_id(), &context_id));
+    association.set_execution_id(execution_id);
+    association.set_context_id(context_id);
+    associations_.push_back(std::move(association));
+    return tensorflow::Status::OK();
+  }
+
+  MetadataAccessObject* const metadata_access_object_;
+  IdMap artifact_type_ids_;
+  IdMap execution_type_ids_;
+  IdMap context_type_ids_;
+  IdMap artifact_ids_;
+  IdMap execution_ids_;
+  IdMap context_ids_;
+  std::vector<ArtifactType> indexed_artifact_types_;
+  std::vector<ExecutionType> indexed_execution_types_;
+  std::vector<ContextType> indexed_context_types_;
+
+  // The kind of the buffered records.
+  StoreSnapshotRecord::RecordCase buffered_record_case_ =
+      StoreSnapshotRecord::RECORD_NOT_SET;
+  std::vector<Artifact> artifacts_;
+  std::vector<int64> exported_artifact_ids_;
+  std::vector<Execution> executions_;
+  std::vector<int64> exported_execution_ids_;
+  std::vector<Event> events_;
+  std::vector<Attribution> attributions_;
+  std::vector<Association> associations_;
+  ImportedRecords imported_records_;
+};
+
+}  // namespace
+
+tensorflow::Status ExportSnapshot(
+    const int64 page_size, MetadataSource* metadata_source,
+    MetadataAccessObject* metadata_access_object,
+    google::protobuf::io::ZeroCopyOutputStream* output) {
+  if (page_size <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        absl::StrCat("page_size should be positive: ", page_size));
+  }
+  TF_RETURN_IF_ERROR(ExecuteTransaction(
+      metadata_source,
+      [metadata_access_object, output]() -> tensorflow::Status {
+        TF_RETURN_IF_ERROR(
+            ExportTypes<ArtifactType>(metadata_access_object, output));
+        TF_RETURN_IF_ERROR(
+            ExportTypes<ExecutionType>(metadata_access_object, output));
+        return ExportTypes<ContextType>(metadata_access_object, output);
+      }));
+
+  // The ids are assigned in increasing order, so the records referring to the
+  // nodes with larger ids than the last exported ones refer to nodes created
+  // after their pages were read, and are skipped.
+  int64 last_context_id;
+  TF_RETURN_IF_ERROR(ExportNodes<Context>(
+      page_size, metadata_source, metadata_access_object,
+      [output](const std::vector<Context>& contexts) -> tensorflow::Status {
+        for (const Context& context : contexts) {
+          TF_RETURN_IF_ERROR(WriteRecord(context, output));
+        }
+        return tensorflow::Status::OK();
+      },
+      &last_context_id));
+
+  int64 last_artifact_id;
+  TF_RETURN_IF_ERROR(ExportNodes<Artifact>(
+      page_size, metadata_source, metadata_access_object,
+      [metadata_access_object, output, last_context_id](
+          const std::vector<Artifact>& artifacts) -> tensorflow::Status {
+        for (const Artifact& artifact : artifacts) {
+          TF_RETURN_IF_ERROR(WriteRecord(artifact, output));
+        }
+        std::vector<Attribution> attributions;
+        TF_RETURN_IF_ERROR(metadata_access_object->FindAttributionsByArtifacts(
+            NodeIds(artifacts), &attributions));
+        for (const Attribution& attribution : attributions) {
+          if (attribution.context_id() > last_context_id) continue;
+          TF_RETURN_IF_ERROR(WriteRecord(attribution, output));
+        }
+        return tensorflow::Status::OK();
+      },
+      &last_artifact_id));
+
+  int64 last_execution_id;
+  return ExportNodes<Execution>(
+      page_size, metadata_source, metadata_access_object,
+      [metadata_access_object, output, last_context_id, last_artifact_id](
+          const std::vector<Execution>& executions) -> tensorflow::Status {
+        for (const Execution& execution : executions) {
+          TF_RETURN_IF_ERROR(WriteRecord(execution, output));
+        }
+        const std::vector<int64> execution_ids = NodeIds(executions);
+        std::vector<Association> associations;
+        TF_RETURN_IF_ERROR(metadata_access_object->FindAssociationsByExecutions(
+            execution_ids, &associations));
+        for (const Association& association : associations) {
+          if (association.context_id() > last_context_id) continue;
+          TF_RETURN_IF_ERROR(WriteRecord(association, output));
+        }
+        std::vector<Event> events;
+        TF_RETURN_IF_ERROR(metadata_access_object->FindEventsByExecutions(
+            execution_ids, &events));
+        for (const Event& event : events) {
+          if (event.artifact_id() > last_artifact_id) continue;
+          TF_RETURN_IF_ERROR(WriteRecord(event, output));
+        }
+        return tensorflow::Status::OK();
+      },
+      &last_execution_id);
+}
+
+tensorflow::Status ImportSnapshot(
+    const int64 batch_size, const ExecuteTransactionFn& execute_transaction,
+    MetadataAccessObject* metadata_access_object,
+    const std::function<void(const ImportedRecords&)>& on_batch_imported,
+    google::protobuf::io::ZeroCopyInputStream* input) {
+  if (batch_size <= 0) {
+    return tensorflow::errors::InvalidArgument(
+        absl::StrCat("batch_size should be positive: ", batch_size));
+  }
+  SnapshotImporter importer(metadata_access_object);
+  bool clean_eof = false;
+  while (!clean_eof) {
+    TF_RETURN_IF_ERROR(execute_transaction(
+        [&importer, &clean_eof, &on_batch_imported, batch_size,
+         input]() -> tensorflow::Status {
+          StoreSnapshotRecord record;
+          for (int64 i = 0; i < batch_size; ++i) {
+            record.Clear();
+            if (!google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+                    &record, input, &clean_eof)) {
+              if (clean_eof) break;
+              return tensorflow::errors::InvalidArgument(
+                  "Cannot parse the store snapshot record.");
+            }
+            TF_RETURN_IF_ERROR(importer.Import(record));
+          }
+          TF_RETURN_IF_ERROR(importer.Flush());
+          on_batch_imported(importer.TakeImportedRecords());
+          return tensorflow::Status::OK();
+        }));
+    TF_RETURN_IF_ERROR(importer.CreatePropertyIndexes(execute_transaction));
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,86 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_STORE_SNAPSHOT_H_
+#define ML_METADATA_METADATA_STORE_STORE_SNAPSHOT_H_
+
+#include <functional>
+#include <vector>
+
+#include "google/protobuf/io/zero_copy_stream.h"
+#include "ml_metadata/metadata_store/metadata_access_object.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace ml_metadata {
+
+// Runs a transaction, e.g., by MetadataStore::ExecuteWriteTransaction.
+using ExecuteTransactionFn = std::function<tensorflow::Status(
+    const std::function<tensorflow::Status()>& transaction)>;
+
+// The records created by a batch of ImportSnapshot, with their new ids.
+struct ImportedRecords {
+  std::vector<Artifact> artifacts;
+  std::vector<Execution> executions;
+  std::vector<Context> contexts;
+  std::vector<Event> events;
+  std::vector<Attribution> attributions;
+  std::vector<Association> associations;
+};
+
+// Writes all types, nodes, events, attributions and associations of the
+// metadata source to `output`, as a stream of length-delimited
+// StoreSnapshotRecord messages. The nodes are read in pages of `page_size`
+// nodes in the order of their ids, so that the memory used does not grow with
+// the size of the store, and the attributions, associations and events of a
+// page are read with one query each. Each page is read in a transaction of its
+// own. The nodes created during the export are included if their pages have
+// not been read yet, and the records referring to the nodes that are not
+// exported are skipped, so the snapshot can always be imported.
+// Returns INVALID_ARGUMENT error, if `page_size` is not positive.
+// Returns INTERNAL error, if a record cannot be written to `output`.
+// Returns detailed INTERNAL error, if query execution fails.
+tensorflow::Status ExportSnapshot(
+    int64 page_size, MetadataSource* metadata_source,
+    MetadataAccessObject* metadata_access_object,
+    google::protobuf::io::ZeroCopyOutputStream* output);
+
+// Reads the records written by ExportSnapshot from `input`, and creates them
+// in the metadata source, running a transaction with `execute_transaction`
+// every `batch_size` records. The types are reused if types with the same
+// names and properties exist. The nodes, events, attributions and
+// associations are created with new ids, and the records referring to the
+// exported ids are remapped. The consecutive records of artifacts,
+// executions, events, attributions and associations within a batch are
+// created in bulk. The id maps grow with the number of nodes, while the
+// records are streamed. `on_batch_imported` is called in the transaction of
+// each batch with the records it created, e.g., to record them as changes of
+// the same transaction.
+// If an error is returned, the batches committed before it are kept.
+// Returns INVALID_ARGUMENT error, if `batch_size` is not positive, a record
+// cannot be parsed or refers to a type or node not imported before it.
+// Returns ALREADY_EXISTS error, if a context with the same type and name
+// exists, or a type with the same name has different properties.
+// Returns detailed INTERNAL error, if query execution fails.
+tensorflow::Status ImportSnapshot(
+    int64 batch_size, const ExecuteTransactionFn& execute_transaction,
+    MetadataAccessObject* metadata_access_object,
+    const std::function<void(const ImportedRecords&)>& on_batch_imported,
+    google::protobuf::io::ZeroCopyInputStream* input);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_STORE_SNAPSHOT_H_
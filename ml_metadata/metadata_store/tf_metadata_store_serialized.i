@@ -17,6 +17,9 @@ limitations under the License.
 %{
 // Do not call these methods directly. Prefer metadata_store.py.
 // For tests, see metadata_store_test.py
+#include "google/protobuf/arena.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
 
@@ -30,9 +33,29 @@ PyObject* ConvertToPythonString(const string& input_str) {
   return PyBytes_FromStringAndSize(input_str.data(), input_str.size());
 }
 
+// Holds a Python buffer, and releases it when going out of scope.
+class PyBufferHolder {
+ public:
+  PyBufferHolder() { view_.obj = nullptr; }
+  ~PyBufferHolder() { PyBuffer_Release(&view_); }
+  Py_buffer* view() { return &view_; }
+
+ private:
+  Py_buffer view_;
+};
+
+// A MetadataStore owned by python. The store methods are called without the
+// GIL, so that the python threads using different stores run in parallel.
+// MetadataStore is thread-unsafe, so the calls to the same store are
+// serialized by `mu`.
+struct PyMetadataStore {
+  std::unique_ptr<ml_metadata::MetadataStore> store;
+  absl::Mutex mu;
+};
+
 template<typename ProtoType>
-tensorflow::Status ParseProto(const string& input, ProtoType* proto) {
-  if (proto->ParseFromString(input)) {
+tensorflow::Status ParseProto(absl::string_view input, ProtoType* proto) {
+  if (proto->ParseFromArray(input.data(), input.size())) {
     return tensorflow::Status::OK();
   }
   return tensorflow::errors::InvalidArgument(
@@ -52,7 +75,7 @@ void set_exception_msg(const std::string& error_message) {
   create_metadata_store_err_msg[len] = '\0';
 }
 
-ml_metadata::MetadataStore* CreateMetadataStore(
+PyMetadataStore* CreateMetadataStore(
     const string& connection_config, const string& migration_options) {
   ml_metadata::ConnectionConfig proto_connection_config;
   ml_metadata::MigrationOptions proto_migration_options;
@@ -65,11 +88,11 @@ ml_metadata::MetadataStore* CreateMetadataStore(
     return NULL;
   }
 
-  std::unique_ptr<ml_metadata::MetadataStore> metadata_store;
+  std::unique_ptr<PyMetadataStore> metadata_store(new PyMetadataStore);
   tensorflow::Status status = ml_metadata::CreateMetadataStore(
       proto_connection_config,
       proto_migration_options,
-      &metadata_store);
+      &metadata_store->store);
   if (!status.ok()) {
     set_exception_msg(status.error_message());
     return NULL;
@@ -77,255 +100,288 @@ ml_metadata::MetadataStore* CreateMetadataStore(
   return metadata_store.release();
 }
 
-void DestroyMetadataStore(ml_metadata::MetadataStore* metadata_store) {
+void DestroyMetadataStore(PyMetadataStore* metadata_store) {
   if (metadata_store != nullptr) {
     delete metadata_store;
   }
 }
 
+// Serializes the message directly into the buffer of a new Python bytes
+// object, without an intermediate C++ string. The GIL is released while the
+// message is serialized, as no other thread can see the new object yet.
+PyObject* SerializeToPythonBytes(const google::protobuf::MessageLite& message) {
+  const size_t size = message.ByteSizeLong();
+  PyObject* bytes = PyBytes_FromStringAndSize(nullptr, size);
+  if (bytes == nullptr) return nullptr;
+  uint8_t* buffer = reinterpret_cast<uint8_t*>(PyBytes_AS_STRING(bytes));
+  Py_BEGIN_ALLOW_THREADS
+  message.SerializeWithCachedSizesToArray(buffer);
+  Py_END_ALLOW_THREADS
+  return bytes;
+}
+
 // Returns a native Python tuple:
 // (serialized_proto_message, status message, status code),
-// that can be deleted in Python safely.
+// that can be deleted in Python safely. The tuple owns its items.
 PyObject* ConvertAccessMetadataStoreResultToPyTuple(
-    const string& serialized_proto_message, const tensorflow::Status& status) {
-  return PyTuple_Pack(3, ConvertToPythonString(serialized_proto_message),
-  ConvertToPythonString(status.error_message()), PyInt_FromLong(status.code()));
+    const google::protobuf::MessageLite& proto_message,
+    const tensorflow::Status& status) {
+  return Py_BuildValue("(NNN)", SerializeToPythonBytes(proto_message),
+                       ConvertToPythonString(status.error_message()),
+                       PyInt_FromLong(status.code()));
+}
+
+// Deserializes the request to an object of type InputProto, and calls the
+// method of the store while holding its mutex. It does not access python
+// objects, so it can run without the GIL.
+template<typename InputProto, typename OutputProto>
+tensorflow::Status CallMetadataStore(
+    PyMetadataStore* metadata_store,
+    absl::string_view request,
+    tensorflow::Status(ml_metadata::MetadataStore::*method)(const InputProto&,
+        OutputProto*),
+    OutputProto* response) {
+  // The request is parsed on an arena, so that its many small messages are
+  // allocated in a few blocks and released at once. The response stays on the
+  // heap, as the store swaps its results into it without copying.
+  google::protobuf::Arena arena;
+  InputProto* proto_request =
+      google::protobuf::Arena::CreateMessage<InputProto>(&arena);
+  TF_RETURN_IF_ERROR(ParseProto(request, proto_request));
+
+  absl::MutexLock lock(&metadata_store->mu);
+  return ((*metadata_store->store).*method)(*proto_request, response);
 }
 
 // Given a method for MetadataStore of the form:
 // tensorflow::Status my_method(const InputProto& input, OutputProto* output);
 // this method will deserialize the request to an object of type InputProto,
-// and serialize the result to a python string object. If there is an error,
-// out_status will be set.
+// and serialize the result to a python bytes object. If there is an error,
+// out_status will be set. The GIL is released during the call.
+// The request is read in place from any object supporting the buffer
+// protocol, e.g., bytes or memoryview, and the result is serialized into the
+// returned bytes object, so the payloads are not copied between C++ and
+// python.
 template<typename InputProto, typename OutputProto>
 PyObject* AccessMetadataStore(
-    ml_metadata::MetadataStore* metadata_store,
-    const string& request,
+    PyMetadataStore* metadata_store,
+    absl::string_view request,
     tensorflow::Status(ml_metadata::MetadataStore::*method)(const InputProto&,
         OutputProto*)) {
-  InputProto proto_request;
-  tensorflow::Status parse_result = ParseProto(request, &proto_request);
-  if (!parse_result.ok()) {
-    return ConvertAccessMetadataStoreResultToPyTuple(
-        /* serialized_proto_message */ "",
-        parse_result);
-  }
-
-  OutputProto proto_response;
-
-  tensorflow::Status status = ((*metadata_store).*method)(proto_request,
-                                                          &proto_response);
-  string response;
-  proto_response.SerializeToString(&response);
+  OutputProto response;
+  tensorflow::Status status;
+  Py_BEGIN_ALLOW_THREADS
+  status = CallMetadataStore(metadata_store, request, method, &response);
+  Py_END_ALLOW_THREADS
   return ConvertAccessMetadataStoreResultToPyTuple(response, status);
 }
 
-PyObject* GetArtifactType(ml_metadata::MetadataStore* metadata_store,
-                          const string& request) {
+PyObject* GetArtifactType(PyMetadataStore* metadata_store,
+                          absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetArtifactType);
 }
 
-PyObject* PutArtifacts(ml_metadata::MetadataStore* metadata_store,
-                       const string& request) {
+PyObject* PutArtifacts(PyMetadataStore* metadata_store,
+                       absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::PutArtifacts);
 }
 
-PyObject* GetArtifactsByID(ml_metadata::MetadataStore* metadata_store,
-                           const string& request) {
+PyObject* GetArtifactsByID(PyMetadataStore* metadata_store,
+                           absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetArtifactsByID);
 }
 
-PyObject* GetArtifactsByType(ml_metadata::MetadataStore* metadata_store,
-                             const string& request) {
+PyObject* GetArtifactsByType(PyMetadataStore* metadata_store,
+                             absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetArtifactsByType);
 }
 
-PyObject* GetArtifactsByURI(ml_metadata::MetadataStore* metadata_store,
-                             const string& request) {
+PyObject* GetArtifactsByURI(PyMetadataStore* metadata_store,
+                             absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetArtifactsByURI);
 }
 
-PyObject* PutArtifactType(ml_metadata::MetadataStore* metadata_store,
-                          const string& request) {
+PyObject* PutArtifactType(PyMetadataStore* metadata_store,
+                          absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::PutArtifactType);
 }
 
-PyObject* GetExecutionType(ml_metadata::MetadataStore* metadata_store,
-                           const string& request) {
+PyObject* GetExecutionType(PyMetadataStore* metadata_store,
+                           absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetExecutionType);
 }
 
-PyObject* GetExecutionTypes(ml_metadata::MetadataStore* metadata_store,
-                            const string& request) {
+PyObject* GetExecutionTypes(PyMetadataStore* metadata_store,
+                            absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetExecutionTypes);
 }
 
-PyObject* GetArtifactTypes(ml_metadata::MetadataStore* metadata_store,
-                           const string& request) {
+PyObject* GetArtifactTypes(PyMetadataStore* metadata_store,
+                           absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetArtifactTypes);
 }
 
-PyObject* PutExecutions(ml_metadata::MetadataStore* metadata_store,
-                        const string& request) {
+PyObject* PutExecutions(PyMetadataStore* metadata_store,
+                        absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::PutExecutions);
 }
 
-PyObject* GetExecutionsByID(ml_metadata::MetadataStore* metadata_store,
-                            const string& request) {
+PyObject* GetExecutionsByID(PyMetadataStore* metadata_store,
+                            absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetExecutionsByID);
 }
 
-PyObject* GetExecutionsByType(ml_metadata::MetadataStore* metadata_store,
-                              const string& request) {
+PyObject* GetExecutionsByType(PyMetadataStore* metadata_store,
+                              absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetExecutionsByType);
 }
 
-PyObject* PutExecutionType(ml_metadata::MetadataStore* metadata_store,
-                           const string& request) {
+PyObject* PutExecutionType(PyMetadataStore* metadata_store,
+                           absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::PutExecutionType);
 }
 
-PyObject* PutEvents(ml_metadata::MetadataStore* metadata_store,
-                    const string& request) {
+PyObject* PutEvents(PyMetadataStore* metadata_store,
+                    absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::PutEvents);
 }
 
-PyObject* PutExecution(ml_metadata::MetadataStore* metadata_store,
-    const string& request) {
+PyObject* PutExecution(PyMetadataStore* metadata_store,
+    absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::PutExecution);
 }
 
-PyObject* GetEventsByExecutionIDs(ml_metadata::MetadataStore* metadata_store,
-                                  const string& request) {
+PyObject* GetEventsByExecutionIDs(PyMetadataStore* metadata_store,
+                                  absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetEventsByExecutionIDs);
 }
 
-PyObject* GetArtifactTypesByID(ml_metadata::MetadataStore* metadata_store,
-                               const string& request) {
+PyObject* GetArtifactTypesByID(PyMetadataStore* metadata_store,
+                               absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetArtifactTypesByID);
 }
 
-PyObject* GetExecutionTypesByID(ml_metadata::MetadataStore* metadata_store,
-                                const string& request) {
+PyObject* GetExecutionTypesByID(PyMetadataStore* metadata_store,
+                                absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetExecutionTypesByID);
 }
 
-PyObject* GetEventsByArtifactIDs(ml_metadata::MetadataStore* metadata_store,
-                                 const string& request) {
+PyObject* GetEventsByArtifactIDs(PyMetadataStore* metadata_store,
+                                 absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetEventsByArtifactIDs);
 }
 
-PyObject* GetArtifacts(ml_metadata::MetadataStore* metadata_store,
-                       const string& request) {
+PyObject* GetArtifacts(PyMetadataStore* metadata_store,
+                       absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetArtifacts);
 }
 
-PyObject* GetExecutions(ml_metadata::MetadataStore* metadata_store,
-                        const string& request) {
+PyObject* GetExecutions(PyMetadataStore* metadata_store,
+                        absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetExecutions);
 }
 
-PyObject* PutContextType(ml_metadata::MetadataStore* metadata_store,
-                         const string& request) {
+PyObject* PutContextType(PyMetadataStore* metadata_store,
+                         absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::PutContextType);
 }
 
-PyObject* GetContextType(ml_metadata::MetadataStore* metadata_store,
-                         const string& request) {
+PyObject* GetContextType(PyMetadataStore* metadata_store,
+                         absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetContextType);
 }
 
-PyObject* GetContextTypes(ml_metadata::MetadataStore* metadata_store,
-                          const string& request) {
+PyObject* GetContextTypes(PyMetadataStore* metadata_store,
+                          absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetContextTypes);
 }
 
-PyObject* GetContextTypesByID(ml_metadata::MetadataStore* metadata_store,
-                              const string& request) {
+PyObject* GetContextTypesByID(PyMetadataStore* metadata_store,
+                              absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetContextTypesByID);
 }
 
-PyObject* PutContexts(ml_metadata::MetadataStore* metadata_store,
-                      const string& request) {
+PyObject* PutContexts(PyMetadataStore* metadata_store,
+                      absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::PutContexts);
 }
 
-PyObject* GetContextsByID(ml_metadata::MetadataStore* metadata_store,
-                          const string& request) {
+PyObject* GetContextsByID(PyMetadataStore* metadata_store,
+                          absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetContextsByID);
 }
 
-PyObject* GetContexts(ml_metadata::MetadataStore* metadata_store,
-                      const string& request) {
+PyObject* GetContexts(PyMetadataStore* metadata_store,
+                      absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetContexts);
 }
 
-PyObject* GetContextsByType(ml_metadata::MetadataStore* metadata_store,
-                            const string& request) {
+PyObject* GetContextsByType(PyMetadataStore* metadata_store,
+                            absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetContextsByType);
 }
 
-PyObject* GetContextByTypeAndName(ml_metadata::MetadataStore* metadata_store,
-                                  const string& request) {
+PyObject* GetContextByTypeAndName(PyMetadataStore* metadata_store,
+                                  absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetContextByTypeAndName);
 }
 
 PyObject* PutAttributionsAndAssociations(
-    ml_metadata::MetadataStore* metadata_store, const string& request) {
+    PyMetadataStore* metadata_store, absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::PutAttributionsAndAssociations);
 }
 
-PyObject* GetContextsByArtifact(ml_metadata::MetadataStore* metadata_store,
-                                const string& request) {
+PyObject* GetContextsByArtifact(PyMetadataStore* metadata_store,
+                                absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetContextsByArtifact);
 }
 
-PyObject* GetContextsByExecution(ml_metadata::MetadataStore* metadata_store,
-                                 const string& request) {
+PyObject* GetContextsByExecution(PyMetadataStore* metadata_store,
+                                 absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetContextsByExecution);
 }
 
-PyObject* GetArtifactsByContext(ml_metadata::MetadataStore* metadata_store,
-                                const string& request) {
+PyObject* GetArtifactsByContext(PyMetadataStore* metadata_store,
+                                absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetArtifactsByContext);
 }
 
-PyObject* GetExecutionsByContext(ml_metadata::MetadataStore* metadata_store,
-                                 const string& request) {
+PyObject* GetExecutionsByContext(PyMetadataStore* metadata_store,
+                                 absl::string_view request) {
   return AccessMetadataStore(metadata_store, request,
       &ml_metadata::MetadataStore::GetExecutionsByContext);
 }
@@ -342,6 +398,14 @@ PyObject* GetExecutionsByContext(ml_metadata::MetadataStore* metadata_store,
   $1 = &temp;
 }
 
+// Typemap to read a request in place from a Python object supporting the
+// buffer protocol. The buffer is held until the call returns.
+%typemap(in) absl::string_view request (PyBufferHolder buffer) {
+  Py_buffer* view = buffer.view();
+  if (PyObject_GetBuffer($input, view, PyBUF_SIMPLE) == -1) SWIG_fail;
+  $1 = absl::string_view(static_cast<const char*>(view->buf), view->len);
+}
+
 %newobject CreateMetadataStore;
 %delobject DestroyMetadataStore;
 
@@ -353,114 +417,114 @@ PyObject* GetExecutionsByContext(ml_metadata::MetadataStore* metadata_store,
   }
 }
 
-ml_metadata::MetadataStore* CreateMetadataStore(
+PyMetadataStore* CreateMetadataStore(
     const string& connection_config, const string& migration_options);
 
-void DestroyMetadataStore(ml_metadata::MetadataStore* metadata_store);
+void DestroyMetadataStore(PyMetadataStore* metadata_store);
 
 
-PyObject* PutArtifactType(ml_metadata::MetadataStore* metadata_store,
-                          const string& request);
+PyObject* PutArtifactType(PyMetadataStore* metadata_store,
+                          absl::string_view request);
 
-PyObject* PutArtifacts(ml_metadata::MetadataStore* metadata_store,
-                       const string& request);
+PyObject* PutArtifacts(PyMetadataStore* metadata_store,
+                       absl::string_view request);
 
-PyObject* GetArtifactType(ml_metadata::MetadataStore* metadata_store,
-                          const string& request);
+PyObject* GetArtifactType(PyMetadataStore* metadata_store,
+                          absl::string_view request);
 
-PyObject* GetArtifactTypes(ml_metadata::MetadataStore* metadata_store,
-                           const string& request);
+PyObject* GetArtifactTypes(PyMetadataStore* metadata_store,
+                           absl::string_view request);
 
-PyObject* GetArtifactsByID(ml_metadata::MetadataStore* metadata_store,
-                           const string& request);
+PyObject* GetArtifactsByID(PyMetadataStore* metadata_store,
+                           absl::string_view request);
 
-PyObject* GetArtifactsByType(ml_metadata::MetadataStore* metadata_store,
-                             const string& request);
+PyObject* GetArtifactsByType(PyMetadataStore* metadata_store,
+                             absl::string_view request);
 
-PyObject* GetArtifactsByURI(ml_metadata::MetadataStore* metadata_store,
-                            const string& request);
+PyObject* GetArtifactsByURI(PyMetadataStore* metadata_store,
+                            absl::string_view request);
 
-PyObject* PutExecutionType(ml_metadata::MetadataStore* metadata_store,
-                           const string& request);
+PyObject* PutExecutionType(PyMetadataStore* metadata_store,
+                           absl::string_view request);
 
-PyObject* PutExecutions(ml_metadata::MetadataStore* metadata_store,
-                        const string& request);
+PyObject* PutExecutions(PyMetadataStore* metadata_store,
+                        absl::string_view request);
 
-PyObject* GetExecutionType(ml_metadata::MetadataStore* metadata_store,
-                           const string& request);
+PyObject* GetExecutionType(PyMetadataStore* metadata_store,
+                           absl::string_view request);
 
-PyObject* GetExecutionTypes(ml_metadata::MetadataStore* metadata_store,
-                           const string& request);
+PyObject* GetExecutionTypes(PyMetadataStore* metadata_store,
+                           absl::string_view request);
 
-PyObject* GetExecutionsByID(ml_metadata::MetadataStore* metadata_store,
-                            const string& request);
+PyObject* GetExecutionsByID(PyMetadataStore* metadata_store,
+                            absl::string_view request);
 
-PyObject* GetExecutionsByType(ml_metadata::MetadataStore* metadata_store,
-                              const string& request);
+PyObject* GetExecutionsByType(PyMetadataStore* metadata_store,
+                              absl::string_view request);
 
-PyObject* PutContextType(ml_metadata::MetadataStore* metadata_store,
-                         const string& request);
+PyObject* PutContextType(PyMetadataStore* metadata_store,
+                         absl::string_view request);
 
-PyObject* GetContextType(ml_metadata::MetadataStore* metadata_store,
-                         const string& request);
+PyObject* GetContextType(PyMetadataStore* metadata_store,
+                         absl::string_view request);
 
-PyObject* GetContextTypes(ml_metadata::MetadataStore* metadata_store,
-                          const string& request);
+PyObject* GetContextTypes(PyMetadataStore* metadata_store,
+                          absl::string_view request);
 
-PyObject* GetArtifactTypesByID(ml_metadata::MetadataStore* metadata_store,
-    const string& request);
+PyObject* GetArtifactTypesByID(PyMetadataStore* metadata_store,
+    absl::string_view request);
 
-PyObject* GetExecutionTypesByID(ml_metadata::MetadataStore* metadata_store,
-    const string& request);
+PyObject* GetExecutionTypesByID(PyMetadataStore* metadata_store,
+    absl::string_view request);
 
-PyObject* GetContextTypesByID(ml_metadata::MetadataStore* metadata_store,
-    const string& request);
+PyObject* GetContextTypesByID(PyMetadataStore* metadata_store,
+    absl::string_view request);
 
-PyObject* PutEvents(ml_metadata::MetadataStore* metadata_store,
-                    const string& request);
+PyObject* PutEvents(PyMetadataStore* metadata_store,
+                    absl::string_view request);
 
-PyObject* PutExecution(ml_metadata::MetadataStore* metadata_store,
-                       const string& request);
+PyObject* PutExecution(PyMetadataStore* metadata_store,
+                       absl::string_view request);
 
-PyObject* GetEventsByExecutionIDs(ml_metadata::MetadataStore* metadata_store,
-                                  const string& request);
+PyObject* GetEventsByExecutionIDs(PyMetadataStore* metadata_store,
+                                  absl::string_view request);
 
-PyObject* GetEventsByArtifactIDs(ml_metadata::MetadataStore* metadata_store,
-    const string& request);
+PyObject* GetEventsByArtifactIDs(PyMetadataStore* metadata_store,
+    absl::string_view request);
 
-PyObject* GetArtifacts(ml_metadata::MetadataStore* metadata_store,
-    const string& request);
+PyObject* GetArtifacts(PyMetadataStore* metadata_store,
+    absl::string_view request);
 
-PyObject* GetExecutions(ml_metadata::MetadataStore* metadata_store,
-    const string& request);
+PyObject* GetExecutions(PyMetadataStore* metadata_store,
+    absl::string_view request);
 
-PyObject* PutContexts(ml_metadata::MetadataStore* metadata_store,
-                      const string& request);
+PyObject* PutContexts(PyMetadataStore* metadata_store,
+                      absl::string_view request);
 
-PyObject* GetContextsByID(ml_metadata::MetadataStore* metadata_store,
-                          const string& request);
+PyObject* GetContextsByID(PyMetadataStore* metadata_store,
+                          absl::string_view request);
 
-PyObject* GetContexts(ml_metadata::MetadataStore* metadata_store,
-                      const string& request);
+PyObject* GetContexts(PyMetadataStore* metadata_store,
+                      absl::string_view request);
 
-PyObject* GetContextsByType(ml_metadata::MetadataStore* metadata_store,
-                            const string& request);
+PyObject* GetContextsByType(PyMetadataStore* metadata_store,
+                            absl::string_view request);
 
-PyObject* GetContextByTypeAndName(ml_metadata::MetadataStore* metadata_store,
-                                  const string& request);
+PyObject* GetContextByTypeAndName(PyMetadataStore* metadata_store,
+                                  absl::string_view request);
 
 PyObject* PutAttributionsAndAssociations(
-    ml_metadata::MetadataStore* metadata_store, const string& request);
+    PyMetadataStore* metadata_store, absl::string_view request);
 
-PyObject* GetContextsByArtifact(ml_metadata::MetadataStore* metadata_store,
-                                const string& request);
+PyObject* GetContextsByArtifact(PyMetadataStore* metadata_store,
+                                absl::string_view request);
 
-PyObject* GetContextsByExecution(ml_metadata::MetadataStore* metadata_store,
-                                 const string& request);
+PyObject* GetContextsByExecution(PyMetadataStore* metadata_store,
+                                 absl::string_view request);
 
-PyObject* GetArtifactsByContext(ml_metadata::MetadataStore* metadata_store,
-                                const string& request);
+PyObject* GetArtifactsByContext(PyMetadataStore* metadata_store,
+                                absl::string_view request);
 
-PyObject* GetExecutionsByContext(ml_metadata::MetadataStore* metadata_store,
-                                 const string& request);
+PyObject* GetExecutionsByContext(PyMetadataStore* metadata_store,
+                                 absl::string_view request);
 
@@ -28,7 +28,7 @@ namespace {
 // no-lint to support vc (C2026) 16380 max length for char[].
 const std::string kBaseQueryConfig = absl::StrCat( // NOLINT
 R"pb(
-  schema_version: 5
+  schema_version: 8
   drop_type_table { query: " DROP TABLE IF EXISTS `Type`; " }
   create_type_table {
     query: " CREATE TABLE IF NOT EXISTS `Type` ( "
@@ -92,10 +92,11 @@ R"pb(
            "   `type_id` INT NOT NULL, "
            "   `name` VARCHAR(255) NOT NULL, "
            "   `data_type` INT NULL, "
+           "   `is_indexed` TINYINT(1) NOT NULL DEFAULT 0, "
            " PRIMARY KEY (`type_id`, `name`)); "
   }
   check_type_property_table {
-    query: " SELECT `type_id`, `name`, `data_type` "
+    query: " SELECT `type_id`, `name`, `data_type`, `is_indexed` "
            " FROM `TypeProperty` LIMIT 1; "
   }
   insert_type_property {
@@ -110,7 +111,56 @@ R"pb(
            " WHERE `type_id` = $0; "
     parameter_num: 1
   }
+  update_type_property_is_indexed {
+    query: " UPDATE `TypeProperty` SET `is_indexed` = 1 "
+           " WHERE `type_id` = $0 AND `name` = $1; "
+    parameter_num: 2
+  }
+  select_indexed_property_by_type_id {
+    query: " SELECT `name` from `TypeProperty` "
+           " WHERE `type_id` = $0 AND `is_indexed` = 1 ORDER BY `name`; "
+    parameter_num: 1
+  }
+  check_property_index {
+    query: " SELECT `name` FROM `sqlite_master` "
+           " WHERE `type` = 'index' AND `name` = 'idx_$0_$1'; "
+    parameter_num: 2
+  }
+  select_table_columns {
+    query: " SELECT `m`.`name`, `p`.`name` "
+           " FROM `sqlite_master` AS `m`, pragma_table_info(`m`.`name`) AS `p` "
+           " WHERE `m`.`type` = 'table'; "
+  }
+  create_int_property_index {
+    query: " CREATE INDEX `idx_$0_int_value` "
+           " ON `$0`(`name`, `is_custom_property`, `int_value`); "
+    parameter_num: 1
+  }
+  create_double_property_index {
+    query: " CREATE INDEX `idx_$0_double_value` "
+           " ON `$0`(`name`, `is_custom_property`, `double_value`); "
+    parameter_num: 1
+  }
+  create_string_property_index {
+    query: " CREATE INDEX `idx_$0_string_value` "
+           " ON `$0`(`name`, `is_custom_property`, `string_value`); "
+    parameter_num: 1
+  }
+  create_last_update_time_index {
+    query: " CREATE INDEX `idx_$0_last_update_time_since_epoch` "
+           " ON `$0`(`last_update_time_since_epoch`); "
+    parameter_num: 1
+  }
+  select_existing_node_ids {
+    query: " SELECT `id` FROM `$0` WHERE `id` IN ($1); "
+    parameter_num: 2
+  }
   select_last_insert_id { query: " SELECT last_insert_rowid(); " }
+  select_first_insert_id {
+    query: " SELECT last_insert_rowid() - $0 + 1; "
+    parameter_num: 1
+  }
+  select_consecutive_insert_ids { query: " SELECT 1; " }
 )pb",
 R"pb(
   drop_artifact_table { query: " DROP TABLE IF EXISTS `Artifact`; " }
@@ -123,39 +173,57 @@ R"pb(
            "   `name` VARCHAR(255), "
            "   `create_time_since_epoch` INT NOT NULL DEFAULT 0, "
            "   `last_update_time_since_epoch` INT NOT NULL DEFAULT 0, "
+           "   `packed_properties` TEXT, "
            "   UNIQUE(`type_id`, `name`) "
            " ); "
   }
   check_artifact_table {
     query: " SELECT `id`, `type_id`, `uri`, `state`, `name`, "
-           "        `create_time_since_epoch`, `last_update_time_since_epoch` "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        `packed_properties` "
            " FROM `Artifact` LIMIT 1; "
   }
   insert_artifact {
     query: " INSERT INTO `Artifact`( "
-           "   `type_id`, `uri` "
-           ") VALUES($0, $1);"
-    parameter_num: 2
+           "   `type_id`, `uri`, `state`, `name`, `create_time_since_epoch`, "
+           "   `last_update_time_since_epoch`, `packed_properties` "
+           ") VALUES($0, $1, $2, $4, $3, $3, $5);"
+    parameter_num: 6
+  }
+  insert_artifacts {
+    query: " INSERT INTO `Artifact`( "
+           "   `type_id`, `uri`, `state`, `name`, `create_time_since_epoch`, "
+           "   `last_update_time_since_epoch`, `packed_properties` "
+           ") VALUES $0;"
+    parameter_num: 1
   }
   select_artifact_by_id {
-    query: " SELECT `type_id`, `uri` "
+    query: " SELECT `type_id`, `uri`, `state`, `name`, `packed_properties` "
            " from `Artifact` "
            " WHERE id = $0; "
     parameter_num: 1
   }
   select_artifacts_by_type_id {
-    query: " SELECT `id` from `Artifact` WHERE `type_id` = $0; "
+    query: " SELECT `id` from `Artifact` "
+           " WHERE `type_id` = $0 ORDER BY `id`; "
     parameter_num: 1
   }
   select_artifacts_by_uri {
     query: " SELECT `id` from `Artifact` WHERE `uri` = $0; "
     parameter_num: 1
   }
+  select_artifacts_by_type_id_and_names {
+    query: " SELECT `id` from `Artifact` "
+           " WHERE `type_id` = $0 and `name` IN ($1) ORDER BY `id`; "
+    parameter_num: 2
+  }
   update_artifact {
     query: " UPDATE `Artifact` "
-           " SET `type_id` = $1, `uri` = $2"
+           " SET `type_id` = $1, `uri` = $2, `state` = $3, `name` = $5, "
+           "     `last_update_time_since_epoch` = $4, "
+           "     `packed_properties` = $6 "
            " WHERE id = $0;"
-    parameter_num: 3
+    parameter_num: 7
   }
   drop_artifact_property_table {
     query: " DROP TABLE IF EXISTS `ArtifactProperty`; "
@@ -181,6 +249,13 @@ R"pb(
            ") VALUES($1, $2, $3, $4);"
     parameter_num: 5
   }
+  insert_artifact_properties {
+    query: " INSERT INTO `ArtifactProperty`( "
+           "   `artifact_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_artifact_property_by_artifact_id {
     query: " SELECT `name` as `key`, `is_custom_property`, "
            "        `int_value`, `double_value`, `string_value` "
@@ -188,6 +263,13 @@ R"pb(
            " WHERE `artifact_id` = $0; "
     parameter_num: 1
   }
+  select_artifact_property_by_artifact_id_and_names {
+    query: " SELECT `name` as `key`, `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " from `ArtifactProperty` "
+           " WHERE `artifact_id` = $0 AND `name` IN ($1); "
+    parameter_num: 2
+  }
   update_artifact_property {
     query: " UPDATE `ArtifactProperty` "
            " SET `$0` = $1 "
@@ -210,35 +292,55 @@ R"pb(
            "   `name` VARCHAR(255), "
            "   `create_time_since_epoch` INT NOT NULL DEFAULT 0, "
            "   `last_update_time_since_epoch` INT NOT NULL DEFAULT 0, "
+           "   `packed_properties` TEXT, "
            "   UNIQUE(`type_id`, `name`) "
            " ); "
   }
   check_execution_table {
     query: " SELECT `id`, `type_id`, `last_known_state`, `name`, "
-           "        `create_time_since_epoch`, `last_update_time_since_epoch` "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        `packed_properties` "
            " FROM `Execution` LIMIT 1; "
   }
   insert_execution {
     query: " INSERT INTO `Execution`( "
-           "   `type_id` "
-           ") VALUES($0);"
+           "   `type_id`, `last_known_state`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "   `packed_properties` "
+           ") VALUES($0, $1, $3, $2, $2, $4);"
+    parameter_num: 5
+  }
+  insert_executions {
+    query: " INSERT INTO `Execution`( "
+           "   `type_id`, `last_known_state`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "   `packed_properties` "
+           ") VALUES $0;"
     parameter_num: 1
   }
   select_execution_by_id {
-    query: " SELECT `type_id` "
+    query: " SELECT `type_id`, `last_known_state`, `name`, `packed_properties` "
            " from `Execution` "
            " WHERE id = $0; "
     parameter_num: 1
   }
   select_executions_by_type_id {
-    query: " SELECT `id` from `Execution` WHERE `type_id` = $0; "
+    query: " SELECT `id` from `Execution` "
+           " WHERE `type_id` = $0 ORDER BY `id`; "
     parameter_num: 1
   }
+  select_executions_by_type_id_and_names {
+    query: " SELECT `id` from `Execution` "
+           " WHERE `type_id` = $0 and `name` IN ($1) ORDER BY `id`; "
+    parameter_num: 2
+  }
   update_execution {
     query: " UPDATE `Execution` "
-           " SET `type_id` = $1 "
+           " SET `type_id` = $1, `last_known_state` = $2, `name` = $4, "
+           "     `last_update_time_since_epoch` = $3, "
+           "     `packed_properties` = $5 "
            " WHERE id = $0;"
-    parameter_num: 2
+    parameter_num: 6
   }
   drop_execution_property_table {
     query: " DROP TABLE IF EXISTS `ExecutionProperty`; "
@@ -264,6 +366,13 @@ R"pb(
            ") VALUES($1, $2, $3, $4);"
     parameter_num: 5
   }
+  insert_execution_properties {
+    query: " INSERT INTO `ExecutionProperty`( "
+           "   `execution_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_execution_property_by_execution_id {
     query: " SELECT `name` as `key`, `is_custom_property`, "
            "        `int_value`, `double_value`, `string_value` "
@@ -271,6 +380,13 @@ R"pb(
            " WHERE `execution_id` = $0; "
     parameter_num: 1
   }
+  select_execution_property_by_execution_id_and_names {
+    query: " SELECT `name` as `key`, `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " from `ExecutionProperty` "
+           " WHERE `execution_id` = $0 AND `name` IN ($1); "
+    parameter_num: 2
+  }
   update_execution_property {
     query: " UPDATE `ExecutionProperty` "
            " SET `$0` = $1 "
@@ -292,37 +408,49 @@ R"pb(
            "   `name` VARCHAR(255) NOT NULL, "
            "   `create_time_since_epoch` INT NOT NULL DEFAULT 0, "
            "   `last_update_time_since_epoch` INT NOT NULL DEFAULT 0, "
+           "   `packed_properties` TEXT, "
            "   UNIQUE(`type_id`, `name`) "
            " ); "
   }
   check_context_table {
     query: " SELECT `id`, `type_id`, `name`, "
-           "        `create_time_since_epoch`, `last_update_time_since_epoch` "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        `packed_properties` "
            " FROM `Context` LIMIT 1; "
   }
   insert_context {
     query: " INSERT INTO `Context`( "
-           "   `type_id`, `name` "
-           ") VALUES($0, $1);"
-    parameter_num: 2
+           "   `type_id`, `name`, `create_time_since_epoch`, "
+           "   `last_update_time_since_epoch`, `packed_properties` "
+           ") VALUES($0, $1, $2, $2, $3);"
+    parameter_num: 4
   }
   select_context_by_id {
-    query: " SELECT `type_id`, `name` from `Context` WHERE id = $0; "
+    query: " SELECT `type_id`, `name`, `packed_properties` "
+           " from `Context` WHERE id = $0; "
     parameter_num: 1
   }
   select_contexts_by_type_id {
-    query: " SELECT `id` from `Context` WHERE `type_id` = $0; "
+    query: " SELECT `id` from `Context` "
+           " WHERE `type_id` = $0 ORDER BY `id`; "
     parameter_num: 1
   }
   select_context_by_type_id_and_name {
     query: " SELECT `id` from `Context` WHERE `type_id` = $0 and `name` = $1; "
     parameter_num: 2
   }
+  select_contexts_by_type_id_and_names {
+    query: " SELECT `id` from `Context` "
+           " WHERE `type_id` = $0 and `name` IN ($1) ORDER BY `id`; "
+    parameter_num: 2
+  }
   update_context {
     query: " UPDATE `Context` "
-           " SET `type_id` = $1, `name` = $2"
+           " SET `type_id` = $1, `name` = $2, "
+           "     `last_update_time_since_epoch` = $3, "
+           "     `packed_properties` = $4 "
            " WHERE id = $0;"
-    parameter_num: 3
+    parameter_num: 5
   }
   drop_context_property_table {
     query: " DROP TABLE IF EXISTS `ContextProperty`; "
@@ -355,6 +483,13 @@ R"pb(
            " WHERE `context_id` = $0; "
     parameter_num: 1
   }
+  select_context_property_by_context_id_and_names {
+    query: " SELECT `name` as `key`, `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " from `ContextProperty` "
+           " WHERE `context_id` = $0 AND `name` IN ($1); "
+    parameter_num: 2
+  }
   update_context_property {
     query: " UPDATE `ContextProperty` "
            " SET `$0` = $1 "
@@ -390,6 +525,13 @@ R"pb(
            ") VALUES($0, $1, $2, $3);"
     parameter_num: 4
   }
+  insert_events {
+    query: " INSERT INTO `Event`( "
+           "   `artifact_id`, `execution_id`, `type`, "
+           "   `milliseconds_since_epoch` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_event_by_artifact_id {
     query: " SELECT `id`, `artifact_id`, `execution_id`, "
            "        `type`, `milliseconds_since_epoch` "
@@ -404,6 +546,13 @@ R"pb(
            " WHERE `execution_id` = $0; "
     parameter_num: 1
   }
+  select_events_by_execution_ids {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch` "
+           " from `Event` "
+           " WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
   drop_event_path_table { query: " DROP TABLE IF EXISTS `EventPath`; " }
   create_event_path_table {
     query: " CREATE TABLE IF NOT EXISTS `EventPath` ( "
@@ -423,12 +572,134 @@ R"pb(
            ") VALUES($0, $2, $3);"
     parameter_num: 4
   }
+  insert_event_paths {
+    query: " INSERT INTO `EventPath`( "
+           "   `event_id`, `is_index_step`, `step_index`, `step_key` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_event_path_by_event_id {
     query: " SELECT `event_id`, `is_index_step`, `step_index`, `step_key` "
            " from `EventPath` "
            " WHERE `event_id` = $0; "
     parameter_num: 1
   }
+  select_event_paths_by_event_ids {
+    query: " SELECT `event_id`, `is_index_step`, `step_index`, `step_key` "
+           " from `EventPath` "
+           " WHERE `event_id` IN ($0); "
+    parameter_num: 1
+  }
+)pb",
+R"pb(
+  delete_artifacts {
+    count_rows {
+      query: " SELECT "
+             "   (SELECT COUNT(*) FROM `Artifact` WHERE `id` IN ($0)) "
+             "     AS `Artifact`, "
+             "   (SELECT COUNT(*) FROM `ArtifactProperty` "
+             "    WHERE `artifact_id` IN ($0)) AS `ArtifactProperty`, "
+             "   (SELECT COUNT(*) FROM `Event` WHERE `artifact_id` IN ($0)) "
+             "     AS `Event`, "
+             "   (SELECT COUNT(*) FROM `EventPath` WHERE `event_id` IN ( "
+             "      SELECT `id` FROM `Event` WHERE `artifact_id` IN ($0) "
+             "    )) AS `EventPath`, "
+             "   (SELECT COUNT(*) FROM `Attribution` "
+             "    WHERE `artifact_id` IN ($0)) AS `Attribution`; "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `EventPath` WHERE `event_id` IN ( "
+             "   SELECT `id` FROM `Event` WHERE `artifact_id` IN ($0) "
+             " ); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `Event` WHERE `artifact_id` IN ($0); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `Attribution` WHERE `artifact_id` IN ($0); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `ArtifactProperty` WHERE `artifact_id` IN ($0); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `Artifact` WHERE `id` IN ($0); "
+      parameter_num: 1
+    }
+  }
+  delete_executions {
+    count_rows {
+      query: " SELECT "
+             "   (SELECT COUNT(*) FROM `Execution` WHERE `id` IN ($0)) "
+             "     AS `Execution`, "
+             "   (SELECT COUNT(*) FROM `ExecutionProperty` "
+             "    WHERE `execution_id` IN ($0)) AS `ExecutionProperty`, "
+             "   (SELECT COUNT(*) FROM `Event` WHERE `execution_id` IN ($0)) "
+             "     AS `Event`, "
+             "   (SELECT COUNT(*) FROM `EventPath` WHERE `event_id` IN ( "
+             "      SELECT `id` FROM `Event` WHERE `execution_id` IN ($0) "
+             "    )) AS `EventPath`, "
+             "   (SELECT COUNT(*) FROM `Association` "
+             "    WHERE `execution_id` IN ($0)) AS `Association`; "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `EventPath` WHERE `event_id` IN ( "
+             "   SELECT `id` FROM `Event` WHERE `execution_id` IN ($0) "
+             " ); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `Event` WHERE `execution_id` IN ($0); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `Association` WHERE `execution_id` IN ($0); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `ExecutionProperty` WHERE `execution_id` IN ($0); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `Execution` WHERE `id` IN ($0); "
+      parameter_num: 1
+    }
+  }
+  delete_contexts {
+    count_rows {
+      query: " SELECT "
+             "   (SELECT COUNT(*) FROM `Context` WHERE `id` IN ($0)) "
+             "     AS `Context`, "
+             "   (SELECT COUNT(*) FROM `ContextProperty` "
+             "    WHERE `context_id` IN ($0)) AS `ContextProperty`, "
+             "   (SELECT COUNT(*) FROM `Attribution` "
+             "    WHERE `context_id` IN ($0)) AS `Attribution`, "
+             "   (SELECT COUNT(*) FROM `Association` "
+             "    WHERE `context_id` IN ($0)) AS `Association`; "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `Attribution` WHERE `context_id` IN ($0); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `Association` WHERE `context_id` IN ($0); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `ContextProperty` WHERE `context_id` IN ($0); "
+      parameter_num: 1
+    }
+    delete_rows {
+      query: " DELETE FROM `Context` WHERE `id` IN ($0); "
+      parameter_num: 1
+    }
+  }
 )pb",
 R"pb(
   drop_association_table { query: " DROP TABLE IF EXISTS `Association`; " }
@@ -462,6 +733,24 @@ R"pb(
            " WHERE `execution_id` = $0; "
     parameter_num: 1
   }
+  insert_associations {
+    query: " INSERT OR IGNORE INTO `Association`( "
+           "   `context_id`, `execution_id` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  select_associations_by_context_ids_and_execution_ids {
+    query: " SELECT `id`, `context_id`, `execution_id` "
+           " from `Association` "
+           " WHERE `context_id` IN ($0) AND `execution_id` IN ($1); "
+    parameter_num: 2
+  }
+  select_associations_by_execution_ids {
+    query: " SELECT `id`, `context_id`, `execution_id` "
+           " from `Association` "
+           " WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
   drop_attribution_table { query: " DROP TABLE IF EXISTS `Attribution`; " }
   create_attribution_table {
     query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
@@ -493,6 +782,24 @@ R"pb(
            " WHERE `artifact_id` = $0; "
     parameter_num: 1
   }
+  insert_attributions {
+    query: " INSERT OR IGNORE INTO `Attribution`( "
+           "   `context_id`, `artifact_id` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  select_attributions_by_context_ids_and_artifact_ids {
+    query: " SELECT `id`, `context_id`, `artifact_id` "
+           " from `Attribution` "
+           " WHERE `context_id` IN ($0) AND `artifact_id` IN ($1); "
+    parameter_num: 2
+  }
+  select_attributions_by_artifact_ids {
+    query: " SELECT `id`, `context_id`, `artifact_id` "
+           " from `Attribution` "
+           " WHERE `artifact_id` IN ($0); "
+    parameter_num: 1
+  }
   drop_mlmd_env_table { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
   create_mlmd_env_table {
     query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
@@ -513,6 +820,124 @@ R"pb(
            " `Artifact`, `Event`, `Execution`, `Type`, `ArtifactProperty`, "
            " `EventPath`, `ExecutionProperty`, `TypeProperty` LIMIT 1; "
   }
+  create_migration_progress_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDEnvMigrationProgress` ( "
+           "   `schema_version` INTEGER PRIMARY KEY, "
+           "   `chunked_query_index` INT NOT NULL, "
+           "   `next_id` BIGINT NOT NULL "
+           " ); "
+  }
+  select_migration_progress {
+    query: " SELECT `chunked_query_index`, `next_id` "
+           " FROM `MLMDEnvMigrationProgress` WHERE `schema_version` = $0; "
+    parameter_num: 1
+  }
+  insert_migration_progress {
+    query: " INSERT INTO `MLMDEnvMigrationProgress` "
+           " (`schema_version`, `chunked_query_index`, `next_id`) "
+           " VALUES ($0, $1, $2); "
+    parameter_num: 3
+  }
+  update_migration_progress {
+    query: " UPDATE `MLMDEnvMigrationProgress` "
+           " SET `chunked_query_index` = $1, `next_id` = $2 "
+           " WHERE `schema_version` = $0; "
+    parameter_num: 3
+  }
+  drop_migration_progress_table {
+    query: " DROP TABLE IF EXISTS `MLMDEnvMigrationProgress`; "
+  }
+  create_change_log_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDChangeLog` ( "
+           "   `log_id` BIGINT NOT NULL, "
+           "   `last_sequence` BIGINT NOT NULL "
+           " ); "
+  }
+  select_change_log {
+    query: " SELECT `log_id`, `last_sequence` FROM `MLMDChangeLog`; "
+  }
+  insert_change_log {
+    query: " INSERT INTO `MLMDChangeLog` (`log_id`, `last_sequence`) "
+           " VALUES ($0, 0); "
+    parameter_num: 1
+  }
+  advance_change_log {
+    query: " UPDATE `MLMDChangeLog` "
+           " SET `last_sequence` = `last_sequence` + $0; "
+    parameter_num: 1
+  }
+  required_tables {
+    name: "Type"
+    column_names: [ "id", "name", "type_kind", "input_type", "output_type" ]
+  }
+  required_tables {
+    name: "TypeProperty"
+    column_names: [ "type_id", "name", "data_type", "is_indexed" ]
+  }
+  required_tables {
+    name: "Artifact"
+    column_names: [
+      "id", "type_id", "uri", "state", "name", "create_time_since_epoch",
+      "last_update_time_since_epoch", "packed_properties"
+    ]
+  }
+  required_tables {
+    name: "ArtifactProperty"
+    column_names: [
+      "artifact_id", "name", "is_custom_property", "int_value",
+      "double_value", "string_value"
+    ]
+  }
+  required_tables {
+    name: "Execution"
+    column_names: [
+      "id", "type_id", "last_known_state", "name", "create_time_since_epoch",
+      "last_update_time_since_epoch", "packed_properties"
+    ]
+  }
+  required_tables {
+    name: "ExecutionProperty"
+    column_names: [
+      "execution_id", "name", "is_custom_property", "int_value",
+      "double_value", "string_value"
+    ]
+  }
+  required_tables {
+    name: "Event"
+    column_names: [
+      "id", "artifact_id", "execution_id", "type", "milliseconds_since_epoch"
+    ]
+  }
+  required_tables {
+    name: "EventPath"
+    column_names: [ "event_id", "is_index_step", "step_index", "step_key" ]
+  }
+  required_tables {
+    name: "MLMDEnv"
+    column_names: [ "schema_version" ]
+  }
+  required_tables {
+    name: "Context"
+    column_names: [
+      "id", "type_id", "name", "create_time_since_epoch",
+      "last_update_time_since_epoch", "packed_properties"
+    ]
+  }
+  required_tables {
+    name: "ContextProperty"
+    column_names: [
+      "context_id", "name", "is_custom_property", "int_value",
+      "double_value", "string_value"
+    ]
+  }
+  required_tables {
+    name: "Association"
+    column_names: [ "id", "context_id", "execution_id" ]
+  }
+  required_tables {
+    name: "Attribution"
+    column_names: [ "id", "context_id", "artifact_id" ]
+  }
 )pb");
 
 // no-lint to support vc (C2026) 16380 max length for char[].
@@ -955,14 +1380,6 @@ R"pb(
                "   UNIQUE(`type_id`, `name`) "
                " ); "
       }
-      upgrade_queries {
-        query: " INSERT INTO `ArtifactTemp` (`id`, `type_id`, `uri`) "
-               " SELECT * FROM `Artifact`; "
-      }
-      upgrade_queries { query: " DROP TABLE `Artifact`; " }
-      upgrade_queries {
-        query: " ALTER TABLE `ArtifactTemp` RENAME TO `Artifact`; "
-      }
       # upgrade Execution table
       upgrade_queries {
         query: " CREATE TABLE `ExecutionTemp` ( "
@@ -975,13 +1392,55 @@ R"pb(
                "   UNIQUE(`type_id`, `name`) "
                " ); "
       }
+      # mirror the writes of clients of the previous version into the copies
+      # while the rows are copied in chunks.
       upgrade_queries {
-        query: " INSERT INTO `ExecutionTemp` (`id`, `type_id`) "
-               " SELECT * FROM `Execution`; "
+        query: " CREATE TRIGGER `ArtifactTempInsert` "
+               " AFTER INSERT ON `Artifact` "
+               " BEGIN "
+               "   INSERT OR REPLACE INTO `ArtifactTemp` "
+               "       (`id`, `type_id`, `uri`) "
+               "   VALUES (NEW.`id`, NEW.`type_id`, NEW.`uri`); "
+               " END; "
       }
-      upgrade_queries { query: " DROP TABLE `Execution`; " }
       upgrade_queries {
-        query: " ALTER TABLE `ExecutionTemp` RENAME TO `Execution`; "
+        query: " CREATE TRIGGER `ArtifactTempUpdate` "
+               " AFTER UPDATE ON `Artifact` "
+               " BEGIN "
+               "   INSERT OR REPLACE INTO `ArtifactTemp` "
+               "       (`id`, `type_id`, `uri`) "
+               "   VALUES (NEW.`id`, NEW.`type_id`, NEW.`uri`); "
+               " END; "
+      }
+      upgrade_queries {
+        query: " CREATE TRIGGER `ArtifactTempDelete` "
+               " AFTER DELETE ON `Artifact` "
+               " BEGIN "
+               "   DELETE FROM `ArtifactTemp` WHERE `id` = OLD.`id`; "
+               " END; "
+      }
+      upgrade_queries {
+        query: " CREATE TRIGGER `ExecutionTempInsert` "
+               " AFTER INSERT ON `Execution` "
+               " BEGIN "
+               "   INSERT OR REPLACE INTO `ExecutionTemp` (`id`, `type_id`) "
+               "   VALUES (NEW.`id`, NEW.`type_id`); "
+               " END; "
+      }
+      upgrade_queries {
+        query: " CREATE TRIGGER `ExecutionTempUpdate` "
+               " AFTER UPDATE ON `Execution` "
+               " BEGIN "
+               "   INSERT OR REPLACE INTO `ExecutionTemp` (`id`, `type_id`) "
+               "   VALUES (NEW.`id`, NEW.`type_id`); "
+               " END; "
+      }
+      upgrade_queries {
+        query: " CREATE TRIGGER `ExecutionTempDelete` "
+               " AFTER DELETE ON `Execution` "
+               " BEGIN "
+               "   DELETE FROM `ExecutionTemp` WHERE `id` = OLD.`id`; "
+               " END; "
       }
       # upgrade Context table
       upgrade_queries {
@@ -993,6 +1452,55 @@ R"pb(
                " ADD COLUMN "
                "     `last_update_time_since_epoch` INT NOT NULL DEFAULT 0; "
       }
+      # copy the Artifact and Execution tables in chunks, and replace them.
+      # The copies are dropped along with their triggers.
+      chunked_upgrade_queries {
+        select_chunk_end {
+          query: " SELECT MAX(`id`), COUNT(*) FROM ( "
+                 "   SELECT `id` FROM `Artifact` WHERE `id` >= $0 "
+                 "   ORDER BY `id` LIMIT $1 "
+                 " ) AS T; "
+          parameter_num: 2
+        }
+        count_remaining_rows {
+          query: " SELECT COUNT(*) FROM `Artifact` WHERE `id` >= $0; "
+          parameter_num: 1
+        }
+        query {
+          query: " INSERT OR REPLACE INTO `ArtifactTemp` "
+                 "     (`id`, `type_id`, `uri`) "
+                 " SELECT `id`, `type_id`, `uri` FROM `Artifact` "
+                 " WHERE `id` BETWEEN $0 AND $1; "
+          parameter_num: 2
+        }
+      }
+      chunked_upgrade_queries {
+        select_chunk_end {
+          query: " SELECT MAX(`id`), COUNT(*) FROM ( "
+                 "   SELECT `id` FROM `Execution` WHERE `id` >= $0 "
+                 "   ORDER BY `id` LIMIT $1 "
+                 " ) AS T; "
+          parameter_num: 2
+        }
+        count_remaining_rows {
+          query: " SELECT COUNT(*) FROM `Execution` WHERE `id` >= $0; "
+          parameter_num: 1
+        }
+        query {
+          query: " INSERT OR REPLACE INTO `ExecutionTemp` (`id`, `type_id`) "
+                 " SELECT `id`, `type_id` FROM `Execution` "
+                 " WHERE `id` BETWEEN $0 AND $1; "
+          parameter_num: 2
+        }
+      }
+      post_chunked_upgrade_queries { query: " DROP TABLE `Artifact`; " }
+      post_chunked_upgrade_queries {
+        query: " ALTER TABLE `ArtifactTemp` RENAME TO `Artifact`; "
+      }
+      post_chunked_upgrade_queries { query: " DROP TABLE `Execution`; " }
+      post_chunked_upgrade_queries {
+        query: " ALTER TABLE `ExecutionTemp` RENAME TO `Execution`; "
+      }
       # check the expected table columns are created properly.
       upgrade_verification {
         previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
@@ -1051,6 +1559,296 @@ R"pb(
                  " ) as T1; "
         }
       }
+      # downgrade queries from version 6
+      downgrade_queries {
+        query: " CREATE TABLE `TypePropertyTemp` ( "
+               "   `type_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `data_type` INT NULL, "
+               " PRIMARY KEY (`type_id`, `name`)); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `TypePropertyTemp` "
+               " SELECT `type_id`, `name`, `data_type` FROM `TypeProperty`; "
+      }
+      downgrade_queries { query: " DROP TABLE `TypeProperty`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `TypePropertyTemp` RENAME TO `TypeProperty`; "
+      }
+      # verify if the downgrading keeps the existing columns
+      downgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `TypeProperty`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `TypeProperty` "
+                 " (`type_id`, `name`, `data_type`, `is_indexed`) "
+                 " VALUES (1, 'p1', 1, 1); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT `type_id`, `name`, `data_type` "
+                 "   FROM `TypeProperty` "
+                 "   WHERE `type_id` = 1 AND `name` = 'p1' AND `data_type` = 1 "
+                 " ) as T1; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v6, to support user declared indexed properties, we added the
+  # is_indexed flag to TypeProperty. The property indexes themselves are
+  # created on demand when a type declares its indexed properties.
+  migration_schemes {
+    key: 6
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `TypeProperty` "
+               " ADD COLUMN `is_indexed` TINYINT(1) NOT NULL DEFAULT 0; "
+      }
+      # check the expected table columns are created properly.
+      upgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `TypeProperty`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `TypeProperty` "
+                 " (`type_id`, `name`, `data_type`) VALUES (1, 'p1', 1); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT `type_id`, `name`, `data_type`, `is_indexed` "
+                 "   FROM `TypeProperty` "
+                 "   WHERE `type_id` = 1 AND `name` = 'p1' AND "
+                 "         `data_type` = 1 AND `is_indexed` = 0 "
+                 " ) as T1; "
+        }
+      }
+      # downgrade queries from version 7
+      downgrade_queries {
+        query: " DROP INDEX `idx_Artifact_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_Execution_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_Context_last_update_time_since_epoch`; "
+      }
+      # verify the indexes are dropped
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND "
+                 "       `name` LIKE 'idx_%_last_update_time_since_epoch'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v7, to read the nodes updated since a time without scanning the node
+  # tables, we indexed Artifact, Execution and Context on their
+  # last_update_time_since_epoch.
+  migration_schemes {
+    key: 7
+    value: {
+      upgrade_queries {
+        query: " CREATE INDEX `idx_Artifact_last_update_time_since_epoch` "
+               " ON `Artifact`(`last_update_time_since_epoch`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX `idx_Execution_last_update_time_since_epoch` "
+               " ON `Execution`(`last_update_time_since_epoch`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX `idx_Context_last_update_time_since_epoch` "
+               " ON `Context`(`last_update_time_since_epoch`); "
+      }
+      # check the expected indexes are created properly.
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 3 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND "
+                 "       `name` LIKE 'idx_%_last_update_time_since_epoch'; "
+        }
+      }
+      # downgrade queries from version 8, which rebuild the node tables
+      # without the packed_properties column. The properties of packed nodes
+      # would be lost, so they must be rewritten as property rows first.
+      downgrade_preconditions {
+        query: " SELECT count(*) = 0 FROM `Artifact` "
+               " WHERE `packed_properties` IS NOT NULL; "
+      }
+      downgrade_preconditions {
+        query: " SELECT count(*) = 0 FROM `Execution` "
+               " WHERE `packed_properties` IS NOT NULL; "
+      }
+      downgrade_preconditions {
+        query: " SELECT count(*) = 0 FROM `Context` "
+               " WHERE `packed_properties` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE TABLE `ArtifactTemp` ( "
+               "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
+               "   `type_id` INT NOT NULL, "
+               "   `uri` TEXT, "
+               "   `state` INT, "
+               "   `name` VARCHAR(255), "
+               "   `create_time_since_epoch` INT NOT NULL DEFAULT 0, "
+               "   `last_update_time_since_epoch` INT NOT NULL DEFAULT 0, "
+               "   UNIQUE(`type_id`, `name`) "
+               " ); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `ArtifactTemp` "
+               " SELECT `id`, `type_id`, `uri`, `state`, `name`, "
+               "        `create_time_since_epoch`, "
+               "        `last_update_time_since_epoch` "
+               " FROM `Artifact`; "
+      }
+      downgrade_queries { query: " DROP TABLE `Artifact`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactTemp` RENAME TO `Artifact`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX `idx_Artifact_last_update_time_since_epoch` "
+               " ON `Artifact`(`last_update_time_since_epoch`); "
+      }
+      downgrade_queries {
+        query: " CREATE TABLE `ExecutionTemp` ( "
+               "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
+               "   `type_id` INT NOT NULL, "
+               "   `last_known_state` INT, "
+               "   `name` VARCHAR(255), "
+               "   `create_time_since_epoch` INT NOT NULL DEFAULT 0, "
+               "   `last_update_time_since_epoch` INT NOT NULL DEFAULT 0, "
+               "   UNIQUE(`type_id`, `name`) "
+               " ); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `ExecutionTemp` "
+               " SELECT `id`, `type_id`, `last_known_state`, `name`, "
+               "        `create_time_since_epoch`, "
+               "        `last_update_time_since_epoch` "
+               " FROM `Execution`; "
+      }
+      downgrade_queries { query: " DROP TABLE `Execution`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionTemp` RENAME TO `Execution`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX `idx_Execution_last_update_time_since_epoch` "
+               " ON `Execution`(`last_update_time_since_epoch`); "
+      }
+      downgrade_queries {
+        query: " CREATE TABLE `ContextTemp` ( "
+               "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
+               "   `type_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `create_time_since_epoch` INT NOT NULL DEFAULT 0, "
+               "   `last_update_time_since_epoch` INT NOT NULL DEFAULT 0, "
+               "   UNIQUE(`type_id`, `name`) "
+               " ); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `ContextTemp` "
+               " SELECT `id`, `type_id`, `name`, `create_time_since_epoch`, "
+               "        `last_update_time_since_epoch` "
+               " FROM `Context`; "
+      }
+      downgrade_queries { query: " DROP TABLE `Context`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextTemp` RENAME TO `Context`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX `idx_Context_last_update_time_since_epoch` "
+               " ON `Context`(`last_update_time_since_epoch`); "
+      }
+      # verify the columns are dropped, and the rows and indexes are kept.
+      downgrade_verification {
+        previous_version_setup_queries {
+          query: " INSERT INTO `Artifact` "
+                 " (`id`, `type_id`, `uri`, `state`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`, "
+                 "  `packed_properties`) "
+                 " VALUES (1, 2, 'uri1', 1, 'name1', 0, 1, NULL); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Execution` "
+                 " (`id`, `type_id`, `last_known_state`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`, "
+                 "  `packed_properties`) "
+                 " VALUES (1, 2, 1, 'name1', 0, 1, NULL); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Context` "
+                 " (`id`, `type_id`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`, "
+                 "  `packed_properties`) "
+                 " VALUES (1, 2, 'name1', 0, 1, NULL); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 3 FROM `sqlite_master` "
+                 " WHERE `type` = 'table' AND "
+                 "       `name` IN ('Artifact', 'Execution', 'Context') AND "
+                 "       `sql` NOT LIKE '%packed_properties%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Artifact` "
+                 " WHERE `id` = 1 AND `type_id` = 2 AND `uri` = 'uri1' AND "
+                 "       `state` = 1 AND `name` = 'name1' AND "
+                 "       `create_time_since_epoch` = 0 AND "
+                 "       `last_update_time_since_epoch` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Execution` "
+                 " WHERE `id` = 1 AND `type_id` = 2 AND "
+                 "       `last_known_state` = 1 AND `name` = 'name1' AND "
+                 "       `create_time_since_epoch` = 0 AND "
+                 "       `last_update_time_since_epoch` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Context` "
+                 " WHERE `id` = 1 AND `type_id` = 2 AND `name` = 'name1' AND "
+                 "       `create_time_since_epoch` = 0 AND "
+                 "       `last_update_time_since_epoch` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 3 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND "
+                 "       `name` LIKE 'idx_%_last_update_time_since_epoch'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v8, to read and write the properties of a node as a single row, we
+  # added the packed_properties column to Artifact, Execution and Context.
+  migration_schemes {
+    key: 8
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Artifact` ADD COLUMN `packed_properties` TEXT; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Execution` ADD COLUMN `packed_properties` TEXT; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Context` ADD COLUMN `packed_properties` TEXT; "
+      }
+      # check the existing nodes keep their property rows.
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `Artifact` "
+                 " WHERE `packed_properties` IS NOT NULL; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `Execution` "
+                 " WHERE `packed_properties` IS NOT NULL; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `Context` "
+                 " WHERE `packed_properties` IS NOT NULL; "
+        }
+      }
     }
   }
 )pb");
@@ -1061,6 +1859,14 @@ const std::string kMySQLMetadataSourceQueryConfig = absl::StrCat( // NOLINT
 R"pb(
   metadata_source_type: MYSQL_METADATA_SOURCE
   select_last_insert_id { query: " SELECT last_insert_id(); " }
+  select_first_insert_id {
+    query: " SELECT last_insert_id(), $0; "
+    parameter_num: 1
+  }
+  select_consecutive_insert_ids {
+    query: " SELECT @@auto_increment_increment = 1 AND "
+           "   @@innodb_autoinc_lock_mode <> 2; "
+  }
   create_type_table {
     query: " CREATE TABLE IF NOT EXISTS `Type` ( "
            "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
@@ -1079,6 +1885,7 @@ R"pb(
            "   `name` VARCHAR(255), "
            "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
            "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `packed_properties` MEDIUMTEXT, "
            "   CONSTRAINT UniqueArtifactTypeName UNIQUE(`type_id`, `name`) "
            " ); "
   }
@@ -1090,6 +1897,7 @@ R"pb(
            "   `name` VARCHAR(255), "
            "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
            "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `packed_properties` MEDIUMTEXT, "
            "   CONSTRAINT UniqueExecutionTypeName UNIQUE(`type_id`, `name`) "
            " ); "
   }
@@ -1100,6 +1908,7 @@ R"pb(
            "   `name` VARCHAR(255) NOT NULL, "
            "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
            "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `packed_properties` MEDIUMTEXT, "
            "   UNIQUE(`type_id`, `name`) "
            " ); "
   }
@@ -1128,6 +1937,36 @@ R"pb(
            "   UNIQUE(`context_id`, `artifact_id`) "
            " ); "
   }
+  insert_associations {
+    query: " INSERT IGNORE INTO `Association`( "
+           "   `context_id`, `execution_id` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  insert_attributions {
+    query: " INSERT IGNORE INTO `Attribution`( "
+           "   `context_id`, `artifact_id` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  check_property_index {
+    query: " SELECT DISTINCT `index_name` "
+           " FROM `information_schema`.`statistics` "
+           " WHERE `table_schema` = (SELECT DATABASE()) AND "
+           "       `table_name` = '$0' AND `index_name` = 'idx_$0_$1'; "
+    parameter_num: 2
+  }
+  select_table_columns {
+    query: " SELECT `table_name`, `column_name` "
+           " FROM `information_schema`.`columns` "
+           " WHERE `table_schema` = (SELECT DATABASE()); "
+  }
+  # TEXT columns can only be indexed by a prefix.
+  create_string_property_index {
+    query: " CREATE INDEX `idx_$0_string_value` "
+           " ON `$0`(`name`, `is_custom_property`, `string_value`(255)); "
+    parameter_num: 1
+  }
   # downgrade to 0.13.2 (i.e., v0), and drops the MLMDEnv table.
   migration_schemes {
     key: 0
@@ -1504,27 +2343,93 @@ R"pb(
   migration_schemes {
     key: 5
     value: {
-      # upgrade Artifact table
+      # upgrade Artifact table. DDL statements commit implicitly, so the
+      # copies and their triggers are created idempotently in case the
+      # migration is interrupted before its progress is recorded.
       upgrade_queries {
-        query: " ALTER TABLE `Artifact` ADD ( "
+        query: " CREATE TABLE IF NOT EXISTS `ArtifactTemp` ( "
+               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+               "   `type_id` INT NOT NULL, "
+               "   `uri` TEXT, "
                "   `state` INT, "
                "   `name` VARCHAR(255), "
                "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
-               " ), "
-               " ADD CONSTRAINT UniqueArtifactTypeName "
-               " UNIQUE(`type_id`, `name`); "
+               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+               "   CONSTRAINT UniqueArtifactTypeName UNIQUE(`type_id`, `name`) "
+               " ); "
       }
       # upgrade Execution table
       upgrade_queries {
-        query: " ALTER TABLE `Execution` ADD ( "
+        query: " CREATE TABLE IF NOT EXISTS `ExecutionTemp` ( "
+               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+               "   `type_id` INT NOT NULL, "
                "   `last_known_state` INT, "
                "   `name` VARCHAR(255), "
                "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
-               " ), "
-               " ADD CONSTRAINT UniqueExecutionTypeName "
-               " UNIQUE(`type_id`, `name`); "
+               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+               "   CONSTRAINT UniqueExecutionTypeName "
+               "       UNIQUE(`type_id`, `name`) "
+               " ); "
+      }
+      # mirror the writes of clients of the previous version into the copies
+      # while the rows are copied in chunks.
+      upgrade_queries {
+        query: " DROP TRIGGER IF EXISTS `ArtifactTempInsert`; "
+      }
+      upgrade_queries {
+        query: " CREATE TRIGGER `ArtifactTempInsert` "
+               " AFTER INSERT ON `Artifact` "
+               " FOR EACH ROW "
+               " REPLACE INTO `ArtifactTemp` (`id`, `type_id`, `uri`) "
+               " VALUES (NEW.`id`, NEW.`type_id`, NEW.`uri`); "
+      }
+      upgrade_queries {
+        query: " DROP TRIGGER IF EXISTS `ArtifactTempUpdate`; "
+      }
+      upgrade_queries {
+        query: " CREATE TRIGGER `ArtifactTempUpdate` "
+               " AFTER UPDATE ON `Artifact` "
+               " FOR EACH ROW "
+               " REPLACE INTO `ArtifactTemp` (`id`, `type_id`, `uri`) "
+               " VALUES (NEW.`id`, NEW.`type_id`, NEW.`uri`); "
+      }
+      upgrade_queries {
+        query: " DROP TRIGGER IF EXISTS `ArtifactTempDelete`; "
+      }
+      upgrade_queries {
+        query: " CREATE TRIGGER `ArtifactTempDelete` "
+               " AFTER DELETE ON `Artifact` "
+               " FOR EACH ROW "
+               " DELETE FROM `ArtifactTemp` WHERE `id` = OLD.`id`; "
+      }
+      upgrade_queries {
+        query: " DROP TRIGGER IF EXISTS `ExecutionTempInsert`; "
+      }
+      upgrade_queries {
+        query: " CREATE TRIGGER `ExecutionTempInsert` "
+               " AFTER INSERT ON `Execution` "
+               " FOR EACH ROW "
+               " REPLACE INTO `ExecutionTemp` (`id`, `type_id`) "
+               " VALUES (NEW.`id`, NEW.`type_id`); "
+      }
+      upgrade_queries {
+        query: " DROP TRIGGER IF EXISTS `ExecutionTempUpdate`; "
+      }
+      upgrade_queries {
+        query: " CREATE TRIGGER `ExecutionTempUpdate` "
+               " AFTER UPDATE ON `Execution` "
+               " FOR EACH ROW "
+               " REPLACE INTO `ExecutionTemp` (`id`, `type_id`) "
+               " VALUES (NEW.`id`, NEW.`type_id`); "
+      }
+      upgrade_queries {
+        query: " DROP TRIGGER IF EXISTS `ExecutionTempDelete`; "
+      }
+      upgrade_queries {
+        query: " CREATE TRIGGER `ExecutionTempDelete` "
+               " AFTER DELETE ON `Execution` "
+               " FOR EACH ROW "
+               " DELETE FROM `ExecutionTemp` WHERE `id` = OLD.`id`; "
       }
       # upgrade Context table
       upgrade_queries {
@@ -1533,6 +2438,55 @@ R"pb(
                "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
                " ) "
       }
+      # copy the Artifact and Execution tables in chunks, and replace them.
+      # The renames are atomic, and the copies are dropped along with their
+      # triggers.
+      chunked_upgrade_queries {
+        select_chunk_end {
+          query: " SELECT MAX(`id`), COUNT(*) FROM ( "
+                 "   SELECT `id` FROM `Artifact` WHERE `id` >= $0 "
+                 "   ORDER BY `id` LIMIT $1 "
+                 " ) AS T; "
+          parameter_num: 2
+        }
+        count_remaining_rows {
+          query: " SELECT COUNT(*) FROM `Artifact` WHERE `id` >= $0; "
+          parameter_num: 1
+        }
+        query {
+          query: " REPLACE INTO `ArtifactTemp` (`id`, `type_id`, `uri`) "
+                 " SELECT `id`, `type_id`, `uri` FROM `Artifact` "
+                 " WHERE `id` BETWEEN $0 AND $1; "
+          parameter_num: 2
+        }
+      }
+      chunked_upgrade_queries {
+        select_chunk_end {
+          query: " SELECT MAX(`id`), COUNT(*) FROM ( "
+                 "   SELECT `id` FROM `Execution` WHERE `id` >= $0 "
+                 "   ORDER BY `id` LIMIT $1 "
+                 " ) AS T; "
+          parameter_num: 2
+        }
+        count_remaining_rows {
+          query: " SELECT COUNT(*) FROM `Execution` WHERE `id` >= $0; "
+          parameter_num: 1
+        }
+        query {
+          query: " REPLACE INTO `ExecutionTemp` (`id`, `type_id`) "
+                 " SELECT `id`, `type_id` FROM `Execution` "
+                 " WHERE `id` BETWEEN $0 AND $1; "
+          parameter_num: 2
+        }
+      }
+      post_chunked_upgrade_queries {
+        query: " RENAME TABLE `Artifact` TO `ArtifactOld`, "
+               "     `ArtifactTemp` TO `Artifact`, "
+               "     `Execution` TO `ExecutionOld`, "
+               "     `ExecutionTemp` TO `Execution`; "
+      }
+      post_chunked_upgrade_queries { query: " DROP TABLE `ArtifactOld`; " }
+      post_chunked_upgrade_queries { query: " DROP TABLE `ExecutionOld`; " }
       # check the expected table columns are created properly.
       upgrade_verification {
         previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
@@ -1591,38 +2545,219 @@ R"pb(
                  " ) as T1; "
         }
       }
+      # downgrade queries from version 6
+      downgrade_queries {
+        query: " ALTER TABLE `TypeProperty` DROP COLUMN `is_indexed`; "
+      }
+      # verify if the downgrading keeps the existing columns
+      downgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `TypeProperty`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `TypeProperty` "
+                 " (`type_id`, `name`, `data_type`, `is_indexed`) "
+                 " VALUES (1, 'p1', 1, 1); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT `type_id`, `name`, `data_type` "
+                 "   FROM `TypeProperty` "
+                 "   WHERE `type_id` = 1 AND `name` = 'p1' AND `data_type` = 1 "
+                 " ) as T1; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 6
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `TypeProperty` "
+               " ADD COLUMN `is_indexed` TINYINT(1) NOT NULL DEFAULT 0; "
+      }
+      # check the expected table columns are created properly.
+      upgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `TypeProperty`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `TypeProperty` "
+                 " (`type_id`, `name`, `data_type`) VALUES (1, 'p1', 1); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT `type_id`, `name`, `data_type`, `is_indexed` "
+                 "   FROM `TypeProperty` "
+                 "   WHERE `type_id` = 1 AND `name` = 'p1' AND "
+                 "         `data_type` = 1 AND `is_indexed` = 0 "
+                 " ) as T1; "
+        }
+      }
+      # downgrade queries from version 7
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " DROP INDEX `idx_Artifact_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               " DROP INDEX `idx_Execution_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Context` "
+               " DROP INDEX `idx_Context_last_update_time_since_epoch`; "
+      }
+      # verify the indexes are dropped
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(DISTINCT `index_name`) = 0 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `index_name` LIKE "
+                 "         'idx_%_last_update_time_since_epoch'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 7
+    value: {
+      upgrade_queries {
+        query: " CREATE INDEX `idx_Artifact_last_update_time_since_epoch` "
+               " ON `Artifact`(`last_update_time_since_epoch`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX `idx_Execution_last_update_time_since_epoch` "
+               " ON `Execution`(`last_update_time_since_epoch`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX `idx_Context_last_update_time_since_epoch` "
+               " ON `Context`(`last_update_time_since_epoch`); "
+      }
+      # check the expected indexes are created properly.
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(DISTINCT `index_name`) = 3 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `index_name` LIKE "
+                 "         'idx_%_last_update_time_since_epoch'; "
+        }
+      }
+      # downgrade queries from version 8, which drop the packed_properties
+      # column. The properties of packed nodes would be lost, so they must be
+      # rewritten as property rows first.
+      downgrade_preconditions {
+        query: " SELECT count(*) = 0 FROM `Artifact` "
+               " WHERE `packed_properties` IS NOT NULL; "
+      }
+      downgrade_preconditions {
+        query: " SELECT count(*) = 0 FROM `Execution` "
+               " WHERE `packed_properties` IS NOT NULL; "
+      }
+      downgrade_preconditions {
+        query: " SELECT count(*) = 0 FROM `Context` "
+               " WHERE `packed_properties` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` DROP COLUMN `packed_properties`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` DROP COLUMN `packed_properties`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Context` DROP COLUMN `packed_properties`; "
+      }
+      # verify the columns are dropped
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 "
+                 " FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `column_name` = 'packed_properties'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 8
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " ADD COLUMN `packed_properties` MEDIUMTEXT; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               " ADD COLUMN `packed_properties` MEDIUMTEXT; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Context` "
+               " ADD COLUMN `packed_properties` MEDIUMTEXT; "
+      }
+      # check the existing nodes keep their property rows.
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `Artifact` "
+                 " WHERE `packed_properties` IS NOT NULL; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `Execution` "
+                 " WHERE `packed_properties` IS NOT NULL; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `Context` "
+                 " WHERE `packed_properties` IS NOT NULL; "
+        }
+      }
     }
   }
 )pb");
 
+// Parses the `kBaseQueryConfig` merged with the `source_query_config`.
+// The returned config is never deleted, as it is cached for the process.
+MetadataSourceQueryConfig* ParseQueryConfig(
+    const std::string& source_query_config) {
+  auto* config = new MetadataSourceQueryConfig();
+  CHECK(tensorflow::protobuf::TextFormat::ParseFromString(kBaseQueryConfig,
+                                                          config));
+  MetadataSourceQueryConfig source_config;
+  CHECK(tensorflow::protobuf::TextFormat::ParseFromString(source_query_config,
+                                                          &source_config));
+  config->MergeFrom(source_config);
+  return config;
+}
+
 }  // namespace
 
 // The `MetadataSourceQueryConfig` protobuf messages are merged to the query
 // config with `MergeFrom`.
 // Note: Singular fields overwrite the `kBaseQueryConfig` message. Repeated
 // fields by default are concatenated to it and should be used with caution.
+// The text protos are parsed once per process, and the parsed configs are
+// copied for each caller.
 MetadataSourceQueryConfig GetMySqlMetadataSourceQueryConfig() {
-  MetadataSourceQueryConfig config;
-  CHECK(tensorflow::protobuf::TextFormat::ParseFromString(kBaseQueryConfig,
-                                                          &config));
-  MetadataSourceQueryConfig mysql_config;
-  CHECK(tensorflow::protobuf::TextFormat::ParseFromString(
-      kMySQLMetadataSourceQueryConfig, &mysql_config));
-  config.MergeFrom(mysql_config);
-  return config;
+  static const MetadataSourceQueryConfig* const kConfig =
+      ParseQueryConfig(kMySQLMetadataSourceQueryConfig);
+  return *kConfig;
 }
 
 MetadataSourceQueryConfig GetSqliteMetadataSourceQueryConfig() {
+  static const MetadataSourceQueryConfig* const kConfig =
+      ParseQueryConfig(kSQLiteMetadataSourceQueryConfig);
+  return *kConfig;
+}
+
+MetadataSourceQueryConfig GetFakeMetadataSourceQueryConfig() {
+  static const MetadataSourceQueryConfig* const kBaseConfig =
+      ParseQueryConfig(/*source_query_config=*/"");
+  // The in-memory source runs no queries, and only has the schema version.
   MetadataSourceQueryConfig config;
-  CHECK(tensorflow::protobuf::TextFormat::ParseFromString(kBaseQueryConfig,
-                                                          &config));
-  MetadataSourceQueryConfig sqlite_config;
-  CHECK(tensorflow::protobuf::TextFormat::ParseFromString(
-      kSQLiteMetadataSourceQueryConfig, &sqlite_config));
-  config.MergeFrom(sqlite_config);
+  config.set_metadata_source_type(FAKE_METADATA_SOURCE);
+  config.set_schema_version(kBaseConfig->schema_version());
   return config;
 }
 
-
 }  // namespace util
 }  // namespace ml_metadata
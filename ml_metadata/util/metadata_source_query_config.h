@@ -26,7 +26,8 @@ MetadataSourceQueryConfig GetMySqlMetadataSourceQueryConfig();
 // Gets the MetadataSourceQueryConfig for SQLiteMetadataSource.
 MetadataSourceQueryConfig GetSqliteMetadataSourceQueryConfig();
 
-// Gets the MetadataSourceQueryConfig for FakeMetadataSource.
+// Gets the MetadataSourceQueryConfig for InMemoryMetadataSource, which has no
+// queries.
 MetadataSourceQueryConfig GetFakeMetadataSourceQueryConfig();
 
 
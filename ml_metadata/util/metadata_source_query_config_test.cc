@@ -15,6 +15,7 @@ limitations under the License.
 #include "ml_metadata/util/metadata_source_query_config.h"
 
 #include <gtest/gtest.h>
+#include "absl/strings/match.h"
 
 namespace ml_metadata {
 namespace util {
@@ -23,11 +24,17 @@ namespace {
 TEST(MetadataSourceQueryConfig, GetMySqlMetadataSourceQueryConfig) {
   const MetadataSourceQueryConfig config = GetMySqlMetadataSourceQueryConfig();
   EXPECT_EQ(config.metadata_source_type(), MYSQL_METADATA_SOURCE);
+  EXPECT_TRUE(absl::StrContains(config.select_table_columns().query(),
+                                "information_schema"));
+  EXPECT_EQ(config.required_tables_size(), 13);
 }
 
 TEST(MetadataSourceQueryConfig, GetSqliteMetadataSourceQueryConfig) {
   const MetadataSourceQueryConfig config = GetSqliteMetadataSourceQueryConfig();
   EXPECT_EQ(config.metadata_source_type(), SQLITE_METADATA_SOURCE);
+  EXPECT_TRUE(absl::StrContains(config.select_table_columns().query(),
+                                "sqlite_master"));
+  EXPECT_EQ(config.required_tables_size(), 13);
 }
 
 